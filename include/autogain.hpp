@@ -19,13 +19,13 @@
 
 #pragma once
 
-#include <ebur128.h>
-#include <sigc++/signal.h>
 #include <sys/types.h>
+#include <cstddef>
 #include <span>
 #include <string>
 #include <thread>
 #include <vector>
+#include "loudness_analyzer.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 
@@ -59,16 +59,21 @@ class AutoGain : public PluginBase {
                std::span<float>& left_out,
                std::span<float>& right_out) override;
 
+  void process(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs) override;
+
   auto get_latency_seconds() -> float override;
 
-  sigc::signal<void(const double,  // loudness
-                    const double,  // gain
-                    const double,  // momentary
-                    const double,  // shortterm
-                    const double,  // integrated
-                    const double,  // relative
-                    const double)>
-      results;  // range
+  // Positions of the loudness meters in the extra values of the meter board slot
+
+  enum Meter : size_t {
+    loudness_meter,
+    gain_meter,
+    momentary_meter,
+    shortterm_meter,
+    integrated_meter,
+    relative_meter,
+    range_meter
+  };
 
   double momentary = 0.0;
   double shortterm = 0.0;
@@ -86,11 +91,11 @@ class AutoGain : public PluginBase {
   double silence_threshold = -70.0;
   double internal_output_gain = 1.0;
 
-  Reference reference = Reference::geometric_mean_msi;
+  float applied_output_gain = 1.0F;  // gain used at the end of the previous quantum
 
-  std::vector<float> data;
+  Reference reference = Reference::geometric_mean_msi;
 
-  ebur128_state* ebur_state = nullptr;
+  LoudnessAnalyzer loudness_analyzer;
 
   std::vector<std::thread> mythreads;
 
@@ -98,5 +103,7 @@ class AutoGain : public PluginBase {
 
   static auto parse_reference_key(const std::string& key) -> Reference;
 
-  void set_maximum_history(const int& seconds);
+  void update_gain();
+
+  void apply_setup();
 };
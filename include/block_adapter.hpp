@@ -0,0 +1,327 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <numeric>
+#include <span>
+#include <vector>
+
+/*
+  Adapts the PipeWire quantum to processors that work on fixed size blocks, and buffers the output of processors that
+  produce a variable amount of samples per cycle.
+
+  All memory is allocated in setup(). The methods used in the realtime thread only do bulk copies on preallocated
+  buffers.
+
+  Latency is computed in the same way for every user. When the quantum is not a multiple of the block size the output
+  is primed with the smallest number of silent frames that guarantees a full quantum in every cycle. That number is
+  block_size - gcd(block_size, quantum). If the output still runs short, the missing frames are prepended as silence
+  and added to the latency.
+*/
+
+template <typename T = float>
+class BlockAdapter {
+ public:
+  BlockAdapter() = default;
+  BlockAdapter(const BlockAdapter&) = delete;
+  auto operator=(const BlockAdapter&) -> BlockAdapter& = delete;
+  BlockAdapter(const BlockAdapter&&) = delete;
+  auto operator=(const BlockAdapter&&) -> BlockAdapter& = delete;
+  ~BlockAdapter() = default;
+
+  /*
+    block_size: number of frames handed to the block callback.
+    quantum: number of frames read and written per cycle.
+    n_priming: frames of silence queued before the first cycle.
+    fifo_capacity: maximum number of frames waiting in the output. Zero selects a size suitable for process().
+    n_channels: number of channels. The stereo methods use the first two.
+  */
+
+  void setup(const size_t& block_size,
+             const size_t& quantum,
+             const size_t& n_priming,
+             const size_t& fifo_capacity = 0U,
+             const size_t& n_channels = 2U) {
+    block = block_size;
+    quantum_size = quantum;
+
+    blocks.assign(n_channels, std::vector<T>(block, static_cast<T>(0)));
+
+    block_views.clear();
+
+    for (auto& b : blocks) {
+      block_views.emplace_back(b);
+    }
+
+    direct_views.resize(n_channels);
+
+    const auto capacity = (fifo_capacity != 0U) ? fifo_capacity : block + quantum + n_priming;
+
+    fifos.assign(n_channels, std::vector<T>(std::max(capacity, n_priming + quantum), static_cast<T>(0)));
+
+    block_fill = 0U;
+    head = 0U;
+    overruns = 0U;
+
+    // The fifo is already zeroed. Priming only has to account for the frames.
+
+    priming = n_priming;
+    count = n_priming;
+    latency = n_priming;
+  }
+
+  // Drops the buffered frames and starts again as after setup(). It does not allocate.
+
+  void reset() {
+    for (auto& b : blocks) {
+      std::ranges::fill(b, static_cast<T>(0));
+    }
+
+    for (auto& f : fifos) {
+      std::ranges::fill(f, static_cast<T>(0));
+    }
+
+    block_fill = 0U;
+    head = 0U;
+
+    count = priming;
+    latency = priming;
+  }
+
+  static auto get_priming(const size_t& block_size, const size_t& quantum) -> size_t {
+    if (block_size == 0U || quantum % block_size == 0U) {
+      return 0U;
+    }
+
+    return block_size - std::gcd(block_size, quantum);
+  }
+
+  [[nodiscard]] auto get_latency() const -> size_t { return latency; }
+
+  [[nodiscard]] auto get_block_size() const -> size_t { return block; }
+
+  [[nodiscard]] auto get_overruns() const -> size_t { return overruns; }
+
+  [[nodiscard]] auto get_n_channels() const -> size_t { return fifos.size(); }
+
+  /*
+    Re-blocks the input, runs process_block(std::span<T>& left, std::span<T>& right) in place on every complete block
+    and writes one quantum to the output. When the quantum is a multiple of the block size and nothing is buffered the
+    blocks are processed directly on the output buffers.
+  */
+
+  template <typename Callback>
+  void process(std::span<T>& left_in,
+               std::span<T>& right_in,
+               std::span<T>& left_out,
+               std::span<T>& right_out,
+               Callback&& process_block) {
+    std::array<std::span<T>, 2U> in = {left_in, right_in};
+    std::array<std::span<T>, 2U> out = {left_out, right_out};
+
+    process(std::span<const std::span<T>>(in), std::span<const std::span<T>>(out),
+            [&](std::span<std::span<T>> b) { process_block(b[0], b[1]); });
+  }
+
+  // Same as above for any number of channels. The callback receives one span per channel.
+
+  template <typename Callback>
+  void process(std::span<const std::span<T>> in, std::span<const std::span<T>> out, Callback&& process_block) {
+    const auto n_channels = std::min(in.size(), out.size());
+
+    if (block == 0U || n_channels == 0U || n_channels > fifos.size() || in[0].size() != quantum_size) {
+      for (size_t c = 0U; c < n_channels; c++) {
+        std::ranges::copy(in[c], out[c].begin());
+      }
+
+      return;
+    }
+
+    if (block_fill == 0U && count == 0U && quantum_size % block == 0U) {
+      for (size_t c = 0U; c < n_channels; c++) {
+        std::ranges::copy(in[c], out[c].begin());
+      }
+
+      for (size_t offset = 0U; offset < quantum_size; offset += block) {
+        for (size_t c = 0U; c < n_channels; c++) {
+          direct_views[c] = out[c].subspan(offset, block);
+        }
+
+        process_block(std::span<std::span<T>>(direct_views.data(), n_channels));
+      }
+
+      return;
+    }
+
+    write_frames(n_channels, in[0].size(), [&](const size_t& c) { return in[c].data(); },
+                 [&](std::span<std::span<T>> b) {
+                   process_block(b);
+
+                   push_frames(b.size(), b[0].size(), [&](const size_t& c) { return b[c].data(); });
+                 });
+
+    pop_frames(n_channels, out[0].size(), [&](const size_t& c) { return out[c].data(); });
+  }
+
+  /*
+    Accumulates the input and calls on_block(std::span<T>& left, std::span<T>& right) for every complete block. The
+    callback decides what to do with the result. Usually it calls push().
+  */
+
+  template <typename Callback>
+  void write(const std::span<const T>& left, const std::span<const T>& right, Callback&& on_block) {
+    write_frames(2U, left.size(), [&](const size_t& c) { return (c == 0U) ? left.data() : right.data(); },
+                 [&](std::span<std::span<T>> b) { on_block(b[0], b[1]); });
+  }
+
+  // Appends frames to the output. When the fifo is full the oldest frames are dropped.
+
+  void push(const std::span<const T>& left, const std::span<const T>& right) {
+    push_frames(2U, left.size(), [&](const size_t& c) { return (c == 0U) ? left.data() : right.data(); });
+  }
+
+  // Fills the output buffers. Missing frames are prepended as silence and counted as latency.
+
+  void pop(std::span<T>& left_out, std::span<T>& right_out) {
+    pop_frames(2U, left_out.size(), [&](const size_t& c) { return (c == 0U) ? left_out.data() : right_out.data(); });
+  }
+
+ private:
+  size_t block = 0U;
+  size_t quantum_size = 0U;
+  size_t block_fill = 0U;
+  size_t head = 0U;
+  size_t count = 0U;
+  size_t latency = 0U;
+  size_t priming = 0U;
+  size_t overruns = 0U;
+
+  std::vector<std::vector<T>> blocks;
+  std::vector<std::vector<T>> fifos;
+
+  std::vector<std::span<T>> block_views, direct_views;
+
+  /*
+    The helpers below take a function returning the buffer of a channel, so that the stereo and the multichannel
+    methods share the same code.
+  */
+
+  template <typename Source, typename Callback>
+  void write_frames(size_t n_channels, const size_t& n_frames, Source&& source, Callback&& on_block) {
+    n_channels = std::min(n_channels, blocks.size());
+
+    size_t n = 0U;
+
+    while (n < n_frames) {
+      const auto n_copy = std::min(block - block_fill, n_frames - n);
+
+      for (size_t c = 0U; c < n_channels; c++) {
+        std::copy_n(source(c) + n, n_copy, blocks[c].begin() + block_fill);
+      }
+
+      block_fill += n_copy;
+      n += n_copy;
+
+      if (block_fill == block) {
+        on_block(std::span<std::span<T>>(block_views.data(), n_channels));
+
+        block_fill = 0U;
+      }
+    }
+  }
+
+  template <typename Source>
+  void push_frames(size_t n_channels, size_t n_frames, Source&& source) {
+    n_channels = std::min(n_channels, fifos.size());
+
+    if (n_channels == 0U) {
+      return;
+    }
+
+    const auto capacity = fifos[0].size();
+
+    size_t offset = 0U;
+
+    if (n_frames > capacity) {
+      overruns += n_frames - capacity;
+
+      offset = n_frames - capacity;
+      n_frames = capacity;
+    }
+
+    if (count + n_frames > capacity) {
+      const auto n_drop = count + n_frames - capacity;
+
+      overruns += n_drop;
+
+      head = (head + n_drop) % capacity;
+      count -= n_drop;
+    }
+
+    const auto tail = (head + count) % capacity;
+    const auto first = std::min(n_frames, capacity - tail);
+
+    for (size_t c = 0U; c < n_channels; c++) {
+      const auto* data = source(c) + offset;
+
+      std::copy_n(data, first, fifos[c].begin() + tail);
+      std::copy_n(data + first, n_frames - first, fifos[c].begin());
+    }
+
+    count += n_frames;
+  }
+
+  template <typename Destination>
+  void pop_frames(size_t n_channels, const size_t& n_frames, Destination&& destination) {
+    n_channels = std::min(n_channels, fifos.size());
+
+    if (n_channels == 0U) {
+      return;
+    }
+
+    const auto capacity = fifos[0].size();
+
+    size_t n_silence = 0U;
+
+    if (count < n_frames) {
+      n_silence = n_frames - count;
+
+      latency = std::min(latency + n_silence, capacity);
+    }
+
+    const auto n_read = n_frames - n_silence;
+    const auto first = std::min(n_read, capacity - head);
+
+    for (size_t c = 0U; c < n_channels; c++) {
+      auto* data = destination(c);
+
+      std::fill_n(data, n_silence, static_cast<T>(0));
+
+      std::copy_n(fifos[c].begin() + head, first, data + n_silence);
+      std::copy_n(fifos[c].begin(), n_read - first, data + n_silence + first);
+    }
+
+    head = (capacity != 0U) ? (head + n_read) % capacity : 0U;
+    count -= n_read;
+  }
+};
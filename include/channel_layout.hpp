@@ -0,0 +1,93 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+/*
+  Channel layouts of the Easy Effects virtual devices and of the filters linked between them. The order of the
+  positions is the one PipeWire uses for the layout and is also the order of the channels given to the plugins.
+*/
+
+namespace channel_layout {
+
+// The values match the channel-layout enum in the application schema
+
+enum class Layout { stereo, surround_51, surround_71 };
+
+enum class Side { left, right, center };
+
+inline auto get_positions(const Layout& layout) -> std::vector<std::string> {
+  switch (layout) {
+    case Layout::surround_51:
+      return {"FL", "FR", "FC", "LFE", "RL", "RR"};
+    case Layout::surround_71:
+      return {"FL", "FR", "FC", "LFE", "RL", "RR", "SL", "SR"};
+    default:
+      return {"FL", "FR"};
+  }
+}
+
+// Comma separated list for the audio.position property
+
+inline auto to_audio_position(const std::vector<std::string>& positions) -> std::string {
+  std::string output;
+
+  for (const auto& p : positions) {
+    output += (output.empty() ? "" : ",") + p;
+  }
+
+  return output;
+}
+
+inline auto is_lfe(const std::string& position) -> bool {
+  return position == "LFE";
+}
+
+// Channels that are neither on the left nor on the right feed both sides of the stereo meters and kernels
+
+inline auto get_side(const std::string& position) -> Side {
+  if (position == "FL" || position == "RL" || position == "SL") {
+    return Side::left;
+  }
+
+  if (position == "FR" || position == "RR" || position == "SR") {
+    return Side::right;
+  }
+
+  return Side::center;
+}
+
+}  // namespace channel_layout
+
+/*
+  How a plugin handles layouts with more than two channels.
+
+  stereo_only: only FL and FR go through the stereo process() and the other channels are copied to the output. This is
+  what the LV2 based plugins and the plugins that were not ported yet do.
+
+  per_channel: every channel is processed on its own with the same settings.
+
+  linked: the channels are processed together and share their detectors and gains.
+*/
+
+enum class ChannelPolicy { stereo_only, per_channel, linked };
@@ -0,0 +1,179 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <semaphore>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+  Process wide pool of workers for the long partitions of the convolution engines. The zita-convolver engines are
+  single level and run in the caller thread, so without the pool the whole kernel is convolved in the realtime thread.
+  Letting zita start its own threads for the long partitions instead would give every convolver and FIR filter its own
+  set of mostly idle realtime threads.
+
+  Every engine that has long partitions registers a Client with the function doing its work. A client has at most one
+  job in flight. Workers are started as clients are added, never more than there are clients or cores minus the one
+  left to the data loop, and are pinned to their cores. Submitting is lock free and can be done from the realtime
+  thread. Adding and removing clients must be done in the main thread.
+*/
+
+class ConvolutionPool {
+ public:
+  ConvolutionPool(const ConvolutionPool&) = delete;
+  auto operator=(const ConvolutionPool&) -> ConvolutionPool& = delete;
+  ConvolutionPool(const ConvolutionPool&&) = delete;
+  auto operator=(const ConvolutionPool&&) -> ConvolutionPool& = delete;
+  ~ConvolutionPool();
+
+  struct Stats {
+    uint64_t submitted = 0U;
+
+    uint64_t completed = 0U;
+
+    // Jobs that finished after their deadline
+
+    uint64_t late = 0U;
+
+    // Jobs that were not submitted because the previous one was still running when its result was needed
+
+    uint64_t dropped = 0U;
+
+    float max_run_time = 0.0F;  // ms
+
+    float max_lateness = 0.0F;  // ms
+  };
+
+  class Client {
+   public:
+    Client(std::string name, std::function<void()> job);
+    Client(const Client&) = delete;
+    auto operator=(const Client&) -> Client& = delete;
+    Client(const Client&&) = delete;
+    auto operator=(const Client&&) -> Client& = delete;
+    ~Client() = default;
+
+    [[nodiscard]] auto is_busy() const -> bool { return busy.load(std::memory_order_acquire); }
+
+    void record_drop() { dropped.fetch_add(1U, std::memory_order_relaxed); }
+
+    [[nodiscard]] auto get_name() const -> const std::string& { return name; }
+
+    [[nodiscard]] auto get_stats() const -> Stats;
+
+   private:
+    friend class ConvolutionPool;
+
+    const std::string name;
+
+    const std::function<void()> job;
+
+    std::atomic<bool> busy = false;
+
+    std::atomic<int64_t> deadline = 0;  // steady clock ns
+
+    std::atomic<uint64_t> submitted = 0U, completed = 0U, late = 0U, dropped = 0U;
+
+    std::atomic<float> max_run_time = 0.0F, max_lateness = 0.0F;
+  };
+
+  static auto get() -> ConvolutionPool&;
+
+  // Also starts a worker when there are fewer workers than clients
+
+  void add(Client* client);
+
+  // Waits for the job in flight, if any, and logs the client statistics.
+
+  void remove(Client* client);
+
+  // Blocks until the client has no job in flight. Must not be called from the realtime thread.
+
+  static void wait(const Client& client);
+
+  /*
+    Queues the client job. The budget is the time available until its result is needed and is used only for the
+    statistics. Returns false when the client still has a job in flight.
+  */
+
+  auto submit(Client& client, const std::chrono::nanoseconds& budget) -> bool;
+
+  [[nodiscard]] auto get_n_workers() const -> uint;
+
+  [[nodiscard]] auto get_clients_stats() -> std::vector<std::pair<std::string, Stats>>;
+
+ private:
+  ConvolutionPool();
+
+  static constexpr size_t capacity = 256U;
+
+  static constexpr uint max_workers = 16U;
+
+  uint n_cores = 1U;
+
+  uint n_max_workers = 1U;
+
+  /*
+    Bounded multi producer multi consumer queue based on Dmitry Vyukov's design. Each cell carries a sequence number
+    telling producers and consumers whose turn it is, so neither side ever blocks on the other.
+  */
+
+  struct Cell {
+    std::atomic<size_t> sequence;
+
+    Client* client = nullptr;
+  };
+
+  std::array<Cell, capacity> cells;
+
+  std::atomic<size_t> enqueue_position = 0U, dequeue_position = 0U;
+
+  std::counting_semaphore<capacity> pending{0};
+
+  std::atomic<bool> quit = false;
+
+  std::vector<std::thread> workers;  // only changed in the main thread
+
+  std::mutex clients_mutex;
+
+  std::vector<Client*> clients;
+
+  auto push(Client* client) -> bool;
+
+  auto pop() -> Client*;
+
+  void worker_loop();
+
+  void start_worker();
+
+  static void configure_worker(std::thread& thread, const uint& index, const uint& n_cores);
+
+  static void run(Client* client);
+};
@@ -20,12 +20,15 @@
 #pragma once
 
 #include <sys/types.h>
-#include <zita-convolver.h>
-#include <deque>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
 #include <span>
 #include <string>
 #include <thread>
 #include <vector>
+#include "block_adapter.hpp"
+#include "partitioned_convolver.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 #include "util.hpp"
@@ -50,6 +53,8 @@ class Convolver : public PluginBase {
                std::span<float>& left_out,
                std::span<float>& right_out) override;
 
+  void process(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs) override;
+
   auto get_latency_seconds() -> float override;
 
   bool do_autogain = false;
@@ -63,7 +68,6 @@ class Convolver : public PluginBase {
   std::vector<std::string> system_data_dir_irs;
 
   bool kernel_is_initialized = false;
-  bool n_samples_is_power_of_2 = true;
   bool zita_ready = false;
   bool ready = false;
   bool notify_latency = false;
@@ -72,13 +76,27 @@ class Convolver : public PluginBase {
   uint ir_width = 100U;
   uint latency_n_frames = 0U;
 
+  /*
+    When the quantum is not a power of two zita still needs power of two blocks and the block adapter delays its
+    output by head_size frames. The first head_size taps of the kernel are then applied directly in the time domain
+    and zita only gets the remaining taps, so the sum of both has no added latency.
+  */
+
+  uint head_size = 0U;
+
+  static constexpr uint max_head_blocksize = 256U;
+
   std::vector<float> kernel_L, kernel_R;
   std::vector<float> original_kernel_L, original_kernel_R;
-  std::vector<float> data_L, data_R;
 
-  std::deque<float> deque_out_L, deque_out_R;
+  // One per channel
 
-  Convproc* conv = nullptr;
+  std::vector<std::vector<float>> head_kernels;
+  std::vector<std::vector<float>> head_histories;
+
+  BlockAdapter<float> block_adapter;
+
+  std::unique_ptr<PartitionedConvolver> conv;
 
   std::vector<std::thread> mythreads;
 
@@ -94,28 +112,36 @@ class Convolver : public PluginBase {
 
   void prepare_kernel();
 
-  template <typename T1>
-  void do_convolution(T1& data_left, T1& data_right) {
-    std::span conv_left_in(conv->inpdata(0), get_zita_buffer_size());
-    std::span conv_right_in(conv->inpdata(1), get_zita_buffer_size());
+  [[nodiscard]] auto get_channel_kernel(const size_t& channel) const -> std::vector<float>;
 
-    std::span conv_left_out(conv->outdata(0), get_zita_buffer_size());
-    std::span conv_right_out(conv->outdata(1), get_zita_buffer_size());
+  void split_kernel(const std::vector<float>& kernel, std::vector<float>& head, std::vector<float>& tail) const;
 
-    std::copy(data_left.begin(), data_left.end(), conv_left_in.begin());
-    std::copy(data_right.begin(), data_right.end(), conv_right_in.begin());
+  void apply_head(const std::span<float>& in,
+                  std::span<float>& out,
+                  const std::vector<float>& head,
+                  std::vector<float>& history) const;
 
-    if (zita_ready) {
-      const int& ret = conv->process(true);  // thread sync mode set to true
+  void do_convolution(std::span<std::span<float>> block) {
+    if (!zita_ready) {
+      return;
+    }
 
-      if (ret != 0) {
-        util::debug(log_tag + "IR: process failed: " + util::to_string(ret, ""));
+    for (uint c = 0U; c < block.size(); c++) {
+      std::ranges::copy(block[c], conv->inpdata(c));
+    }
+
+    const int& ret = conv->process();
+
+    if (ret != 0) {
+      util::debug(log_tag + "IR: process failed: " + util::to_string(ret, ""));
+
+      zita_ready = false;
+
+      return;
+    }
 
-        zita_ready = false;
-      } else {
-        std::copy(conv_left_out.begin(), conv_left_out.end(), data_left.begin());
-        std::copy(conv_right_out.begin(), conv_right_out.end(), data_right.begin());
-      }
+    for (uint c = 0U; c < block.size(); c++) {
+      std::copy_n(conv->outdata(c), block[c].size(), block[c].begin());
     }
   }
 };
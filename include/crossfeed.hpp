@@ -52,4 +52,6 @@ class Crossfeed : public PluginBase {
   std::vector<float> data;
 
   bs2b_base bs2b;
+
+  void apply_setup();
 };
@@ -19,14 +19,16 @@
 
 #pragma once
 
+#include <sys/types.h>
 #include <memory>
 #include <span>
 #include <string>
 #include <vector>
+#include "block_adapter.hpp"
 #include "ladspa_wrapper.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
-#include "resampler.hpp"
+#include "polyphase_resampler.hpp"
 
 class DeepFilterNet : public PluginBase {
  public:
@@ -56,9 +58,15 @@ class DeepFilterNet : public PluginBase {
   bool resample = false;
   bool resampler_ready = true;
 
-  std::unique_ptr<Resampler> resampler_inL, resampler_outL;
-  std::unique_ptr<Resampler> resampler_inR, resampler_outR;
+  static constexpr uint n_priming_frames = 2U;
+
+  uint resampler_latency = 0U;
+
+  PolyphaseResampler resampler_in, resampler_out;
+
+  BlockAdapter<float> output_fifo;
 
   std::vector<float> resampled_outL, resampled_outR;
-  std::vector<float> carryover_l, carryover_r;
+
+  void apply_setup();
 };
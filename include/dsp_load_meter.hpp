@@ -0,0 +1,151 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+  Lock free histogram of the time a plugin spends processing a quantum, measured as a fraction of the quantum duration.
+  Only the realtime thread records values and resets the window. Other threads may read a snapshot at any time, but
+  it can be slightly inconsistent while the realtime thread is writing.
+*/
+
+class DspLoadMeter {
+ public:
+  DspLoadMeter() { reset(); }
+  DspLoadMeter(const DspLoadMeter&) = delete;
+  auto operator=(const DspLoadMeter&) -> DspLoadMeter& = delete;
+  DspLoadMeter(const DspLoadMeter&&) = delete;
+  auto operator=(const DspLoadMeter&&) -> DspLoadMeter& = delete;
+
+  struct Stats {
+    // Fractions of the quantum duration in the current window
+
+    float p50 = 0.0F;
+
+    float p99 = 0.0F;
+
+    float max = 0.0F;
+
+    float threshold = 1.0F;
+
+    uint64_t cycles = 0U;
+
+    // Cycles above the threshold in the current window
+
+    uint64_t overruns = 0U;
+  };
+
+  void set_threshold(const float& value) { threshold.store(value, std::memory_order_relaxed); }
+
+  void record(const float& load) {
+    const auto bin = std::min(static_cast<size_t>(std::max(load, 0.0F) * bins_per_unit), n_bins - 1U);
+
+    bins[bin].fetch_add(1U, std::memory_order_relaxed);
+
+    if (load > window_max.load(std::memory_order_relaxed)) {
+      window_max.store(load, std::memory_order_relaxed);
+    }
+
+    if (load > threshold.load(std::memory_order_relaxed)) {
+      overruns.fetch_add(1U, std::memory_order_relaxed);
+    }
+  }
+
+  auto snapshot(const bool& reset_window) -> Stats {
+    Stats stats;
+
+    std::array<uint32_t, n_bins> counts{};
+
+    for (size_t n = 0U; n < n_bins; n++) {
+      counts[n] = reset_window ? bins[n].exchange(0U, std::memory_order_relaxed)
+                               : bins[n].load(std::memory_order_relaxed);
+
+      stats.cycles += counts[n];
+    }
+
+    stats.max = reset_window ? window_max.exchange(0.0F, std::memory_order_relaxed)
+                             : window_max.load(std::memory_order_relaxed);
+
+    stats.threshold = threshold.load(std::memory_order_relaxed);
+
+    stats.overruns = reset_window ? overruns.exchange(0U, std::memory_order_relaxed)
+                                  : overruns.load(std::memory_order_relaxed);
+
+    if (stats.cycles != 0U) {
+      stats.p50 = percentile(counts, stats.cycles, 0.5F);
+      stats.p99 = percentile(counts, stats.cycles, 0.99F);
+    }
+
+    return stats;
+  }
+
+  void reset() {
+    for (auto& b : bins) {
+      b.store(0U, std::memory_order_relaxed);
+    }
+
+    window_max.store(0.0F, std::memory_order_relaxed);
+
+    overruns.store(0U, std::memory_order_relaxed);
+  }
+
+ private:
+  // 1% resolution up to twice the quantum duration. The last bin takes everything above that.
+
+  static constexpr size_t bins_per_unit = 100U;
+
+  static constexpr size_t n_bins = (2U * bins_per_unit) + 1U;
+
+  std::array<std::atomic<uint32_t>, n_bins> bins;
+
+  std::atomic<float> window_max = {0.0F};
+
+  std::atomic<float> threshold = {1.0F};
+
+  std::atomic<uint64_t> overruns = {0U};
+
+  static_assert(std::atomic<float>::is_always_lock_free);
+  static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+  static auto percentile(const std::array<uint32_t, n_bins>& counts, const uint64_t& total, const float& fraction)
+      -> float {
+    const auto target = static_cast<uint64_t>(fraction * static_cast<float>(total));
+
+    uint64_t sum = 0U;
+
+    for (size_t n = 0U; n < n_bins; n++) {
+      sum += counts[n];
+
+      if (sum > target) {
+        // upper edge of the bin
+
+        return static_cast<float>(n + 1U) / static_cast<float>(bins_per_unit);
+      }
+    }
+
+    return static_cast<float>(n_bins) / static_cast<float>(bins_per_unit);
+  }
+};
@@ -81,4 +81,6 @@ class EchoCanceller : public PluginBase {
   void free_speex();
 
   void init_speex();
+
+  void apply_setup();
 };
@@ -24,9 +24,13 @@
 #include <pipewire/proxy.h>
 #include <sigc++/connection.h>
 #include <sigc++/signal.h>
+#include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <utility>
 #include <vector>
 #include "autogain.hpp"
 #include "bass_enhancer.hpp"
@@ -43,7 +47,9 @@
 #include "exciter.hpp"
 #include "expander.hpp"
 #include "filter.hpp"
+#include "fused_chain.hpp"
 #include "gate.hpp"
+#include "graph_transaction.hpp"
 #include "limiter.hpp"
 #include "loudness.hpp"
 #include "maximizer.hpp"
@@ -77,6 +83,8 @@ class EffectsBase {
   std::shared_ptr<OutputLevel> output_level;
   std::shared_ptr<Spectrum> spectrum;
 
+  std::shared_ptr<FusedChain> fused_chain;
+
   std::shared_ptr<AutoGain> autogain;
   std::shared_ptr<BassEnhancer> bass_enhancer;
   std::shared_ptr<BassLoudness> bass_loudness;
@@ -110,6 +118,18 @@ class EffectsBase {
 
   sigc::signal<void(const float&)> pipeline_latency;
 
+  // Emitted in the main thread when a plugin finished loading and was added to the plugins map
+
+  sigc::signal<void(const std::string&)> plugin_loaded;
+
+  // False while the plugin is still being built by the PluginLoader
+
+  [[nodiscard]] auto is_plugin_ready(const std::string& name) const -> bool;
+
+  // True while the PluginLoader is still building plugins of this pipeline
+
+  [[nodiscard]] auto has_loading_plugins() const -> bool;
+
   auto get_plugins_map() -> std::map<std::string, std::shared_ptr<PluginBase>>;
 
   template <typename T>
@@ -117,6 +137,32 @@ class EffectsBase {
     return std::dynamic_pointer_cast<T>(plugins[name]);
   }
 
+  /*
+    Snapshots are presets whose plugins were built, configured and prepared ahead of time under instance names that
+    are not in the pipeline. Activating one only replaces the plugins list. In the fused pipeline the new chain starts
+    at the next quantum and the previous one is faded out during snapshot-crossfade milliseconds.
+  */
+
+  static constexpr auto max_snapshots = 4U;
+
+  // First id of a block of instance ids that is not used by the pipeline or by another snapshot
+
+  [[nodiscard]] auto get_free_snapshot_id() const -> uint;
+
+  // The plugins parameters must already be written to the settings paths of the instances in list
+
+  void preload_snapshot(const std::string& preset_name,
+                        const std::vector<std::string>& list,
+                        const std::vector<std::string>& blocklist);
+
+  void remove_snapshot(const std::string& preset_name);
+
+  [[nodiscard]] auto get_snapshots() const -> std::vector<std::string>;
+
+  [[nodiscard]] auto is_snapshot_ready(const std::string& preset_name) const -> bool;
+
+  auto activate_snapshot(const std::string& preset_name) -> bool;
+
  protected:
   GSettings *settings = nullptr, *global_settings = nullptr;
 
@@ -124,14 +170,62 @@ class EffectsBase {
 
   std::map<std::string, std::shared_ptr<PluginBase>> plugins;
 
-  std::vector<pw_proxy*> list_proxies, list_proxies_listen_mic;
+  std::vector<pw_proxy*> list_proxies_listen_mic;
+
+  /*
+    Links made by connect_filters, grouped by the pair of nodes they connect. Keeping them per edge allows a change in
+    the plugin list to touch only the links around the plugins that were inserted, removed or moved.
+  */
+
+  std::map<std::pair<uint, uint>, std::vector<pw_proxy*>> chain_links;
 
   std::vector<sigc::connection> connections;
 
   std::vector<gulong> gconnections, gconnections_global;
 
+  /*
+    Plugins in the list whose construction was handed to the PluginLoader. They enter the plugins map, and therefore
+    the pipeline, only when on_filter_loaded() runs in the main thread.
+  */
+
+  std::set<std::string> loading_plugins;
+
+  struct Snapshot {
+    std::vector<std::string> list, blocklist;
+
+    std::map<std::string, std::shared_ptr<PluginBase>> plugins;
+
+    uint n_pending = 0U;
+
+    uint generation = 0U;
+  };
+
+  std::map<std::string, Snapshot> snapshots;
+
+  // Crossfade for the next connect_fused_chain call. It is only nonzero while a snapshot is being activated.
+
+  float snapshot_crossfade = 0.0F;
+
   void create_filters_if_necessary();
 
+  // Builds the plugin in the PluginLoader and calls on_loaded with it in the main thread
+
+  void load_filter(const std::string& name, std::function<void(const std::shared_ptr<PluginBase>&)> on_loaded);
+
+  [[nodiscard]] auto make_filter(const std::string& name, const std::string& path, const std::string& instance_id) const
+      -> std::shared_ptr<PluginBase>;
+
+  void on_filter_loaded(const std::string& name, const std::shared_ptr<PluginBase>& filter);
+
+  void install_filter(const std::string& name, const std::shared_ptr<PluginBase>& filter);
+
+  void on_snapshot_filter_loaded(const std::string& preset_name,
+                                 const uint& generation,
+                                 const std::string& name,
+                                 const std::shared_ptr<PluginBase>& filter);
+
+  [[nodiscard]] auto find_snapshot_filter(const std::string& name) const -> std::shared_ptr<PluginBase>;
+
   void remove_unused_filters();
 
   void activate_filters();
@@ -139,4 +233,56 @@ class EffectsBase {
   void deactivate_filters();
 
   void broadcast_pipeline_latency();
+
+  auto get_selected_plugins(const std::vector<std::string>& list) -> std::vector<std::shared_ptr<PluginBase>>;
+
+  // Connects the filters that are not connected yet, waiting for all of them at once
+
+  void connect_concurrently(const std::vector<std::shared_ptr<PluginBase>>& filters);
+
+  auto use_fused_chain(const std::vector<std::string>& list) -> bool;
+
+  auto connect_fused_chain(const std::vector<std::string>& list) -> bool;
+
+  void disconnect_fused_chain();
+
+  /*
+    Makes the graph match the ordered node list and the probe edges. The edges that are already linked are kept. The
+    missing ones are created and the edges that are not part of the new path are removed in the same transaction, so
+    no input port ever has two sources. Edges touching device_node_id may have fewer links than the pipeline layout
+    has channels.
+  */
+
+  void link_chain(const std::vector<uint>& nodes,
+                  const std::vector<std::pair<uint, uint>>& probe_edges,
+                  const uint& device_node_id);
+
+  // Queues the destruction of every link in chain_links
+
+  void unlink_chain(GraphTransaction& transaction);
+
+  // Disconnects the plugins that are not in the list and the fused chain if it is not being used
+
+  void disconnect_unused_filters(const std::vector<std::string>& list, const bool& fused_chain_in_use);
+
+ private:
+  /*
+    Shared with the loader jobs. The destructor waits until n_loading reaches zero because the jobs use the
+    PipeManager. A job may still be notifying after the destructor returned, so the counter can not be a member of this
+    object. The main thread callbacks of the jobs check alive because they may run after this object is gone.
+  */
+
+  struct LoaderState {
+    std::atomic<uint> n_loading = 0U;
+
+    bool alive = true;
+  };
+
+  std::shared_ptr<LoaderState> loader_state = std::make_shared<LoaderState>();
+
+  // Each snapshot uses ids in [n * snapshot_id_block, (n + 1) * snapshot_id_block) with n > 0
+
+  static constexpr auto snapshot_id_block = 100U;
+
+  uint snapshot_generation = 0U;
 };
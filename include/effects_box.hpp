@@ -22,7 +22,6 @@
 #include <adwaita.h>
 #include <glib-object.h>
 #include <glibconfig.h>
-#include <gsl/gsl_spline.h>
 #include <gtk/gtkbox.h>
 #include <gtk/gtkicontheme.h>
 #include "application.hpp"
@@ -19,7 +19,6 @@
 
 #pragma once
 
-#include <sigc++/signal.h>
 #include <span>
 #include <string>
 #include "pipe_manager.hpp"
@@ -47,7 +46,9 @@ class Exciter : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
-  sigc::signal<void(const double)> harmonics;
+  // Positions of the meters in the extra values of the meter board slot
+
+  enum Meter : size_t { harmonics_meter };
 
   double harmonics_port_value = 0.0;
 
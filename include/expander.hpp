@@ -20,7 +20,6 @@
 #pragma once
 
 #include <pipewire/proxy.h>
-#include <sigc++/signal.h>
 #include <sys/types.h>
 #include <span>
 #include <string>
@@ -54,7 +53,9 @@ class Expander : public PluginBase {
 
   void update_probe_links() override;
 
-  sigc::signal<void(const float)> reduction, sidechain, curve, envelope;
+  // Positions of the meters in the extra values of the meter board slot
+
+  enum Meter : size_t { reduction_meter, sidechain_meter, curve_meter, envelope_meter };
 
   float reduction_port_value = 0.0F;
   float sidechain_port_value = 0.0F;
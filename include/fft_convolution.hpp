@@ -0,0 +1,74 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <fftw3.h>
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+/*
+  Offline linear convolution of two long signals. Both inputs are split in blocks of partition_size samples and
+  transformed once. Each output block is the sum of the products of the block spectra whose indices add up to it and
+  is overlap-added to the result after the inverse transform.
+
+  The fftw plans are created in the constructor and destroyed in the destructor. Like the other fftw users in this
+  project the instance should be created and destroyed in the main thread. The process method can run in any thread.
+*/
+
+class FftConvolution {
+ public:
+  explicit FftConvolution(const size_t& partition_size = 16384U);
+  FftConvolution(const FftConvolution&) = delete;
+  auto operator=(const FftConvolution&) -> FftConvolution& = delete;
+  FftConvolution(const FftConvolution&&) = delete;
+  auto operator=(const FftConvolution&&) -> FftConvolution& = delete;
+  ~FftConvolution();
+
+  /*
+    Returns a vector with a.size() + b.size() - 1 samples. The progress callback receives values between 0 and 1. An
+    empty vector is returned when one of the inputs is empty or when cancel is set while the convolution is running.
+  */
+
+  auto process(const std::vector<float>& a,
+               const std::vector<float>& b,
+               const std::function<void(const float&)>& on_progress,
+               const std::atomic<bool>& cancel) -> std::vector<float>;
+
+ private:
+  size_t partition_size = 0U;
+
+  size_t fft_size = 0U;
+
+  size_t n_bins = 0U;
+
+  float* real_buffer = nullptr;
+
+  fftwf_complex* complex_buffer = nullptr;
+
+  fftwf_plan plan_forward = nullptr;
+
+  fftwf_plan plan_backward = nullptr;
+
+  auto transform_blocks(const std::vector<float>& x, const std::atomic<bool>& cancel)
+      -> std::vector<std::vector<std::complex<float>>>;
+};
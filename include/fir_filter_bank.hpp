@@ -0,0 +1,81 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <algorithm>
+#include <span>
+#include <string>
+#include <vector>
+#include "fir_filter_base.hpp"
+#include "util.hpp"
+
+/*
+  Splits a stereo signal into adjacent bandpass bands with a single zita-convolver instance. Every band is an output
+  of the same engine, so the input is transformed once per block no matter how many bands there are, and only one
+  set of convolution threads is created.
+*/
+
+class FirFilterBank : public FirFilterBase {
+ public:
+  FirFilterBank(std::string tag);
+  FirFilterBank(const FirFilterBank&) = delete;
+  auto operator=(const FirFilterBank&) -> FirFilterBank& = delete;
+  FirFilterBank(const FirFilterBank&&) = delete;
+  auto operator=(const FirFilterBank&&) -> FirFilterBank& = delete;
+  ~FirFilterBank() override;
+
+  // Band n goes from edges[n] to edges[n + 1]
+
+  void set_band_edges(std::span<const float> edges);
+
+  void setup() override;
+
+  [[nodiscard]] auto is_ready() const -> bool;
+
+  // The band outputs are only valid after a successful setup() and are overwritten by the next process_bands() call.
+
+  [[nodiscard]] auto get_band_left(const uint& band) const -> std::span<float>;
+
+  [[nodiscard]] auto get_band_right(const uint& band) const -> std::span<float>;
+
+  template <typename T1>
+  void process_bands(const T1& data_left, const T1& data_right) {
+    if (!zita_ready) {
+      return;
+    }
+
+    std::copy(data_left.begin(), data_left.end(), conv->inpdata(0));
+    std::copy(data_right.begin(), data_right.end(), conv->inpdata(1));
+
+    const int& ret = conv->process();
+
+    if (ret != 0) {
+      util::debug(log_tag + "IR: process failed: " + util::to_string(ret, ""));
+
+      zita_ready = false;
+    }
+  }
+
+ private:
+  std::vector<float> band_edges;
+
+  std::vector<std::vector<float>> kernels;
+};
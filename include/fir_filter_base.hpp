@@ -20,11 +20,12 @@
 #pragma once
 
 #include <sys/types.h>
-#include <zita-convolver.h>
 #include <algorithm>
+#include <memory>
 #include <span>
 #include <string>
 #include <vector>
+#include "partitioned_convolver.hpp"
 #include "util.hpp"
 
 class FirFilterBase {
@@ -52,6 +53,10 @@ class FirFilterBase {
 
   template <typename T1>
   void process(T1& data_left, T1& data_right) {
+    if (!zita_ready) {
+      return;
+    }
+
     std::span conv_left_in(conv->inpdata(0), n_samples);
     std::span conv_right_in(conv->inpdata(1), n_samples);
 
@@ -61,17 +66,15 @@ class FirFilterBase {
     std::copy(data_left.begin(), data_left.end(), conv_left_in.begin());
     std::copy(data_right.begin(), data_right.end(), conv_right_in.begin());
 
-    if (zita_ready) {
-      const int& ret = conv->process(true);  // thread sync mode set to true
+    const int& ret = conv->process();
 
-      if (ret != 0) {
-        util::debug(log_tag + "IR: process failed: " + util::to_string(ret, ""));
+    if (ret != 0) {
+      util::debug(log_tag + "IR: process failed: " + util::to_string(ret, ""));
 
-        zita_ready = false;
-      } else {
-        std::copy(conv_left_out.begin(), conv_left_out.end(), data_left.begin());
-        std::copy(conv_right_out.begin(), conv_right_out.end(), data_right.begin());
-      }
+      zita_ready = false;
+    } else {
+      std::copy(conv_left_out.begin(), conv_left_out.end(), data_left.begin());
+      std::copy(conv_right_out.begin(), conv_right_out.end(), data_right.begin());
     }
   }
 
@@ -90,12 +93,20 @@ class FirFilterBase {
 
   std::vector<float> kernel;
 
-  Convproc* conv = nullptr;
+  std::unique_ptr<PartitionedConvolver> conv;
 
   [[nodiscard]] auto create_lowpass_kernel(const float& cutoff, const float& transition_band) const
       -> std::vector<float>;
 
+  [[nodiscard]] auto create_bandpass_kernel(const float& min_frequency,
+                                            const float& max_frequency,
+                                            const float& transition_band) const -> std::vector<float>;
+
   void setup_zita();
 
+  // Output 2 * n is the left channel convolved with kernels[n] and output 2 * n + 1 the right one.
+
+  void setup_zita(std::span<const std::vector<float>> kernels);
+
   static void direct_conv(const std::vector<float>& a, const std::vector<float>& b, std::vector<float>& c);
 };
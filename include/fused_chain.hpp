@@ -0,0 +1,145 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "pipe_manager.hpp"
+#include "pipeline_type.hpp"
+#include "plugin_base.hpp"
+
+/*
+  A single PipeWire filter that runs a list of plugins in sequence. The plugins are not connected to the graph while
+  they are in the chain. Their process() method is called directly from this filter's realtime callback using
+  internal scratch buffers. This avoids one graph node, two links and one scheduler wakeup per plugin and quantum.
+*/
+
+class FusedChain : public PluginBase {
+ public:
+  FusedChain(const std::string& tag,
+             const std::string& schema,
+             const std::string& schema_path,
+             PipeManager* pipe_manager,
+             PipelineType pipe_type);
+  FusedChain(const FusedChain&) = delete;
+  auto operator=(const FusedChain&) -> FusedChain& = delete;
+  FusedChain(const FusedChain&&) = delete;
+  auto operator=(const FusedChain&&) -> FusedChain& = delete;
+  ~FusedChain() override;
+
+  void setup() override;
+
+  void process(std::span<float>& left_in,
+               std::span<float>& right_in,
+               std::span<float>& left_out,
+               std::span<float>& right_out) override;
+
+  void process(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs) override;
+
+  auto get_latency_seconds() -> float override;
+
+  /*
+    The new chain starts at the next quantum. With a crossfade the previous chain keeps running for that many seconds
+    and its output is faded into the output of the new one. It is released in the main thread once the fade is over.
+    It is used when switching between snapshots.
+  */
+
+  void set_chain(const std::vector<std::shared_ptr<PluginBase>>& list, const float& crossfade_seconds = 0.0F);
+
+  void clear_chain();
+
+  void update_latency();
+
+  /*
+    Plugins that read a probe (echo canceller and sidechain inputs) need their own ports and links. A chain containing
+    any of them can not be fused.
+  */
+
+  static auto can_fuse(const std::vector<std::shared_ptr<PluginBase>>& list) -> bool;
+
+ private:
+  // The chain as last set by the main thread. The realtime thread gets it a quantum later.
+
+  std::vector<std::shared_ptr<PluginBase>> active_chain;
+
+  // The chain run by the realtime thread
+
+  std::vector<std::shared_ptr<PluginBase>> chain;
+
+  // The chain being faded out by the realtime thread
+
+  std::vector<std::shared_ptr<PluginBase>> previous_chain;
+
+  bool fade_pending = false;
+
+  float fade_seconds = 0.0F;
+
+  uint fade_length = 0U, fade_position = 0U;
+
+  /*
+    Crossfades started by set_chain() are numbered. The realtime thread publishes the number of the last one it
+    finished and fade_cleanup_source waits for it in the main thread to release previous_chain.
+  */
+
+  uint fade_generation = 0U;  // main thread
+
+  uint running_fade_generation = 0U;  // realtime thread
+
+  std::atomic<uint> finished_fade_generation = {0U};
+  static_assert(std::atomic<uint>::is_always_lock_free);
+
+  guint fade_cleanup_source = 0U;
+
+  // One scratch buffer per channel
+
+  std::vector<std::vector<float>> buffers_a, buffers_b;
+
+  std::vector<std::span<float>> views_a, views_b;
+
+  // Output of the previous chain during a crossfade
+
+  std::vector<std::vector<float>> buffers_fade;
+
+  std::vector<std::span<float>> views_fade;
+
+  /*
+    Outside of PipeWire (offline rendering) there is nothing to link to the probe ports. Plugins that use them are
+    still run and get silence as their probe signal.
+  */
+
+  std::vector<float> silent_probe_left, silent_probe_right;
+
+  // Called by the realtime thread for a vector it no longer holds
+
+  static void release_users(const std::vector<std::shared_ptr<PluginBase>>& list);
+
+  void schedule_fade_cleanup();
+
+  void cancel_fade_cleanup();
+
+  void release_previous_chain();
+
+  void run_chain(const std::vector<std::shared_ptr<PluginBase>>& list,
+                 std::span<std::span<float>> inputs,
+                 std::span<std::span<float>> outputs);
+};
@@ -20,7 +20,6 @@
 #pragma once
 
 #include <pipewire/proxy.h>
-#include <sigc++/signal.h>
 #include <sys/types.h>
 #include <span>
 #include <string>
@@ -54,8 +53,18 @@ class Gate : public PluginBase {
 
   void update_probe_links() override;
 
-  sigc::signal<void(const float)> attack_zone_start, attack_threshold, release_zone_start, release_threshold, reduction,
-      sidechain, curve, envelope;
+  // Positions of the meters in the extra values of the meter board slot
+
+  enum Meter : size_t {
+    attack_zone_start_meter,
+    attack_threshold_meter,
+    release_zone_start_meter,
+    release_threshold_meter,
+    reduction_meter,
+    sidechain_meter,
+    curve_meter,
+    envelope_meter
+  };
 
   float attack_zone_start_port_value = 0.0F;
   float attack_threshold_port_value = 0.0F;
@@ -0,0 +1,117 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <pipewire/proxy.h>
+#include <sys/types.h>
+#include <vector>
+
+class PipeManager;
+
+/*
+  Collects link creations and destructions and applies them together. commit() issues every queued operation under a
+  single lock of the PipeWire loop and waits for one pw_core_sync, instead of one round-trip per port pair. Failures
+  are only known after that round-trip, so commit() reports them in its result.
+
+  Must be used from the main thread, like the rest of the PipeManager linking methods.
+*/
+
+class GraphTransaction {
+ public:
+  explicit GraphTransaction(PipeManager* pipe_manager);
+  GraphTransaction(const GraphTransaction&) = delete;
+  auto operator=(const GraphTransaction&) -> GraphTransaction& = delete;
+  GraphTransaction(const GraphTransaction&&) = delete;
+  auto operator=(const GraphTransaction&&) -> GraphTransaction& = delete;
+  ~GraphTransaction();
+
+  struct LinkFailure {
+    uint output_node_id = 0U;
+
+    uint input_node_id = 0U;
+
+    uint output_port_id = 0U;
+
+    uint input_port_id = 0U;
+  };
+
+  struct CreatedLink {
+    uint output_node_id = 0U;
+
+    uint input_node_id = 0U;
+
+    pw_proxy* proxy = nullptr;
+  };
+
+  struct Result {
+    // Proxies of the links that were created. The caller owns them, as with PipeManager::link_nodes().
+
+    std::vector<pw_proxy*> proxies;
+
+    // The same links together with the nodes they connect
+
+    std::vector<CreatedLink> links;
+
+    std::vector<LinkFailure> failures;
+  };
+
+  /*
+    Queues links between the matching ports of both nodes. The ports are matched right away, so the returned number of
+    queued links can be used to decide how to continue the chain before commit().
+  */
+
+  auto link_nodes(const uint& output_node_id,
+                  const uint& input_node_id,
+                  const bool& probe_link = false,
+                  const bool& link_passive = true) -> uint;
+
+  void destroy_links(const std::vector<pw_proxy*>& list);
+
+  // Queues the destruction of a registry object. Usually a link found in PipeManager::list_links.
+
+  void destroy_object(const uint& id);
+
+  [[nodiscard]] auto empty() const -> bool;
+
+  // Applies the queued operations and clears the queue. The transaction can be reused afterwards.
+
+  auto commit() -> Result;
+
+ private:
+  PipeManager* pm = nullptr;
+
+  struct PendingLink {
+    uint output_node_id = 0U;
+
+    uint input_node_id = 0U;
+
+    uint output_port_id = 0U;
+
+    uint input_port_id = 0U;
+
+    bool passive = true;
+  };
+
+  std::vector<PendingLink> links_to_create;
+
+  std::vector<pw_proxy*> proxies_to_destroy;
+
+  std::vector<uint> objects_to_destroy;
+};
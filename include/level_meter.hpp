@@ -19,13 +19,13 @@
 
 #pragma once
 
-#include <ebur128.h>
-#include <sigc++/signal.h>
 #include <sys/types.h>
+#include <cstddef>
 #include <span>
 #include <string>
 #include <thread>
 #include <vector>
+#include "loudness_analyzer.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 
@@ -49,39 +49,34 @@ class LevelMeter : public PluginBase {
                std::span<float>& left_out,
                std::span<float>& right_out) override;
 
+  void process(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs) override;
+
   auto get_latency_seconds() -> float override;
 
   void reset_history();
 
-  sigc::signal<void(const double,  // momentary
-                    const double,  // shortterm
-                    const double,  // integrated
-                    const double,  // relative
-                    const double,  // range
-                    const double,  // true_peak_R
-                    const double   // true_peak_R
-                    )>
-      results;  // range
+  // Positions of the loudness meters in the extra values of the meter board slot
+
+  enum Meter : size_t {
+    momentary_meter,
+    shortterm_meter,
+    integrated_meter,
+    relative_meter,
+    range_meter,
+    true_peak_left_meter,
+    true_peak_right_meter
+  };
 
  private:
   bool ebur128_ready = false;
 
   uint old_rate = 0U;
 
-  double momentary = 0.0;
-  double shortterm = 0.0;
-  double global = 0.0;
-  double relative = 0.0;
-  double range = 0.0;
-
-  double true_peak_L = 0.0;
-  double true_peak_R = 0.0;
-
-  std::vector<float> data;
-
-  ebur128_state* ebur_state = nullptr;
+  LoudnessAnalyzer loudness;
 
   std::vector<std::thread> mythreads;
 
   auto init_ebur128() -> bool;
+
+  void apply_setup();
 };
@@ -20,7 +20,6 @@
 #pragma once
 
 #include <pipewire/proxy.h>
-#include <sigc++/signal.h>
 #include <sys/types.h>
 #include <span>
 #include <string>
@@ -54,7 +53,9 @@ class Limiter : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
-  sigc::signal<void(const float)> gain_left, gain_right, sidechain_left, sidechain_right;
+  // Positions of the meters in the extra values of the meter board slot
+
+  enum Meter : size_t { gain_left_meter, gain_right_meter, sidechain_left_meter, sidechain_right_meter };
 
   float gain_l_port_value = 0.0F;
   float gain_r_port_value = 0.0F;
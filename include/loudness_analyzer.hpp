@@ -0,0 +1,132 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <ebur128.h>
+#include <sys/types.h>
+#include <atomic>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <vector>
+#include "channel_layout.hpp"
+
+/*
+  EBU R128 analysis used by the plugins that measure loudness. Feeding audio is cheap, but the momentary and
+  short-term queries scan their whole window and, without histogram mode, the integrated loudness and the loudness
+  range get more expensive as the history grows. So the metrics are only refreshed at update_rate instead of every
+  quantum. Not thread safe: the owner serializes init() and process() the way it does for the rest of its state.
+*/
+
+class LoudnessAnalyzer {
+ public:
+  LoudnessAnalyzer() = default;
+  LoudnessAnalyzer(const LoudnessAnalyzer&) = delete;
+  auto operator=(const LoudnessAnalyzer&) -> LoudnessAnalyzer& = delete;
+  LoudnessAnalyzer(const LoudnessAnalyzer&&) = delete;
+  auto operator=(const LoudnessAnalyzer&&) -> LoudnessAnalyzer& = delete;
+  ~LoudnessAnalyzer();
+
+  struct Options {
+    bool true_peak = false;
+
+    bool sample_peak = false;
+
+    // History used for the integrated loudness and the loudness range. Zero keeps everything since init() and
+    // selects histogram mode, where both are O(1).
+
+    uint max_history_seconds = 0U;
+
+    // Channel positions of the audio given to process(). Empty means stereo.
+
+    std::vector<std::string> positions;
+  };
+
+  struct Metrics {
+    double momentary = 0.0;
+    double shortterm = 0.0;
+    double global = 0.0;
+    double relative = 0.0;
+    double range = 0.0;
+
+    // Since init(). Channels that are neither on the left nor on the right count for both sides.
+    double true_peak_left = 0.0;
+    double true_peak_right = 0.0;
+
+    // Since the previous update
+    double sample_peak_left = 0.0;
+    double sample_peak_right = 0.0;
+
+    // Whether every query succeeded in the last update
+    bool valid = false;
+  };
+
+  static constexpr uint default_update_rate = 10U;
+
+  // Allocates, so it must not be called from the realtime thread.
+
+  auto init(const uint& rate, const Options& options) -> bool;
+
+  void set_max_history(const uint& seconds);
+
+  void set_update_rate(const uint& hz) { update_rate.store(hz, std::memory_order_relaxed); }
+
+  // Returns true when the metrics were refreshed by this call.
+
+  auto process(std::span<const float> left, std::span<const float> right) -> bool;
+
+  // One span per position given in the options
+
+  auto process(std::span<const std::span<float>> channels) -> bool;
+
+  [[nodiscard]] auto get_metrics() const -> const Metrics& { return metrics; }
+
+  [[nodiscard]] auto ready() const -> bool { return state != nullptr; }
+
+ private:
+  ebur128_state* state = nullptr;
+
+  Options options;
+
+  uint rate = 0U;
+
+  uint n_channels = 2U;
+
+  std::vector<channel_layout::Side> sides;
+
+  std::atomic<uint> update_rate = default_update_rate;
+
+  uint frames_since_update = 0U;
+
+  double sample_peak_left = 0.0, sample_peak_right = 0.0;
+
+  Metrics metrics;
+
+  // Quanta are interleaved in chunks of this size, so the buffer does not depend on the quantum.
+
+  static constexpr size_t chunk_frames = 1024U;
+
+  std::vector<float> data;
+
+  template <typename Source>
+  auto add_frames(const size_t& n_frames, Source&& source) -> bool;
+
+  void update_metrics();
+};
@@ -0,0 +1,114 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <lilv/lilv.h>
+#include <sys/types.h>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lv2 {
+
+enum PortType { TYPE_CONTROL, TYPE_AUDIO, TYPE_ATOM };
+
+struct Port {
+  PortType type;  // Datatype
+
+  uint index;  // Port index
+
+  std::string name;
+
+  std::string symbol;
+
+  float value = 0.0F;  // Control value (if applicable)
+
+  float min = -std::numeric_limits<float>::infinity();
+
+  float max = std::numeric_limits<float>::infinity();
+
+  bool is_input;  // True if an input port
+
+  bool optional;  // True if the connection is optional
+};
+
+/*
+  Process wide LilvWorld shared by every Lv2Wrapper. The installed bundles are scanned only once, on first use, and the
+  plugin lookups and port descriptions are cached by URI. The port descriptions can also be kept on disk. An entry is
+  reused only while the modification times of its bundle files are unchanged.
+*/
+
+class World {
+ public:
+  World(const World&) = delete;
+  auto operator=(const World&) -> World& = delete;
+  World(const World&&) = delete;
+  auto operator=(const World&&) -> World& = delete;
+
+  static auto get() -> World&;
+
+  [[nodiscard]] auto get_lilv_world() const -> LilvWorld*;
+
+  // Lilv is not thread safe. Anything querying the world outside of this class must hold this lock.
+  auto lock() -> std::unique_lock<std::mutex>;
+
+  auto find_plugin(const std::string& uri) -> const LilvPlugin*;
+
+  auto get_ports(const std::string& uri, const LilvPlugin* plugin) -> std::vector<Port>;
+
+ private:
+  World();
+  ~World() = default;
+
+  LilvWorld* world = nullptr;
+
+  bool use_disk_cache = false;
+
+  bool disk_cache_loaded = false;
+
+  std::filesystem::path disk_cache_path;
+
+  nlohmann::json disk_cache;
+
+  std::mutex mutex;
+
+  std::unordered_map<std::string, const LilvPlugin*> plugins;
+
+  std::unordered_map<std::string, std::vector<Port>> ports;
+
+  auto read_ports(const LilvPlugin* plugin) -> std::vector<Port>;
+
+  static auto get_bundle_stamp(const std::filesystem::path& bundle) -> int64_t;
+
+  auto read_disk_cache(const std::string& uri, const std::string& bundle, const int64_t& stamp, std::vector<Port>& out)
+      -> bool;
+
+  void write_disk_cache(const std::string& uri,
+                        const std::string& bundle,
+                        const int64_t& stamp,
+                        const std::vector<Port>& list);
+};
+
+}  // namespace lv2
@@ -29,6 +29,7 @@
 #include <lv2/urid/urid.h>
 #include <sys/types.h>
 #include <array>
+#include <deque>
 #include <functional>
 #include <limits>
 #include <mutex>
@@ -36,6 +37,7 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include "lv2_world.hpp"
 #include "string_literal_wrapper.hpp"
 #include "util.hpp"
 
@@ -47,28 +49,6 @@ using namespace std::string_literals;
 
 #define LV2_UI_makeSONameResident LV2_UI_PREFIX "makeSONameResident"
 
-enum PortType { TYPE_CONTROL, TYPE_AUDIO, TYPE_ATOM };
-
-struct Port {
-  PortType type;  // Datatype
-
-  uint index;  // Port index
-
-  std::string name;
-
-  std::string symbol;
-
-  float value = 0.0F;  // Control value (if applicable)
-
-  float min = -std::numeric_limits<float>::infinity();
-
-  float max = std::numeric_limits<float>::infinity();
-
-  bool is_input;  // True if an input port
-
-  bool optional;  // True if the connection is optional
-};
-
 class Lv2Wrapper {
  public:
   Lv2Wrapper(const std::string& plugin_uri);
@@ -108,8 +88,12 @@ class Lv2Wrapper {
 
   void set_control_port_value(const std::string& symbol, const float& value);
 
+  void set_control_port_value(const uint& index, const float& value);
+
   auto get_control_port_value(const std::string& symbol) -> float;
 
+  [[nodiscard]] auto get_control_port_value(const uint& index) const -> float;
+
   auto has_instance() -> bool;
 
   void load_ui();
@@ -130,104 +114,134 @@ class Lv2Wrapper {
 
   template <StringLiteralWrapper key_wrapper, StringLiteralWrapper gkey_wrapper>
   void bind_key_bool(GSettings* settings) {
-    set_control_port_value(key_wrapper.msg.data(),
+    auto* binding = bind_control_port(key_wrapper.msg.data());
+
+    if (binding == nullptr) {
+      return;
+    }
+
+    set_control_port_value(binding->index,
                            static_cast<float>(g_settings_get_boolean(settings, gkey_wrapper.msg.data())));
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<ControlPortBinding*>(user_data);
 
-                       self->set_control_port_value(key_wrapper.msg.data(),
-                                                    static_cast<float>(g_settings_get_boolean(settings, key)));
+                       binding->self->set_control_port_value(binding->index,
+                                                             static_cast<float>(g_settings_get_boolean(settings, key)));
                      }),
-                     this);
+                     binding);
 
     auto gkey = gkey_wrapper.msg.data();
-    auto key = key_wrapper.msg.data();
+    auto index = binding->index;
 
-    gsettings_sync_funcs.emplace_back([settings, gkey, key, this]() {
-      g_settings_set_boolean(settings, gkey, static_cast<gboolean>(get_control_port_value(key)));
+    gsettings_sync_funcs.emplace_back([settings, gkey, index, this]() {
+      g_settings_set_boolean(settings, gkey, static_cast<gboolean>(get_control_port_value(index)));
     });
   }
 
   template <StringLiteralWrapper key_wrapper, StringLiteralWrapper gkey_wrapper>
   void bind_key_enum(GSettings* settings) {
-    set_control_port_value(key_wrapper.msg.data(),
+    auto* binding = bind_control_port(key_wrapper.msg.data());
+
+    if (binding == nullptr) {
+      return;
+    }
+
+    set_control_port_value(binding->index,
                            static_cast<float>(g_settings_get_enum(settings, gkey_wrapper.msg.data())));
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<ControlPortBinding*>(user_data);
 
-                       self->set_control_port_value(key_wrapper.msg.data(),
-                                                    static_cast<float>(g_settings_get_enum(settings, key)));
+                       binding->self->set_control_port_value(binding->index,
+                                                             static_cast<float>(g_settings_get_enum(settings, key)));
                      }),
-                     this);
+                     binding);
 
     auto gkey = gkey_wrapper.msg.data();
-    auto key = key_wrapper.msg.data();
+    auto index = binding->index;
 
-    gsettings_sync_funcs.emplace_back([settings, gkey, key, this]() {
-      g_settings_set_enum(settings, gkey, static_cast<gint>(get_control_port_value(key)));
+    gsettings_sync_funcs.emplace_back([settings, gkey, index, this]() {
+      g_settings_set_enum(settings, gkey, static_cast<gint>(get_control_port_value(index)));
     });
   }
 
   template <StringLiteralWrapper key_wrapper, StringLiteralWrapper gkey_wrapper>
   void bind_key_int(GSettings* settings) {
-    set_control_port_value(key_wrapper.msg.data(),
+    auto* binding = bind_control_port(key_wrapper.msg.data());
+
+    if (binding == nullptr) {
+      return;
+    }
+
+    set_control_port_value(binding->index,
                            static_cast<float>(g_settings_get_int(settings, gkey_wrapper.msg.data())));
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<ControlPortBinding*>(user_data);
 
-                       self->set_control_port_value(key_wrapper.msg.data(),
-                                                    static_cast<float>(g_settings_get_int(settings, key)));
+                       binding->self->set_control_port_value(binding->index,
+                                                             static_cast<float>(g_settings_get_int(settings, key)));
                      }),
-                     this);
+                     binding);
 
     auto gkey = gkey_wrapper.msg.data();
-    auto key = key_wrapper.msg.data();
+    auto index = binding->index;
 
-    gsettings_sync_funcs.emplace_back([settings, gkey, key, this]() {
-      g_settings_set_int(settings, gkey, static_cast<gint>(get_control_port_value(key)));
+    gsettings_sync_funcs.emplace_back([settings, gkey, index, this]() {
+      g_settings_set_int(settings, gkey, static_cast<gint>(get_control_port_value(index)));
     });
   }
 
   template <StringLiteralWrapper key_wrapper, StringLiteralWrapper gkey_wrapper>
   void bind_key_double(GSettings* settings) {
-    set_control_port_value(key_wrapper.msg.data(),
+    auto* binding = bind_control_port(key_wrapper.msg.data());
+
+    if (binding == nullptr) {
+      return;
+    }
+
+    set_control_port_value(binding->index,
                            static_cast<float>(g_settings_get_double(settings, gkey_wrapper.msg.data())));
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<ControlPortBinding*>(user_data);
 
-                       self->set_control_port_value(key_wrapper.msg.data(),
-                                                    static_cast<float>(g_settings_get_double(settings, key)));
+                       binding->self->set_control_port_value(binding->index,
+                                                             static_cast<float>(g_settings_get_double(settings, key)));
                      }),
-                     this);
+                     binding);
 
     auto gkey = gkey_wrapper.msg.data();
-    auto key = key_wrapper.msg.data();
+    auto index = binding->index;
 
-    gsettings_sync_funcs.emplace_back([settings, gkey, key, this]() {
-      g_settings_set_double(settings, gkey, static_cast<gdouble>(get_control_port_value(key)));
+    gsettings_sync_funcs.emplace_back([settings, gkey, index, this]() {
+      g_settings_set_double(settings, gkey, static_cast<gdouble>(get_control_port_value(index)));
     });
   }
 
   template <StringLiteralWrapper key_wrapper, StringLiteralWrapper gkey_wrapper, bool lower_bound = true>
   void bind_key_double_db(GSettings* settings) {
+    auto* binding = bind_control_port(key_wrapper.msg.data());
+
+    if (binding == nullptr) {
+      return;
+    }
+
     auto key_v = g_settings_get_double(settings, gkey_wrapper.msg.data());
 
     auto linear_v =
         (!lower_bound && key_v <= util::minimum_db_d_level) ? 0.0F : static_cast<float>(util::db_to_linear(key_v));
 
-    set_control_port_value(key_wrapper.msg.data(), linear_v);
+    set_control_port_value(binding->index, linear_v);
 
     g_signal_connect(settings, ("changed::"s + gkey_wrapper.msg.data()).c_str(),
                      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
-                       auto* self = static_cast<Lv2Wrapper*>(user_data);
+                       auto* binding = static_cast<ControlPortBinding*>(user_data);
 
                        auto key_v = g_settings_get_double(settings, gkey_wrapper.msg.data());
 
@@ -235,15 +249,15 @@ class Lv2Wrapper {
                                            ? 0.0F
                                            : static_cast<float>(util::db_to_linear(key_v));
 
-                       self->set_control_port_value(key_wrapper.msg.data(), linear_v);
+                       binding->self->set_control_port_value(binding->index, linear_v);
                      }),
-                     this);
+                     binding);
 
     auto gkey = gkey_wrapper.msg.data();
-    auto key = key_wrapper.msg.data();
+    auto index = binding->index;
 
-    gsettings_sync_funcs.emplace_back([settings, gkey, key, this]() {
-      const auto linear_v = get_control_port_value(key);
+    gsettings_sync_funcs.emplace_back([settings, gkey, index, this]() {
+      const auto linear_v = get_control_port_value(index);
 
       const auto db_v = (!lower_bound & (linear_v == 0.0F)) ? util::minimum_db_d_level : util::linear_to_db(linear_v);
 
@@ -280,8 +294,20 @@ class Lv2Wrapper {
 
   std::vector<Port> ports;
 
-  // Multiband compressor/gate use 1+8*7=57 control ports. Round up to 64.
-  std::array<std::pair<size_t, uint>, 64> control_ports_cache;
+  std::unordered_map<std::string, uint> map_cp_symbol_to_idx;
+
+  /*
+    The port index of every key bound to gsettings is resolved once in bind_control_port. The signal handlers get a
+    pointer to their binding so they never have to search the ports. A deque keeps these pointers valid as it grows.
+  */
+
+  struct ControlPortBinding {
+    Lv2Wrapper* self;
+
+    uint index;
+  };
+
+  std::deque<ControlPortBinding> control_port_bindings;
 
   struct {
     struct {
@@ -311,6 +337,8 @@ class Lv2Wrapper {
   void connect_control_ports();
 
   auto map_urid(const std::string& uri) -> LV2_URID;
+
+  auto bind_control_port(const std::string& symbol) -> ControlPortBinding*;
 };
 
 }  // namespace lv2
@@ -19,7 +19,6 @@
 
 #pragma once
 
-#include <sigc++/signal.h>
 #include <sys/types.h>
 #include <span>
 #include <string>
@@ -48,7 +47,9 @@ class Maximizer : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
-  sigc::signal<void(const double)> reduction;
+  // Positions of the meters in the extra values of the meter board slot
+
+  enum Meter : size_t { reduction_meter };
 
   double reduction_port_value = 0.0;
 
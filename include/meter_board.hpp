@@ -0,0 +1,123 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include "dsp_load_meter.hpp"
+
+/*
+  Preallocated board where the plugins publish their meters. The realtime thread only stores into atomics. The
+  interface reads the slots of the visible plugins once per frame instead of receiving one idle source per meter.
+*/
+
+class MeterBoard {
+ public:
+  MeterBoard(const MeterBoard&) = delete;
+  auto operator=(const MeterBoard&) -> MeterBoard& = delete;
+  MeterBoard(const MeterBoard&&) = delete;
+  auto operator=(const MeterBoard&&) -> MeterBoard& = delete;
+
+  static constexpr size_t n_slots = 256U;
+
+  // Plugin specific meters like gain reduction or loudness. The multiband plugins use four per band.
+
+  static constexpr size_t n_extra = 32U;
+
+  struct Slot {
+    // Incremented after every update. Readers compare it with the last value they have seen.
+
+    std::atomic<uint64_t> sequence = {0U};
+
+    // Peak levels in dB
+
+    std::atomic<float> input_left = {0.0F}, input_right = {0.0F};
+
+    std::atomic<float> output_left = {0.0F}, output_right = {0.0F};
+
+    std::array<std::atomic<float>, n_extra> extra{};
+
+    // Summary of the last DspLoadMeter window
+
+    std::atomic<float> load_p50 = {0.0F}, load_p99 = {0.0F}, load_max = {0.0F}, load_threshold = {1.0F};
+
+    std::atomic<uint64_t> load_cycles = {0U}, load_overruns = {0U};
+
+    void set_levels(const float& in_left, const float& in_right, const float& out_left, const float& out_right) {
+      input_left.store(in_left, std::memory_order_relaxed);
+      input_right.store(in_right, std::memory_order_relaxed);
+      output_left.store(out_left, std::memory_order_relaxed);
+      output_right.store(out_right, std::memory_order_relaxed);
+
+      sequence.fetch_add(1U, std::memory_order_release);
+    }
+
+    void set_extra(const size_t& index, const float& value) { extra[index].store(value, std::memory_order_relaxed); }
+
+    void set_dsp_load(const DspLoadMeter::Stats& stats) {
+      load_p50.store(stats.p50, std::memory_order_relaxed);
+      load_p99.store(stats.p99, std::memory_order_relaxed);
+      load_max.store(stats.max, std::memory_order_relaxed);
+      load_threshold.store(stats.threshold, std::memory_order_relaxed);
+      load_cycles.store(stats.cycles, std::memory_order_relaxed);
+      load_overruns.store(stats.overruns, std::memory_order_relaxed);
+
+      sequence.fetch_add(1U, std::memory_order_release);
+    }
+
+    [[nodiscard]] auto get_dsp_load() const -> DspLoadMeter::Stats {
+      return {.p50 = load_p50.load(std::memory_order_relaxed),
+              .p99 = load_p99.load(std::memory_order_relaxed),
+              .max = load_max.load(std::memory_order_relaxed),
+              .threshold = load_threshold.load(std::memory_order_relaxed),
+              .cycles = load_cycles.load(std::memory_order_relaxed),
+              .overruns = load_overruns.load(std::memory_order_relaxed)};
+    }
+
+    [[nodiscard]] auto get_extra(const size_t& index) const -> float {
+      return extra[index].load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto get_sequence() const -> uint64_t { return sequence.load(std::memory_order_acquire); }
+  };
+
+  static_assert(std::atomic<float>::is_always_lock_free);
+  static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+  static auto get() -> MeterBoard&;
+
+  // Returns nullptr when all slots are in use
+
+  auto acquire() -> Slot*;
+
+  void release(Slot* slot);
+
+ private:
+  MeterBoard() = default;
+
+  std::mutex mutex;
+
+  std::array<Slot, n_slots> slots;
+
+  std::array<bool, n_slots> in_use{};
+};
@@ -23,7 +23,6 @@
 #include <glib-object.h>
 #include <glib.h>
 #include <pipewire/context.h>
-#include <sigc++/signal.h>
 #include <sys/types.h>
 #include <array>
 #include <cstddef>
@@ -63,7 +62,16 @@ class MultibandCompressor : public PluginBase {
 
   void update_probe_links() override;
 
-  sigc::signal<void(const std::array<float, n_bands>)> reduction, envelope, curve, frequency_range;
+  // Positions of the meters in the extra values of the meter board slot. Each meter takes one value per band.
+
+  enum Meter : size_t {
+    frequency_range_meter = 0U,
+    envelope_meter = n_bands,
+    curve_meter = 2U * n_bands,
+    reduction_meter = 3U * n_bands
+  };
+
+  static_assert(4U * n_bands <= MeterBoard::n_extra);
 
   std::array<float, n_bands> frequency_range_end_port_array = {0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F};
   std::array<float, n_bands> envelope_port_array = {0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F, 0.0F};
@@ -23,7 +23,6 @@
 #include <glib-object.h>
 #include <glib.h>
 #include <pipewire/proxy.h>
-#include <sigc++/signal.h>
 #include <sys/types.h>
 #include <array>
 #include <cstddef>
@@ -63,7 +62,16 @@ class MultibandGate : public PluginBase {
 
   void update_probe_links() override;
 
-  sigc::signal<void(const std::array<float, n_bands>)> reduction, envelope, curve, frequency_range;
+  // Positions of the meters in the extra values of the meter board slot. Each meter takes one value per band.
+
+  enum Meter : size_t {
+    frequency_range_meter = 0U,
+    envelope_meter = n_bands,
+    curve_meter = 2U * n_bands,
+    reduction_meter = 3U * n_bands
+  };
+
+  static_assert(4U * n_bands <= MeterBoard::n_extra);
 
   float latency_port_value = 0.0F;
 
@@ -0,0 +1,61 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <string>
+#include "effects_base.hpp"
+#include "pipeline_type.hpp"
+
+/*
+  Runs the effects of a preset over an audio file without PipeWire. The plugins are the same objects the pipelines use
+  but they are created without a PipeManager and driven through a FusedChain from a loop that reads and writes the
+  files with libsndfile in fixed quanta. Nothing waits for a realtime clock, so the render is as fast as the CPU allows.
+
+  Usage: easyeffects --render -l <preset> [-t output|input] [-q <quantum>] <input file> <output file>
+
+  --render has to be the first argument. The user settings are never touched because the preset is loaded into an
+  in memory settings backend.
+*/
+
+class OfflineRenderer : public EffectsBase {
+ public:
+  OfflineRenderer(PipelineType pipe_type);
+  OfflineRenderer(const OfflineRenderer&) = delete;
+  auto operator=(const OfflineRenderer&) -> OfflineRenderer& = delete;
+  OfflineRenderer(const OfflineRenderer&&) = delete;
+  auto operator=(const OfflineRenderer&&) -> OfflineRenderer& = delete;
+  ~OfflineRenderer() override;
+
+  auto render(const std::string& input_path, const std::string& output_path, const uint& quantum) -> bool;
+
+  // Entry point used by main() when the first argument is --render
+
+  static auto run_from_command_line(int argc, char* argv[]) -> int;
+
+ private:
+  // Number of silent quanta used at most to let the plugins finish the setup they defer to the main loop
+
+  static constexpr uint max_warmup_cycles = 64U;
+
+  void create_chain();
+
+  static auto dispatch_main_context() -> bool;
+};
@@ -44,5 +44,7 @@ class OutputLevel : public PluginBase {
                std::span<float>& left_out,
                std::span<float>& right_out) override;
 
+  void process(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs) override;
+
   auto get_latency_seconds() -> float override;
 };
@@ -0,0 +1,117 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <zita-convolver.h>
+#include <chrono>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include "convolution_pool.hpp"
+
+/*
+  Uniformly partitioned convolution split in two zita-convolver engines that never start threads of their own.
+
+  The direct engine has partitions of the quantum size, covers the first 2 * deferred_quantum taps of each kernel and
+  runs in the caller thread. The deferred engine has partitions of deferred_quantum frames and covers the remaining
+  taps. Its input is collected block by block and each block is convolved by a ConvolutionPool worker while the next
+  one is being collected. The result is needed only one block later, because the taps it covers are delayed by two
+  blocks, so the overall output has no added latency.
+
+  configure, impdata_create, start_process and stop_process must be called from the main thread. inpdata, outdata and
+  process are used from the realtime thread and have the same meaning as in zita.
+*/
+
+class PartitionedConvolver {
+ public:
+  explicit PartitionedConvolver(std::string name);
+  PartitionedConvolver(const PartitionedConvolver&) = delete;
+  auto operator=(const PartitionedConvolver&) -> PartitionedConvolver& = delete;
+  PartitionedConvolver(const PartitionedConvolver&&) = delete;
+  auto operator=(const PartitionedConvolver&&) -> PartitionedConvolver& = delete;
+  ~PartitionedConvolver();
+
+  // Return values are the zita error codes. Any previous configuration is discarded.
+
+  auto configure(const uint& n_inputs,
+                 const uint& n_outputs,
+                 const uint& max_size,
+                 const uint& quantum,
+                 const uint& rate) -> int;
+
+  auto impdata_create(const uint& input, const uint& output, std::span<const float> data) -> int;
+
+  auto start_process() -> int;
+
+  void stop_process();
+
+  [[nodiscard]] auto inpdata(const uint& input) const -> float* { return direct->inpdata(input); }
+
+  [[nodiscard]] auto outdata(const uint& output) const -> float* { return direct->outdata(output); }
+
+  auto process() -> int;
+
+  [[nodiscard]] auto get_stats() const -> ConvolutionPool::Stats;
+
+ private:
+  uint n_inputs = 0U;
+  uint n_outputs = 0U;
+  uint quantum = 0U;
+  uint deferred_quantum = 0U;
+  uint deferred_position = 0U;
+
+  bool deferred_submitted = false;
+
+  // Set when a deferred block was dropped. The next job clears the engine history first.
+
+  bool deferred_reset = false;
+
+  // Copy of deferred_reset for the job. Only written by the realtime thread while the worker is idle.
+
+  bool reset_before_block = false;
+
+  // Whether the client is in the pool. Only the engines with a deferred part use it.
+
+  bool registered = false;
+
+  // The deferred block is this many quanta long unless that goes above the zita partition limit
+
+  static constexpr uint deferred_factor = 8U;
+
+  std::chrono::nanoseconds deferred_budget{0};
+
+  Convproc* direct = nullptr;
+
+  Convproc* deferred = nullptr;
+
+  // deferred_staged holds the last complete block while the worker convolves it
+
+  std::vector<std::vector<float>> deferred_input, deferred_staged, deferred_output;
+
+  std::unique_ptr<ConvolutionPool::Client> client;
+
+  void exchange_deferred_block();
+
+  void run_deferred_block();
+
+  static void destroy(Convproc*& conv);
+};
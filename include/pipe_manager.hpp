@@ -31,14 +31,17 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include "pipe_objects.hpp"
 
 class PipeManager {
  public:
-  PipeManager();
+  explicit PipeManager(std::vector<std::string> channel_positions = {"FL", "FR"});
   PipeManager(const PipeManager&) = delete;
   auto operator=(const PipeManager&) -> PipeManager& = delete;
   PipeManager(const PipeManager&&) = delete;
@@ -52,6 +55,10 @@ class PipeManager {
 
   inline static bool exiting = false;
 
+  // Sequence number of the last core done event. Written by the loop thread with the loop lock held.
+
+  int sync_done_seq = -1;
+
   inline static bool exclude_monitor_stream = true;
 
   spa_hook metadata_listener{};
@@ -68,9 +75,36 @@ class PipeManager {
 
   std::vector<DeviceInfo> list_devices;
 
+  /*
+    Indexes over the containers above. The registry callbacks update them together with the containers, so looking
+    up a node by id, an object by serial or the port of a node carrying a given channel does not scan anything. The
+    lists are unordered: removing an element moves the last one into its place.
+  */
+
+  std::unordered_map<uint, uint64_t> node_serial_by_id;
+
+  std::unordered_map<uint64_t, size_t> link_index_by_serial;
+
+  std::unordered_map<uint64_t, size_t> port_index_by_serial;
+
+  std::unordered_map<uint, std::vector<uint64_t>> port_serials_by_node;
+
+  std::unordered_map<PortKey, uint64_t, PortKeyHash> port_serial_by_key;
+
+  std::unordered_map<uint, size_t> module_index_by_id;
+
+  std::unordered_map<uint, size_t> client_index_by_id;
+
+  std::unordered_map<uint, size_t> device_index_by_id;
+
   std::string default_output_device_name, default_input_device_name;
 
   NodeInfo ee_sink_node, ee_source_node;
+
+  // Channels of our virtual devices and of every filter in the pipelines. Fixed for the lifetime of the instance.
+
+  const std::vector<std::string> channel_positions;
+
   NodeInfo output_device, input_device;
 
   constexpr static auto blocklist_node_name =
@@ -105,7 +139,16 @@ class PipeManager {
   auto count_node_ports(const uint& node_id) -> uint;
 
   /*
-    Links the output ports of the node output_node_id to the input ports of the node input_node_id
+    Pairs the output ports of the node output_node_id with the input ports of the node input_node_id. For a probe link
+    FL and FR go to the PROBE_FL and PROBE_FR inputs.
+  */
+
+  auto match_ports(const uint& output_node_id, const uint& input_node_id, const bool& probe_link = false)
+      -> std::vector<std::pair<PortInfo, PortInfo>>;
+
+  /*
+    Links the output ports of the node output_node_id to the input ports of the node input_node_id. This and
+    destroy_links() are single operation GraphTransactions. Use one directly when several links change together.
   */
 
   auto link_nodes(const uint& output_node_id,
@@ -119,7 +162,7 @@ class PipeManager {
     Destroy all the filters links
   */
 
-  void destroy_links(const std::vector<pw_proxy*>& list) const;
+  void destroy_links(const std::vector<pw_proxy*>& list);
 
   void lock() const;
 
@@ -129,6 +172,14 @@ class PipeManager {
 
   auto wait_full() const -> int;
 
+  /*
+    Blocks until ready() returns true or the timeout expires. ready() is called with the loop lock held, first right
+    away and then every time the loop is signalled. The registry signals it when a node or a port is added and the
+    filters do it when their state changes. Returns the last value of ready(). Must not be called from the loop thread.
+  */
+
+  auto wait_until(const std::function<bool()>& ready, const int& timeout_seconds = 10) const -> bool;
+
   static void lock_node_map();
 
   static void unlock_node_map();
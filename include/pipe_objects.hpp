@@ -25,7 +25,9 @@
 #include <spa/param/param.h>
 #include <spa/utils/defs.h>
 #include <sys/types.h>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <string>
 
 struct NodeInfo {
@@ -104,6 +106,15 @@ struct LinkInfo {
   pw_link_state state = PW_LINK_STATE_UNLINKED;
 };
 
+enum class PortDirection { unknown, input, output };
+
+/*
+  The audio.channel values link_nodes() cares about. Anything else is unknown and the ports of such nodes are matched
+  by their port id.
+*/
+
+enum class AudioChannel { unknown, mono, fl, fr, fc, lfe, rl, rr, sl, sr, probe_fl, probe_fr };
+
 struct PortInfo {
   std::string path;
 
@@ -113,7 +124,9 @@ struct PortInfo {
 
   std::string name;
 
-  std::string direction;
+  PortDirection direction = PortDirection::unknown;
+
+  AudioChannel channel = AudioChannel::unknown;
 
   bool physical = false;
 
@@ -130,6 +143,27 @@ struct PortInfo {
   uint64_t serial = SPA_ID_INVALID;
 };
 
+// Key of the PipeManager index used to find the port of a node that carries a given channel
+
+struct PortKey {
+  uint node_id = 0U;
+
+  PortDirection direction = PortDirection::unknown;
+
+  AudioChannel channel = AudioChannel::unknown;
+
+  auto operator==(const PortKey&) const -> bool = default;
+};
+
+struct PortKeyHash {
+  auto operator()(const PortKey& key) const -> size_t {
+    const auto packed = (static_cast<uint64_t>(key.node_id) << 16U) | (static_cast<uint64_t>(key.direction) << 8U) |
+                        static_cast<uint64_t>(key.channel);
+
+    return std::hash<uint64_t>{}(packed);
+  }
+};
+
 struct ModuleInfo {
   uint id;
 
@@ -20,11 +20,11 @@
 #pragma once
 
 #include <STTypes.h>
-#include <deque>
 #include <span>
 #include <string>
 #include <vector>
 #include "SoundTouch.h"
+#include "block_adapter.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 
@@ -64,7 +64,7 @@ class Pitch : public PluginBase {
 
   std::vector<float> data_L, data_R, data;
 
-  std::deque<float> deque_out_L, deque_out_R;
+  BlockAdapter<float> block_adapter;
 
   soundtouch::SoundTouch* snd_touch = nullptr;
 
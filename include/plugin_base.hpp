@@ -27,14 +27,22 @@
 #include <sys/types.h>
 #include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <span>
 #include <string>
 #include <vector>
+#include "channel_layout.hpp"
+#include "dsp_load_meter.hpp"
 #include "lv2_wrapper.hpp"
+#include "meter_board.hpp"
 #include "pipe_manager.hpp"
 #include "pipeline_type.hpp"
+#include "rt_command_queue.hpp"
 #include "util.hpp"
 
 class PluginBase {
@@ -60,16 +68,16 @@ class PluginBase {
   };
 
   struct data {
-    struct port* in_left = nullptr;
-    struct port* in_right = nullptr;
+    // One port per channel position
 
-    struct port* out_left = nullptr;
-    struct port* out_right = nullptr;
+    std::vector<struct port*> in, out;
 
     struct port* probe_left = nullptr;
     struct port* probe_right = nullptr;
 
     PluginBase* pb = nullptr;
+
+    PipeManager* pm = nullptr;
   };
 
   const std::string log_tag;
@@ -90,6 +98,12 @@ class PluginBase {
 
   uint rate = 0U;
 
+  // Positions of the channels of the filter in the order of the layout. Always stereo without a PipeManager.
+
+  std::vector<std::string> channel_positions;
+
+  uint n_channels = 2U;
+
   bool package_installed = true;
 
   std::atomic<bool> bypass = {false};
@@ -97,6 +111,14 @@ class PluginBase {
 
   bool connected_to_pw = false;
 
+  /*
+    Number of FusedChain vectors that hold this plugin on the realtime side. The main thread increments it before it
+    posts a chain and the realtime thread decrements it when a vector holding the plugin is swapped out.
+  */
+
+  std::atomic<uint> fused_chain_users = {0U};
+  static_assert(std::atomic<uint>::is_always_lock_free);
+
   bool send_notifications = false;
 
   float delta_t = 0.0F;
@@ -105,10 +127,30 @@ class PluginBase {
 
   float latency_value = 0.0F;  // seconds
 
-  std::chrono::time_point<std::chrono::system_clock> clock_start;
+  std::chrono::time_point<std::chrono::steady_clock> clock_start;
 
   std::vector<float> dummy_left, dummy_right;
 
+  // Preallocated views given to the multichannel process()
+
+  std::vector<std::span<float>> channel_in, channel_out;
+
+  // Number of realtime cycles that could not take data_mutex because another thread was holding it.
+
+  std::atomic<uint64_t> rt_contended_cycles = {0U};
+  static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+  /*
+    Time spent between prepare_process() and finish_process() relative to the quantum duration. A summary of every
+    notification window is published in meter_slot.
+  */
+
+  DspLoadMeter dsp_load_meter;
+
+  // Where notify() publishes the input and output peaks. It is nullptr when the meter board is full.
+
+  MeterBoard::Slot* meter_slot = nullptr;
+
   [[nodiscard]] auto get_node_id() const -> uint;
 
   void set_active(const bool& state) const;
@@ -117,6 +159,20 @@ class PluginBase {
 
   auto connect_to_pw() -> bool;
 
+  /*
+    The two halves of connect_to_pw(). request_connection() only asks PipeWire to create the node. finish_connection()
+    blocks until the node and all of its ports are in the registry. Requesting several filters before finishing the
+    first one lets PipeWire create all of them concurrently.
+  */
+
+  auto request_connection() -> bool;
+
+  auto finish_connection() -> bool;
+
+  // True when the node and its ports are registered or when the filter is in an error. Needs the loop lock.
+
+  [[nodiscard]] auto connection_settled() const -> bool;
+
   void disconnect_from_pw();
 
   void reset_settings();
@@ -129,6 +185,16 @@ class PluginBase {
 
   virtual void setup();
 
+  /*
+    Called before and after process() for every cycle. They keep the rate, the block size and the notification timer
+    up to date. Besides our own filter callback they are also used by FusedChain, that runs several plugins inside a
+    single PipeWire node.
+  */
+
+  void prepare_process(const uint& rate, const uint& n_samples);
+
+  void finish_process();
+
   virtual void process(std::span<float>& left_in,
                        std::span<float>& right_in,
                        std::span<float>& left_out,
@@ -141,12 +207,28 @@ class PluginBase {
                        std::span<float>& probe_left,
                        std::span<float>& probe_right);
 
+  /*
+    Entry point for layouts with more than two channels. There is one span per channel position. The default runs the
+    stereo process() on FL and FR and passes the other channels through, delayed by the plugin latency so that they
+    stay aligned. That is the stereo_only policy. Plugins with another policy override it and usually implement the
+    stereo process() on top of it.
+  */
+
+  virtual void process(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs);
+
+  // Multichannel processing for the plugins that read a probe. The probe is always stereo.
+
+  void process_with_probe(std::span<std::span<float>> inputs,
+                          std::span<std::span<float>> outputs,
+                          std::span<float>& probe_left,
+                          std::span<float>& probe_right);
+
+  [[nodiscard]] auto get_channel_policy() const -> ChannelPolicy;
+
   virtual void update_probe_links();
 
   virtual auto get_latency_seconds() -> float;
 
-  sigc::signal<void(const float, const float)> input_level;
-  sigc::signal<void(const float, const float)> output_level;
   sigc::signal<void()> latency;
 
  protected:
@@ -164,12 +246,20 @@ class PluginBase {
 
   uint n_ports = 4U;
 
+  ChannelPolicy channel_policy = ChannelPolicy::stereo_only;
+
+  // With the per_channel policy the LFE channel is only delayed to stay aligned with the processed channels
+
+  bool lfe_passthrough = true;
+
   float input_gain = 1.0F;
   float output_gain = 1.0F;
 
   std::unique_ptr<lv2::Lv2Wrapper> lv2_wrapper;
 
-  std::vector<gulong> gconnections;
+  RtCommandQueue<64U> rt_commands;
+
+  std::vector<gulong> gconnections, gconnections_global;
 
   void setup_input_output_gain();
 
@@ -182,13 +272,93 @@ class PluginBase {
                  std::span<float>& left_out,
                  std::span<float>& right_out);
 
+  // Peaks of channels that are neither on the left nor on the right go to both sides of the meters
+
+  void get_peaks(std::span<const std::span<float>> inputs, std::span<const std::span<float>> outputs);
+
   static void apply_gain(std::span<float>& left, std::span<float>& right, const float& gain);
 
+  static void apply_gain(std::span<const std::span<float>> channels, const float& gain);
+
+  // Whether channel n goes through the per_channel and linked processing
+
+  [[nodiscard]] auto is_processed_channel(const size_t& n) const -> bool;
+
   void update_filter_params();
 
+  /*
+    The realtime thread must never wait for data_mutex. process() takes it through lock_for_rt(), that only tries to
+    lock it. When it fails the cycle is counted in rt_contended_cycles and the plugin writes its input with
+    write_delayed_dry(). On success the commands posted with post_to_rt() are run before the lock is returned.
+  */
+
+  auto lock_for_rt() -> std::unique_lock<std::mutex>;
+
+  /*
+    prepare_process() calls setup() in the realtime thread. Plugins that need data_mutex to reconfigure only set this
+    flag there and do the work in process() once lock_for_rt() succeeds, retrying in the next cycle when it fails.
+  */
+
+  bool setup_pending = false;
+
+  void post_to_rt(std::function<void()> cmd);
+
+  // True when neither PipeWire nor a FusedChain can be running process()
+
+  [[nodiscard]] auto is_idle() const -> bool;
+
+  // Runs the posted commands in the calling thread. Only allowed when no realtime thread can be running process().
+
+  void run_posted_commands();
+
+  /*
+    Plugins with latency call allocate_dry_delay() in their constructor and store_dry() in every cycle that holds the
+    lock, before the input is changed. write_delayed_dry() then delays the input by the plugin latency, so that the
+    cycles where lock_for_rt() fails stay aligned with the processed ones. Without the delay lines it copies the input.
+  */
+
+  void allocate_dry_delay();
+
+  void store_dry(std::span<const std::span<float>> inputs);
+
+  void store_dry(const std::span<float>& left_in, const std::span<float>& right_in);
+
+  void write_delayed_dry(std::span<const std::span<float>> inputs, std::span<std::span<float>> outputs);
+
+  void write_delayed_dry(const std::span<float>& left_in,
+                         const std::span<float>& right_in,
+                         std::span<float>& left_out,
+                         std::span<float>& right_out);
+
  private:
   uint node_id = 0U;
 
+  std::chrono::time_point<std::chrono::steady_clock> process_start;
+
   float input_peak_left = util::minimum_linear_level, input_peak_right = util::minimum_linear_level;
   float output_peak_left = util::minimum_linear_level, output_peak_right = util::minimum_linear_level;
+
+  // Length of the delay lines. They are sized in the constructor.
+
+  size_t delay_line_size = 0U;
+
+  // Delay lines of the channels passed through by the stereo_only policy
+
+  std::vector<std::vector<float>> passthrough_delay;
+
+  size_t passthrough_write_index = 0U;
+
+  // Input of the last second. Only allocated by the plugins that have latency.
+
+  std::vector<std::vector<float>> dry_delay;
+
+  size_t dry_write_index = 0U;
+
+  // Commands that did not fit in rt_commands. A timeout moves them to the queue as the realtime thread drains it.
+
+  std::deque<std::function<void()>> rt_overflow;
+
+  guint rt_overflow_source = 0U;
+
+  void pass_through_extra_channels(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs);
 };
@@ -0,0 +1,72 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+  Process wide pool that builds plugins outside of the main thread. A plugin constructor is where its resources are
+  loaded: LV2 lookups, GSettings objects, LADSPA libraries and noise suppression models. With several plugins in a
+  preset doing it one after the other in the main thread takes seconds.
+
+  The pool is small on purpose. Most of the work is I/O or waits on the LV2 world lock, so more workers would not help.
+  FFTW planning is not thread safe and it is never done here. The plugins only plan in the main thread, from the
+  callbacks that setup() schedules with util::idle_add.
+*/
+
+class PluginLoader {
+ public:
+  PluginLoader(const PluginLoader&) = delete;
+  auto operator=(const PluginLoader&) -> PluginLoader& = delete;
+  PluginLoader(const PluginLoader&&) = delete;
+  auto operator=(const PluginLoader&&) -> PluginLoader& = delete;
+  ~PluginLoader();
+
+  static auto get() -> PluginLoader&;
+
+  // Queues the job. The workers are started on demand, up to max_workers.
+
+  void submit(std::function<void()> job);
+
+ private:
+  PluginLoader() = default;
+
+  static constexpr uint max_workers = 4U;
+
+  std::mutex mutex;
+
+  std::condition_variable cv;
+
+  std::deque<std::function<void()>> jobs;
+
+  std::vector<std::thread> workers;
+
+  uint n_idle = 0U;
+
+  bool quit = false;
+
+  void worker_loop();
+};
@@ -0,0 +1,100 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <sys/types.h>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+/*
+  Rational ratio polyphase resampler for the realtime thread. The ratio output_rate / input_rate is reduced to L / M
+  and a windowed sinc prototype with L phases is built once per ratio and shared by every instance using it. All
+  buffers are allocated in setup(). process() only reads the filter bank and writes to preallocated memory.
+
+  Both channels go through the same loop so that each filter phase is loaded once per output frame. The dot products
+  are written with independent partial sums over contiguous memory, which the compiler turns into SIMD code on x86 and
+  ARM without fast-math or intrinsics.
+
+  For offline conversions of whole files the libsamplerate based Resampler is still the better choice.
+*/
+
+class PolyphaseResampler {
+ public:
+  PolyphaseResampler() = default;
+  PolyphaseResampler(const PolyphaseResampler&) = delete;
+  auto operator=(const PolyphaseResampler&) -> PolyphaseResampler& = delete;
+  PolyphaseResampler(const PolyphaseResampler&&) = delete;
+  auto operator=(const PolyphaseResampler&&) -> PolyphaseResampler& = delete;
+  ~PolyphaseResampler() = default;
+
+  // max_input_frames is the largest number of frames that will be given to a single process() call
+
+  void setup(const uint& input_rate, const uint& output_rate, const size_t& max_input_frames);
+
+  /*
+    Returns views of the internal output buffers. They are valid until the next call. The number of output frames
+    varies by one frame around max_input_frames * output_rate / input_rate depending on the phase.
+  */
+
+  auto process(const std::span<const float>& left, const std::span<const float>& right)
+      -> std::pair<std::span<const float>, std::span<const float>>;
+
+  // Group delay of the anti aliasing filter measured in output frames. It does not depend on the input.
+
+  [[nodiscard]] auto get_latency() const -> uint { return latency; }
+
+  [[nodiscard]] auto get_max_output_frames() const -> size_t { return output_L.size(); }
+
+  void reset();
+
+ private:
+  struct Bank {
+    uint n_phases = 0U;
+
+    uint n_taps = 0U;
+
+    // n_phases filters of n_taps coefficients each. Every filter is reversed so it runs forward over the history.
+
+    std::vector<float> coefficients;
+  };
+
+  static auto get_bank(const uint& up, const uint& down) -> std::shared_ptr<const Bank>;
+
+  static auto make_bank(const uint& up, const uint& down) -> std::shared_ptr<const Bank>;
+
+  std::shared_ptr<const Bank> bank;
+
+  uint up = 1U;  // L
+
+  uint down = 1U;  // M
+
+  uint phase = 0U;
+
+  uint latency = 0U;
+
+  size_t position = 0U;
+
+  std::vector<float> history_L, history_R;
+
+  std::vector<float> output_L, output_R;
+};
@@ -94,6 +94,21 @@ class PresetsManager {
                            const std::vector<std::string>& plugins,
                            const nlohmann::json& json) -> bool;
 
+  /*
+    Writes the plugin parameters of a local preset to new instances whose ids start at first_instance_id. The plugins
+    in the pipeline are not touched. plugins receives the new instance names and blocklist the preset blocklist.
+  */
+
+  auto write_snapshot(const PresetType& preset_type,
+                      const std::string& name,
+                      const uint& first_instance_id,
+                      std::vector<std::string>& plugins,
+                      std::vector<std::string>& blocklist) -> bool;
+
+  void set_last_preset_keys(const PresetType& preset_type,
+                            const std::string& preset_name = "",
+                            const std::string& package_name = "");
+
   void import_from_filesystem(const PresetType& preset_type, const std::string& file_path);
 
   void import_from_community_package(const PresetType& preset_type,
@@ -148,12 +163,13 @@ class PresetsManager {
                                             const std::filesystem::path& path,
                                             const std::string& package) -> bool;
 
-  void set_last_preset_keys(const PresetType& preset_type,
-                            const std::string& preset_name = "",
-                            const std::string& package_name = "");
-
   auto load_preset_file(const PresetType& preset_type, const std::filesystem::path& input_file) -> bool;
 
+  auto read_plugins_order(const PresetType& preset_type,
+                          const std::filesystem::path& input_file,
+                          nlohmann::json& json,
+                          std::vector<std::string>& plugins) -> bool;
+
   void save_blocklist(const PresetType& preset_type, nlohmann::json& json);
 
   auto load_blocklist(const PresetType& preset_type, const nlohmann::json& json) -> bool;
@@ -33,9 +33,9 @@
 #include <rnnoise.h>
 #endif
 
-#include <deque>
+#include "block_adapter.hpp"
 #include "plugin_base.hpp"
-#include "resampler.hpp"
+#include "polyphase_resampler.hpp"
 
 class RNNoise : public PluginBase {
  public:
@@ -93,13 +93,13 @@ class RNNoise : public PluginBase {
 
   const float inv_short_max = 1.0F / (SHRT_MAX + 1.0F);
 
-  std::deque<float> deque_out_L, deque_out_R;
+  BlockAdapter<float> block_adapter;
 
-  std::vector<float> data_L, data_R, data_tmp;
-  std::vector<float> resampled_data_L, resampled_data_R;
+  std::vector<float> data_tmp;
 
-  std::unique_ptr<Resampler> resampler_inL, resampler_outL;
-  std::unique_ptr<Resampler> resampler_inR, resampler_outR;
+  PolyphaseResampler resampler_in, resampler_out;
+
+  uint resampler_latency = 0U;
 
 #ifdef ENABLE_RNNOISE
 
@@ -114,94 +114,51 @@ class RNNoise : public PluginBase {
 
   void free_rnnoise();
 
-  template <typename T1, typename T2>
-  void remove_noise(const T1& left_in, const T1& right_in, T2& out_L, T2& out_R) {
-    for (const auto& v : left_in) {
-      data_L.push_back(v);
-
-      if (data_L.size() == blocksize) {
-        if (state_left != nullptr) {
-          std::ranges::for_each(data_L, [](auto& v) { v *= static_cast<float>(SHRT_MAX + 1); });
-
-          data_tmp = data_L;
+  void apply_setup();
 
-          vad_prob_left = rnnoise_process_frame(state_left, data_L.data(), data_L.data());
+  template <typename T1>
+  void denoise_block(DenoiseState* state, T1& data, float& vad_prob, int& vad_grace) {
+    std::ranges::for_each(data, [](auto& v) { v *= static_cast<float>(SHRT_MAX + 1); });
 
-          if (enable_vad) {
-            if (vad_prob_left >= vad_thres) {
-              vad_grace_left = release;
-            }
+    std::copy(data.begin(), data.end(), data_tmp.begin());
 
-            if (vad_grace_left >= 0) {
-              --vad_grace_left;
+    vad_prob = rnnoise_process_frame(state, data.data(), data.data());
 
-              for (size_t i = 0U; i < data_L.size(); i++) {
-                data_L[i] = data_L[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
+    if (enable_vad) {
+      if (vad_prob >= vad_thres) {
+        vad_grace = release;
+      }
 
-                data_L[i] *= inv_short_max;
-              }
-            } else {
-              std::ranges::for_each(data_L, [&](auto& v) { v = 0.0F; });
-            }
-          } else {
-            for (size_t i = 0U; i < data_L.size(); i++) {
-              data_L[i] = data_L[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
+      if (vad_grace >= 0) {
+        --vad_grace;
 
-              data_L[i] *= inv_short_max;
-            }
-          }
-        }
+        for (size_t i = 0U; i < data.size(); i++) {
+          data[i] = data[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
 
-        for (const auto& v : data_L) {
-          out_L.push_back(v);
+          data[i] *= inv_short_max;
         }
+      } else {
+        std::ranges::for_each(data, [&](auto& v) { v = 0.0F; });
+      }
+    } else {
+      for (size_t i = 0U; i < data.size(); i++) {
+        data[i] = data[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
 
-        data_L.resize(0U);
+        data[i] *= inv_short_max;
       }
     }
+  }
 
-    for (const auto& v : right_in) {
-      data_R.push_back(v);
-
-      if (data_R.size() == blocksize) {
-        if (state_right != nullptr) {
-          std::ranges::for_each(data_R, [](auto& v) { v *= static_cast<float>(SHRT_MAX + 1); });
-
-          data_tmp = data_R;
-
-          vad_prob_right = rnnoise_process_frame(state_right, data_R.data(), data_R.data());
-
-          if (enable_vad) {
-            if (vad_prob_right >= vad_thres) {
-              vad_grace_right = release;
-            }
-
-            if (vad_grace_right >= 0) {
-              --vad_grace_right;
-
-              for (size_t i = 0U; i < data_R.size(); i++) {
-                data_R[i] = data_R[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
-
-                data_R[i] *= inv_short_max;
-              }
-            } else {
-              std::ranges::for_each(data_R, [&](auto& v) { v = 0.0F; });
-            }
-          } else {
-            for (size_t i = 0U; i < data_R.size(); i++) {
-              data_R[i] = data_R[i] * wet_ratio + data_tmp[i] * (1.0F - wet_ratio);
+  // Denoises one block of blocksize frames in place.
 
-              data_R[i] *= inv_short_max;
-            }
-          }
-        }
-
-        for (const auto& v : data_R) {
-          out_R.push_back(v);
-        }
+  template <typename T1>
+  void remove_noise(T1& left, T1& right) {
+    if (state_left != nullptr) {
+      denoise_block(state_left, left, vad_prob_left, vad_grace_left);
+    }
 
-        data_R.resize(0U);
-      }
+    if (state_right != nullptr) {
+      denoise_block(state_right, right, vad_prob_right, vad_grace_right);
     }
   }
 
@@ -0,0 +1,100 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+/*
+  Single producer single consumer queue used to hand work from the main thread to the realtime thread.
+
+  The consumer only invokes the stored functions. It never destroys them. A slot keeps its function until the producer
+  writes a new one on it, so any memory held by the closure is released outside of the realtime thread.
+*/
+
+template <size_t capacity>
+class RtCommandQueue {
+ public:
+  RtCommandQueue() = default;
+  RtCommandQueue(const RtCommandQueue&) = delete;
+  auto operator=(const RtCommandQueue&) -> RtCommandQueue& = delete;
+  RtCommandQueue(const RtCommandQueue&&) = delete;
+  auto operator=(const RtCommandQueue&&) -> RtCommandQueue& = delete;
+  ~RtCommandQueue() = default;
+
+  // Producer side. Returns false when the queue is full. The command is only moved from when it is queued.
+
+  auto push(std::function<void()>&& cmd) -> bool {
+    const auto w = write_index.load(std::memory_order_relaxed);
+    const auto next = (w + 1U) % capacity;
+
+    if (next == read_index.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    slots[w] = std::move(cmd);
+
+    write_index.store(next, std::memory_order_release);
+
+    return true;
+  }
+
+  /*
+    Producer side. Releases the functions the consumer has already run, so that what their closures hold is freed now
+    instead of when their slot is reused.
+  */
+
+  void release_consumed() {
+    const auto r = read_index.load(std::memory_order_acquire);
+
+    while (release_index != r) {
+      slots[release_index] = nullptr;
+
+      release_index = (release_index + 1U) % capacity;
+    }
+  }
+
+  // Consumer side. Runs every pending command in the order they were pushed.
+
+  void drain() {
+    auto r = read_index.load(std::memory_order_relaxed);
+
+    const auto w = write_index.load(std::memory_order_acquire);
+
+    while (r != w) {
+      slots[r]();
+
+      r = (r + 1U) % capacity;
+    }
+
+    read_index.store(r, std::memory_order_release);
+  }
+
+ private:
+  std::array<std::function<void()>, capacity> slots;
+
+  std::atomic<size_t> write_index = {0U}, read_index = {0U};
+  static_assert(std::atomic<size_t>::is_always_lock_free);
+
+  size_t release_index = 0U;  // only used by the producer
+};
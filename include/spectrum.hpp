@@ -22,10 +22,17 @@
 #include <fftw3.h>
 #include <sigc++/signal.h>
 #include <sys/types.h>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <deque>
+#include <memory>
+#include <mutex>
 #include <span>
 #include <string>
+#include <thread>
 #include <vector>
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
@@ -52,36 +59,135 @@ class Spectrum : public PluginBase {
 
   auto get_latency_seconds() -> float override;
 
-  std::tuple<uint, uint, double*> compute_magnitudes();  // rate, nbands, magnitudes
+  /*
+    Copies the latest spectrum computed by the analysis thread. The magnitudes are already reduced to the display
+    points and converted to dB. The frequencies are only copied when layout_serial differs from the serial of the
+    current display layout, which is written back to layout_serial. Returns false if no new frame is available.
+  */
+
+  auto get_display_data(uint& layout_serial, std::vector<double>& frequencies, std::vector<double>& magnitudes)
+      -> bool;
 
  private:
   std::atomic<bool> fftw_ready = false;
 
-  fftwf_plan plan = nullptr;
+  static constexpr auto analysis_period = std::chrono::milliseconds(16);
+
+  // Large enough for the biggest fft plus about a second of backlog at 48 kHz.
+
+  static constexpr uint max_fft_size = 65536U;
+  static constexpr uint ring_size = 2U * max_fft_size;
+  static constexpr uint ring_mask = ring_size - 1U;
+  static constexpr uint ring_guard = 16384U;  // more than the largest quantum pipewire uses
+
+  enum class Window { hann, hamming, blackman_harris, flat_top };
+
+  enum class Averaging { none, exponential, peak_hold, welch };
+
+  /*
+    Everything that depends on the analysis settings. It is built on the main thread, where fftw plans are created
+    and destroyed, and swapped into the analysis thread under analysis_mutex. The realtime thread never touches it.
+  */
+
+  struct Analyzer {
+    Analyzer(const uint& fft_size, const Window& window_type);
+    Analyzer(const Analyzer&) = delete;
+    auto operator=(const Analyzer&) -> Analyzer& = delete;
+    Analyzer(const Analyzer&&) = delete;
+    auto operator=(const Analyzer&&) -> Analyzer& = delete;
+    ~Analyzer();
+
+    uint fft_size = 0U, n_bins = 0U, hop = 0U;
+
+    Averaging averaging = Averaging::none;
 
-  fftwf_complex* complex_output = nullptr;
+    float averaging_time = 0.0F;  // seconds
 
-  static constexpr uint n_bands = 8192U;
+    float scale = 0.0F;  // power normalization so that a full scale sine reads the same with every window
+
+    float* real_input = nullptr;
+
+    fftwf_complex* complex_output = nullptr;
+
+    fftwf_plan plan = nullptr;
+
+    std::vector<float> window, power, accumulated, result;
+
+    // Averaging state. It depends on the stream rate and is reset by the analysis thread.
+
+    float decay = 0.0F;
+
+    uint welch_frames = 1U, n_averaged = 0U;
+  };
 
-  std::array<float, n_bands> real_input;
-  std::array<double, n_bands / 2U + 1U> output;
+  /*
+    Maps a display point to the fft bins. Where the bins are wider than the distance between display points the
+    power is interpolated between first_bin and first_bin + 1 using weight. Otherwise the peak in
+    [first_bin, last_bin] is taken so that tones do not get averaged away at high frequencies.
+  */
+
+  struct DisplayBand {
+    uint first_bin = 0U;
+    uint last_bin = 0U;
+    float weight = 0.0F;
+    bool interpolate = true;
+  };
 
   std::vector<float> left_delayed_vector;
   std::vector<float> right_delayed_vector;
   std::span<float> left_delayed;
   std::span<float> right_delayed;
 
-  std::array<float, n_bands> latest_samples_mono;
+  /*
+    The realtime thread appends the downmixed signal to this ring and then publishes the total number of samples
+    written. It never waits for the analysis thread. The analysis thread copies a frame out of the ring and checks
+    afterwards that it was not overwritten in the meantime, discarding it if it was.
+  */
 
-  std::array<float, n_bands> hann_window;
+  std::array<float, ring_size> ring;
+  std::atomic<uint64_t> ring_write_count = 0U;
+  static_assert(std::atomic<uint64_t>::is_always_lock_free);
 
-  enum {
-    DB_BIT_IDX = (1 << 0),      // To which db_buffers array process() should write.
-    DB_BIT_NEWDATA = (1 << 1),  // If new data has been written by process().
-    DB_BIT_BUSY = (1 << 2),     // If process() is currently writing data.
-  };
+  // Display layout requested by the settings and the stream rate. Read by the analysis thread.
+
+  std::atomic<uint> analysis_rate = 0U, display_n_points = 0U;
+  std::atomic<float> display_min_freq = 0.0F, display_max_freq = 0.0F;
+  std::atomic<bool> layout_dirty = true;
+
+  // Owned by the analysis thread. The main thread only swaps analyzer while holding analysis_mutex.
+
+  std::unique_ptr<Analyzer> analyzer;
+
+  bool analyzer_changed = true;
+
+  uint64_t next_frame_end = 0U;
+
+  std::vector<DisplayBand> display_bands;
+  std::vector<double> display_freqs, display_db;
+
+  // Published to the GUI under display_mutex.
+
+  std::mutex display_mutex;
+  std::vector<double> published_freqs, published_db;
+  uint published_layout_serial = 0U;
+  bool new_frame = false;
+
+  std::thread analysis_thread;
+  std::mutex analysis_mutex;
+  std::condition_variable analysis_cv;
+  bool analysis_quit = false;
+
+  void read_display_settings();
+
+  void create_analyzer();
+
+  void analysis_loop();
+
+  auto analyze_frame(const uint64_t& frame_end) -> bool;
+
+  void reset_averaging();
+
+  void build_display_layout();
 
-  std::array<std::array<float, n_bands>, 2> db_buffers;
-  std::atomic<int> db_control = {0};
-  static_assert(std::atomic<int>::is_always_lock_free);
+  void reduce_to_display();
 };
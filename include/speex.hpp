@@ -66,4 +66,6 @@ class Speex : public PluginBase {
   SpeexPreprocessState *state_left = nullptr, *state_right = nullptr;
 
   void free_speex();
+
+  void apply_setup();
 };
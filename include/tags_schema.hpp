@@ -179,6 +179,12 @@ inline constexpr auto output_path = "/com/github/wwmm/easyeffects/streamoutputs/
 
 }  // namespace tags::schema::filter
 
+namespace tags::schema::fused_chain {
+
+inline constexpr auto id = "com.github.wwmm.easyeffects.fusedchain";
+
+}  // namespace tags::schema::fused_chain
+
 namespace tags::schema::gate {
 
 inline constexpr auto id = "com.github.wwmm.easyeffects.gate";
@@ -0,0 +1,86 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/*
+  Records spans of the startup and of preset loads in the Chrome trace event format. The file can be opened in
+  Perfetto or in chrome://tracing to see which phase dominates on a given machine and how the plugin construction
+  overlaps between the loader workers.
+
+  Recording is enabled by the --trace-startup option or by the EASYEFFECTS_TRACE environment variable. Both take the
+  path of the output file. Spans are appended to it once the startup is done, whenever a few thousand of them are
+  pending and when the application shuts down. When recording is disabled a span costs one atomic load. Spans are not
+  meant for the realtime thread.
+*/
+
+namespace tracer {
+
+void enable(const std::string& output_file);
+
+auto is_enabled() -> bool;
+
+// Appends the spans recorded so far to the output file
+
+void flush();
+
+// Flushes and terminates the output file. Spans recorded afterwards are dropped
+
+void write();
+
+class Span {
+ public:
+  explicit Span(const char* name);
+
+  // A name that has to be built is given as a function returning it. The function is only called while recording.
+
+  template <typename F>
+    requires std::is_invocable_r_v<std::string, F>
+  explicit Span(F&& make_name) : active(is_enabled()) {
+    if (active) {
+      name = std::forward<F>(make_name)();
+
+      start = std::chrono::steady_clock::now();
+    }
+  }
+
+  Span(const Span&) = delete;
+  auto operator=(const Span&) -> Span& = delete;
+  Span(const Span&&) = delete;
+  auto operator=(const Span&&) -> Span& = delete;
+  ~Span();
+
+  // Ends the span before the end of its scope
+
+  void end();
+
+ private:
+  bool active = false;
+
+  std::string name;
+
+  std::chrono::steady_clock::time_point start;
+};
+
+}  // namespace tracer
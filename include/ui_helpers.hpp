@@ -37,15 +37,20 @@
 #include <gtk/gtkswitch.h>
 #include <gtk/gtktogglebutton.h>
 #include <sys/types.h>
+#include <functional>
 #include <locale>
+#include <memory>
 #define FMT_HEADER_ONLY
 #include <fmt/core.h>
 #include <fmt/format.h>
 #include <glib/gi18n.h>
 #include <string>
+#include "meter_board.hpp"
 #include "string_literal_wrapper.hpp"
 #include "util.hpp"
 
+class PluginBase;
+
 namespace ui {
 
 void show_fixed_toast(AdwToastOverlay* toast_overlay,
@@ -84,6 +89,29 @@ void update_level(GtkLevelBar* w_left,
                   const float& left,
                   const float& right);
 
+/*
+  Calls update once per frame with the meter board slot of the plugin, but only while the widget is mapped and the
+  plugin has published new values since the last call. The plugin is kept alive until the widget is destroyed or the
+  returned callback id is removed. The id is 0 when the plugin has no slot.
+*/
+
+auto add_meter_tick_callback(GtkWidget* widget,
+                             std::shared_ptr<PluginBase> plugin,
+                             std::function<void(const MeterBoard::Slot&)> update) -> guint;
+
+// Input and output level meters shown by every plugin box. The output widgets may be nullptr.
+
+void bind_level_meters(GtkWidget* widget,
+                       std::shared_ptr<PluginBase> plugin,
+                       GtkLevelBar* input_left,
+                       GtkLabel* input_left_label,
+                       GtkLevelBar* input_right,
+                       GtkLabel* input_right_label,
+                       GtkLevelBar* output_left = nullptr,
+                       GtkLabel* output_left_label = nullptr,
+                       GtkLevelBar* output_right = nullptr,
+                       GtkLabel* output_right_label = nullptr);
+
 void append_to_string_list(GtkStringList* string_list, const std::string& name);
 
 void remove_from_string_list(GtkStringList* string_list, const std::string& name);
@@ -26,6 +26,7 @@
 #include <gtk/gtk.h>
 #include <spa/param/param.h>
 #include <spa/utils/defs.h>
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <cstring>
@@ -33,8 +34,11 @@
 #include <ostream>
 #include <string>
 #include <thread>
+#include <vector>
 #include "application_ui.hpp"
+#include "channel_layout.hpp"
 #include "config.h"
+#include "effects_base.hpp"
 #include "pipe_manager.hpp"
 #include "pipe_objects.hpp"
 #include "preferences_window.hpp"
@@ -46,6 +50,7 @@
 #include "tags_pipewire.hpp"
 #include "tags_resources.hpp"
 #include "tags_schema.hpp"
+#include "tracer.hpp"
 #include "util.hpp"
 
 namespace app {
@@ -77,9 +82,62 @@ void update_bypass_state(Application* self) {
   util::info(((state) != 0 ? "enabling" : "disabling") + " global bypass"s);
 }
 
+void update_snapshots(Application* self, const PresetType& preset_type) {
+  EffectsBase* effects = (preset_type == PresetType::input) ? static_cast<EffectsBase*>(self->sie) : self->soe;
+
+  GSettings* settings = (preset_type == PresetType::input) ? self->sie_settings : self->soe_settings;
+
+  auto names = util::gchar_array_to_vector(g_settings_get_strv(settings, "snapshot-presets"));
+
+  if (names.size() > EffectsBase::max_snapshots) {
+    util::warning("only the first " + util::to_string(EffectsBase::max_snapshots) + " snapshot presets are preloaded");
+
+    names.resize(EffectsBase::max_snapshots);
+  }
+
+  const auto prepared = effects->get_snapshots();
+
+  for (const auto& name : prepared) {
+    if (std::ranges::find(names, name) == names.end()) {
+      effects->remove_snapshot(name);
+    }
+  }
+
+  for (const auto& name : names) {
+    if (std::ranges::find(prepared, name) != prepared.end()) {
+      continue;
+    }
+
+    std::vector<std::string> plugins;
+    std::vector<std::string> blocklist;
+
+    if (self->presets_manager->write_snapshot(preset_type, name, effects->get_free_snapshot_id(), plugins, blocklist)) {
+      effects->preload_snapshot(name, plugins, blocklist);
+    }
+  }
+}
+
+auto activate_snapshot(Application* self, const std::string& name) -> bool {
+  for (const auto preset_type : {PresetType::input, PresetType::output}) {
+    EffectsBase* effects = (preset_type == PresetType::input) ? static_cast<EffectsBase*>(self->sie) : self->soe;
+
+    if (effects->activate_snapshot(name)) {
+      self->presets_manager->set_last_preset_keys(preset_type, name);
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
 void on_startup(GApplication* gapp) {
   G_APPLICATION_CLASS(application_parent_class)->startup(gapp);
 
+  if (const auto* trace_file = std::getenv("EASYEFFECTS_TRACE"); trace_file != nullptr && !tracer::is_enabled()) {
+    tracer::enable(trace_file);
+  }
+
   auto* self = EE_APP(gapp);
 
   self->data = new Data();
@@ -87,14 +145,18 @@ void on_startup(GApplication* gapp) {
   self->sie_settings = g_settings_new(tags::schema::id_input);
   self->soe_settings = g_settings_new(tags::schema::id_output);
 
-  self->pm = new PipeManager();
-  self->soe = new StreamOutputEffects(self->pm);
-  self->sie = new StreamInputEffects(self->pm);
-
   if (self->settings == nullptr) {
     self->settings = g_settings_new(tags::app::id);
   }
 
+  // The layout is read only here. Changing it takes effect the next time the service starts.
+
+  const auto layout = static_cast<channel_layout::Layout>(g_settings_get_enum(self->settings, "channel-layout"));
+
+  self->pm = new PipeManager(channel_layout::get_positions(layout));
+  self->soe = new StreamOutputEffects(self->pm);
+  self->sie = new StreamInputEffects(self->pm);
+
   if (self->presets_manager == nullptr) {
     self->presets_manager = new PresetsManager();
   }
@@ -224,8 +286,43 @@ void on_startup(GApplication* gapp) {
                        }),
                        self));
 
+  self->data->gconnections_soe.push_back(
+      g_signal_connect(self->soe_settings, "changed::snapshot-presets",
+                       G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                         update_snapshots(static_cast<Application*>(user_data), PresetType::output);
+                       }),
+                       self));
+
+  self->data->gconnections_sie.push_back(
+      g_signal_connect(self->sie_settings, "changed::snapshot-presets",
+                       G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                         update_snapshots(static_cast<Application*>(user_data), PresetType::input);
+                       }),
+                       self));
+
   update_bypass_state(self);
 
+  update_snapshots(self, PresetType::output);
+  update_snapshots(self, PresetType::input);
+
+  /*
+    The startup spans are written as soon as the plugins built in the background are ready instead of waiting for the
+    shutdown. Later batches of loads, like the preset ones, are flushed the same way.
+  */
+
+  if (tracer::is_enabled()) {
+    const auto flush_trace = [=](const std::string& name) {
+      if (!self->sie->has_loading_plugins() && !self->soe->has_loading_plugins()) {
+        tracer::flush();
+      }
+    };
+
+    self->data->connections.push_back(self->sie->plugin_loaded.connect(flush_trace));
+    self->data->connections.push_back(self->soe->plugin_loaded.connect(flush_trace));
+
+    flush_trace("");
+  }
+
   if ((g_application_get_flags(gapp) & G_APPLICATION_IS_SERVICE) != 0) {
     g_application_hold(gapp);
   }
@@ -260,6 +357,10 @@ void application_class_init(ApplicationClass* klass) {
 
     auto* self = EE_APP(gapp);
 
+    if (const char* trace_file = nullptr; g_variant_dict_lookup(options, "trace-startup", "^&ay", &trace_file) != 0) {
+      tracer::enable(trace_file);
+    }
+
     if (self->settings == nullptr) {
       self->settings = g_settings_new(tags::app::id);
     }
@@ -369,6 +470,32 @@ void application_class_init(ApplicationClass* klass) {
       }
     }
 
+    if (g_variant_dict_contains(options, "snapshot") != 0) {
+      const char* name = nullptr;
+
+      if (g_variant_dict_lookup(options, "snapshot", "&s", &name) != 0) {
+        if (activate_snapshot(self, name)) {
+          return EXIT_SUCCESS;
+        }
+
+        // Not preloaded or still loading. The preset is loaded the usual way.
+
+        util::warning("the snapshot " + std::string(name) + " is not ready. Loading it as a regular preset");
+
+        if (self->presets_manager->preset_file_exists(PresetType::input, name)) {
+          self->presets_manager->load_local_preset_file(PresetType::input, name);
+
+          return EXIT_SUCCESS;
+        }
+
+        if (self->presets_manager->preset_file_exists(PresetType::output, name)) {
+          self->presets_manager->load_local_preset_file(PresetType::output, name);
+
+          return EXIT_SUCCESS;
+        }
+      }
+    }
+
     if (g_variant_dict_contains(options, "reset") != 0) {
       util::reset_all_keys_except(self->settings);
 
@@ -458,6 +585,8 @@ void application_class_init(ApplicationClass* klass) {
     self->soe = nullptr;
     self->pm = nullptr;
 
+    tracer::write();
+
     util::debug("Shutting down...");
   };
 }
@@ -631,6 +760,16 @@ auto application_new() -> GApplication* {
                                   "value. Example: easyeffects -s input"),
                                 nullptr);
 
+  g_application_add_main_option(G_APPLICATION(app), "snapshot", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING,
+                                _("Switch to a preset preloaded through the snapshot-presets setting. Other presets "
+                                  "are loaded as usual. Example: easyeffects --snapshot music"),
+                                nullptr);
+
+  g_application_add_main_option(G_APPLICATION(app), "trace-startup", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME,
+                                _("Record the startup and the preset loads and write them to a trace file. "
+                                  "Example: easyeffects --trace-startup trace.json"),
+                                _("FILE"));
+
   return G_APPLICATION(app);
 }
 
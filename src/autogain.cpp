@@ -18,17 +18,18 @@
  */
 
 #include "autogain.hpp"
-#include <ebur128.h>
 #include <gio/gio.h>
 #include <glib-object.h>
 #include <glib.h>
 #include <sys/types.h>
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <mutex>
 #include <span>
 #include <string>
+#include "loudness_analyzer.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 #include "tags_plugin_name.hpp"
@@ -48,6 +49,8 @@ AutoGain::AutoGain(const std::string& tag,
                  pipe_type),
       target(g_settings_get_double(settings, "target")),
       silence_threshold(g_settings_get_double(settings, "silence-threshold")) {
+  channel_policy = ChannelPolicy::linked;
+
   reference = parse_reference_key(util::gsettings_get_string(settings, "reference"));
 
   gconnections.push_back(g_signal_connect(settings, "changed::target",
@@ -72,7 +75,8 @@ AutoGain::AutoGain(const std::string& tag,
 
                                             std::scoped_lock<std::mutex> lock(self->data_mutex);
 
-                                            self->set_maximum_history(g_settings_get_int(settings, key));
+                                            self->loudness_analyzer.set_max_history(
+                                                static_cast<uint>(g_settings_get_int(settings, key)));
                                           }),
                                           this));
 
@@ -106,6 +110,17 @@ AutoGain::AutoGain(const std::string& tag,
       }),
       this));
 
+  loudness_analyzer.set_update_rate(static_cast<uint>(g_settings_get_int(global_settings, "loudness-update-rate")));
+
+  gconnections_global.push_back(g_signal_connect(global_settings, "changed::loudness-update-rate",
+                                                 G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                                   auto* self = static_cast<AutoGain*>(user_data);
+
+                                                   self->loudness_analyzer.set_update_rate(
+                                                       static_cast<uint>(g_settings_get_int(settings, key)));
+                                                 }),
+                                                 this));
+
   setup_input_output_gain();
 }
 
@@ -120,12 +135,6 @@ AutoGain::~AutoGain() {
 
   mythreads.clear();
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
-
-  if (ebur_state != nullptr) {
-    ebur128_destroy(&ebur_state);
-  }
-
   util::debug(log_tag + name + " destroyed");
 }
 
@@ -136,20 +145,15 @@ auto AutoGain::init_ebur128() -> bool {
 
   internal_output_gain = 1.0;
 
-  if (ebur_state != nullptr) {
-    ebur128_destroy(&ebur_state);
-
-    ebur_state = nullptr;
-  }
-
-  ebur_state = ebur128_init(2U, rate, EBUR128_MODE_S | EBUR128_MODE_I | EBUR128_MODE_LRA | EBUR128_MODE_SAMPLE_PEAK);
-
-  ebur128_set_channel(ebur_state, 0U, EBUR128_LEFT);
-  ebur128_set_channel(ebur_state, 1U, EBUR128_RIGHT);
+  /*
+    The integrated loudness must follow the maximum-history window, which the histogram mode of libebur128 ignores.
+    So we keep the block mode here and rely on the analyzer only querying it at its update rate.
+  */
 
-  set_maximum_history(g_settings_get_int(settings, "maximum-history"));
+  const auto max_history = static_cast<uint>(g_settings_get_int(settings, "maximum-history"));
 
-  return ebur_state != nullptr;
+  return loudness_analyzer.init(
+      rate, {.sample_peak = true, .max_history_seconds = max_history, .positions = channel_positions});
 }
 
 auto AutoGain::parse_reference_key(const std::string& key) -> Reference {
@@ -180,28 +184,14 @@ auto AutoGain::parse_reference_key(const std::string& key) -> Reference {
   return Reference::geometric_mean_msi;
 }
 
-void AutoGain::set_maximum_history(const int& seconds) {
-  if (ebur_state == nullptr) {
-    return;
-  }
-
-  // The value given to ebur128_set_max_history must be in milliseconds
-
-  ebur128_set_max_history(ebur_state, static_cast<ulong>(seconds) * 1000UL);
-}
-
 void AutoGain::setup() {
-  if (2U * static_cast<size_t>(n_samples) != data.size()) {
-    data.resize(static_cast<size_t>(n_samples) * 2U);
-  }
+  setup_pending = true;
+}
 
+void AutoGain::apply_setup() {
   if (rate != old_rate) {
-    data_mutex.lock();
-
     ebur128_ready = false;
 
-    data_mutex.unlock();
-
     mythreads.emplace_back([this]() {  // Using emplace_back here makes sense
       if (ebur128_ready) {
         return;
@@ -222,43 +212,14 @@ void AutoGain::setup() {
   }
 }
 
-void AutoGain::process(std::span<float>& left_in,
-                       std::span<float>& right_in,
-                       std::span<float>& left_out,
-                       std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
-
-  if (bypass || !ebur128_ready) {
-    std::copy(left_in.begin(), left_in.end(), left_out.begin());
-    std::copy(right_in.begin(), right_in.end(), right_out.begin());
-
-    return;
-  }
-
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
-
-  for (size_t n = 0U; n < n_samples; n++) {
-    data[2U * n] = left_in[n];
-    data[2U * n + 1U] = right_in[n];
-  }
-
-  ebur128_add_frames_float(ebur_state, data.data(), n_samples);
-
-  auto failed = false;
+void AutoGain::update_gain() {
+  const auto& metrics = loudness_analyzer.get_metrics();
 
-  if (EBUR128_SUCCESS != ebur128_loudness_momentary(ebur_state, &momentary)) {
-    failed = true;
-  }
-
-  if (EBUR128_SUCCESS != ebur128_loudness_shortterm(ebur_state, &shortterm)) {
-    failed = true;
-  }
-
-  if (EBUR128_SUCCESS != ebur128_loudness_global(ebur_state, &global)) {
-    failed = true;
-  }
+  momentary = metrics.momentary;
+  shortterm = metrics.shortterm;
+  global = metrics.global;
+  relative = metrics.relative;
+  range = metrics.range;
 
   if (std::isinf(momentary) || std::isnan(momentary)) {
     /*
@@ -289,110 +250,159 @@ void AutoGain::process(std::span<float>& left_in,
     global = momentary;
   }
 
-  if (EBUR128_SUCCESS != ebur128_relative_threshold(ebur_state, &relative)) {
-    failed = true;
-  }
+  if (momentary > silence_threshold && metrics.valid) {
+    // Sample peaks since the previous update
+    const auto peak_L = metrics.sample_peak_left;
+    const auto peak_R = metrics.sample_peak_right;
 
-  if (EBUR128_SUCCESS != ebur128_loudness_range(ebur_state, &range)) {
-    failed = true;
-  }
+    switch (reference) {
+      case Reference::momentary: {
+        loudness = momentary;
 
-  if (momentary > silence_threshold && !failed) {
-    double peak_L = 0.0;
-    double peak_R = 0.0;
+        break;
+      }
+      case Reference::shortterm: {
+        loudness = shortterm;
 
-    if (EBUR128_SUCCESS != ebur128_prev_sample_peak(ebur_state, 0U, &peak_L)) {
-      failed = true;
-    }
+        break;
+      }
+      case Reference::integrated: {
+        loudness = global;
 
-    if (EBUR128_SUCCESS != ebur128_prev_sample_peak(ebur_state, 1U, &peak_R)) {
-      failed = true;
-    }
+        break;
+      }
+      case Reference::geometric_mean_msi: {
+        loudness = std::cbrt(momentary * shortterm * global);
 
-    if (!failed) {
-      switch (reference) {
-        case Reference::momentary: {
-          loudness = momentary;
+        break;
+      }
+      case Reference::geometric_mean_ms: {
+        loudness = std::sqrt(std::fabs(momentary * shortterm));
 
-          break;
+        if (momentary < 0 && shortterm < 0) {
+          loudness *= -1;
         }
-        case Reference::shortterm: {
-          loudness = shortterm;
 
-          break;
-        }
-        case Reference::integrated: {
-          loudness = global;
+        break;
+      }
+      case Reference::geometric_mean_mi: {
+        loudness = std::sqrt(std::fabs(momentary * global));
 
-          break;
+        if (momentary < 0 && global < 0) {
+          loudness *= -1;
         }
-        case Reference::geometric_mean_msi: {
-          loudness = std::cbrt(momentary * shortterm * global);
 
-          break;
+        break;
+      }
+      case Reference::geometric_mean_si: {
+        loudness = std::sqrt(std::fabs(shortterm * global));
+
+        if (shortterm < 0 && global < 0) {
+          loudness *= -1;
         }
-        case Reference::geometric_mean_ms: {
-          loudness = std::sqrt(std::fabs(momentary * shortterm));
 
-          if (momentary < 0 && shortterm < 0) {
-            loudness *= -1;
-          }
+        break;
+      }
+    }
 
-          break;
-        }
-        case Reference::geometric_mean_mi: {
-          loudness = std::sqrt(std::fabs(momentary * global));
+    const double diff = target - loudness;
 
-          if (momentary < 0 && global < 0) {
-            loudness *= -1;
-          }
+    // 10^(diff/20). The way below should be faster than using pow
+    const double gain = std::exp((diff / 20.0) * std::log(10.0));
 
-          break;
-        }
-        case Reference::geometric_mean_si: {
-          loudness = std::sqrt(std::fabs(shortterm * global));
+    const double peak = (peak_L > peak_R) ? peak_L : peak_R;
 
-          if (shortterm < 0 && global < 0) {
-            loudness *= -1;
-          }
+    const auto db_peak = util::linear_to_db(peak);
 
-          break;
-        }
+    if (db_peak > util::minimum_db_level) {
+      if (gain * peak < 1.0) {
+        internal_output_gain = gain;
       }
+    }
+  }
+}
 
-      const double diff = target - loudness;
+void AutoGain::process(std::span<float>& left_in,
+                       std::span<float>& right_in,
+                       std::span<float>& left_out,
+                       std::span<float>& right_out) {
+  std::array<std::span<float>, 2U> inputs = {left_in, right_in};
+  std::array<std::span<float>, 2U> outputs = {left_out, right_out};
 
-      // 10^(diff/20). The way below should be faster than using pow
-      const double gain = std::exp((diff / 20.0) * std::log(10.0));
+  process(inputs, outputs);
+}
 
-      const double peak = (peak_L > peak_R) ? peak_L : peak_R;
+void AutoGain::process(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs) {
+  const auto lock = lock_for_rt();
 
-      const auto db_peak = util::linear_to_db(peak);
+  if (lock.owns_lock() && setup_pending) {
+    apply_setup();
 
-      if (db_peak > util::minimum_db_level) {
-        if (gain * peak < 1.0) {
-          internal_output_gain = gain;
-        }
-      }
+    setup_pending = false;
+  }
+
+  if (!lock.owns_lock() || bypass || !ebur128_ready) {
+    for (size_t c = 0U; c < inputs.size(); c++) {
+      std::ranges::copy(inputs[c], outputs[c].begin());
     }
+
+    // Without the lock the gain of the last processed quantum is kept. Falling back to unity would be a jump.
+
+    if (!lock.owns_lock() && !bypass && ebur128_ready) {
+      apply_gain(outputs, input_gain * applied_output_gain * output_gain);
+    }
+
+    return;
   }
 
-  std::copy(left_in.begin(), left_in.end(), left_out.begin());
-  std::copy(right_in.begin(), right_in.end(), right_out.begin());
+  if (input_gain != 1.0F) {
+    apply_gain(inputs, input_gain);
+  }
 
-  if (internal_output_gain != 1.0F) {
-    apply_gain(left_out, right_out, static_cast<float>(internal_output_gain));
+  if (loudness_analyzer.process(inputs)) {
+    update_gain();
+  }
+
+  for (size_t c = 0U; c < inputs.size(); c++) {
+    std::ranges::copy(inputs[c], outputs[c].begin());
+  }
+
+  /*
+    The gain only changes when the loudness is updated. Ramping to the new value across the quantum avoids a step
+    at every update.
+  */
+
+  if (const auto gain = static_cast<float>(internal_output_gain); gain != applied_output_gain) {
+    const auto step = (gain - applied_output_gain) / static_cast<float>(outputs[0].size());
+
+    for (auto& channel : outputs) {
+      for (size_t n = 0U; n < channel.size(); n++) {
+        channel[n] *= applied_output_gain + step * static_cast<float>(n + 1U);
+      }
+    }
+
+    applied_output_gain = gain;
+  } else if (gain != 1.0F) {
+    apply_gain(outputs, gain);
   }
 
   if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
+    apply_gain(outputs, output_gain);
   }
 
   if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
+    get_peaks(inputs, outputs);
 
     if (send_notifications) {
-      results.emit(loudness, internal_output_gain, momentary, shortterm, global, relative, range);
+      if (meter_slot != nullptr) {
+        meter_slot->set_extra(loudness_meter, static_cast<float>(loudness));
+        meter_slot->set_extra(gain_meter, static_cast<float>(internal_output_gain));
+        meter_slot->set_extra(momentary_meter, static_cast<float>(momentary));
+        meter_slot->set_extra(shortterm_meter, static_cast<float>(shortterm));
+        meter_slot->set_extra(integrated_meter, static_cast<float>(global));
+        meter_slot->set_extra(relative_meter, static_cast<float>(relative));
+        meter_slot->set_extra(range_meter, static_cast<float>(range));
+      }
 
       notify();
     }
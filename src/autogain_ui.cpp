@@ -33,6 +33,7 @@
 #include <string>
 #include <vector>
 #include "autogain.hpp"
+#include "meter_board.hpp"
 #include "tags_resources.hpp"
 #include "tags_schema.hpp"
 #include "ui_helpers.hpp"
@@ -107,80 +108,49 @@ void setup(AutogainBox* self, std::shared_ptr<AutoGain> autogain, const std::str
 
   autogain->set_post_messages(true);
 
-  self->data->connections.push_back(autogain->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(autogain->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(autogain->results.connect([=](const double loudness, const double gain,
-                                                                  const double momentary, const double shortterm,
-                                                                  const double integrated, const double relative,
-                                                                  const double range) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LEVEL_BAR(self->l_level) || !GTK_IS_LABEL(self->l_label) || !GTK_IS_LEVEL_BAR(self->g_level) ||
-              !GTK_IS_LABEL(self->g_label) || !GTK_IS_LEVEL_BAR(self->m_level) || !GTK_IS_LABEL(self->m_label) ||
-              !GTK_IS_LEVEL_BAR(self->s_level) || !GTK_IS_LABEL(self->s_label) || !GTK_IS_LEVEL_BAR(self->i_level) ||
-              !GTK_IS_LABEL(self->i_label) || !GTK_IS_LEVEL_BAR(self->r_level) || !GTK_IS_LABEL(self->r_label) ||
-              !GTK_IS_LEVEL_BAR(self->lra_level) || !GTK_IS_LABEL(self->lra_label)) {
-            return;
-          }
-
-          gtk_level_bar_set_value(self->l_level, util::db_to_linear(loudness));
-          gtk_label_set_text(self->l_label, fmt::format("{0:.0f} LUFS", loudness).c_str());
-
-          gtk_level_bar_set_value(self->g_level, gain);
-          gtk_label_set_text(self->g_label,
-                             fmt::format(ui::get_user_locale(), "{0:.2Lf} dB", util::linear_to_db(gain)).c_str());
-
-          gtk_level_bar_set_value(self->m_level, util::db_to_linear(momentary));
-          gtk_label_set_text(self->m_label, fmt::format("{0:.0f} LUFS", momentary).c_str());
-
-          gtk_level_bar_set_value(self->s_level, util::db_to_linear(shortterm));
-          gtk_label_set_text(self->s_label, fmt::format("{0:.0f} LUFS", shortterm).c_str());
-
-          gtk_level_bar_set_value(self->i_level, util::db_to_linear(integrated));
-          gtk_label_set_text(self->i_label, fmt::format("{0:.0f} LUFS", integrated).c_str());
-
-          gtk_level_bar_set_value(self->r_level, util::db_to_linear(relative));
-          gtk_label_set_text(self->r_label, fmt::format("{0:.0f} LUFS", relative).c_str());
-
-          gtk_level_bar_set_value(self->lra_level, util::db_to_linear(range));
-          gtk_label_set_text(self->lra_label, fmt::format("{0:.0f} LU", range).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+  ui::bind_level_meters(GTK_WIDGET(self), autogain, self->input_level_left, self->input_level_left_label,
+                        self->input_level_right, self->input_level_right_label, self->output_level_left,
+                        self->output_level_left_label, self->output_level_right, self->output_level_right_label);
+
+  ui::add_meter_tick_callback(GTK_WIDGET(self), autogain, [=](const MeterBoard::Slot& slot) {
+    if (!GTK_IS_LEVEL_BAR(self->l_level) || !GTK_IS_LABEL(self->l_label) || !GTK_IS_LEVEL_BAR(self->g_level) ||
+        !GTK_IS_LABEL(self->g_label) || !GTK_IS_LEVEL_BAR(self->m_level) || !GTK_IS_LABEL(self->m_label) ||
+        !GTK_IS_LEVEL_BAR(self->s_level) || !GTK_IS_LABEL(self->s_label) || !GTK_IS_LEVEL_BAR(self->i_level) ||
+        !GTK_IS_LABEL(self->i_label) || !GTK_IS_LEVEL_BAR(self->r_level) || !GTK_IS_LABEL(self->r_label) ||
+        !GTK_IS_LEVEL_BAR(self->lra_level) || !GTK_IS_LABEL(self->lra_label)) {
+      return;
+    }
+
+    const auto loudness = slot.get_extra(AutoGain::loudness_meter);
+    const auto gain = slot.get_extra(AutoGain::gain_meter);
+    const auto momentary = slot.get_extra(AutoGain::momentary_meter);
+    const auto shortterm = slot.get_extra(AutoGain::shortterm_meter);
+    const auto integrated = slot.get_extra(AutoGain::integrated_meter);
+    const auto relative = slot.get_extra(AutoGain::relative_meter);
+    const auto range = slot.get_extra(AutoGain::range_meter);
+
+    gtk_level_bar_set_value(self->l_level, util::db_to_linear(loudness));
+    gtk_label_set_text(self->l_label, fmt::format("{0:.0f} LUFS", loudness).c_str());
+
+    gtk_level_bar_set_value(self->g_level, gain);
+    gtk_label_set_text(self->g_label,
+                       fmt::format(ui::get_user_locale(), "{0:.2Lf} dB", util::linear_to_db(gain)).c_str());
+
+    gtk_level_bar_set_value(self->m_level, util::db_to_linear(momentary));
+    gtk_label_set_text(self->m_label, fmt::format("{0:.0f} LUFS", momentary).c_str());
+
+    gtk_level_bar_set_value(self->s_level, util::db_to_linear(shortterm));
+    gtk_label_set_text(self->s_label, fmt::format("{0:.0f} LUFS", shortterm).c_str());
+
+    gtk_level_bar_set_value(self->i_level, util::db_to_linear(integrated));
+    gtk_label_set_text(self->i_label, fmt::format("{0:.0f} LUFS", integrated).c_str());
+
+    gtk_level_bar_set_value(self->r_level, util::db_to_linear(relative));
+    gtk_label_set_text(self->r_label, fmt::format("{0:.0f} LUFS", relative).c_str());
+
+    gtk_level_bar_set_value(self->lra_level, util::db_to_linear(range));
+    gtk_label_set_text(self->lra_label, fmt::format("{0:.0f} LU", range).c_str());
+  });
 
   gtk_label_set_text(self->plugin_credit, ui::get_plugin_credit_translated(self->data->autogain->package).c_str());
 
@@ -119,7 +119,9 @@ void BassEnhancer::process(std::span<float>& left_in,
         return;
       }
 
-      harmonics.emit(harmonics_port_value);
+      if (meter_slot != nullptr) {
+        meter_slot->set_extra(harmonics_meter, static_cast<float>(harmonics_port_value));
+      }
 
       notify();
     }
@@ -0,0 +1,367 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+#include <glib.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <nlohmann/json.hpp>
+#include <numbers>
+#include <ostream>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+#include "config.h"
+#include "effects_base.hpp"
+#include "pipeline_type.hpp"
+#include "plugin_base.hpp"
+#include "tags_plugin_name.hpp"
+#include "tags_schema.hpp"
+#include "util.hpp"
+
+/*
+  Microbenchmarks for the realtime path of every plugin. Each plugin is created without a PipeManager and its
+  process() is called directly with a synthetic signal (white noise plus a 1 kHz sine) for all combinations of the
+  common sampling rates and quanta. For each one we report the average cost per sample, the worst cycle and how many
+  C++ allocations happened inside process(). The results can be written as json to track regressions.
+
+  Only the operator new calls are counted. Allocations done by C libraries through malloc are not visible here.
+*/
+
+namespace {
+
+std::atomic<bool> count_allocations = {false};
+
+std::atomic<uint64_t> n_allocations = {0U};
+
+constexpr auto rates = std::to_array<uint>({44100U, 48000U, 96000U});
+
+constexpr auto quanta = std::to_array<uint>({32U, 64U, 128U, 256U, 512U, 1024U, 2048U});
+
+constexpr uint max_warmup_cycles = 64U;
+
+constexpr uint min_cycles = 16U;
+
+struct Result {
+  std::string plugin;
+
+  bool installed;
+
+  uint rate;
+
+  uint quantum;
+
+  uint64_t cycles;
+
+  double ns_per_sample;
+
+  double worst_cycle_ns;
+
+  double allocations_per_cycle;
+
+  double worst_load;  // worst cycle divided by the quantum duration
+};
+
+class BenchmarkEffects : public EffectsBase {
+ public:
+  BenchmarkEffects() : EffectsBase("benchmarks: ", tags::schema::id_output, nullptr, PipelineType::output) {}
+
+  auto create_plugin(const std::string& base_name) -> std::shared_ptr<PluginBase> {
+    const auto name = base_name + "#0";
+
+    const auto list = std::to_array<const gchar*>({name.c_str(), nullptr});
+
+    g_settings_set_strv(settings, "plugins", list.data());
+
+    create_filters_if_necessary();
+
+    return plugins[name];
+  }
+
+  void destroy_plugins() { plugins.clear(); }
+};
+
+auto dispatch_main_context() -> bool {
+  auto dispatched = false;
+
+  while (g_main_context_pending(nullptr) != 0) {
+    g_main_context_iteration(nullptr, 0);
+
+    dispatched = true;
+  }
+
+  return dispatched;
+}
+
+auto make_signal(const uint& rate) -> std::vector<float> {
+  // One second of white noise at -20 dBFS plus a 1 kHz sine at -12 dBFS. The seed is fixed so that runs are
+  // comparable.
+
+  std::mt19937 generator(1234U);
+
+  std::uniform_real_distribution<float> noise(-0.1F, 0.1F);
+
+  std::vector<float> signal(rate);
+
+  for (uint n = 0U; n < rate; n++) {
+    signal[n] = noise(generator) +
+                0.25F * std::sin(2.0F * std::numbers::pi_v<float> * 1000.0F * static_cast<float>(n) /
+                                 static_cast<float>(rate));
+  }
+
+  return signal;
+}
+
+auto run(PluginBase& plugin, const uint& rate, const uint& quantum, const double& seconds) -> Result {
+  const auto signal = make_signal(rate);
+
+  std::vector<float> buffer_left_in(quantum), buffer_right_in(quantum);
+  std::vector<float> buffer_left_out(quantum), buffer_right_out(quantum);
+  std::vector<float> buffer_probe_left(quantum), buffer_probe_right(quantum);
+
+  std::span<float> left_in(buffer_left_in);
+  std::span<float> right_in(buffer_right_in);
+  std::span<float> left_out(buffer_left_out);
+  std::span<float> right_out(buffer_right_out);
+  std::span<float> probe_left(buffer_probe_left);
+  std::span<float> probe_right(buffer_probe_right);
+
+  const auto run_cycle = [&]() {
+    plugin.prepare_process(rate, quantum);
+
+    if (!plugin.enable_probe) {
+      plugin.process(left_in, right_in, left_out, right_out);
+    } else {
+      plugin.process(left_in, right_in, left_out, right_out, probe_left, probe_right);
+    }
+
+    plugin.finish_process();
+  };
+
+  // Let the plugin finish the setup it posts to the main thread before timing anything
+
+  for (uint n = 0U; n < max_warmup_cycles; n++) {
+    std::ranges::fill(buffer_left_in, 0.0F);
+    std::ranges::fill(buffer_right_in, 0.0F);
+
+    run_cycle();
+
+    if (!dispatch_main_context() && n > 0U) {
+      break;
+    }
+  }
+
+  const auto n_cycles = std::max(
+      min_cycles, static_cast<uint>(std::ceil(seconds * static_cast<double>(rate) / static_cast<double>(quantum))));
+
+  double total_ns = 0.0;
+  double worst_ns = 0.0;
+  uint64_t allocations = 0U;
+  size_t offset = 0U;
+
+  for (uint c = 0U; c < n_cycles; c++) {
+    for (uint n = 0U; n < quantum; n++) {
+      buffer_left_in[n] = signal[offset];
+      buffer_right_in[n] = signal[signal.size() - 1U - offset];
+
+      offset = (offset + 1U) % signal.size();
+    }
+
+    n_allocations = 0U;
+    count_allocations = true;
+
+    const auto time_start = std::chrono::steady_clock::now();
+
+    run_cycle();
+
+    const auto time_end = std::chrono::steady_clock::now();
+
+    count_allocations = false;
+    allocations += n_allocations;
+
+    const auto ns = std::chrono::duration<double, std::nano>(time_end - time_start).count();
+
+    total_ns += ns;
+    worst_ns = std::max(worst_ns, ns);
+
+    // The notifications some plugins post must not pile up between cycles
+
+    dispatch_main_context();
+  }
+
+  const auto quantum_ns = 1.0e9 * static_cast<double>(quantum) / static_cast<double>(rate);
+
+  return {.plugin = plugin.name,
+          .installed = plugin.package_installed,
+          .rate = rate,
+          .quantum = quantum,
+          .cycles = n_cycles,
+          .ns_per_sample = total_ns / (static_cast<double>(n_cycles) * static_cast<double>(quantum)),
+          .worst_cycle_ns = worst_ns,
+          .allocations_per_cycle = static_cast<double>(allocations) / static_cast<double>(n_cycles),
+          .worst_load = worst_ns / quantum_ns};
+}
+
+void print(const Result& r) {
+  std::cout << std::left << std::setw(22) << r.plugin << std::right << std::setw(7) << r.rate << std::setw(6)
+            << r.quantum << std::fixed << std::setprecision(2) << std::setw(12) << r.ns_per_sample << std::setw(12)
+            << r.worst_cycle_ns / 1000.0 << std::setw(9) << 100.0 * r.worst_load << std::setw(10)
+            << r.allocations_per_cycle << (r.installed ? "" : "   (not installed)") << '\n';
+}
+
+auto to_json(const std::vector<Result>& results) -> nlohmann::json {
+  auto list = nlohmann::json::array();
+
+  for (const auto& r : results) {
+    list.push_back({{"plugin", r.plugin},
+                    {"installed", r.installed},
+                    {"rate", r.rate},
+                    {"quantum", r.quantum},
+                    {"cycles", r.cycles},
+                    {"ns-per-sample", r.ns_per_sample},
+                    {"worst-cycle-ns", r.worst_cycle_ns},
+                    {"worst-load", r.worst_load},
+                    {"allocations-per-cycle", r.allocations_per_cycle}});
+  }
+
+  return {{"version", VERSION}, {"results", list}};
+}
+
+}  // namespace
+
+auto operator new(std::size_t size) -> void* {
+  if (count_allocations.load(std::memory_order_relaxed)) {
+    n_allocations.fetch_add(1U, std::memory_order_relaxed);
+  }
+
+  if (auto* p = std::malloc(size == 0U ? 1U : size)) {
+    return p;
+  }
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t size) noexcept {
+  std::free(p);
+}
+
+auto main(int argc, char* argv[]) -> int {
+  // Nothing in the user database is changed. Every plugin starts from its default settings.
+
+  g_setenv("GSETTINGS_BACKEND", "memory", 1);
+
+  gchar** selected = nullptr;
+  gchar* json_path = nullptr;
+  gdouble seconds = 1.0;
+
+  auto entries = std::to_array<GOptionEntry>(
+      {{"plugin", 'p', G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING_ARRAY, &selected,
+        "Only benchmark this plugin. Can be used more than once", "NAME"},
+       {"seconds", 's', G_OPTION_FLAG_NONE, G_OPTION_ARG_DOUBLE, &seconds,
+        "Seconds of audio processed per rate and quantum. Default: 1", "S"},
+       {"json", 'j', G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME, &json_path, "Write the results to this json file",
+        "FILE"},
+       {}});
+
+  auto* context = g_option_context_new("- benchmark the plugins realtime processing");
+
+  g_option_context_add_main_entries(context, entries.data(), nullptr);
+
+  GError* error = nullptr;
+
+  if (g_option_context_parse(context, &argc, &argv, &error) == 0) {
+    std::cerr << error->message << '\n';
+
+    g_error_free(error);
+    g_option_context_free(context);
+
+    return EXIT_FAILURE;
+  }
+
+  g_option_context_free(context);
+
+  std::vector<std::string> names;
+
+  for (const auto& name : tags::plugin_name::list) {
+    if (selected == nullptr || g_strv_contains(selected, name) != 0) {
+      names.emplace_back(name);
+    }
+  }
+
+  g_strfreev(selected);
+
+  std::cout << std::left << std::setw(22) << "plugin" << std::right << std::setw(7) << "rate" << std::setw(6) << "q"
+            << std::setw(12) << "ns/sample" << std::setw(12) << "worst us" << std::setw(9) << "load %" << std::setw(10)
+            << "allocs" << '\n';
+
+  std::vector<Result> results;
+
+  {
+    BenchmarkEffects effects;
+
+    for (const auto& name : names) {
+      auto plugin = effects.create_plugin(name);
+
+      if (plugin == nullptr) {
+        continue;
+      }
+
+      for (const auto& rate : rates) {
+        for (const auto& quantum : quanta) {
+          results.push_back(run(*plugin, rate, quantum, seconds));
+
+          print(results.back());
+        }
+      }
+
+      plugin.reset();
+
+      effects.destroy_plugins();
+    }
+  }
+
+  if (json_path != nullptr) {
+    if (std::ofstream os(json_path); os.is_open()) {
+      os << std::setw(2) << to_json(results) << '\n';
+    } else {
+      std::cerr << "could not write " << json_path << '\n';
+    }
+
+    g_free(json_path);
+  }
+
+  return EXIT_SUCCESS;
+}
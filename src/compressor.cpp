@@ -208,10 +208,12 @@ void Compressor::process(std::span<float>& left_in,
       envelope_port_value =
           0.5F * (lv2_wrapper->get_control_port_value("elm_l") + lv2_wrapper->get_control_port_value("elm_r"));
 
-      reduction.emit(reduction_port_value);
-      sidechain.emit(sidechain_port_value);
-      curve.emit(curve_port_value);
-      envelope.emit(envelope_port_value);
+      if (meter_slot != nullptr) {
+        meter_slot->set_extra(reduction_meter, reduction_port_value);
+        meter_slot->set_extra(sidechain_meter, sidechain_port_value);
+        meter_slot->set_extra(curve_meter, curve_port_value);
+        meter_slot->set_extra(envelope_meter, envelope_port_value);
+      }
 
       notify();
     }
@@ -219,6 +221,10 @@ void Compressor::process(std::span<float>& left_in,
 }
 
 void Compressor::update_sidechain_links(const std::string& key) {
+  if (pm == nullptr) {
+    return;
+  }
+
   if (util::gsettings_get_string(settings, "sidechain-type") != "External") {
     pm->destroy_links(list_proxies);
 
@@ -0,0 +1,301 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "convolution_pool.hpp"
+#include <pthread.h>
+#include <sched.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "util.hpp"
+
+namespace {
+
+auto now_ns() -> int64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+ConvolutionPool::Client::Client(std::string name, std::function<void()> job)
+    : name(std::move(name)), job(std::move(job)) {}
+
+auto ConvolutionPool::Client::get_stats() const -> Stats {
+  Stats stats;
+
+  stats.submitted = submitted.load(std::memory_order_relaxed);
+  stats.completed = completed.load(std::memory_order_relaxed);
+  stats.late = late.load(std::memory_order_relaxed);
+  stats.dropped = dropped.load(std::memory_order_relaxed);
+  stats.max_run_time = max_run_time.load(std::memory_order_relaxed);
+  stats.max_lateness = max_lateness.load(std::memory_order_relaxed);
+
+  return stats;
+}
+
+ConvolutionPool::ConvolutionPool() {
+  for (size_t n = 0U; n < capacity; n++) {
+    cells[n].sequence.store(n, std::memory_order_relaxed);
+  }
+
+  n_cores = std::max(std::thread::hardware_concurrency(), 1U);
+
+  // One core is left to the PipeWire data loop
+
+  n_max_workers = std::clamp(n_cores - 1U, 1U, max_workers);
+}
+
+ConvolutionPool::~ConvolutionPool() {
+  quit.store(true, std::memory_order_release);
+
+  pending.release(static_cast<std::ptrdiff_t>(workers.size()));
+
+  for (auto& t : workers) {
+    t.join();
+  }
+}
+
+auto ConvolutionPool::get() -> ConvolutionPool& {
+  static ConvolutionPool pool;
+
+  return pool;
+}
+
+void ConvolutionPool::start_worker() {
+  const auto index = static_cast<uint>(workers.size());
+
+  workers.emplace_back([this] { worker_loop(); });
+
+  configure_worker(workers.back(), index, n_cores);
+
+  util::debug("convolution pool: started worker " + util::to_string(index));
+}
+
+void ConvolutionPool::configure_worker(std::thread& thread, const uint& index, const uint& n_cores) {
+  const auto handle = thread.native_handle();
+
+  // The first worker goes to the second core. The first one is usually where the data loop runs.
+
+  cpu_set_t cpuset;
+
+  CPU_ZERO(&cpuset);
+
+  CPU_SET((index + 1U) % n_cores, &cpuset);
+
+  if (pthread_setaffinity_np(handle, sizeof(cpu_set_t), &cpuset) != 0) {
+    util::debug("convolution pool: could not pin worker " + util::to_string(index));
+  }
+
+  /*
+    The lowest realtime priority keeps the workers ahead of the normal threads but behind the data loop, which is what
+    zita did with its own threads. Without the rights to use SCHED_FIFO they just keep the default policy.
+  */
+
+  sched_param param{};
+
+  param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+
+  if (pthread_setschedparam(handle, SCHED_FIFO, &param) != 0) {
+    util::debug("convolution pool: could not set SCHED_FIFO for worker " + util::to_string(index));
+  }
+}
+
+void ConvolutionPool::add(Client* client) {
+  std::scoped_lock<std::mutex> lock(clients_mutex);
+
+  if (clients.size() >= capacity) {
+    util::warning("convolution pool: too many clients, " + client->get_name() + " jobs may be dropped");
+  }
+
+  clients.push_back(client);
+
+  // A client has at most one job in flight, so more workers than clients would never have work
+
+  if (workers.size() < std::min(clients.size(), static_cast<size_t>(n_max_workers))) {
+    start_worker();
+  }
+}
+
+void ConvolutionPool::remove(Client* client) {
+  wait(*client);
+
+  {
+    std::scoped_lock<std::mutex> lock(clients_mutex);
+
+    std::erase(clients, client);
+  }
+
+  const auto stats = client->get_stats();
+
+  util::debug("convolution pool: " + client->get_name() + " submitted " + util::to_string(stats.submitted) +
+              ", late " + util::to_string(stats.late) + ", dropped " + util::to_string(stats.dropped) +
+              ", max run time " + util::to_string(stats.max_run_time) + " ms");
+}
+
+void ConvolutionPool::wait(const Client& client) {
+  client.busy.wait(true, std::memory_order_acquire);
+}
+
+auto ConvolutionPool::submit(Client& client, const std::chrono::nanoseconds& budget) -> bool {
+  if (client.busy.exchange(true, std::memory_order_acq_rel)) {
+    return false;
+  }
+
+  client.deadline.store(now_ns() + budget.count(), std::memory_order_relaxed);
+
+  client.submitted.fetch_add(1U, std::memory_order_relaxed);
+
+  if (!push(&client)) {
+    client.dropped.fetch_add(1U, std::memory_order_relaxed);
+
+    client.busy.store(false, std::memory_order_release);
+    client.busy.notify_all();
+
+    return false;
+  }
+
+  pending.release();
+
+  return true;
+}
+
+auto ConvolutionPool::get_n_workers() const -> uint {
+  return static_cast<uint>(workers.size());
+}
+
+auto ConvolutionPool::get_clients_stats() -> std::vector<std::pair<std::string, Stats>> {
+  std::scoped_lock<std::mutex> lock(clients_mutex);
+
+  std::vector<std::pair<std::string, Stats>> output;
+
+  output.reserve(clients.size());
+
+  for (const auto* c : clients) {
+    output.emplace_back(c->get_name(), c->get_stats());
+  }
+
+  return output;
+}
+
+auto ConvolutionPool::push(Client* client) -> bool {
+  auto position = enqueue_position.load(std::memory_order_relaxed);
+
+  while (true) {
+    auto& cell = cells[position % capacity];
+
+    const auto sequence = cell.sequence.load(std::memory_order_acquire);
+
+    const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+    if (diff == 0) {
+      if (enqueue_position.compare_exchange_weak(position, position + 1U, std::memory_order_relaxed)) {
+        cell.client = client;
+
+        cell.sequence.store(position + 1U, std::memory_order_release);
+
+        return true;
+      }
+    } else if (diff < 0) {
+      return false;  // full
+    } else {
+      position = enqueue_position.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+auto ConvolutionPool::pop() -> Client* {
+  auto position = dequeue_position.load(std::memory_order_relaxed);
+
+  while (true) {
+    auto& cell = cells[position % capacity];
+
+    const auto sequence = cell.sequence.load(std::memory_order_acquire);
+
+    const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1U);
+
+    if (diff == 0) {
+      if (dequeue_position.compare_exchange_weak(position, position + 1U, std::memory_order_relaxed)) {
+        auto* client = cell.client;
+
+        cell.sequence.store(position + capacity, std::memory_order_release);
+
+        return client;
+      }
+    } else if (diff < 0) {
+      return nullptr;  // empty
+    } else {
+      position = dequeue_position.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void ConvolutionPool::worker_loop() {
+  while (true) {
+    pending.acquire();
+
+    if (quit.load(std::memory_order_acquire)) {
+      return;
+    }
+
+    if (auto* client = pop(); client != nullptr) {
+      run(client);
+    }
+  }
+}
+
+void ConvolutionPool::run(Client* client) {
+  const auto start = now_ns();
+
+  client->job();
+
+  const auto end = now_ns();
+
+  const auto run_time = static_cast<float>(end - start) * 1.0e-6F;
+
+  // Only one job per client is in flight, so the maxima below are not written concurrently.
+
+  if (run_time > client->max_run_time.load(std::memory_order_relaxed)) {
+    client->max_run_time.store(run_time, std::memory_order_relaxed);
+  }
+
+  if (const auto lateness = end - client->deadline.load(std::memory_order_relaxed); lateness > 0) {
+    client->late.fetch_add(1U, std::memory_order_relaxed);
+
+    const auto lateness_ms = static_cast<float>(lateness) * 1.0e-6F;
+
+    if (lateness_ms > client->max_lateness.load(std::memory_order_relaxed)) {
+      client->max_lateness.store(lateness_ms, std::memory_order_relaxed);
+    }
+  }
+
+  client->completed.fetch_add(1U, std::memory_order_relaxed);
+
+  client->busy.store(false, std::memory_order_release);
+  client->busy.notify_all();
+}
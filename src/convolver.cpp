@@ -21,10 +21,9 @@
 #include <gio/gio.h>
 #include <glib-object.h>
 #include <glib.h>
-#include <sched.h>
 #include <sys/types.h>
-#include <zita-convolver.h>
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <memory>
@@ -33,6 +32,9 @@
 #include <span>
 #include <string>
 #include <vector>
+#include "block_adapter.hpp"
+#include "channel_layout.hpp"
+#include "partitioned_convolver.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 #include "resampler.hpp"
@@ -40,14 +42,6 @@
 #include "tags_resources.hpp"
 #include "util.hpp"
 
-namespace {
-
-constexpr auto CONVPROC_SCHEDULER_PRIORITY = 0;
-
-constexpr auto CONVPROC_SCHEDULER_CLASS = SCHED_FIFO;
-
-}  // namespace
-
 Convolver::Convolver(const std::string& tag,
                      const std::string& schema,
                      const std::string& schema_path,
@@ -61,7 +55,12 @@ Convolver::Convolver(const std::string& tag,
                  pipe_manager,
                  pipe_type),
       do_autogain(g_settings_get_boolean(settings, "autogain") != 0),
-      ir_width(g_settings_get_int(settings, "ir-width")) {
+      ir_width(g_settings_get_int(settings, "ir-width")),
+      conv(std::make_unique<PartitionedConvolver>(log_tag + name)) {
+  channel_policy = ChannelPolicy::per_channel;
+
+  allocate_dry_delay();
+
   // Initialize directories for local and community irs
   local_dir_irs = std::string{g_get_user_config_dir()} + "/easyeffects/irs";
 
@@ -133,13 +132,7 @@ Convolver::~Convolver() {
 
   ready = false;
 
-  if (conv != nullptr) {
-    conv->stop_process();
-
-    conv->cleanup();
-
-    delete conv;
-  }
+  conv->stop_process();
 
   util::debug(log_tag + name + " destroyed");
 }
@@ -160,23 +153,27 @@ void Convolver::setup() {
 
     blocksize = n_samples;
 
-    n_samples_is_power_of_2 = (n_samples & (n_samples - 1U)) == 0U && n_samples != 0U;
+    const bool n_samples_is_power_of_2 = (n_samples & (n_samples - 1U)) == 0U && n_samples != 0U;
 
     if (!n_samples_is_power_of_2) {
       while ((blocksize & (blocksize - 1)) != 0 && blocksize > 2) {
         blocksize--;
       }
+
+      // The time domain head is as long as the block adapter delay, which is always shorter than the block.
+
+      blocksize = std::min(blocksize, max_head_blocksize);
     }
 
-    data_L.resize(0U);
-    data_R.resize(0U);
+    head_size = BlockAdapter<float>::get_priming(blocksize, n_samples);
+
+    block_adapter.setup(blocksize, n_samples, head_size, 0U, n_channels);
 
-    deque_out_L.resize(0U);
-    deque_out_R.resize(0U);
+    head_histories.assign(n_channels, std::vector<float>(head_size + n_samples, 0.0F));
 
     notify_latency = true;
 
-    latency_n_frames = 0U;
+    latency_n_frames = block_adapter.get_latency() - head_size;
 
     read_kernel_file();
 
@@ -200,85 +197,72 @@ void Convolver::process(std::span<float>& left_in,
                         std::span<float>& right_in,
                         std::span<float>& left_out,
                         std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::array<std::span<float>, 2U> inputs = {left_in, right_in};
+  std::array<std::span<float>, 2U> outputs = {left_out, right_out};
 
-  if (bypass || !ready) {
-    std::copy(left_in.begin(), left_in.end(), left_out.begin());
-    std::copy(right_in.begin(), right_in.end(), right_out.begin());
+  process(inputs, outputs);
+}
 
-    return;
-  }
+void Convolver::process(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs) {
+  const auto lock = lock_for_rt();
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
+  if (!lock.owns_lock()) {
+    write_delayed_dry(inputs, outputs);
+
+    return;
   }
 
-  if (n_samples_is_power_of_2) {
-    std::copy(left_in.begin(), left_in.end(), left_out.begin());
-    std::copy(right_in.begin(), right_in.end(), right_out.begin());
+  store_dry(inputs);
 
-    do_convolution(left_out, right_out);
-  } else {
-    for (size_t j = 0U; j < left_in.size(); j++) {
-      data_L.push_back(left_in[j]);
-      data_R.push_back(right_in[j]);
+  if (bypass || !ready) {
+    for (size_t c = 0U; c < inputs.size(); c++) {
+      std::ranges::copy(inputs[c], outputs[c].begin());
+    }
 
-      if (data_L.size() == blocksize) {
-        do_convolution(data_L, data_R);
+    return;
+  }
 
-        for (const auto& v : data_L) {
-          deque_out_L.push_back(v);
-        }
+  if (input_gain != 1.0F) {
+    apply_gain(inputs, input_gain);
+  }
 
-        for (const auto& v : data_R) {
-          deque_out_R.push_back(v);
-        }
+  if (head_size != 0U) {
+    // The input is saved before the block adapter writes to the output. They can be the same buffer.
 
-        data_L.resize(0U);
-        data_R.resize(0U);
-      }
+    for (size_t c = 0U; c < inputs.size(); c++) {
+      std::ranges::copy(inputs[c], head_histories[c].begin() + head_size);
     }
+  }
 
-    // copying the processed samples to the output buffers
+  block_adapter.process(inputs, outputs, [this](std::span<std::span<float>> block) { do_convolution(block); });
 
-    if (deque_out_L.size() >= left_out.size()) {
-      for (float& v : left_out) {
-        v = deque_out_L.front();
+  if (head_size != 0U) {
+    for (size_t c = 0U; c < inputs.size(); c++) {
+      apply_head(inputs[c], outputs[c], head_kernels[c], head_histories[c]);
+    }
 
-        deque_out_L.pop_front();
-      }
+    /*
+      When the block adapter runs out of frames it adds silence and the tail is delayed more than head_size. The head
+      runs on the raw quantum and would stay ahead of it. Both restart together so that they are aligned again.
+    */
 
-      for (float& v : right_out) {
-        v = deque_out_R.front();
+    if (block_adapter.get_latency() != head_size) {
+      block_adapter.reset();
 
-        deque_out_R.pop_front();
+      for (auto& history : head_histories) {
+        std::ranges::fill(history, 0.0F);
       }
-    } else {
-      const uint offset = 2U * (left_out.size() - deque_out_L.size());
-
-      if (offset != latency_n_frames) {
-        latency_n_frames = offset;
+    }
+  }
 
-        notify_latency = true;
-      }
+  if (const auto delay = block_adapter.get_latency() - head_size; delay != latency_n_frames) {
+    latency_n_frames = delay;
 
-      for (uint n = 0U; !deque_out_L.empty() && n < left_out.size(); n++) {
-        if (n < offset) {
-          left_out[n] = 0.0F;
-          right_out[n] = 0.0F;
-        } else {
-          left_out[n] = deque_out_L.front();
-          right_out[n] = deque_out_R.front();
-
-          deque_out_R.pop_front();
-          deque_out_L.pop_front();
-        }
-      }
-    }
+    notify_latency = true;
   }
 
   if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
+    apply_gain(outputs, output_gain);
   }
 
   if (notify_latency) {
@@ -294,7 +278,7 @@ void Convolver::process(std::span<float>& left_in,
   }
 
   if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
+    get_peaks(inputs, outputs);
 
     if (send_notifications) {
       notify();
@@ -474,52 +458,50 @@ void Convolver::setup_zita() {
     return;
   }
 
-  const uint max_convolution_size = kernel_L.size();
-  const uint buffer_size = get_zita_buffer_size();
-
-  if (conv != nullptr) {
-    conv->stop_process();
-
-    conv->cleanup();
-
-    delete conv;
-  }
+  /*
+    Every channel has its own kernel. The LFE gets the identity, so it is only delayed like the others. Only the first
+    taps are convolved in the realtime thread. The rest of the kernel is convolved in larger blocks by the shared
+    convolution pool.
+  */
 
-  conv = new Convproc();
+  std::vector<std::vector<float>> tails(n_channels);
 
-  conv->set_options(0);
+  head_kernels.resize(n_channels);
 
-  int ret = conv->configure(2, 2, max_convolution_size, buffer_size, buffer_size, buffer_size, 0.0F /*density*/);
+  uint max_convolution_size = 0U;
 
-  if (ret != 0) {
-    util::warning(log_tag + name + " can't initialise zita-convolver engine: " + util::to_string(ret, ""));
+  for (uint c = 0U; c < n_channels; c++) {
+    split_kernel(get_channel_kernel(c), head_kernels[c], tails[c]);
 
-    return;
+    max_convolution_size = std::max(max_convolution_size, static_cast<uint>(tails[c].size()));
   }
 
-  ret = conv->impdata_create(0, 0, 1, kernel_L.data(), 0, static_cast<int>(kernel_L.size()));
+  const uint buffer_size = get_zita_buffer_size();
+
+  int ret = conv->configure(n_channels, n_channels, max_convolution_size, buffer_size, rate);
 
   if (ret != 0) {
-    util::warning(log_tag + name + " left impdata_create failed: " + util::to_string(ret));
+    util::warning(log_tag + name + " can't initialise zita-convolver engine: " + util::to_string(ret, ""));
 
     return;
   }
 
-  ret = conv->impdata_create(1, 1, 1, kernel_R.data(), 0, static_cast<int>(kernel_R.size()));
+  for (uint c = 0U; c < n_channels; c++) {
+    ret = conv->impdata_create(c, c, tails[c]);
 
-  if (ret != 0) {
-    util::warning(log_tag + name + " right impdata_create failed: " + util::to_string(ret, ""));
+    if (ret != 0) {
+      util::warning(log_tag + name + " " + channel_positions[c] + " impdata_create failed: " + util::to_string(ret));
 
-    return;
+      return;
+    }
   }
 
-  ret = conv->start_process(CONVPROC_SCHEDULER_PRIORITY, CONVPROC_SCHEDULER_CLASS);
+  ret = conv->start_process();
 
   if (ret != 0) {
     util::warning(log_tag + name + " start_process failed: " + util::to_string(ret, ""));
 
     conv->stop_process();
-    conv->cleanup();
 
     return;
   }
@@ -529,11 +511,77 @@ void Convolver::setup_zita() {
   util::debug(log_tag + name + ": zita is ready");
 }
 
-auto Convolver::get_zita_buffer_size() -> uint {
-  if (n_samples_is_power_of_2) {
-    return n_samples;
+auto Convolver::get_channel_kernel(const size_t& channel) const -> std::vector<float> {
+  if (!is_processed_channel(channel)) {
+    return {1.0F};
+  }
+
+  switch (channel_layout::get_side(channel_positions[channel])) {
+    case channel_layout::Side::left:
+      return kernel_L;
+    case channel_layout::Side::right:
+      return kernel_R;
+    case channel_layout::Side::center: {
+      std::vector<float> kernel(std::max(kernel_L.size(), kernel_R.size()), 0.0F);
+
+      for (size_t n = 0U; n < kernel_L.size(); n++) {
+        kernel[n] += 0.5F * kernel_L[n];
+      }
+
+      for (size_t n = 0U; n < kernel_R.size(); n++) {
+        kernel[n] += 0.5F * kernel_R[n];
+      }
+
+      return kernel;
+    }
   }
 
+  return kernel_L;
+}
+
+void Convolver::split_kernel(const std::vector<float>& kernel,
+                             std::vector<float>& head,
+                             std::vector<float>& tail) const {
+  head.assign(head_size, 0.0F);
+
+  const auto n_head = std::min(static_cast<size_t>(head_size), kernel.size());
+
+  std::copy_n(kernel.begin(), n_head, head.begin());
+
+  tail.assign(kernel.begin() + static_cast<std::ptrdiff_t>(n_head), kernel.end());
+
+  // zita needs at least one tap
+
+  if (tail.empty()) {
+    tail.push_back(0.0F);
+  }
+}
+
+void Convolver::apply_head(const std::span<float>& in,
+                           std::span<float>& out,
+                           const std::vector<float>& head,
+                           std::vector<float>& history) const {
+  /*
+    history holds the last head_size input frames followed by the current quantum. The output of zita is delayed by
+    head_size frames and covers the kernel taps from head_size on. Here we add the taps before that.
+  */
+
+  for (size_t n = 0U; n < in.size(); n++) {
+    const auto* x = history.data() + head_size + n;
+
+    float sum = 0.0F;
+
+    for (size_t k = 0U; k < head_size; k++) {
+      sum += head[k] * x[-static_cast<std::ptrdiff_t>(k)];
+    }
+
+    out[n] += sum;
+  }
+
+  std::copy(history.end() - head_size, history.end(), history.begin());
+}
+
+auto Convolver::get_zita_buffer_size() -> uint {
   return blocksize;
 }
 
@@ -21,20 +21,20 @@
 #include <gio/gio.h>
 #include <glib-object.h>
 #include <glib.h>
+#include <glib/gi18n.h>
 #include <gtk/gtk.h>
 #include <gtk/gtkdropdown.h>
 #include <sndfile.h>
-#include <algorithm>
+#include <atomic>
 #include <cstddef>
-#include <execution>
 #include <filesystem>
 #include <memory>
-#include <numeric>
 #include <sndfile.hh>
 #include <string>
 #include <thread>
 #include <vector>
 #include "convolver_ui_common.hpp"
+#include "fft_convolution.hpp"
 #include "resampler.hpp"
 #include "tags_app.hpp"
 #include "tags_resources.hpp"
@@ -53,7 +53,11 @@ struct Data {
  public:
   ~Data() { util::debug("data struct destroyed"); }
 
-  std::vector<std::thread> mythreads;
+  std::thread worker;
+
+  std::atomic<bool> cancel = false;
+
+  std::unique_ptr<FftConvolution> fft_convolution;
 };
 
 struct _ConvolverMenuCombine {
@@ -63,7 +67,9 @@ struct _ConvolverMenuCombine {
 
   GtkEntry* output_kernel_name;
 
-  GtkSpinner* spinner;
+  GtkButton* combine_kernels;
+
+  GtkProgressBar* progress_bar;
 
   GtkStringList *string_list_1, *string_list_2;
 
@@ -85,53 +91,55 @@ void remove_from_string_list(ConvolverMenuCombine* self, const std::string& irs_
   ui::remove_from_string_list(self->string_list_2, irs_filename);
 }
 
-void direct_conv(const std::vector<float>& a, const std::vector<float>& b, std::vector<float>& c) {
-  std::vector<size_t> indices(c.size());
+void set_running(ConvolverMenuCombine* self, const bool& state) {
+  gtk_button_set_label(self->combine_kernels, state ? _("Cancel") : _("Combine"));
 
-  std::iota(indices.begin(), indices.end(), 0U);
+  if (state) {
+    gtk_widget_remove_css_class(GTK_WIDGET(self->combine_kernels), "suggested-action");
+  } else {
+    gtk_widget_add_css_class(GTK_WIDGET(self->combine_kernels), "suggested-action");
+  }
 
-  auto each = [&](const int n) {
-    c[n] = 0.0F;
+  gtk_progress_bar_set_fraction(self->progress_bar, 0.0);
 
-    // Static cast to avoid gcc signedness warning.
+  gtk_widget_set_visible(GTK_WIDGET(self->progress_bar), state);
 
-    const int a_size = static_cast<int>(a.size());
-    const int b_size = static_cast<int>(b.size());
+  gtk_widget_set_sensitive(GTK_WIDGET(self->dropdown_kernel_1), !state);
+  gtk_widget_set_sensitive(GTK_WIDGET(self->dropdown_kernel_2), !state);
+  gtk_widget_set_sensitive(GTK_WIDGET(self->output_kernel_name), !state);
+}
 
-    for (int m = 0; m < b_size; m++) {
-      if (const auto z = n - m; z >= 0 && z < a_size - 1) {
-        c[n] += b[m] * a[z];
-      }
-    }
-  };
-#if defined(ENABLE_LIBCPP_WORKAROUNDS) && (_LIBCPP_VERSION < 170000 || defined(_LIBCPP_HAS_NO_INCOMPLETE_PSTL))
-  std::for_each(indices.begin(), indices.end(), each);
-#else
-  std::for_each(std::execution::par_unseq, indices.begin(), indices.end(), each);
-#endif
+void on_combine_finished(ConvolverMenuCombine* self) {
+  // When the widget was disposed before this callback could run the worker was already joined
+
+  if (!self->data->worker.joinable()) {
+    return;
+  }
+
+  self->data->worker.join();
+
+  self->data->fft_convolution.reset();
+
+  set_running(self, false);
 }
 
 void combine_kernels(ConvolverMenuCombine* self,
                      const std::string& kernel_1_name,
                      const std::string& kernel_2_name,
                      const std::string& output_file_name) {
-  if (output_file_name.empty()) {
-    // The method combine_kernels run in a secondary thread. But the widgets have to be used in the main thread.
+  // This function runs in the worker thread. The widgets have to be used in the main thread.
 
+  auto finish = [=]() {
     g_object_ref(self);
 
-    util::idle_add([=] { gtk_spinner_stop(self->spinner); }, [=]() { g_object_unref(self); });
-
-    return;
-  }
+    util::idle_add([=] { on_combine_finished(self); }, [=]() { g_object_unref(self); });
+  };
 
   auto [rate1, kernel_1_L, kernel_1_R] = ui::convolver::read_kernel(irs_dir, irs_ext, kernel_1_name);
   auto [rate2, kernel_2_L, kernel_2_R] = ui::convolver::read_kernel(irs_dir, irs_ext, kernel_2_name);
 
   if (rate1 == 0 || rate2 == 0) {
-    g_object_ref(self);
-
-    util::idle_add([=] { gtk_spinner_stop(self->spinner); }, [=]() { g_object_unref(self); });
+    finish();
 
     return;
   }
@@ -158,17 +166,43 @@ void combine_kernels(ConvolverMenuCombine* self,
     kernel_1_R = resampler->process(kernel_1_R, true);
   }
 
-  std::vector<float> kernel_L(kernel_1_L.size() + kernel_2_L.size() - 1U);
-  std::vector<float> kernel_R(kernel_1_R.size() + kernel_2_R.size() - 1U);
+  // Each channel is half of the work. The progress bar is only updated when the displayed value changes.
 
-  // As the convolution is commutative we change the order based on which will run faster.
+  auto last_percent = std::make_shared<int>(-1);
 
-  if (kernel_1_L.size() > kernel_2_L.size()) {
-    direct_conv(kernel_1_L, kernel_2_L, kernel_L);
-    direct_conv(kernel_1_R, kernel_2_R, kernel_R);
-  } else {
-    direct_conv(kernel_2_L, kernel_1_L, kernel_L);
-    direct_conv(kernel_2_R, kernel_1_R, kernel_R);
+  auto progress = [=](const float& offset) {
+    return [=](const float& value) {
+      const auto percent = static_cast<int>(100.0F * (offset + (0.5F * value)));
+
+      if (percent == *last_percent) {
+        return;
+      }
+
+      *last_percent = percent;
+
+      g_object_ref(self);
+
+      util::idle_add(
+          [=] {
+            if (self->data->worker.joinable()) {
+              gtk_progress_bar_set_fraction(self->progress_bar, 0.01 * percent);
+            }
+          },
+          [=]() { g_object_unref(self); });
+    };
+  };
+
+  auto* fft_convolution = self->data->fft_convolution.get();
+
+  const auto kernel_L = fft_convolution->process(kernel_1_L, kernel_2_L, progress(0.0F), self->data->cancel);
+  const auto kernel_R = fft_convolution->process(kernel_1_R, kernel_2_R, progress(0.5F), self->data->cancel);
+
+  if (self->data->cancel.load() || kernel_L.empty() || kernel_L.size() != kernel_R.size()) {
+    util::debug("the kernels " + kernel_1_name + " and " + kernel_2_name + " were not combined");
+
+    finish();
+
+    return;
   }
 
   std::vector<float> buffer(kernel_L.size() * 2U);  // 2 channels interleaved
@@ -191,12 +225,18 @@ void combine_kernels(ConvolverMenuCombine* self,
 
   util::debug("combined kernel saved: " + output_file_path.string());
 
-  g_object_ref(self);
-
-  util::idle_add([=] { gtk_spinner_stop(self->spinner); }, [=]() { g_object_unref(self); });
+  finish();
 }
 
 void on_combine_kernels(ConvolverMenuCombine* self, GtkButton* btn) {
+  // While a combination is running the button cancels it
+
+  if (self->data->worker.joinable()) {
+    self->data->cancel.store(true);
+
+    return;
+  }
+
   if (g_list_model_get_n_items(G_LIST_MODEL(self->string_list_1)) == 0U ||
       g_list_model_get_n_items(G_LIST_MODEL(self->string_list_2)) == 0U) {
     return;
@@ -209,11 +249,9 @@ void on_combine_kernels(ConvolverMenuCombine* self, GtkButton* btn) {
     return;
   }
 
-  gtk_spinner_start(self->spinner);
-
-  const auto* const kernel_1_name = gtk_string_object_get_string(GTK_STRING_OBJECT(dropdown_1_selection));
+  const std::string kernel_1_name = gtk_string_object_get_string(GTK_STRING_OBJECT(dropdown_1_selection));
 
-  const auto* const kernel_2_name = gtk_string_object_get_string(GTK_STRING_OBJECT(dropdown_2_selection));
+  const std::string kernel_2_name = gtk_string_object_get_string(GTK_STRING_OBJECT(dropdown_2_selection));
 
   std::string output_name = g_utf8_make_valid(gtk_editable_get_text(GTK_EDITABLE(self->output_kernel_name)), -1);
 
@@ -228,34 +266,42 @@ void on_combine_kernels(ConvolverMenuCombine* self, GtkButton* btn) {
 
     gtk_widget_grab_focus(GTK_WIDGET(self->output_kernel_name));
 
-    gtk_spinner_stop(self->spinner);
-  } else {
-    // Truncate filename if longer than 100 characters
+    return;
+  }
+
+  // Truncate filename if longer than 100 characters
 
-    if (output_name.size() > 100U) {
-      output_name.resize(100U);
-    }
+  if (output_name.size() > 100U) {
+    output_name.resize(100U);
+  }
 
-    gtk_widget_remove_css_class(GTK_WIDGET(self->output_kernel_name), "error");
+  gtk_widget_remove_css_class(GTK_WIDGET(self->output_kernel_name), "error");
 
-    /*
-      The current code convolving the impulse responses is doing direct convolution. It can be very slow depending on
-      the size of each kernel. So we do not want to do it in the main thread.
-    */
+  set_running(self, true);
 
-    self->data->mythreads.emplace_back(  // Using emplace_back here makes sense
-        [=]() { combine_kernels(self, kernel_1_name, kernel_2_name, output_name); });
-  }
+  /*
+    Reading and resampling the kernels and the convolution itself can take a few seconds for long impulse responses.
+    So we do not want to do it in the main thread. The fftw plans are created here because fftw planning is not thread
+    safe and the other fftw users in this program also create their plans in the main thread.
+  */
+
+  self->data->cancel.store(false);
+
+  self->data->fft_convolution = std::make_unique<FftConvolution>();
+
+  self->data->worker = std::thread([=]() { combine_kernels(self, kernel_1_name, kernel_2_name, output_name); });
 }
 
 void dispose(GObject* object) {
   auto* self = EE_CONVOLVER_MENU_COMBINE(object);
 
-  for (auto& t : self->data->mythreads) {
-    t.join();
+  if (self->data->worker.joinable()) {
+    self->data->cancel.store(true);
+
+    self->data->worker.join();
   }
 
-  self->data->mythreads.clear();
+  self->data->fft_convolution.reset();
 
   g_object_unref(self->app_settings);
 
@@ -288,7 +334,8 @@ void convolver_menu_combine_class_init(ConvolverMenuCombineClass* klass) {
   gtk_widget_class_bind_template_child(widget_class, ConvolverMenuCombine, dropdown_kernel_1);
   gtk_widget_class_bind_template_child(widget_class, ConvolverMenuCombine, dropdown_kernel_2);
   gtk_widget_class_bind_template_child(widget_class, ConvolverMenuCombine, output_kernel_name);
-  gtk_widget_class_bind_template_child(widget_class, ConvolverMenuCombine, spinner);
+  gtk_widget_class_bind_template_child(widget_class, ConvolverMenuCombine, combine_kernels);
+  gtk_widget_class_bind_template_child(widget_class, ConvolverMenuCombine, progress_bar);
 
   gtk_widget_class_bind_template_callback(widget_class, on_combine_kernels);
 }
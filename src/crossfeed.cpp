@@ -23,7 +23,6 @@
 #include <glib.h>
 #include <algorithm>
 #include <cstddef>
-#include <mutex>
 #include <span>
 #include <string>
 #include "pipe_manager.hpp"
@@ -51,9 +50,9 @@ Crossfeed::Crossfeed(const std::string& tag,
                                           G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                                             auto* self = static_cast<Crossfeed*>(user_data);
 
-                                            std::scoped_lock<std::mutex> lock(self->data_mutex);
-
-                                            self->bs2b.set_level_fcut(g_settings_get_int(settings, key));
+                                            self->post_to_rt([self, value = g_settings_get_int(settings, key)]() {
+                                              self->bs2b.set_level_fcut(value);
+                                            });
                                           }),
                                           this));
 
@@ -61,9 +60,9 @@ Crossfeed::Crossfeed(const std::string& tag,
       g_signal_connect(settings, "changed::feed", G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
                          auto* self = static_cast<Crossfeed*>(user_data);
 
-                         std::scoped_lock<std::mutex> lock(self->data_mutex);
+                         const auto value = 10 * static_cast<int>(g_settings_get_double(settings, key));
 
-                         self->bs2b.set_level_feed(10 * static_cast<int>(g_settings_get_double(settings, key)));
+                         self->post_to_rt([self, value]() { self->bs2b.set_level_feed(value); });
                        }),
                        this));
 
@@ -79,8 +78,10 @@ Crossfeed::~Crossfeed() {
 }
 
 void Crossfeed::setup() {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  setup_pending = true;
+}
 
+void Crossfeed::apply_setup() {
   data.resize(2U * static_cast<size_t>(n_samples));
 
   if (rate != bs2b.get_srate()) {
@@ -92,7 +93,19 @@ void Crossfeed::process(std::span<float>& left_in,
                         std::span<float>& right_in,
                         std::span<float>& left_out,
                         std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  const auto lock = lock_for_rt();
+
+  if (!lock.owns_lock()) {
+    write_delayed_dry(left_in, right_in, left_out, right_out);
+
+    return;
+  }
+
+  if (setup_pending) {
+    apply_setup();
+
+    setup_pending = false;
+  }
 
   if (bypass) {
     std::copy(left_in.begin(), left_in.end(), left_out.begin());
@@ -23,13 +23,14 @@
 #include <glib.h>
 #include <sys/types.h>
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <memory>
 #include <mutex>
 #include <span>
 #include <string>
-#include "fir_filter_bandpass.hpp"
-#include "fir_filter_base.hpp"
+#include "block_adapter.hpp"
+#include "fir_filter_bank.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 #include "tags_plugin_name.hpp"
@@ -47,15 +48,26 @@ Crystalizer::Crystalizer(const std::string& tag,
                  schema_path,
                  pipe_manager,
                  pipe_type) {
-  for (uint n = 0U; n < nbands; n++) {
-    filters.at(n) = std::make_unique<FirFilterBandpass>(log_tag + name + " band" + util::to_string(n));
-  }
+  channel_policy = ChannelPolicy::per_channel;
+
+  allocate_dry_delay();
 
   std::ranges::fill(band_mute, false);
   std::ranges::fill(band_bypass, false);
   std::ranges::fill(band_intensity, 1.0F);
-  std::ranges::fill(band_last_L, 0.0F);
-  std::ranges::fill(band_last_R, 0.0F);
+
+  channel_state.resize(n_channels);
+
+  for (size_t c = 0U; c < n_channels; c++) {
+    if (is_processed_channel(c)) {
+      processed_channels.push_back(c);
+    }
+  }
+
+  for (size_t n = 0U; n < processed_channels.size(); n += 2U) {
+    filter_banks.push_back(
+        std::make_unique<FirFilterBank>(log_tag + name + " filter bank " + util::to_string(n / 2U) + " "));
+  }
 
   frequencies[0] = 20.0F;
   frequencies[1] = 520.0F;
@@ -94,12 +106,12 @@ Crystalizer::~Crystalizer() {
 }
 
 void Crystalizer::setup() {
-  data_mutex.lock();
+  setup_pending = true;
+}
 
+void Crystalizer::apply_setup() {
   filters_are_ready = false;
 
-  data_mutex.unlock();
-
   /*
     As zita uses fftw we have to be careful when reinitializing it. The thread that creates the fftw plan has to be the
     same that destroys it. Otherwise segmentation faults can happen. As we do not want to do this initializing in the
@@ -113,7 +125,7 @@ void Crystalizer::setup() {
 
     blocksize = n_samples;
 
-    n_samples_is_power_of_2 = (n_samples & (n_samples - 1U)) == 0 && n_samples != 0U;
+    const bool n_samples_is_power_of_2 = (n_samples & (n_samples - 1U)) == 0 && n_samples != 0U;
 
     if (!n_samples_is_power_of_2) {
       while ((blocksize & (blocksize - 1U)) != 0 && blocksize > 2U) {
@@ -124,32 +136,54 @@ void Crystalizer::setup() {
     util::debug(log_tag + name + " blocksize: " + util::to_string(blocksize));
 
     notify_latency = true;
-    do_first_rotation = true;
 
-    latency_n_frames = 1U;  // the second derivative forces us to delay at least one sample
+    block_adapter.setup(blocksize, n_samples, BlockAdapter<float>::get_priming(blocksize, n_samples), 0U, n_channels);
+
+    // the second derivative forces us to delay at least one sample
 
-    deque_out_L.resize(0U);
-    deque_out_R.resize(0U);
+    latency_n_frames = block_adapter.get_latency() + 1U;
 
-    data_L.resize(0U);
-    data_R.resize(0U);
+    silence.assign(blocksize, 0.0F);
 
-    for (uint n = 0U; n < nbands; n++) {
-      band_data_L.at(n).resize(blocksize);
-      band_data_R.at(n).resize(blocksize);
+    for (auto& state : channel_state) {
+      state.do_first_rotation = true;
 
-      band_second_derivative_L.at(n).resize(blocksize);
-      band_second_derivative_R.at(n).resize(blocksize);
+      std::ranges::fill(state.band_last, 0.0F);
+      std::ranges::fill(state.band_next, 0.0F);
+
+      for (auto& d2 : state.band_second_derivative) {
+        d2.resize(blocksize);
+      }
     }
 
-    for (uint n = 0U; n < nbands; n++) {
-      filters.at(n)->set_n_samples(blocksize);
-      filters.at(n)->set_rate(rate);
+    for (size_t k = 0U; k < filter_banks.size(); k++) {
+      auto& bank = filter_banks[k];
+
+      bank->set_n_samples(blocksize);
+      bank->set_rate(rate);
+      bank->set_band_edges(frequencies);
+
+      bank->setup();
+
+      if (!bank->is_ready()) {
+        util::warning(log_tag + name + " the filter bank could not be initialized");
+
+        return;
+      }
+
+      const auto left = processed_channels[2U * k];
+
+      for (uint n = 0U; n < nbands; n++) {
+        channel_state[left].band_data.at(n) = bank->get_band_left(n);
+      }
 
-      filters.at(n)->set_min_frequency(frequencies.at(n));
-      filters.at(n)->set_max_frequency(frequencies.at(n + 1U));
+      if (2U * k + 1U < processed_channels.size()) {
+        const auto right = processed_channels[2U * k + 1U];
 
-      filters.at(n)->setup();
+        for (uint n = 0U; n < nbands; n++) {
+          channel_state[right].band_data.at(n) = bank->get_band_right(n);
+        }
+      }
     }
 
     data_mutex.lock();
@@ -164,85 +198,53 @@ void Crystalizer::process(std::span<float>& left_in,
                           std::span<float>& right_in,
                           std::span<float>& left_out,
                           std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  std::array<std::span<float>, 2U> inputs = {left_in, right_in};
+  std::array<std::span<float>, 2U> outputs = {left_out, right_out};
 
-  if (bypass || !filters_are_ready) {
-    std::copy(left_in.begin(), left_in.end(), left_out.begin());
-    std::copy(right_in.begin(), right_in.end(), right_out.begin());
+  process(inputs, outputs);
+}
 
-    return;
-  }
+void Crystalizer::process(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs) {
+  const auto lock = lock_for_rt();
 
-  if (input_gain != 1.0F) {
-    apply_gain(left_in, right_in, input_gain);
-  }
-
-  if (n_samples_is_power_of_2 && blocksize == n_samples) {
-    std::copy(left_in.begin(), left_in.end(), left_out.begin());
-    std::copy(right_in.begin(), right_in.end(), right_out.begin());
+  if (!lock.owns_lock()) {
+    write_delayed_dry(inputs, outputs);
 
-    enhance_peaks(left_out, right_out);
-  } else {
-    for (size_t j = 0U; j < left_in.size(); j++) {
-      data_L.push_back(left_in[j]);
-      data_R.push_back(right_in[j]);
+    return;
+  }
 
-      if (data_L.size() == blocksize) {
-        enhance_peaks(data_L, data_R);
+  if (setup_pending) {
+    apply_setup();
 
-        for (const auto& v : data_L) {
-          deque_out_L.push_back(v);
-        }
+    setup_pending = false;
+  }
 
-        for (const auto& v : data_R) {
-          deque_out_R.push_back(v);
-        }
+  store_dry(inputs);
 
-        data_L.resize(0U);
-        data_R.resize(0U);
-      }
+  if (bypass || !filters_are_ready) {
+    for (size_t c = 0U; c < inputs.size(); c++) {
+      std::ranges::copy(inputs[c], outputs[c].begin());
     }
 
-    // copying the processed samples to the output buffers
-
-    if (deque_out_L.size() >= left_out.size()) {
-      for (float& v : left_out) {
-        v = deque_out_L.front();
-
-        deque_out_L.pop_front();
-      }
-
-      for (float& v : right_out) {
-        v = deque_out_R.front();
+    return;
+  }
 
-        deque_out_R.pop_front();
-      }
-    } else {
-      uint offset = 2U * (left_out.size() - deque_out_L.size());
+  if (input_gain != 1.0F) {
+    apply_gain(inputs, input_gain);
+  }
 
-      if (offset != latency_n_frames) {
-        latency_n_frames = offset + 1U;  // the second derivative forces us to delay at least one sample
+  block_adapter.process(inputs, outputs, [this](std::span<std::span<float>> block) { enhance_peaks(block); });
 
-        notify_latency = true;
-      }
+  // the second derivative forces us to delay at least one sample
 
-      for (uint n = 0U; !deque_out_L.empty() && n < left_out.size(); n++) {
-        if (n < offset) {
-          left_out[n] = 0.0F;
-          right_out[n] = 0.0F;
-        } else {
-          left_out[n] = deque_out_L.front();
-          right_out[n] = deque_out_R.front();
+  if (block_adapter.get_latency() + 1U != latency_n_frames) {
+    latency_n_frames = block_adapter.get_latency() + 1U;
 
-          deque_out_R.pop_front();
-          deque_out_L.pop_front();
-        }
-      }
-    }
+    notify_latency = true;
   }
 
   if (output_gain != 1.0F) {
-    apply_gain(left_out, right_out, output_gain);
+    apply_gain(outputs, output_gain);
   }
 
   if (notify_latency) {
@@ -264,7 +266,7 @@ void Crystalizer::process(std::span<float>& left_in,
   }
 
   if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
+    get_peaks(inputs, outputs);
 
     if (send_notifications) {
       notify();
@@ -272,6 +274,116 @@ void Crystalizer::process(std::span<float>& left_in,
   }
 }
 
+void Crystalizer::enhance_peaks(std::span<std::span<float>> block) {
+  /*
+    All bands of a channel pair come out of the same convolution engine in a single call. The band_data spans point to
+    its output buffers, so the peak enhancement below works on them in place.
+  */
+
+  for (size_t k = 0U; k < filter_banks.size(); k++) {
+    const auto left = processed_channels[2U * k];
+
+    const auto right = (2U * k + 1U < processed_channels.size()) ? block[processed_channels[2U * k + 1U]]
+                                                                  : std::span<float>(silence);
+
+    filter_banks[k]->process_bands(block[left], right);
+
+    if (!filter_banks[k]->is_ready()) {
+      return;
+    }
+  }
+
+  for (const auto& c : processed_channels) {
+    enhance_channel(channel_state[c], block[c]);
+  }
+}
+
+void Crystalizer::enhance_channel(ChannelState& state, std::span<float> data) {
+  for (uint n = 0U; n < nbands; n++) {
+    auto& band_data = state.band_data.at(n);
+
+    /*
+      Later we will need to calculate the second derivative of each band. This
+      is done through the central difference method. In order to calculate
+      the derivative at the last elements of the array we have to know the first
+      element of the next buffer. As we do not have this information the only
+      way to do this calculation is delaying the signal by 1 sample.
+    */
+
+    // last becomes the first
+
+    std::rotate(band_data.rbegin(), band_data.rbegin() + 1, band_data.rend());
+
+    /*
+      band_data was rotated. Its first value is the last one from the original array. We have to save it for the next
+      round.
+    */
+
+    if (state.do_first_rotation) {
+      state.band_next.at(n) = band_data[0];
+
+      state.band_last.at(n) = 0.0F;
+
+      band_data[0] = 0.0F;
+    } else {
+      const float v = band_data[0];
+
+      band_data[0] = state.band_next.at(n);
+
+      state.band_next.at(n) = v;
+    }
+  }
+
+  state.do_first_rotation = false;
+
+  for (uint n = 0U; n < nbands; n++) {
+    auto& band_data = state.band_data.at(n);
+    auto& d2 = state.band_second_derivative.at(n);
+
+    if (band_bypass.at(n)) {
+      state.band_last.at(n) = band_data[blocksize - 1U];
+
+      continue;
+    }
+
+    // Calculating the second derivative
+
+    d2[0] = band_data[1] - 2.0F * band_data[0] + state.band_last.at(n);
+
+    for (uint m = 1U; m < blocksize - 1U; m++) {
+      d2[m] = band_data[m + 1U] - 2.0F * band_data[m] + band_data[m - 1U];
+    }
+
+    d2[blocksize - 1U] = state.band_next.at(n) - 2.0F * band_data[blocksize - 1U] + band_data[blocksize - 2U];
+
+    state.band_last.at(n) = band_data[blocksize - 1U];
+
+    // peak enhancing using second derivative
+
+    const auto intensity = band_intensity.at(n);
+
+    for (uint m = 0U; m < blocksize; m++) {
+      band_data[m] -= intensity * d2[m];
+    }
+  }
+
+  // add bands
+
+  std::ranges::fill(data, 0.0F);
+
+  for (uint n = 0U; n < nbands; n++) {
+    if (band_mute.at(n)) {
+      continue;
+    }
+
+    const auto& band_data = state.band_data.at(n);
+
+    for (uint m = 0U; m < blocksize; m++) {
+      data[m] += band_data[m];
+    }
+  }
+}
+
 void Crystalizer::bind_band(const int& n) {
   const std::string bandn = "band" + util::to_string(n);
 
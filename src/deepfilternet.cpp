@@ -18,16 +18,18 @@
  */
 
 #include "deepfilternet.hpp"
+#include <sys/types.h>
 #include <algorithm>
 #include <memory>
 #include <mutex>
 #include <span>
 #include <string>
 #include <vector>
+#include "block_adapter.hpp"
 #include "ladspa_wrapper.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
-#include "resampler.hpp"
+#include "polyphase_resampler.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
 
@@ -43,6 +45,8 @@ DeepFilterNet::DeepFilterNet(const std::string& tag,
                  schema_path,
                  pipe_manager,
                  pipe_type) {
+  allocate_dry_delay();
+
   ladspa_wrapper = std::make_unique<ladspa::LadspaWrapper>("libdeep_filter_ladspa.so", "deep_filter_stereo");
 
   package_installed = ladspa_wrapper->found_plugin();
@@ -80,8 +84,10 @@ DeepFilterNet::~DeepFilterNet() {
 }
 
 void DeepFilterNet::setup() {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  setup_pending = true;
+}
 
+void DeepFilterNet::apply_setup() {
   if (!ladspa_wrapper->found_plugin()) {
     return;
   }
@@ -99,28 +105,21 @@ void DeepFilterNet::setup() {
     }
 
     if (resample && !resampler_ready) {
-      resampler_inL = std::make_unique<Resampler>(rate, 48000);
-      resampler_inR = std::make_unique<Resampler>(rate, 48000);
-      resampler_outL = std::make_unique<Resampler>(48000, rate);
-      resampler_outR = std::make_unique<Resampler>(48000, rate);
-
-      std::vector<float> dummy(n_samples);
+      resampler_in.setup(rate, 48000, n_samples);
+      resampler_out.setup(48000, rate, resampler_in.get_max_output_frames());
 
-      const auto resampled_inL = resampler_inL->process(dummy, false);
-      const auto resampled_inR = resampler_inR->process(dummy, false);
+      resampled_outL.assign(resampler_in.get_max_output_frames(), 0.0F);
+      resampled_outR.assign(resampler_in.get_max_output_frames(), 0.0F);
 
-      resampled_outL.resize(resampled_inL.size());
-      resampled_outR.resize(resampled_inR.size());
+      /*
+        The output resampler does not produce exactly one quantum per cycle. A couple of frames of silence in the
+        output fifo absorb the difference.
+      */
 
-      resampler_outL->process(resampled_inL, false);
-      resampler_outR->process(resampled_inR, false);
+      output_fifo.setup(n_samples, n_samples, n_priming_frames,
+                        (2U * n_samples) + resampler_out.get_max_output_frames());
 
-      carryover_l.clear();
-      carryover_r.clear();
-      carryover_l.reserve(4);  // chosen by fair dice roll.
-      carryover_r.reserve(4);  // guaranteed to be random.
-      carryover_l.push_back(0.0F);
-      carryover_r.push_back(0.0F);
+      resampler_latency = (resampler_in.get_latency() * rate / 48000U) + resampler_out.get_latency();
 
       resampler_ready = true;
     }
@@ -131,9 +130,23 @@ void DeepFilterNet::process(std::span<float>& left_in,
                             std::span<float>& right_in,
                             std::span<float>& left_out,
                             std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  const auto lock = lock_for_rt();
+
+  if (!lock.owns_lock()) {
+    write_delayed_dry(left_in, right_in, left_out, right_out);
+
+    return;
+  }
+
+  if (setup_pending) {
+    apply_setup();
+
+    setup_pending = false;
+  }
+
+  store_dry(left_in, right_in);
 
-  if (!ladspa_wrapper->found_plugin() || !ladspa_wrapper->has_instance() || bypass) {
+  if (!ladspa_wrapper->found_plugin() || !ladspa_wrapper->has_instance() || bypass || !resampler_ready) {
     std::copy(left_in.begin(), left_in.end(), left_out.begin());
     std::copy(right_in.begin(), right_in.end(), right_out.begin());
 
@@ -144,15 +157,18 @@ void DeepFilterNet::process(std::span<float>& left_in,
     apply_gain(left_in, right_in, input_gain);
   }
 
+  // Frames given to the ladspa plugin at 48 kHz
+
+  size_t n_resampled = 0U;
+
   if (resample) {
-    const auto& resampled_inL = resampler_inL->process(left_in, false);
-    const auto& resampled_inR = resampler_inR->process(right_in, false);
+    const auto [resampled_inL, resampled_inR] = resampler_in.process(left_in, right_in);
 
-    resampled_outL.resize(resampled_inL.size());
-    resampled_outR.resize(resampled_inR.size());
+    n_resampled = resampled_inL.size();
 
-    ladspa_wrapper->n_samples = resampled_inL.size();
-    ladspa_wrapper->connect_data_ports(resampled_inL, resampled_inR, resampled_outL, resampled_outR);
+    ladspa_wrapper->n_samples = n_resampled;
+    ladspa_wrapper->connect_data_ports(resampled_inL, resampled_inR, std::span(resampled_outL.data(), n_resampled),
+                                       std::span(resampled_outR.data(), n_resampled));
   } else {
     ladspa_wrapper->connect_data_ports(left_in, right_in, left_out, right_out);
   }
@@ -160,37 +176,11 @@ void DeepFilterNet::process(std::span<float>& left_in,
   ladspa_wrapper->run();
 
   if (resample) {
-    const auto& outL = resampler_outL->process(resampled_outL, false);
-    const auto& outR = resampler_outR->process(resampled_outR, false);
-
-    auto carryover_end_l = std::min(carryover_l.size(), left_out.size());
-    auto carryover_end_r = std::min(carryover_r.size(), right_out.size());
-
-    auto left_offset =
-        carryover_end_l + outL.size() > left_out.size() ? carryover_end_l : left_out.size() - outL.size();
-    auto right_offset =
-        carryover_end_r + outR.size() > right_out.size() ? carryover_end_r : right_out.size() - outR.size();
-
-    auto left_count = std::min(outL.size(), left_out.size() - left_offset);
-    auto right_count = std::min(outR.size(), right_out.size() - right_offset);
-
-    std::copy(carryover_l.begin(), carryover_l.begin() + carryover_end_l, left_out.begin());
-    std::copy(carryover_r.begin(), carryover_r.begin() + carryover_end_r, right_out.begin());
-
-    carryover_l.erase(carryover_l.begin(), carryover_l.begin() + carryover_end_l);
-    carryover_r.erase(carryover_r.begin(), carryover_r.begin() + carryover_end_r);
+    const auto [outL, outR] = resampler_out.process(std::span<const float>(resampled_outL.data(), n_resampled),
+                                                    std::span<const float>(resampled_outR.data(), n_resampled));
 
-    std::fill(left_out.begin() + carryover_end_l, left_out.begin() + left_offset, 0);
-    std::fill(right_out.begin() + carryover_end_r, right_out.begin() + right_offset, 0);
-
-    std::copy(outL.begin(), outL.begin() + left_count, left_out.begin() + left_offset);
-    std::copy(outR.begin(), outR.begin() + right_count, right_out.begin() + right_offset);
-
-    carryover_l.insert(carryover_l.end(), outL.begin() + left_count, outL.end());
-    carryover_r.insert(carryover_r.end(), outR.begin() + right_count, outR.end());
-
-    std::fill(left_out.begin() + left_offset + left_count, left_out.end(), 0);
-    std::fill(right_out.begin() + right_offset + right_count, right_out.end(), 0);
+    output_fifo.push(outL, outR);
+    output_fifo.pop(left_out, right_out);
   }
 
   if (output_gain != 1.0F) {
@@ -207,5 +197,9 @@ void DeepFilterNet::process(std::span<float>& left_in,
 }
 
 auto DeepFilterNet::get_latency_seconds() -> float {
-  return 0.02F + 1.0F / rate;
+  if (resample) {
+    return 0.02F + static_cast<float>(resampler_latency + output_fifo.get_latency()) / static_cast<float>(rate);
+  }
+
+  return 0.02F + 1.0F / static_cast<float>(rate);
 }
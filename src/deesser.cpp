@@ -126,8 +126,10 @@ void Deesser::process(std::span<float>& left_in,
       detected_port_value = static_cast<double>(lv2_wrapper->get_control_port_value("detected"));
       compression_port_value = static_cast<double>(lv2_wrapper->get_control_port_value("compression"));
 
-      detected.emit(detected_port_value);
-      compression.emit(compression_port_value);
+      if (meter_slot != nullptr) {
+        meter_slot->set_extra(detected_meter, static_cast<float>(detected_port_value));
+        meter_slot->set_extra(compression_meter, static_cast<float>(compression_port_value));
+      }
 
       notify();
     }
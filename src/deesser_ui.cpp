@@ -32,6 +32,7 @@
 #include <string>
 #include <vector>
 #include "deesser.hpp"
+#include "meter_board.hpp"
 #include "tags_resources.hpp"
 #include "tags_schema.hpp"
 #include "ui_helpers.hpp"
@@ -99,73 +100,25 @@ void setup(DeesserBox* self, std::shared_ptr<Deesser> deesser, const std::string
 
   deesser->set_post_messages(true);
 
-  self->data->connections.push_back(deesser->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(deesser->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(deesser->detected.connect([=](const double value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LEVEL_BAR(self->compression) || !GTK_IS_LABEL(self->compression_label)) {
-            return;
-          }
-
-          gtk_level_bar_set_value(self->compression, 1.0 - value);
-          gtk_label_set_text(self->compression_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(deesser->compression.connect([=](const double value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LEVEL_BAR(self->detected) || !GTK_IS_LABEL(self->detected_label)) {
-            return;
-          }
-
-          gtk_level_bar_set_value(self->detected, value);
-          gtk_label_set_text(self->detected_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+  ui::bind_level_meters(GTK_WIDGET(self), deesser, self->input_level_left, self->input_level_left_label,
+                        self->input_level_right, self->input_level_right_label, self->output_level_left,
+                        self->output_level_left_label, self->output_level_right, self->output_level_right_label);
+
+  ui::add_meter_tick_callback(GTK_WIDGET(self), deesser, [=](const MeterBoard::Slot& slot) {
+    if (!GTK_IS_LEVEL_BAR(self->compression) || !GTK_IS_LABEL(self->compression_label) ||
+        !GTK_IS_LEVEL_BAR(self->detected) || !GTK_IS_LABEL(self->detected_label)) {
+      return;
+    }
+
+    const auto detected = static_cast<double>(slot.get_extra(Deesser::detected_meter));
+    const auto compression = static_cast<double>(slot.get_extra(Deesser::compression_meter));
+
+    gtk_level_bar_set_value(self->compression, 1.0 - detected);
+    gtk_label_set_text(self->compression_label, fmt::format("{0:.0f}", util::linear_to_db(detected)).c_str());
+
+    gtk_level_bar_set_value(self->detected, compression);
+    gtk_label_set_text(self->detected_label, fmt::format("{0:.0f}", util::linear_to_db(compression)).c_str());
+  });
 
   gtk_label_set_text(self->plugin_credit, ui::get_plugin_credit_translated(self->data->deesser->package).c_str());
 
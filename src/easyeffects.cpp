@@ -30,6 +30,7 @@
 #include <string>
 #include "application.hpp"
 #include "config.h"
+#include "offline_renderer.hpp"
 #include "util.hpp"
 
 auto sigterm(void* data) -> int {
@@ -60,6 +61,12 @@ auto main(int argc, char* argv[]) -> int {
       return errno;
     }
 
+    // Offline rendering does not need PipeWire nor a GtkApplication
+
+    if (argc > 1 && std::string(argv[1]) == "--render") {
+      return OfflineRenderer::run_from_command_line(argc, argv);
+    }
+
     auto* app = app::application_new();
 
     g_unix_signal_add(2, G_SOURCE_FUNC(sigterm), app);
@@ -66,35 +66,37 @@ EchoCanceller::EchoCanceller(const std::string& tag,
   gconnections.push_back(g_signal_connect(
       settings, "changed::residual-echo-suppression",
       G_CALLBACK(+[](GSettings* settings, char* key, EchoCanceller* self) {
-        std::scoped_lock<std::mutex> lock(self->data_mutex);
-
-        self->residual_echo_suppression = g_settings_get_int(settings, key);
-
-        if (self->state_left) {
-          speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_ECHO_SUPPRESS, &self->residual_echo_suppression);
-        }
-
-        if (self->state_right) {
-          speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_ECHO_SUPPRESS, &self->residual_echo_suppression);
-        }
+        self->post_to_rt([self, value = g_settings_get_int(settings, key)]() {
+          self->residual_echo_suppression = value;
+
+          if (self->state_left) {
+            speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_ECHO_SUPPRESS,
+                                 &self->residual_echo_suppression);
+          }
+
+          if (self->state_right) {
+            speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_ECHO_SUPPRESS,
+                                 &self->residual_echo_suppression);
+          }
+        });
       }),
       this));
 
   gconnections.push_back(g_signal_connect(
       settings, "changed::near-end-suppression", G_CALLBACK(+[](GSettings* settings, char* key, EchoCanceller* self) {
-        std::scoped_lock<std::mutex> lock(self->data_mutex);
-
-        self->near_end_suppression = g_settings_get_int(settings, key);
-
-        if (self->state_left) {
-          speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_ECHO_SUPPRESS_ACTIVE,
-                               &self->near_end_suppression);
-        }
-
-        if (self->state_right) {
-          speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_ECHO_SUPPRESS_ACTIVE,
-                               &self->near_end_suppression);
-        }
+        self->post_to_rt([self, value = g_settings_get_int(settings, key)]() {
+          self->near_end_suppression = value;
+
+          if (self->state_left) {
+            speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_ECHO_SUPPRESS_ACTIVE,
+                                 &self->near_end_suppression);
+          }
+
+          if (self->state_right) {
+            speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_ECHO_SUPPRESS_ACTIVE,
+                                 &self->near_end_suppression);
+          }
+        });
       }),
       this));
 
@@ -126,8 +128,10 @@ EchoCanceller::~EchoCanceller() {
 }
 
 void EchoCanceller::setup() {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  setup_pending = true;
+}
 
+void EchoCanceller::apply_setup() {
   ready = false;
 
   notify_latency = true;
@@ -143,7 +147,19 @@ void EchoCanceller::process(std::span<float>& left_in,
                             std::span<float>& right_out,
                             std::span<float>& probe_left,
                             std::span<float>& probe_right) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  const auto lock = lock_for_rt();
+
+  if (!lock.owns_lock()) {
+    write_delayed_dry(left_in, right_in, left_out, right_out);
+
+    return;
+  }
+
+  if (setup_pending) {
+    apply_setup();
+
+    setup_pending = false;
+  }
 
   if (bypass || !ready) {
     std::copy(left_in.begin(), left_in.end(), left_out.begin());
@@ -22,11 +22,14 @@
 #include <glib-object.h>
 #include <glib.h>
 #include <algorithm>
+#include <functional>
 #include <map>
 #include <memory>
 #include <ranges>
+#include <set>
 #include <string>
 #include <utility>
+#include <vector>
 #include "autogain.hpp"
 #include "bass_enhancer.hpp"
 #include "bass_loudness.hpp"
@@ -42,7 +45,9 @@
 #include "exciter.hpp"
 #include "expander.hpp"
 #include "filter.hpp"
+#include "fused_chain.hpp"
 #include "gate.hpp"
+#include "graph_transaction.hpp"
 #include "level_meter.hpp"
 #include "limiter.hpp"
 #include "loudness.hpp"
@@ -53,6 +58,7 @@
 #include "pipe_manager.hpp"
 #include "pitch.hpp"
 #include "plugin_base.hpp"
+#include "plugin_loader.hpp"
 #include "reverb.hpp"
 #include "rnnoise.hpp"
 #include "spectrum.hpp"
@@ -61,6 +67,7 @@
 #include "tags_app.hpp"
 #include "tags_plugin_name.hpp"
 #include "tags_schema.hpp"
+#include "tracer.hpp"
 #include "util.hpp"
 
 EffectsBase::EffectsBase(std::string tag, const std::string& schema, PipeManager* pipe_manager, PipelineType pipe_type)
@@ -81,13 +88,10 @@ EffectsBase::EffectsBase(std::string tag, const std::string& schema, PipeManager
   spectrum = std::make_shared<Spectrum>(log_tag, tags::schema::spectrum::id, tags::app::path + "/spectrum/"s, pm,
                                         pipeline_type);
 
-  if (!output_level->connected_to_pw) {
-    output_level->connect_to_pw();
-  }
+  fused_chain = std::make_shared<FusedChain>(log_tag, tags::schema::fused_chain::id, schema_base_path + "fusedchain/",
+                                             pm, pipeline_type);
 
-  if (!spectrum->connected_to_pw) {
-    spectrum->connect_to_pw();
-  }
+  connect_concurrently({output_level, spectrum});
 
   create_filters_if_necessary();
 
@@ -138,6 +142,12 @@ EffectsBase::EffectsBase(std::string tag, const std::string& schema, PipeManager
 }
 
 EffectsBase::~EffectsBase() {
+  loader_state->alive = false;
+
+  for (auto n = loader_state->n_loading.load(); n != 0U; n = loader_state->n_loading.load()) {
+    loader_state->n_loading.wait(n);
+  }
+
   for (auto& c : connections) {
     c.disconnect();
   }
@@ -172,83 +182,313 @@ void EffectsBase::create_filters_if_necessary() {
     return;
   }
 
+  std::vector<std::string> from_snapshots;
+
   for (const auto& name : list) {
-    if (plugins.contains(name)) {
+    if (plugins.contains(name) || loading_plugins.contains(name)) {
+      continue;
+    }
+
+    // Snapshot plugins are already built and prepared. They enter the pipeline right away.
+
+    if (auto filter = find_snapshot_filter(name); filter != nullptr) {
+      install_filter(name, filter);
+
+      from_snapshots.push_back(name);
+
+      continue;
+    }
+
+    /*
+      Only the registration is done here. The plugin is built by the PluginLoader workers and joins the pipeline when
+      on_filter_loaded runs. Until then the interface shows it as loading and connect_filters skips it.
+    */
+
+    loading_plugins.insert(name);
+
+    load_filter(name, [this, name](const std::shared_ptr<PluginBase>& filter) { on_filter_loaded(name, filter); });
+  }
+
+  // Emitted only after all of them were installed so that the first rewiring already sees the whole snapshot
+
+  for (const auto& name : from_snapshots) {
+    plugin_loaded.emit(name);
+  }
+}
+
+void EffectsBase::load_filter(const std::string& name,
+                              std::function<void(const std::shared_ptr<PluginBase>&)> on_loaded) {
+  auto instance_id = util::to_string(tags::plugin_name::get_id(name));
+
+  auto path = schema_base_path + tags::plugin_name::get_base_name(name) + "/" + instance_id + "/";
+
+  path.erase(std::remove(path.begin(), path.end(), '_'), path.end());
+
+  loader_state->n_loading.fetch_add(1U);
+
+  PluginLoader::get().submit([this, state = loader_state, name, path, instance_id, on_loaded = std::move(on_loaded)] {
+    auto filter = make_filter(name, path, instance_id);
+
+    util::idle_add([state, filter, on_loaded] {
+      if (state->alive) {
+        on_loaded(filter);
+      }
+    });
+
+    // Only the shared state is used from here on. This object may be destroyed as soon as the counter reaches zero.
+
+    state->n_loading.fetch_sub(1U);
+
+    state->n_loading.notify_all();
+  });
+}
+
+auto EffectsBase::make_filter(const std::string& name, const std::string& path, const std::string& instance_id) const
+    -> std::shared_ptr<PluginBase> {
+  const tracer::Span span([&] { return log_tag + "construct " + name; });
+
+  std::shared_ptr<PluginBase> filter;
+
+  if (name.starts_with(tags::plugin_name::autogain)) {
+    filter = std::make_shared<AutoGain>(log_tag, tags::schema::autogain::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::bass_enhancer)) {
+    filter = std::make_shared<BassEnhancer>(log_tag, tags::schema::bass_enhancer::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::bass_loudness)) {
+    filter = std::make_shared<BassLoudness>(log_tag, tags::schema::bass_loudness::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::compressor)) {
+    filter = std::make_shared<Compressor>(log_tag, tags::schema::compressor::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::convolver)) {
+    filter = std::make_shared<Convolver>(log_tag, tags::schema::convolver::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::crossfeed)) {
+    filter = std::make_shared<Crossfeed>(log_tag, tags::schema::crossfeed::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::crystalizer)) {
+    filter = std::make_shared<Crystalizer>(log_tag, tags::schema::crystalizer::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::deepfilternet)) {
+    filter = std::make_shared<DeepFilterNet>(log_tag, tags::schema::deepfilternet::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::deesser)) {
+    filter = std::make_shared<Deesser>(log_tag, tags::schema::deesser::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::delay)) {
+    filter = std::make_shared<Delay>(log_tag, tags::schema::delay::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::echo_canceller)) {
+    filter = std::make_shared<EchoCanceller>(log_tag, tags::schema::echo_canceller::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::exciter)) {
+    filter = std::make_shared<Exciter>(log_tag, tags::schema::exciter::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::expander)) {
+    filter = std::make_shared<Expander>(log_tag, tags::schema::expander::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::equalizer)) {
+    filter = std::make_shared<Equalizer>(
+        log_tag, tags::schema::equalizer::id, path, tags::schema::equalizer::channel_id,
+        schema_base_path + "equalizer/" + instance_id + "/leftchannel/",
+        schema_base_path + "equalizer/" + instance_id + "/rightchannel/", pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::filter)) {
+    filter = std::make_shared<Filter>(log_tag, tags::schema::filter::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::gate)) {
+    filter = std::make_shared<Gate>(log_tag, tags::schema::gate::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::level_meter)) {
+    filter = std::make_shared<LevelMeter>(log_tag, tags::schema::level_meter::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::limiter)) {
+    filter = std::make_shared<Limiter>(log_tag, tags::schema::limiter::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::loudness)) {
+    filter = std::make_shared<Loudness>(log_tag, tags::schema::loudness::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::maximizer)) {
+    filter = std::make_shared<Maximizer>(log_tag, tags::schema::maximizer::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::multiband_compressor)) {
+    filter = std::make_shared<MultibandCompressor>(log_tag, tags::schema::multiband_compressor::id, path, pm,
+                                                   pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::multiband_gate)) {
+    filter = std::make_shared<MultibandGate>(log_tag, tags::schema::multiband_gate::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::pitch)) {
+    filter = std::make_shared<Pitch>(log_tag, tags::schema::pitch::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::reverb)) {
+    filter = std::make_shared<Reverb>(log_tag, tags::schema::reverb::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::rnnoise)) {
+    filter = std::make_shared<RNNoise>(log_tag, tags::schema::rnnoise::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::speex)) {
+    filter = std::make_shared<Speex>(log_tag, tags::schema::speex::id, path, pm, pipeline_type);
+  } else if (name.starts_with(tags::plugin_name::stereo_tools)) {
+    filter = std::make_shared<StereoTools>(log_tag, tags::schema::stereo_tools::id, path, pm, pipeline_type);
+  }
+
+  return filter;
+}
+
+void EffectsBase::on_filter_loaded(const std::string& name, const std::shared_ptr<PluginBase>& filter) {
+  loading_plugins.erase(name);
+
+  if (filter == nullptr) {
+    return;
+  }
+
+  // The plugin may have been removed from the list while it was loading
+
+  if (const auto list = util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
+      std::ranges::find(list, name) == list.end()) {
+    return;
+  }
+
+  install_filter(name, filter);
+
+  util::debug(log_tag + name + " loaded");
+
+  plugin_loaded.emit(name);
+
+  broadcast_pipeline_latency();
+}
+
+void EffectsBase::install_filter(const std::string& name, const std::shared_ptr<PluginBase>& filter) {
+  filter->notification_time_window = spectrum->notification_time_window;
+
+  connections.push_back(filter->latency.connect([this]() { broadcast_pipeline_latency(); }));
+
+  plugins.insert(std::make_pair(name, filter));
+}
+
+auto EffectsBase::get_free_snapshot_id() const -> uint {
+  const auto list = util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
+
+  /*
+    The plugins map is checked too. It keeps the instances of snapshots that were active once, and their settings
+    paths must not be written again.
+  */
+
+  for (uint first = snapshot_id_block;; first += snapshot_id_block) {
+    const auto in_block = [&](const std::string& name) {
+      const auto id = tags::plugin_name::get_id(name);
+
+      return id >= first && id < first + snapshot_id_block;
+    };
+
+    if (std::ranges::any_of(list, in_block) || std::ranges::any_of(plugins | std::views::keys, in_block)) {
       continue;
     }
 
-    auto instance_id = util::to_string(tags::plugin_name::get_id(name));
-
-    auto path = schema_base_path + tags::plugin_name::get_base_name(name) + "/" + instance_id + "/";
-
-    path.erase(std::remove(path.begin(), path.end(), '_'), path.end());
-
-    std::shared_ptr<PluginBase> filter;
-
-    if (name.starts_with(tags::plugin_name::autogain)) {
-      filter = std::make_shared<AutoGain>(log_tag, tags::schema::autogain::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::bass_enhancer)) {
-      filter = std::make_shared<BassEnhancer>(log_tag, tags::schema::bass_enhancer::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::bass_loudness)) {
-      filter = std::make_shared<BassLoudness>(log_tag, tags::schema::bass_loudness::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::compressor)) {
-      filter = std::make_shared<Compressor>(log_tag, tags::schema::compressor::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::convolver)) {
-      filter = std::make_shared<Convolver>(log_tag, tags::schema::convolver::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::crossfeed)) {
-      filter = std::make_shared<Crossfeed>(log_tag, tags::schema::crossfeed::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::crystalizer)) {
-      filter = std::make_shared<Crystalizer>(log_tag, tags::schema::crystalizer::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::deepfilternet)) {
-      filter = std::make_shared<DeepFilterNet>(log_tag, tags::schema::deepfilternet::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::deesser)) {
-      filter = std::make_shared<Deesser>(log_tag, tags::schema::deesser::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::delay)) {
-      filter = std::make_shared<Delay>(log_tag, tags::schema::delay::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::echo_canceller)) {
-      filter = std::make_shared<EchoCanceller>(log_tag, tags::schema::echo_canceller::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::exciter)) {
-      filter = std::make_shared<Exciter>(log_tag, tags::schema::exciter::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::expander)) {
-      filter = std::make_shared<Expander>(log_tag, tags::schema::expander::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::equalizer)) {
-      filter = std::make_shared<Equalizer>(
-          log_tag, tags::schema::equalizer::id, path, tags::schema::equalizer::channel_id,
-          schema_base_path + "equalizer/" + instance_id + "/leftchannel/",
-          schema_base_path + "equalizer/" + instance_id + "/rightchannel/", pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::filter)) {
-      filter = std::make_shared<Filter>(log_tag, tags::schema::filter::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::gate)) {
-      filter = std::make_shared<Gate>(log_tag, tags::schema::gate::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::level_meter)) {
-      filter = std::make_shared<LevelMeter>(log_tag, tags::schema::level_meter::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::limiter)) {
-      filter = std::make_shared<Limiter>(log_tag, tags::schema::limiter::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::loudness)) {
-      filter = std::make_shared<Loudness>(log_tag, tags::schema::loudness::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::maximizer)) {
-      filter = std::make_shared<Maximizer>(log_tag, tags::schema::maximizer::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::multiband_compressor)) {
-      filter = std::make_shared<MultibandCompressor>(log_tag, tags::schema::multiband_compressor::id, path, pm,
-                                                     pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::multiband_gate)) {
-      filter = std::make_shared<MultibandGate>(log_tag, tags::schema::multiband_gate::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::pitch)) {
-      filter = std::make_shared<Pitch>(log_tag, tags::schema::pitch::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::reverb)) {
-      filter = std::make_shared<Reverb>(log_tag, tags::schema::reverb::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::rnnoise)) {
-      filter = std::make_shared<RNNoise>(log_tag, tags::schema::rnnoise::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::speex)) {
-      filter = std::make_shared<Speex>(log_tag, tags::schema::speex::id, path, pm, pipeline_type);
-    } else if (name.starts_with(tags::plugin_name::stereo_tools)) {
-      filter = std::make_shared<StereoTools>(log_tag, tags::schema::stereo_tools::id, path, pm, pipeline_type);
+    if (std::ranges::none_of(snapshots | std::views::values,
+                             [&](const auto& snapshot) { return std::ranges::any_of(snapshot.list, in_block); })) {
+      return first;
+    }
+  }
+}
+
+void EffectsBase::preload_snapshot(const std::string& preset_name,
+                                   const std::vector<std::string>& list,
+                                   const std::vector<std::string>& blocklist) {
+  remove_snapshot(preset_name);
+
+  auto& snapshot = snapshots[preset_name];
+
+  snapshot.list = list;
+  snapshot.blocklist = blocklist;
+  snapshot.n_pending = static_cast<uint>(list.size());
+  snapshot.generation = ++snapshot_generation;
+
+  util::debug(log_tag + "preloading the snapshot " + preset_name);
+
+  for (const auto& name : list) {
+    load_filter(name, [this, preset_name, generation = snapshot.generation, name](const auto& filter) {
+      on_snapshot_filter_loaded(preset_name, generation, name, filter);
+    });
+  }
+}
+
+void EffectsBase::on_snapshot_filter_loaded(const std::string& preset_name,
+                                            const uint& generation,
+                                            const std::string& name,
+                                            const std::shared_ptr<PluginBase>& filter) {
+  // The snapshot may have been removed or prepared again while its plugins were loading
+
+  const auto it = snapshots.find(preset_name);
+
+  if (it == snapshots.end() || it->second.generation != generation) {
+    return;
+  }
+
+  auto& snapshot = it->second;
+
+  snapshot.n_pending--;
+
+  if (filter != nullptr) {
+    /*
+      The plugin is not in any chain yet, so its setup can run here with the current rate and quantum instead of in
+      the first realtime cycle after the switch.
+    */
+
+    if (output_level->rate != 0U && output_level->n_samples != 0U) {
+      filter->prepare_process(output_level->rate, output_level->n_samples);
     }
 
-    connections.push_back(filter->latency.connect([this]() { broadcast_pipeline_latency(); }));
+    snapshot.plugins.insert(std::make_pair(name, filter));
+  }
+
+  if (snapshot.n_pending == 0U) {
+    util::debug(log_tag + "the snapshot " + preset_name + " is ready");
+  }
+}
+
+void EffectsBase::remove_snapshot(const std::string& preset_name) {
+  // Instances that are in the pipeline stay in the plugins map
+
+  snapshots.erase(preset_name);
+}
+
+auto EffectsBase::get_snapshots() const -> std::vector<std::string> {
+  std::vector<std::string> names;
+
+  for (const auto& name : snapshots | std::views::keys) {
+    names.push_back(name);
+  }
+
+  return names;
+}
+
+auto EffectsBase::is_snapshot_ready(const std::string& preset_name) const -> bool {
+  const auto it = snapshots.find(preset_name);
 
-    plugins.insert(std::make_pair(name, filter));
+  return it != snapshots.end() && it->second.n_pending == 0U;
+}
+
+auto EffectsBase::find_snapshot_filter(const std::string& name) const -> std::shared_ptr<PluginBase> {
+  for (const auto& snapshot : snapshots | std::views::values) {
+    if (const auto it = snapshot.plugins.find(name); it != snapshot.plugins.end()) {
+      return it->second;
+    }
   }
+
+  return nullptr;
+}
+
+auto EffectsBase::activate_snapshot(const std::string& preset_name) -> bool {
+  if (!is_snapshot_ready(preset_name)) {
+    return false;
+  }
+
+  const tracer::Span span([&] { return log_tag + "activate snapshot " + preset_name; });
+
+  const auto& snapshot = snapshots.at(preset_name);
+
+  util::debug(log_tag + "activating the snapshot " + preset_name);
+
+  /*
+    The changed signals are emitted synchronously. create_filters_if_necessary takes the prepared instances from the
+    snapshot and connect_filters switches the chain while the crossfade is set.
+  */
+
+  snapshot_crossfade = 0.001F * static_cast<float>(g_settings_get_double(settings, "snapshot-crossfade"));
+
+  g_settings_set_strv(settings, "blocklist", util::make_gchar_pointer_vector(snapshot.blocklist).data());
+
+  g_settings_set_strv(settings, "plugins", util::make_gchar_pointer_vector(snapshot.list).data());
+
+  snapshot_crossfade = 0.0F;
+
+  return true;
+}
+
+auto EffectsBase::is_plugin_ready(const std::string& name) const -> bool {
+  return plugins.contains(name);
+}
+
+auto EffectsBase::has_loading_plugins() const -> bool {
+  return !loading_plugins.empty();
 }
 
 void EffectsBase::remove_unused_filters() {
@@ -311,8 +551,204 @@ void EffectsBase::broadcast_pipeline_latency() {
   util::debug(log_tag + "pipeline latency: " + util::to_string(latency_value, "") + " ms");
 
   pipeline_latency.emit(latency_value);
+
+  if (fused_chain->connected_to_pw) {
+    fused_chain->update_latency();
+  }
 }
 
 auto EffectsBase::get_plugins_map() -> std::map<std::string, std::shared_ptr<PluginBase>> {
   return plugins;
 }
+
+auto EffectsBase::get_selected_plugins(const std::vector<std::string>& list)
+    -> std::vector<std::shared_ptr<PluginBase>> {
+  std::vector<std::shared_ptr<PluginBase>> selected;
+
+  for (const auto& name : list) {
+    if (plugins.contains(name)) {
+      selected.push_back(plugins[name]);
+    }
+  }
+
+  return selected;
+}
+
+void EffectsBase::connect_concurrently(const std::vector<std::shared_ptr<PluginBase>>& filters) {
+  std::vector<std::shared_ptr<PluginBase>> requested;
+
+  for (const auto& filter : filters) {
+    if (!filter->connected_to_pw && filter->request_connection()) {
+      requested.push_back(filter);
+    }
+  }
+
+  if (requested.empty()) {
+    return;
+  }
+
+  const tracer::Span span(
+      [&] { return log_tag + "connect_to_pw " + util::to_string(requested.size()) + " filters"; });
+
+  /*
+    PipeWire creates all the requested nodes at the same time. A single wait covers the whole set instead of one wait
+    per filter. finish_connection() returns right away for the filters that are already settled.
+  */
+
+  pm->wait_until([&] { return std::ranges::all_of(requested, [](const auto& f) { return f->connection_settled(); }); });
+
+  for (const auto& filter : requested) {
+    filter->finish_connection();
+  }
+}
+
+auto EffectsBase::use_fused_chain(const std::vector<std::string>& list) -> bool {
+  if (g_settings_get_boolean(settings, "fused-pipeline") == 0) {
+    return false;
+  }
+
+  if (!FusedChain::can_fuse(get_selected_plugins(list))) {
+    util::debug(log_tag + "the selected plugins need probe links. The pipeline will not be fused.");
+
+    return false;
+  }
+
+  return true;
+}
+
+auto EffectsBase::connect_fused_chain(const std::vector<std::string>& list) -> bool {
+  const auto selected = get_selected_plugins(list);
+
+  /*
+    The plugins in the chain are run by the fused filter. Their own nodes have to stay out of the graph or they would
+    be processing the same instance from two realtime callbacks.
+  */
+
+  for (const auto& plugin : selected) {
+    if (plugin->connected_to_pw) {
+      plugin->disconnect_from_pw();
+    }
+  }
+
+  fused_chain->set_chain(selected, snapshot_crossfade);
+
+  snapshot_crossfade = 0.0F;
+
+  fused_chain->notification_time_window = spectrum->notification_time_window;
+
+  if (!fused_chain->connected_to_pw && !fused_chain->connect_to_pw()) {
+    fused_chain->clear_chain();
+
+    return false;
+  }
+
+  fused_chain->update_latency();
+
+  return true;
+}
+
+void EffectsBase::disconnect_fused_chain() {
+  if (fused_chain->connected_to_pw) {
+    fused_chain->disconnect_from_pw();
+  }
+
+  fused_chain->clear_chain();
+}
+
+void EffectsBase::link_chain(const std::vector<uint>& nodes,
+                             const std::vector<std::pair<uint, uint>>& probe_edges,
+                             const uint& device_node_id) {
+  const tracer::Span span([&] { return log_tag + "link_chain"; });
+
+  const auto n_channels = static_cast<uint>(pm->channel_positions.size());
+
+  std::set<std::pair<uint, uint>> path;
+
+  GraphTransaction transaction(pm);
+
+  if (!nodes.empty()) {
+    uint prev_node_id = nodes.front();
+
+    for (size_t n = 1U; n < nodes.size(); n++) {
+      const auto next_node_id = nodes[n];
+
+      const std::pair edge{prev_node_id, next_node_id};
+
+      if (chain_links.contains(edge)) {
+        path.insert(edge);
+
+        prev_node_id = next_node_id;
+
+        continue;
+      }
+
+      const auto n_links = transaction.link_nodes(prev_node_id, next_node_id);
+
+      // A mono microphone or a stereo output device are fine even when the pipeline has more channels
+
+      const auto touches_device = prev_node_id == device_node_id || next_node_id == device_node_id;
+
+      if (n_links == n_channels || (touches_device && n_links != 0U)) {
+        path.insert(edge);
+
+        prev_node_id = next_node_id;
+      } else {
+        util::warning(log_tag + "link from node " + util::to_string(prev_node_id) + " to node " +
+                      util::to_string(next_node_id) + " failed");
+      }
+    }
+  }
+
+  for (const auto& edge : probe_edges) {
+    if (chain_links.contains(edge) || transaction.link_nodes(edge.first, edge.second, true) != 0U) {
+      path.insert(edge);
+    }
+  }
+
+  /*
+    The old edges are removed in the same transaction that creates the new ones. commit() destroys before it creates,
+    under a single loop lock, so an input port is never fed by the old and the new source at once. That would sum the
+    dry and the processed signals. Only the ports whose source changes are touched, and the edges kept in the path
+    carry audio the whole time. Links of edges that were rejected above are also removed here.
+  */
+
+  for (auto it = chain_links.begin(); it != chain_links.end();) {
+    if (path.contains(it->first)) {
+      ++it;
+
+      continue;
+    }
+
+    transaction.destroy_links(it->second);
+
+    it = chain_links.erase(it);
+  }
+
+  for (const auto& link : transaction.commit().links) {
+    chain_links[{link.output_node_id, link.input_node_id}].push_back(link.proxy);
+  }
+}
+
+void EffectsBase::unlink_chain(GraphTransaction& transaction) {
+  for (const auto& proxies : chain_links | std::views::values) {
+    transaction.destroy_links(proxies);
+  }
+
+  chain_links.clear();
+}
+
+void EffectsBase::disconnect_unused_filters(const std::vector<std::string>& list, const bool& fused_chain_in_use) {
+  // The map keys carry the instance id. PluginBase::name is only the base name of the plugin.
+
+  for (const auto& [name, plugin] : plugins) {
+    if (plugin->connected_to_pw && std::ranges::find(list, name) == list.end()) {
+      util::debug(log_tag + "disconnecting the " + name + " filter from PipeWire");
+
+      plugin->disconnect_from_pw();
+    }
+  }
+
+  if (!fused_chain_in_use) {
+    disconnect_fused_chain();
+  }
+}
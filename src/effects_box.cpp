@@ -27,8 +27,6 @@
 #include <glib.h>
 #include <glib/gi18n.h>
 #include <gobject/gobject.h>
-#include <gsl/gsl_interp.h>
-#include <gsl/gsl_spline.h>
 #include <gtk/gtk.h>
 #include <gtk/gtkshortcut.h>
 #include <sigc++/connection.h>
@@ -40,6 +38,7 @@
 #include "blocklist_menu.hpp"
 #include "chart.hpp"
 #include "effects_base.hpp"
+#include "meter_board.hpp"
 #include "pipeline_type.hpp"
 #include "plugins_box.hpp"
 #include "tags_app.hpp"
@@ -66,11 +65,11 @@ struct Data {
 
   PipelineType pipeline_type;
 
-  uint spectrum_rate, spectrum_n_bands;
+  uint spectrum_layout_serial;
 
-  float global_output_level_left, global_output_level_right, pipeline_latency_ms;
+  float pipeline_latency_ms;
 
-  std::vector<double> spectrum_mag, spectrum_x_axis, spectrum_freqs;
+  std::vector<double> spectrum_mag, spectrum_x_axis;
 
   std::vector<sigc::connection> connections;
 
@@ -110,36 +109,8 @@ struct _EffectsBox {
 // NOLINTNEXTLINE
 G_DEFINE_TYPE(EffectsBox, effects_box, GTK_TYPE_BOX)
 
-void init_spectrum_frequency_axis(EffectsBox* self) {
-  self->data->spectrum_freqs.resize(self->data->spectrum_n_bands);
-
-  for (uint n = 0U; n < self->data->spectrum_n_bands; n++) {
-    self->data->spectrum_freqs[n] = 0.5F * static_cast<float>(self->data->spectrum_rate) * static_cast<float>(n) /
-                                    static_cast<float>(self->data->spectrum_n_bands);
-  }
-
-  if (!self->data->spectrum_freqs.empty()) {
-    const auto min_freq = static_cast<float>(g_settings_get_int(self->settings_spectrum, "minimum-frequency"));
-    const auto max_freq = static_cast<float>(g_settings_get_int(self->settings_spectrum, "maximum-frequency"));
-
-    if (min_freq > (max_freq - 100.0F)) {
-      return;
-    }
-
-    auto log_x_axis = util::logspace(min_freq, max_freq, g_settings_get_int(self->settings_spectrum, "n-points"));
-
-    self->data->spectrum_x_axis.resize(log_x_axis.size());
-    self->data->spectrum_mag.resize(log_x_axis.size());
-
-    std::copy(log_x_axis.begin(), log_x_axis.end(), self->data->spectrum_x_axis.begin());
-
-    ui::chart::set_x_data(self->spectrum_chart, self->data->spectrum_x_axis);
-  }
-}
-
 void setup_spectrum(EffectsBox* self) {
-  self->data->spectrum_rate = 0U;
-  self->data->spectrum_n_bands = 0U;
+  self->data->spectrum_layout_serial = 0U;
 
   ui::chart::set_color(self->spectrum_chart, util::gsettings_get_color(self->settings_spectrum, "color"));
 
@@ -252,32 +223,6 @@ void setup_spectrum(EffectsBox* self) {
         }
       }),
       self));
-
-  self->data->gconnections_spectrum.push_back(g_signal_connect(
-      self->settings_spectrum, "changed::n-points", G_CALLBACK(+[](GSettings* settings, char* key, EffectsBox* self) {
-        g_object_ref(self);
-
-        util::idle_add([=]() { init_spectrum_frequency_axis(self); }, [=]() { g_object_unref(self); });
-      }),
-      self));
-
-  self->data->gconnections_spectrum.push_back(
-      g_signal_connect(self->settings_spectrum, "changed::minimum-frequency",
-                       G_CALLBACK(+[](GSettings* settings, char* key, EffectsBox* self) {
-                         g_object_ref(self);
-
-                         util::idle_add([=]() { init_spectrum_frequency_axis(self); }, [=]() { g_object_unref(self); });
-                       }),
-                       self));
-
-  self->data->gconnections_spectrum.push_back(
-      g_signal_connect(self->settings_spectrum, "changed::maximum-frequency",
-                       G_CALLBACK(+[](GSettings* settings, char* key, EffectsBox* self) {
-                         g_object_ref(self);
-
-                         util::idle_add([=]() { init_spectrum_frequency_axis(self); }, [=]() { g_object_unref(self); });
-                       }),
-                       self));
 }
 
 void stack_visible_child_changed(EffectsBox* self, GParamSpec* pspec, GtkWidget* stack) {
@@ -303,42 +248,23 @@ static gboolean spectrum_data_update(GtkWidget* widget, GdkFrameClock* frame_clo
     return G_SOURCE_CONTINUE;
   }
 
-  auto [rate, n_bands, magnitudes] = self->data->effects_base->spectrum->compute_magnitudes();
+  // The analysis thread already did the fft and the reduction to the display points in dB.
 
-  // No new data available, no redraw required.
-  if (rate == 0 || n_bands == 0) {
+  const auto layout_serial = self->data->spectrum_layout_serial;
+
+  if (!self->data->effects_base->spectrum->get_display_data(self->data->spectrum_layout_serial,
+                                                            self->data->spectrum_x_axis, self->data->spectrum_mag)) {
     return G_SOURCE_CONTINUE;
   }
 
-  if (self->data->spectrum_rate != rate || self->data->spectrum_n_bands != n_bands) {
-    self->data->spectrum_rate = rate;
-    self->data->spectrum_n_bands = n_bands;
-
-    init_spectrum_frequency_axis(self);
+  if (self->data->spectrum_layout_serial != layout_serial) {
+    ui::chart::set_x_data(self->spectrum_chart, self->data->spectrum_x_axis);
   }
 
-  auto* acc = gsl_interp_accel_alloc();
-  auto* spline = gsl_spline_alloc(gsl_interp_steffen, n_bands);
-
-  gsl_spline_init(spline, self->data->spectrum_freqs.data(), magnitudes, n_bands);
-
-  for (size_t n = 0; n < self->data->spectrum_x_axis.size(); n++) {
-    self->data->spectrum_mag[n] = static_cast<float>(gsl_spline_eval(spline, self->data->spectrum_x_axis[n], acc));
+  if (self->data->spectrum_mag.size() != self->data->spectrum_x_axis.size()) {
+    return G_SOURCE_CONTINUE;
   }
 
-  gsl_spline_free(spline);
-  gsl_interp_accel_free(acc);
-
-  std::ranges::for_each(self->data->spectrum_mag, [](auto& v) {
-    v = 10.0F * std::log10(v);
-
-    if (!std::isinf(v)) {
-      v = (v > util::minimum_db_level) ? v : util::minimum_db_level;
-    } else {
-      v = util::minimum_db_level;
-    }
-  });
-
   ui::chart::set_y_data(self->spectrum_chart, self->data->spectrum_mag);
 
   return G_SOURCE_CONTINUE;
@@ -411,37 +337,17 @@ void setup(EffectsBox* self, app::Application* application, PipelineType pipelin
 
   // output level
 
-  self->data->connections.push_back(
-      self->data->effects_base->output_level->output_level.connect([=](const float left, const float right) {
-        self->data->global_output_level_left = left;
-        self->data->global_output_level_right = right;
-
-        if (!schedule_signal_idle) {
-          return;
-        }
+  ui::add_meter_tick_callback(
+      GTK_WIDGET(self), self->data->effects_base->output_level, [=](const MeterBoard::Slot& slot) {
+        const auto left = slot.output_left.load(std::memory_order_relaxed);
+        const auto right = slot.output_right.load(std::memory_order_relaxed);
 
-        g_idle_add((GSourceFunc) +
-                       [](EffectsBox* self) {
-                         if (!schedule_signal_idle) {
-                           return G_SOURCE_REMOVE;
-                         }
+        gtk_label_set_text(self->label_global_output_level_left, fmt::format("{0:.0f}", left).c_str());
 
-                         gtk_label_set_text(self->label_global_output_level_left,
-                                            fmt::format("{0:.0f}", self->data->global_output_level_left).c_str());
+        gtk_label_set_text(self->label_global_output_level_right, fmt::format("{0:.0f}", right).c_str());
 
-                         gtk_label_set_text(self->label_global_output_level_right,
-                                            fmt::format("{0:.0f}", self->data->global_output_level_right).c_str());
-
-                         gtk_widget_set_opacity(
-                             GTK_WIDGET(self->saturation_icon),
-                             (self->data->global_output_level_left > 0.0 || self->data->global_output_level_right > 0.0)
-                                 ? 1.0
-                                 : 0.0);
-
-                         return G_SOURCE_REMOVE;
-                       },
-                   self);
-      }));
+        gtk_widget_set_opacity(GTK_WIDGET(self->saturation_icon), (left > 0.0F || right > 0.0F) ? 1.0 : 0.0);
+      });
 
   // spectrum array
 
@@ -31,6 +31,7 @@
 #include <string>
 #include <vector>
 #include "exciter.hpp"
+#include "meter_board.hpp"
 #include "tags_resources.hpp"
 #include "tags_schema.hpp"
 #include "ui_helpers.hpp"
@@ -98,54 +99,20 @@ void setup(ExciterBox* self, std::shared_ptr<Exciter> exciter, const std::string
 
   exciter->set_post_messages(true);
 
-  self->data->connections.push_back(exciter->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(exciter->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(exciter->harmonics.connect([=](const double value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LEVEL_BAR(self->harmonics_levelbar) || !GTK_IS_LABEL(self->harmonics_levelbar_label)) {
-            return;
-          }
-
-          gtk_level_bar_set_value(self->harmonics_levelbar, value);
-          gtk_label_set_text(self->harmonics_levelbar_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+  ui::bind_level_meters(GTK_WIDGET(self), exciter, self->input_level_left, self->input_level_left_label,
+                        self->input_level_right, self->input_level_right_label, self->output_level_left,
+                        self->output_level_left_label, self->output_level_right, self->output_level_right_label);
+
+  ui::add_meter_tick_callback(GTK_WIDGET(self), exciter, [=](const MeterBoard::Slot& slot) {
+    if (!GTK_IS_LEVEL_BAR(self->harmonics_levelbar) || !GTK_IS_LABEL(self->harmonics_levelbar_label)) {
+      return;
+    }
+
+    const auto harmonics = static_cast<double>(slot.get_extra(Exciter::harmonics_meter));
+
+    gtk_level_bar_set_value(self->harmonics_levelbar, harmonics);
+    gtk_label_set_text(self->harmonics_levelbar_label, fmt::format("{0:.0f}", util::linear_to_db(harmonics)).c_str());
+  });
 
   gtk_label_set_text(self->plugin_credit, ui::get_plugin_credit_translated(self->data->exciter->package).c_str());
 
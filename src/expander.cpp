@@ -204,10 +204,12 @@ void Expander::process(std::span<float>& left_in,
       envelope_port_value =
           0.5F * (lv2_wrapper->get_control_port_value("elm_l") + lv2_wrapper->get_control_port_value("elm_r"));
 
-      reduction.emit(reduction_port_value);
-      sidechain.emit(sidechain_port_value);
-      curve.emit(curve_port_value);
-      envelope.emit(envelope_port_value);
+      if (meter_slot != nullptr) {
+        meter_slot->set_extra(reduction_meter, reduction_port_value);
+        meter_slot->set_extra(sidechain_meter, sidechain_port_value);
+        meter_slot->set_extra(curve_meter, curve_port_value);
+        meter_slot->set_extra(envelope_meter, envelope_port_value);
+      }
 
       notify();
     }
@@ -215,6 +217,10 @@ void Expander::process(std::span<float>& left_in,
 }
 
 void Expander::update_sidechain_links(const std::string& key) {
+  if (pm == nullptr) {
+    return;
+  }
+
   if (util::gsettings_get_string(settings, "sidechain-type") != "External") {
     pm->destroy_links(list_proxies);
 
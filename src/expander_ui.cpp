@@ -35,6 +35,7 @@
 #include <string>
 #include <vector>
 #include "expander.hpp"
+#include "meter_board.hpp"
 #include "node_info_holder.hpp"
 #include "pipe_manager.hpp"
 #include "pipe_objects.hpp"
@@ -159,107 +160,26 @@ void setup(ExpanderBox* self, std::shared_ptr<Expander> expander, const std::str
     }
   }
 
-  self->data->connections.push_back(expander->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
+  ui::bind_level_meters(GTK_WIDGET(self), expander, self->input_level_left, self->input_level_left_label,
+                        self->input_level_right, self->input_level_right_label, self->output_level_left,
+                        self->output_level_left_label, self->output_level_right, self->output_level_right_label);
 
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(expander->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(expander->reduction.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->gain_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->gain_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(expander->envelope.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->envelope_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->envelope_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(expander->sidechain.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->sidechain_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->sidechain_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(expander->curve.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
+  ui::add_meter_tick_callback(GTK_WIDGET(self), expander, [=](const MeterBoard::Slot& slot) {
+    if (!GTK_IS_LABEL(self->gain_label) || !GTK_IS_LABEL(self->envelope_label) ||
+        !GTK_IS_LABEL(self->sidechain_label) || !GTK_IS_LABEL(self->curve_label)) {
+      return;
+    }
 
-          if (!GTK_IS_LABEL(self->curve_label)) {
-            return;
-          }
+    const auto reduction = slot.get_extra(Expander::reduction_meter);
+    const auto envelope = slot.get_extra(Expander::envelope_meter);
+    const auto sidechain = slot.get_extra(Expander::sidechain_meter);
+    const auto curve = slot.get_extra(Expander::curve_meter);
 
-          gtk_label_set_text(self->curve_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+    gtk_label_set_text(self->gain_label, fmt::format("{0:.0f}", util::linear_to_db(reduction)).c_str());
+    gtk_label_set_text(self->envelope_label, fmt::format("{0:.0f}", util::linear_to_db(envelope)).c_str());
+    gtk_label_set_text(self->sidechain_label, fmt::format("{0:.0f}", util::linear_to_db(sidechain)).c_str());
+    gtk_label_set_text(self->curve_label, fmt::format("{0:.0f}", util::linear_to_db(curve)).c_str());
+  });
 
   self->data->connections.push_back(pm->source_added.connect([=](const NodeInfo info) {
     for (guint n = 0U; n < g_list_model_get_n_items(G_LIST_MODEL(self->input_devices_model)); n++) {
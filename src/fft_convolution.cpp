@@ -0,0 +1,130 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fft_convolution.hpp"
+#include <fftw3.h>
+#include <algorithm>
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+FftConvolution::FftConvolution(const size_t& partition_size)
+    : partition_size(partition_size), fft_size(2U * partition_size), n_bins(partition_size + 1U) {
+  real_buffer = fftwf_alloc_real(fft_size);
+  complex_buffer = fftwf_alloc_complex(n_bins);
+
+  plan_forward = fftwf_plan_dft_r2c_1d(static_cast<int>(fft_size), real_buffer, complex_buffer, FFTW_ESTIMATE);
+  plan_backward = fftwf_plan_dft_c2r_1d(static_cast<int>(fft_size), complex_buffer, real_buffer, FFTW_ESTIMATE);
+}
+
+FftConvolution::~FftConvolution() {
+  fftwf_destroy_plan(plan_forward);
+  fftwf_destroy_plan(plan_backward);
+
+  fftwf_free(real_buffer);
+  fftwf_free(complex_buffer);
+}
+
+auto FftConvolution::transform_blocks(const std::vector<float>& x, const std::atomic<bool>& cancel)
+    -> std::vector<std::vector<std::complex<float>>> {
+  const auto n_blocks = (x.size() + partition_size - 1U) / partition_size;
+
+  std::vector<std::vector<std::complex<float>>> spectra(n_blocks);
+
+  auto* const spectrum = reinterpret_cast<std::complex<float>*>(complex_buffer);
+
+  for (size_t n = 0U; n < n_blocks && !cancel.load(); n++) {
+    const auto offset = n * partition_size;
+    const auto count = std::min(partition_size, x.size() - offset);
+
+    // The second half stays zero so that the circular convolution of two blocks does not wrap around
+
+    std::fill(real_buffer, real_buffer + fft_size, 0.0F);
+    std::copy_n(x.begin() + static_cast<std::ptrdiff_t>(offset), count, real_buffer);
+
+    fftwf_execute(plan_forward);
+
+    spectra[n].assign(spectrum, spectrum + n_bins);
+  }
+
+  return spectra;
+}
+
+auto FftConvolution::process(const std::vector<float>& a,
+                             const std::vector<float>& b,
+                             const std::function<void(const float&)>& on_progress,
+                             const std::atomic<bool>& cancel) -> std::vector<float> {
+  if (a.empty() || b.empty()) {
+    return {};
+  }
+
+  const auto spectra_a = transform_blocks(a, cancel);
+  const auto spectra_b = transform_blocks(b, cancel);
+
+  if (cancel.load()) {
+    return {};
+  }
+
+  const auto n_a = spectra_a.size();
+  const auto n_b = spectra_b.size();
+  const auto n_output_blocks = n_a + n_b - 1U;
+
+  std::vector<float> output(a.size() + b.size() - 1U, 0.0F);
+
+  auto* const spectrum = reinterpret_cast<std::complex<float>*>(complex_buffer);
+
+  // fftw does not normalize the inverse transform
+
+  const auto scale = 1.0F / static_cast<float>(fft_size);
+
+  for (size_t k = 0U; k < n_output_blocks; k++) {
+    if (cancel.load()) {
+      return {};
+    }
+
+    std::fill(spectrum, spectrum + n_bins, std::complex<float>(0.0F, 0.0F));
+
+    const auto first = (k >= n_b) ? k - n_b + 1U : 0U;
+    const auto last = std::min(k, n_a - 1U);
+
+    for (size_t i = first; i <= last; i++) {
+      const auto& block_a = spectra_a[i];
+      const auto& block_b = spectra_b[k - i];
+
+      for (size_t m = 0U; m < n_bins; m++) {
+        spectrum[m] += block_a[m] * block_b[m];
+      }
+    }
+
+    fftwf_execute(plan_backward);
+
+    const auto offset = k * partition_size;
+    const auto count = std::min(fft_size, output.size() - offset);
+
+    for (size_t n = 0U; n < count; n++) {
+      output[offset + n] += scale * real_buffer[n];
+    }
+
+    on_progress(static_cast<float>(k + 1U) / static_cast<float>(n_output_blocks));
+  }
+
+  return output;
+}
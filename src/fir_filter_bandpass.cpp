@@ -18,8 +18,6 @@
  */
 
 #include "fir_filter_bandpass.hpp"
-#include <algorithm>
-#include <cstddef>
 #include <string>
 #include <utility>
 #include "fir_filter_base.hpp"
@@ -29,30 +27,12 @@ FirFilterBandpass::FirFilterBandpass(std::string tag) : FirFilterBase(std::move(
 FirFilterBandpass::~FirFilterBandpass() = default;
 
 void FirFilterBandpass::setup() {
-  const auto lowpass_kernel = create_lowpass_kernel(max_frequency, transition_band);
+  kernel = create_bandpass_kernel(min_frequency, max_frequency, transition_band);
 
-  // high-pass kernel
-
-  auto highpass_kernel = create_lowpass_kernel(min_frequency, transition_band);
-
-  std::ranges::for_each(highpass_kernel, [](auto& v) { v *= -1.0F; });
-
-  highpass_kernel[(highpass_kernel.size() - 1U) / 2U] += 1.0F;
-
-  kernel.resize(highpass_kernel.size());
-
-  /*
-    Creating a bandpass from a band reject through spectral inversion https://www.dspguide.com/ch16/4.htm
-  */
-
-  for (size_t n = 0U; n < kernel.size(); n++) {
-    kernel[n] = lowpass_kernel[n] + highpass_kernel[n];
+  if (kernel.empty()) {
+    return;
   }
 
-  std::ranges::for_each(kernel, [](auto& v) { v *= -1.0F; });
-
-  kernel[(kernel.size() - 1U) / 2U] += 1.0F;
-
   delay = 0.5F * static_cast<float>(kernel.size() - 1U) / static_cast<float>(rate);
 
   setup_zita();
@@ -0,0 +1,63 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fir_filter_bank.hpp"
+#include <sys/types.h>
+#include <span>
+#include <string>
+#include <utility>
+#include "fir_filter_base.hpp"
+
+FirFilterBank::FirFilterBank(std::string tag) : FirFilterBase(std::move(tag)) {}
+
+FirFilterBank::~FirFilterBank() = default;
+
+void FirFilterBank::set_band_edges(std::span<const float> edges) {
+  band_edges.assign(edges.begin(), edges.end());
+}
+
+void FirFilterBank::setup() {
+  kernels.clear();
+
+  for (size_t n = 0U; n + 1U < band_edges.size(); n++) {
+    kernels.push_back(create_bandpass_kernel(band_edges[n], band_edges[n + 1U], transition_band));
+  }
+
+  if (kernels.empty() || kernels.front().empty()) {
+    return;
+  }
+
+  // All kernels share the transition band and therefore the length and the delay.
+
+  delay = 0.5F * static_cast<float>(kernels.front().size() - 1U) / static_cast<float>(rate);
+
+  setup_zita(kernels);
+}
+
+auto FirFilterBank::is_ready() const -> bool {
+  return zita_ready;
+}
+
+auto FirFilterBank::get_band_left(const uint& band) const -> std::span<float> {
+  return {conv->outdata(2U * band), n_samples};
+}
+
+auto FirFilterBank::get_band_right(const uint& band) const -> std::span<float> {
+  return {conv->outdata(2U * band + 1U), n_samples};
+}
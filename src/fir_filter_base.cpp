@@ -18,38 +18,24 @@
  */
 
 #include "fir_filter_base.hpp"
-#include <sched.h>
 #include <sys/types.h>
-#include <zita-convolver.h>
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <memory>
 #include <numbers>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
+#include "partitioned_convolver.hpp"
 #include "util.hpp"
 
-namespace {
-
-constexpr auto CONVPROC_SCHEDULER_PRIORITY = 0;
-
-constexpr auto CONVPROC_SCHEDULER_CLASS = SCHED_FIFO;
-
-}  // namespace
-
-FirFilterBase::FirFilterBase(std::string tag) : log_tag(std::move(tag)) {}
+FirFilterBase::FirFilterBase(std::string tag)
+    : log_tag(std::move(tag)), conv(std::make_unique<PartitionedConvolver>(log_tag)) {}
 
 FirFilterBase::~FirFilterBase() {
   zita_ready = false;
-
-  if (conv != nullptr) {
-    conv->stop_process();
-
-    conv->cleanup();
-
-    delete conv;
-  }
 }
 
 void FirFilterBase::set_rate(const uint& value) {
@@ -143,26 +129,71 @@ auto FirFilterBase::create_lowpass_kernel(const float& cutoff, const float& tran
   return output;
 }
 
+auto FirFilterBase::create_bandpass_kernel(const float& min_frequency,
+                                           const float& max_frequency,
+                                           const float& transition_band) const -> std::vector<float> {
+  const auto lowpass_kernel = create_lowpass_kernel(max_frequency, transition_band);
+
+  // high-pass kernel
+
+  auto highpass_kernel = create_lowpass_kernel(min_frequency, transition_band);
+
+  std::vector<float> output;
+
+  if (lowpass_kernel.empty() || highpass_kernel.empty()) {
+    return output;
+  }
+
+  std::ranges::for_each(highpass_kernel, [](auto& v) { v *= -1.0F; });
+
+  highpass_kernel[(highpass_kernel.size() - 1U) / 2U] += 1.0F;
+
+  output.resize(highpass_kernel.size());
+
+  /*
+    Creating a bandpass from a band reject through spectral inversion https://www.dspguide.com/ch16/4.htm
+  */
+
+  for (size_t n = 0U; n < output.size(); n++) {
+    output[n] = lowpass_kernel[n] + highpass_kernel[n];
+  }
+
+  std::ranges::for_each(output, [](auto& v) { v *= -1.0F; });
+
+  output[(output.size() - 1U) / 2U] += 1.0F;
+
+  return output;
+}
+
 void FirFilterBase::setup_zita() {
+  setup_zita(std::span<const std::vector<float>>(&kernel, 1U));
+}
+
+void FirFilterBase::setup_zita(std::span<const std::vector<float>> kernels) {
   zita_ready = false;
 
-  if (n_samples == 0U || kernel.empty()) {
+  if (n_samples == 0U || kernels.empty()) {
     return;
   }
 
-  if (conv != nullptr) {
-    conv->stop_process();
+  size_t max_kernel_size = 0U;
 
-    conv->cleanup();
+  for (const auto& k : kernels) {
+    if (k.empty()) {
+      return;
+    }
 
-    delete conv;
+    max_kernel_size = std::max(max_kernel_size, k.size());
   }
 
-  conv = new Convproc();
+  /*
+    Both channels are convolved with every kernel. Zita transforms each input block once and shares it among all the
+    outputs fed by that input, so adding kernels only adds the spectral products and the inverse transforms.
+  */
 
-  conv->set_options(0);
+  const auto n_outputs = 2U * static_cast<uint>(kernels.size());
 
-  int ret = conv->configure(2, 2, kernel.size(), n_samples, n_samples, n_samples, 0.0F /*density*/);
+  int ret = conv->configure(2, n_outputs, static_cast<uint>(max_kernel_size), n_samples, rate);
 
   if (ret != 0) {
     util::warning(log_tag + "can't initialise zita-convolver engine: " + util::to_string(ret, ""));
@@ -170,29 +201,30 @@ void FirFilterBase::setup_zita() {
     return;
   }
 
-  ret = conv->impdata_create(0, 0, 1, kernel.data(), 0, static_cast<int>(kernel.size()));
+  for (uint n = 0U; n < kernels.size(); n++) {
+    ret = conv->impdata_create(0, 2U * n, kernels[n]);
 
-  if (ret != 0) {
-    util::warning(log_tag + "left impdata_create failed: " + util::to_string(ret, ""));
+    if (ret != 0) {
+      util::warning(log_tag + "left impdata_create failed: " + util::to_string(ret, ""));
 
-    return;
-  }
+      return;
+    }
 
-  ret = conv->impdata_create(1, 1, 1, kernel.data(), 0, static_cast<int>(kernel.size()));
+    ret = conv->impdata_create(1, 2U * n + 1U, kernels[n]);
 
-  if (ret != 0) {
-    util::warning(log_tag + "right impdata_create failed: " + util::to_string(ret, ""));
+    if (ret != 0) {
+      util::warning(log_tag + "right impdata_create failed: " + util::to_string(ret, ""));
 
-    return;
+      return;
+    }
   }
 
-  ret = conv->start_process(CONVPROC_SCHEDULER_PRIORITY, CONVPROC_SCHEDULER_CLASS);
+  ret = conv->start_process();
 
   if (ret != 0) {
     util::warning(log_tag + "start_process failed: " + util::to_string(ret, ""));
 
     conv->stop_process();
-    conv->cleanup();
 
     return;
   }
@@ -0,0 +1,333 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "fused_chain.hpp"
+#include <sys/types.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#include "pipe_manager.hpp"
+#include "plugin_base.hpp"
+#include "tags_plugin_name.hpp"
+#include "util.hpp"
+
+FusedChain::FusedChain(const std::string& tag,
+                       const std::string& schema,
+                       const std::string& schema_path,
+                       PipeManager* pipe_manager,
+                       PipelineType pipe_type)
+    : PluginBase(tag, "fused_chain", tags::plugin_package::ee, schema, schema_path, pipe_manager, pipe_type) {}
+
+FusedChain::~FusedChain() {
+  if (connected_to_pw) {
+    disconnect_from_pw();
+  }
+
+  clear_chain();
+
+  util::debug(log_tag + name + " destroyed");
+}
+
+void FusedChain::setup() {
+  util::debug(log_tag + name + ": PipeWire blocksize: " + util::to_string(n_samples, ""));
+  util::debug(log_tag + name + ": PipeWire sampling rate: " + util::to_string(rate, ""));
+
+  buffers_a.assign(n_channels, std::vector<float>(n_samples, 0.0F));
+  buffers_b.assign(n_channels, std::vector<float>(n_samples, 0.0F));
+
+  buffers_fade.assign(n_channels, std::vector<float>(n_samples, 0.0F));
+
+  views_a.assign(buffers_a.begin(), buffers_a.end());
+  views_b.assign(buffers_b.begin(), buffers_b.end());
+  views_fade.assign(buffers_fade.begin(), buffers_fade.end());
+
+  silent_probe_left.assign(n_samples, 0.0F);
+  silent_probe_right.assign(n_samples, 0.0F);
+}
+
+void FusedChain::process(std::span<float>& left_in,
+                         std::span<float>& right_in,
+                         std::span<float>& left_out,
+                         std::span<float>& right_out) {
+  std::array<std::span<float>, 2U> inputs = {left_in, right_in};
+  std::array<std::span<float>, 2U> outputs = {left_out, right_out};
+
+  process(inputs, outputs);
+}
+
+void FusedChain::process(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs) {
+  /*
+    The chain and the crossfade state are only changed by the commands posted by set_chain() and clear_chain(). They
+    are run here without data_mutex, so the chain is never bypassed because the main thread holds the lock.
+  */
+
+  rt_commands.drain();
+
+  if (!previous_chain.empty() && !fade_pending && fade_position >= fade_length) {
+    finished_fade_generation.store(running_fade_generation, std::memory_order_release);
+  }
+
+  if (chain.empty() || views_a.size() < inputs.size() || buffers_a[0].size() < n_samples) {
+    for (size_t c = 0U; c < inputs.size(); c++) {
+      std::ranges::copy(inputs[c], outputs[c].begin());
+    }
+
+    return;
+  }
+
+  if (fade_pending) {
+    fade_length = static_cast<uint>(fade_seconds * static_cast<float>(rate));
+    fade_position = 0U;
+
+    fade_pending = false;
+  }
+
+  const auto n_used = inputs.size();
+
+  for (size_t c = 0U; c < n_used; c++) {
+    views_a[c] = std::span<float>(buffers_a[c].data(), n_samples);
+    views_b[c] = std::span<float>(buffers_b[c].data(), n_samples);
+    views_fade[c] = std::span<float>(buffers_fade[c].data(), n_samples);
+  }
+
+  const auto fading = fade_position < fade_length && !previous_chain.empty();
+
+  if (fading) {
+    run_chain(previous_chain, inputs, std::span<std::span<float>>(views_fade.data(), n_used));
+  }
+
+  run_chain(chain, inputs, outputs);
+
+  if (!fading) {
+    return;
+  }
+
+  // Linear gains. Both chains process the same input so their outputs are mostly correlated.
+
+  for (size_t c = 0U; c < n_used; c++) {
+    for (size_t n = 0U; n < n_samples; n++) {
+      const auto gain = std::min(1.0F, static_cast<float>(fade_position + n) / static_cast<float>(fade_length));
+
+      outputs[c][n] = gain * outputs[c][n] + (1.0F - gain) * views_fade[c][n];
+    }
+  }
+
+  fade_position += n_samples;
+}
+
+void FusedChain::run_chain(const std::vector<std::shared_ptr<PluginBase>>& list,
+                           std::span<std::span<float>> inputs,
+                           std::span<std::span<float>> outputs) {
+  /*
+    Each plugin reads from the output of the previous one. Two sets of scratch buffers are used alternately so that
+    input and output never alias. The first plugin reads the node input and the last one writes the given output.
+  */
+
+  const auto n_used = inputs.size();
+
+  std::span<float> probe_left(silent_probe_left.data(), n_samples);
+  std::span<float> probe_right(silent_probe_right.data(), n_samples);
+
+  std::span<std::span<float>> in = inputs;
+
+  for (size_t n = 0U; n < list.size(); n++) {
+    const bool is_last = n == list.size() - 1U;
+
+    std::span<std::span<float>> out =
+        is_last ? outputs : std::span<std::span<float>>(((n % 2U == 0U) ? views_a : views_b).data(), n_used);
+
+    const auto& plugin = list[n];
+
+    plugin->prepare_process(rate, n_samples);
+
+    if (!plugin->enable_probe) {
+      plugin->process(in, out);
+    } else {
+      plugin->process_with_probe(in, out, probe_left, probe_right);
+    }
+
+    plugin->finish_process();
+
+    in = out;
+  }
+}
+
+auto FusedChain::get_latency_seconds() -> float {
+  return latency_value;
+}
+
+void FusedChain::set_chain(const std::vector<std::shared_ptr<PluginBase>>& list, const float& crossfade_seconds) {
+  if (list == active_chain) {
+    return;
+  }
+
+  /*
+    A plugin can not run twice in the same quantum. The crossfade is only possible when the two chains do not share
+    any instance.
+  */
+
+  const auto shared = std::ranges::any_of(
+      list, [&](const auto& p) { return std::ranges::find(active_chain, p) != active_chain.end(); });
+
+  const auto crossfade = crossfade_seconds > 0.0F && !active_chain.empty() && !shared;
+
+  /*
+    The realtime thread swaps its vectors with the ones in the closure. The replaced vectors stay in the closure and
+    are released in the main thread, so the realtime thread never drops the last reference to a plugin.
+  */
+
+  for (const auto& plugin : list) {
+    plugin->fused_chain_users.fetch_add(1U, std::memory_order_relaxed);
+  }
+
+  if (crossfade) {
+    fade_generation++;
+  }
+
+  post_to_rt([this, next = list, previous = crossfade ? active_chain : std::vector<std::shared_ptr<PluginBase>>{},
+              fade = crossfade ? crossfade_seconds : 0.0F, generation = fade_generation]() mutable {
+    std::swap(chain, next);
+    std::swap(previous_chain, previous);
+
+    running_fade_generation = generation;
+
+    // With a crossfade the plugins of the replaced chain are still run from previous_chain
+
+    release_users(previous);
+
+    if (fade == 0.0F) {
+      release_users(next);
+    }
+
+    fade_seconds = fade;
+    fade_pending = fade > 0.0F;
+    fade_length = 0U;
+  });
+
+  // Without a crossfade the closure already released the previous chain
+
+  if (crossfade) {
+    schedule_fade_cleanup();
+  } else {
+    cancel_fade_cleanup();
+  }
+
+  active_chain = list;
+
+  std::string names;
+
+  for (const auto& plugin : active_chain) {
+    names += plugin->name + " ";
+  }
+
+  util::debug(log_tag + name + " running in a single node: " + names);
+}
+
+void FusedChain::clear_chain() {
+  post_to_rt([this, next = std::vector<std::shared_ptr<PluginBase>>{},
+              previous = std::vector<std::shared_ptr<PluginBase>>{}]() mutable {
+    std::swap(chain, next);
+    std::swap(previous_chain, previous);
+
+    release_users(next);
+    release_users(previous);
+
+    fade_length = 0U;
+    fade_pending = false;
+  });
+
+  cancel_fade_cleanup();
+
+  active_chain.clear();
+}
+
+void FusedChain::schedule_fade_cleanup() {
+  if (fade_cleanup_source != 0U) {
+    return;
+  }
+
+  /*
+    Once the last crossfade is over the previous chain is swapped with an empty vector. Its instances, possibly those
+    of a snapshot that is no longer active, are then released in the main thread instead of at the next set_chain().
+    While nobody runs process() the fade can not finish and the chain is released right away.
+  */
+
+  fade_cleanup_source = g_timeout_add(100U, GSourceFunc(+[](FusedChain* self) {
+                                        const auto fade_is_over =
+                                            self->finished_fade_generation.load(std::memory_order_acquire) ==
+                                            self->fade_generation;
+
+                                        if (!fade_is_over && !self->is_idle()) {
+                                          return G_SOURCE_CONTINUE;
+                                        }
+
+                                        self->fade_cleanup_source = 0U;
+
+                                        self->release_previous_chain();
+
+                                        return G_SOURCE_REMOVE;
+                                      }),
+                                      this);
+}
+
+void FusedChain::release_previous_chain() {
+  post_to_rt([this, previous = std::vector<std::shared_ptr<PluginBase>>{}]() mutable {
+    std::swap(previous_chain, previous);
+
+    release_users(previous);
+  });
+}
+
+void FusedChain::cancel_fade_cleanup() {
+  if (fade_cleanup_source != 0U) {
+    g_source_remove(fade_cleanup_source);
+
+    fade_cleanup_source = 0U;
+  }
+}
+
+void FusedChain::release_users(const std::vector<std::shared_ptr<PluginBase>>& list) {
+  for (const auto& plugin : list) {
+    plugin->fused_chain_users.fetch_sub(1U, std::memory_order_release);
+  }
+}
+
+void FusedChain::update_latency() {
+  float total = 0.0F;
+
+  for (const auto& plugin : active_chain) {
+    total += plugin->get_latency_seconds();
+  }
+
+  latency_value = total;
+
+  util::debug(log_tag + name + " latency: " + util::to_string(latency_value, "") + " s");
+
+  update_filter_params();
+}
+
+auto FusedChain::can_fuse(const std::vector<std::shared_ptr<PluginBase>>& list) -> bool {
+  return std::ranges::none_of(list, [](const auto& plugin) { return plugin->enable_probe; });
+}
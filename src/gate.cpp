@@ -211,14 +211,16 @@ void Gate::process(std::span<float>& left_in,
       envelope_port_value =
           0.5F * (lv2_wrapper->get_control_port_value("elm_l") + lv2_wrapper->get_control_port_value("elm_r"));
 
-      attack_zone_start.emit(attack_zone_start_port_value);
-      attack_threshold.emit(attack_threshold_port_value);
-      release_zone_start.emit(release_zone_start_port_value);
-      release_threshold.emit(release_threshold_port_value);
-      reduction.emit(reduction_port_value);
-      sidechain.emit(sidechain_port_value);
-      curve.emit(curve_port_value);
-      envelope.emit(envelope_port_value);
+      if (meter_slot != nullptr) {
+        meter_slot->set_extra(attack_zone_start_meter, attack_zone_start_port_value);
+        meter_slot->set_extra(attack_threshold_meter, attack_threshold_port_value);
+        meter_slot->set_extra(release_zone_start_meter, release_zone_start_port_value);
+        meter_slot->set_extra(release_threshold_meter, release_threshold_port_value);
+        meter_slot->set_extra(reduction_meter, reduction_port_value);
+        meter_slot->set_extra(sidechain_meter, sidechain_port_value);
+        meter_slot->set_extra(curve_meter, curve_port_value);
+        meter_slot->set_extra(envelope_meter, envelope_port_value);
+      }
 
       notify();
     }
@@ -226,6 +228,10 @@ void Gate::process(std::span<float>& left_in,
 }
 
 void Gate::update_sidechain_links(const std::string& key) {
+  if (pm == nullptr) {
+    return;
+  }
+
   if (util::gsettings_get_string(settings, "sidechain-input") != "External") {
     pm->destroy_links(list_proxies);
 
@@ -36,6 +36,7 @@
 #include <string>
 #include <vector>
 #include "gate.hpp"
+#include "meter_board.hpp"
 #include "node_info_holder.hpp"
 #include "pipe_manager.hpp"
 #include "pipe_objects.hpp"
@@ -162,183 +163,44 @@ void setup(GateBox* self, std::shared_ptr<Gate> gate, const std::string& schema_
     }
   }
 
-  self->data->connections.push_back(gate->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
+  ui::bind_level_meters(GTK_WIDGET(self), gate, self->input_level_left, self->input_level_left_label,
+                        self->input_level_right, self->input_level_right_label, self->output_level_left,
+                        self->output_level_left_label, self->output_level_right, self->output_level_right_label);
 
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->attack_zone_start.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->attack_zone_start_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->attack_zone_start_label,
-                             fmt::format(ui::get_user_locale(), "{0:.1Lf}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->attack_threshold.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->attack_threshold_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->attack_threshold_label,
-                             fmt::format(ui::get_user_locale(), "{0:.1Lf}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->release_zone_start.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->release_zone_start_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->release_zone_start_label,
-                             fmt::format(ui::get_user_locale(), "{0:.1Lf}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->release_threshold.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->release_threshold_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->release_threshold_label,
-                             fmt::format(ui::get_user_locale(), "{0:.1Lf}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->reduction.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->gain_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->gain_label, fmt::format("{0:.0Lf}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->envelope.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->envelope_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->envelope_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(gate->sidechain.connect([=](const float value) {
-    g_object_ref(self);
+  ui::add_meter_tick_callback(GTK_WIDGET(self), gate, [=](const MeterBoard::Slot& slot) {
+    if (!GTK_IS_LABEL(self->attack_zone_start_label) || !GTK_IS_LABEL(self->attack_threshold_label) ||
+        !GTK_IS_LABEL(self->release_zone_start_label) || !GTK_IS_LABEL(self->release_threshold_label) ||
+        !GTK_IS_LABEL(self->gain_label) || !GTK_IS_LABEL(self->envelope_label) ||
+        !GTK_IS_LABEL(self->sidechain_label) || !GTK_IS_LABEL(self->curve_label)) {
+      return;
+    }
 
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
+    const auto attack_zone_start = slot.get_extra(Gate::attack_zone_start_meter);
+    const auto attack_threshold = slot.get_extra(Gate::attack_threshold_meter);
+    const auto release_zone_start = slot.get_extra(Gate::release_zone_start_meter);
+    const auto release_threshold = slot.get_extra(Gate::release_threshold_meter);
+    const auto reduction = slot.get_extra(Gate::reduction_meter);
+    const auto envelope = slot.get_extra(Gate::envelope_meter);
+    const auto sidechain = slot.get_extra(Gate::sidechain_meter);
+    const auto curve = slot.get_extra(Gate::curve_meter);
 
-          if (!GTK_IS_LABEL(self->sidechain_label)) {
-            return;
-          }
+    gtk_label_set_text(self->attack_zone_start_label,
+                       fmt::format(ui::get_user_locale(), "{0:.1Lf}", util::linear_to_db(attack_zone_start)).c_str());
 
-          gtk_label_set_text(self->sidechain_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+    gtk_label_set_text(self->attack_threshold_label,
+                       fmt::format(ui::get_user_locale(), "{0:.1Lf}", util::linear_to_db(attack_threshold)).c_str());
 
-  self->data->connections.push_back(gate->curve.connect([=](const float value) {
-    g_object_ref(self);
+    gtk_label_set_text(self->release_zone_start_label,
+                       fmt::format(ui::get_user_locale(), "{0:.1Lf}", util::linear_to_db(release_zone_start)).c_str());
 
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
+    gtk_label_set_text(self->release_threshold_label,
+                       fmt::format(ui::get_user_locale(), "{0:.1Lf}", util::linear_to_db(release_threshold)).c_str());
 
-          if (!GTK_IS_LABEL(self->curve_label)) {
-            return;
-          }
-
-          gtk_label_set_text(self->curve_label, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+    gtk_label_set_text(self->gain_label, fmt::format("{0:.0Lf}", util::linear_to_db(reduction)).c_str());
+    gtk_label_set_text(self->envelope_label, fmt::format("{0:.0f}", util::linear_to_db(envelope)).c_str());
+    gtk_label_set_text(self->sidechain_label, fmt::format("{0:.0f}", util::linear_to_db(sidechain)).c_str());
+    gtk_label_set_text(self->curve_label, fmt::format("{0:.0f}", util::linear_to_db(curve)).c_str());
+  });
 
   self->data->connections.push_back(pm->source_added.connect([=](const NodeInfo info) {
     for (guint n = 0U; n < g_list_model_get_n_items(G_LIST_MODEL(self->input_devices_model)); n++) {
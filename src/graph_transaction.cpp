@@ -0,0 +1,172 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "graph_transaction.hpp"
+#include <pipewire/core.h>
+#include <pipewire/keys.h>
+#include <pipewire/link.h>
+#include <pipewire/properties.h>
+#include <pipewire/proxy.h>
+#include <spa/utils/defs.h>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+#include "pipe_manager.hpp"
+#include "tracer.hpp"
+#include "util.hpp"
+
+GraphTransaction::GraphTransaction(PipeManager* pipe_manager) : pm(pipe_manager) {}
+
+GraphTransaction::~GraphTransaction() {
+  if (!empty()) {
+    util::warning("a graph transaction was destroyed without being committed. Its operations were discarded");
+  }
+}
+
+auto GraphTransaction::link_nodes(const uint& output_node_id,
+                                  const uint& input_node_id,
+                                  const bool& probe_link,
+                                  const bool& link_passive) -> uint {
+  const auto pairs = pm->match_ports(output_node_id, input_node_id, probe_link);
+
+  for (const auto& [outp, inp] : pairs) {
+    links_to_create.push_back({.output_node_id = output_node_id,
+                               .input_node_id = input_node_id,
+                               .output_port_id = outp.id,
+                               .input_port_id = inp.id,
+                               .passive = link_passive});
+  }
+
+  return static_cast<uint>(pairs.size());
+}
+
+void GraphTransaction::destroy_links(const std::vector<pw_proxy*>& list) {
+  for (auto* proxy : list) {
+    if (proxy != nullptr) {
+      proxies_to_destroy.push_back(proxy);
+    }
+  }
+}
+
+void GraphTransaction::destroy_object(const uint& id) {
+  objects_to_destroy.push_back(id);
+}
+
+auto GraphTransaction::empty() const -> bool {
+  return links_to_create.empty() && proxies_to_destroy.empty() && objects_to_destroy.empty();
+}
+
+auto GraphTransaction::commit() -> Result {
+  Result result;
+
+  if (empty()) {
+    return result;
+  }
+
+  const tracer::Span span([&] {
+    return "link_nodes: " + util::to_string(links_to_create.size()) + " links, " +
+           util::to_string(proxies_to_destroy.size() + objects_to_destroy.size()) + " removals";
+  });
+
+  std::vector<std::pair<PendingLink, pw_proxy*>> created;
+
+  created.reserve(links_to_create.size());
+
+  pm->lock();
+
+  // Destructions go first so that ports being reused by the new links are already free
+
+  for (const auto& id : objects_to_destroy) {
+    pw_registry_destroy(pm->registry, id);
+  }
+
+  for (auto* proxy : proxies_to_destroy) {
+    pw_proxy_destroy(proxy);
+  }
+
+  for (const auto& link : links_to_create) {
+    pw_properties* props = pw_properties_new(nullptr, nullptr);
+
+    pw_properties_set(props, PW_KEY_LINK_PASSIVE, (link.passive) ? "true" : "false");
+    pw_properties_set(props, PW_KEY_OBJECT_LINGER, "false");
+    pw_properties_set(props, PW_KEY_LINK_OUTPUT_NODE, util::to_string(link.output_node_id).c_str());
+    pw_properties_set(props, PW_KEY_LINK_OUTPUT_PORT, util::to_string(link.output_port_id).c_str());
+    pw_properties_set(props, PW_KEY_LINK_INPUT_NODE, util::to_string(link.input_node_id).c_str());
+    pw_properties_set(props, PW_KEY_LINK_INPUT_PORT, util::to_string(link.input_port_id).c_str());
+
+    auto* proxy = static_cast<pw_proxy*>(
+        pw_core_create_object(pm->core, "link-factory", PW_TYPE_INTERFACE_Link, PW_VERSION_LINK, &props->dict, 0));
+
+    pw_properties_free(props);
+
+    if (proxy == nullptr) {
+      result.failures.push_back({.output_node_id = link.output_node_id,
+                                 .input_node_id = link.input_node_id,
+                                 .output_port_id = link.output_port_id,
+                                 .input_port_id = link.input_port_id});
+
+      continue;
+    }
+
+    created.emplace_back(link, proxy);
+  }
+
+  // A single round-trip for everything queued above
+
+  pm->sync_wait_unlock();
+
+  /*
+    The server binds every link it could create before it answers the sync. A proxy that is still unbound belongs to
+    a link that was refused. The reason was already logged by the core error callback.
+  */
+
+  pm->lock();
+
+  for (const auto& [link, proxy] : created) {
+    if (pw_proxy_get_bound_id(proxy) != SPA_ID_INVALID) {
+      result.proxies.push_back(proxy);
+
+      result.links.push_back(
+          {.output_node_id = link.output_node_id, .input_node_id = link.input_node_id, .proxy = proxy});
+
+      continue;
+    }
+
+    pw_proxy_destroy(proxy);
+
+    result.failures.push_back({.output_node_id = link.output_node_id,
+                               .input_node_id = link.input_node_id,
+                               .output_port_id = link.output_port_id,
+                               .input_port_id = link.input_port_id});
+  }
+
+  pm->unlock();
+
+  for (const auto& f : result.failures) {
+    util::warning("failed to link the port " + util::to_string(f.output_port_id) + " of the node " +
+                  util::to_string(f.output_node_id) + " to the port " + util::to_string(f.input_port_id) +
+                  " of the node " + util::to_string(f.input_node_id));
+  }
+
+  links_to_create.clear();
+  proxies_to_destroy.clear();
+  objects_to_destroy.clear();
+
+  return result;
+}
@@ -18,12 +18,15 @@
  */
 
 #include "level_meter.hpp"
-#include <ebur128.h>
+#include <gio/gio.h>
+#include <glib-object.h>
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <mutex>
 #include <span>
 #include <string>
+#include "loudness_analyzer.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 #include "tags_plugin_name.hpp"
@@ -40,7 +43,20 @@ LevelMeter::LevelMeter(const std::string& tag,
                  schema,
                  schema_path,
                  pipe_manager,
-                 pipe_type) {}
+                 pipe_type) {
+  channel_policy = ChannelPolicy::linked;
+
+  loudness.set_update_rate(static_cast<uint>(g_settings_get_int(global_settings, "loudness-update-rate")));
+
+  gconnections_global.push_back(g_signal_connect(global_settings, "changed::loudness-update-rate",
+                                                 G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                                   auto* self = static_cast<LevelMeter*>(user_data);
+
+                                                   self->loudness.set_update_rate(
+                                                       static_cast<uint>(g_settings_get_int(settings, key)));
+                                                 }),
+                                                 this));
+}
 
 LevelMeter::~LevelMeter() {
   if (connected_to_pw) {
@@ -53,12 +69,6 @@ LevelMeter::~LevelMeter() {
 
   mythreads.clear();
 
-  std::scoped_lock<std::mutex> lock(data_mutex);
-
-  if (ebur_state != nullptr) {
-    ebur128_destroy(&ebur_state);
-  }
-
   util::debug(log_tag + name + " destroyed");
 }
 
@@ -67,33 +77,19 @@ auto LevelMeter::init_ebur128() -> bool {
     return false;
   }
 
-  if (ebur_state != nullptr) {
-    ebur128_destroy(&ebur_state);
-
-    ebur_state = nullptr;
-  }
-
-  ebur_state = ebur128_init(
-      2U, rate, EBUR128_MODE_S | EBUR128_MODE_I | EBUR128_MODE_LRA | EBUR128_MODE_TRUE_PEAK | EBUR128_MODE_HISTOGRAM);
+  // No history limit, so the integrated loudness and the range come from the O(1) histogram.
 
-  ebur128_set_channel(ebur_state, 0U, EBUR128_LEFT);
-  ebur128_set_channel(ebur_state, 1U, EBUR128_RIGHT);
-
-  return ebur_state != nullptr;
+  return loudness.init(rate, {.true_peak = true, .positions = channel_positions});
 }
 
 void LevelMeter::setup() {
-  if (2U * static_cast<size_t>(n_samples) != data.size()) {
-    data.resize(static_cast<size_t>(n_samples) * 2U);
-  }
+  setup_pending = true;
+}
 
+void LevelMeter::apply_setup() {
   if (rate != old_rate) {
-    data_mutex.lock();
-
     ebur128_ready = false;
 
-    data_mutex.unlock();
-
     mythreads.emplace_back([this]() {  // Using emplace_back here makes sense
       if (ebur128_ready) {
         return;
@@ -118,55 +114,46 @@ void LevelMeter::process(std::span<float>& left_in,
                          std::span<float>& right_in,
                          std::span<float>& left_out,
                          std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
-
-  std::copy(left_in.begin(), left_in.end(), left_out.begin());
-  std::copy(right_in.begin(), right_in.end(), right_out.begin());
-
-  if (bypass || !ebur128_ready) {
-    return;
-  }
-
-  for (size_t n = 0U; n < n_samples; n++) {
-    data[2U * n] = left_in[n];
-    data[2U * n + 1U] = right_in[n];
-  }
-
-  ebur128_add_frames_float(ebur_state, data.data(), n_samples);
+  std::array<std::span<float>, 2U> inputs = {left_in, right_in};
+  std::array<std::span<float>, 2U> outputs = {left_out, right_out};
 
-  if (EBUR128_SUCCESS != ebur128_loudness_momentary(ebur_state, &momentary)) {
-    momentary = 0.0;
-  }
+  process(inputs, outputs);
+}
 
-  if (EBUR128_SUCCESS != ebur128_loudness_shortterm(ebur_state, &shortterm)) {
-    shortterm = 0.0;
-  }
+void LevelMeter::process(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs) {
+  const auto lock = lock_for_rt();
 
-  if (EBUR128_SUCCESS != ebur128_loudness_global(ebur_state, &global)) {
-    global = 0.0;
-  }
+  if (lock.owns_lock() && setup_pending) {
+    apply_setup();
 
-  if (EBUR128_SUCCESS != ebur128_relative_threshold(ebur_state, &relative)) {
-    relative = 0.0;
+    setup_pending = false;
   }
 
-  if (EBUR128_SUCCESS != ebur128_loudness_range(ebur_state, &range)) {
-    range = 0.0;
+  for (size_t c = 0U; c < inputs.size(); c++) {
+    std::ranges::copy(inputs[c], outputs[c].begin());
   }
 
-  if (EBUR128_SUCCESS != ebur128_true_peak(ebur_state, 0U, &true_peak_L)) {
-    true_peak_L = 0.0;
+  if (!lock.owns_lock() || bypass || !ebur128_ready) {
+    return;
   }
 
-  if (EBUR128_SUCCESS != ebur128_true_peak(ebur_state, 1U, &true_peak_R)) {
-    true_peak_R = 0.0;
-  }
+  loudness.process(inputs);
 
   if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
+    get_peaks(inputs, outputs);
 
     if (send_notifications) {
-      results.emit(momentary, shortterm, global, relative, range, true_peak_L, true_peak_R);
+      if (meter_slot != nullptr) {
+        const auto& metrics = loudness.get_metrics();
+
+        meter_slot->set_extra(momentary_meter, static_cast<float>(metrics.momentary));
+        meter_slot->set_extra(shortterm_meter, static_cast<float>(metrics.shortterm));
+        meter_slot->set_extra(integrated_meter, static_cast<float>(metrics.global));
+        meter_slot->set_extra(relative_meter, static_cast<float>(metrics.relative));
+        meter_slot->set_extra(range_meter, static_cast<float>(metrics.range));
+        meter_slot->set_extra(true_peak_left_meter, static_cast<float>(metrics.true_peak_left));
+        meter_slot->set_extra(true_peak_right_meter, static_cast<float>(metrics.true_peak_right));
+      }
 
       notify();
     }
@@ -32,6 +32,7 @@
 #include <string>
 #include <vector>
 #include "level_meter.hpp"
+#include "meter_board.hpp"
 #include "tags_resources.hpp"
 #include "tags_schema.hpp"
 #include "ui_helpers.hpp"
@@ -96,63 +97,45 @@ void setup(LevelMeterBox* self, std::shared_ptr<LevelMeter> level_meter, const s
 
   level_meter->set_post_messages(true);
 
-  self->data->connections.push_back(level_meter->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(level_meter->results.connect(
-      [=](const double momentary, const double shortterm, const double integrated, const double relative,
-          const double range, const double true_peak_L, const double true_peak_R) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              if (!GTK_IS_LEVEL_BAR(self->m_level) || !GTK_IS_LABEL(self->m_label) ||
-                  !GTK_IS_LEVEL_BAR(self->s_level) || !GTK_IS_LABEL(self->s_label) ||
-                  !GTK_IS_LEVEL_BAR(self->i_level) || !GTK_IS_LABEL(self->i_label) ||
-                  !GTK_IS_LEVEL_BAR(self->r_level) || !GTK_IS_LABEL(self->r_label) ||
-                  !GTK_IS_LEVEL_BAR(self->lra_level) || !GTK_IS_LABEL(self->lra_label) ||
-                  !GTK_IS_LABEL(self->true_peak_left_label) || !GTK_IS_LABEL(self->true_peak_right_label)) {
-                return;
-              }
-
-              gtk_label_set_text(self->true_peak_left_label,
-                                 fmt::format("{0:.0f} dB", util::linear_to_db(true_peak_L)).c_str());
-              gtk_label_set_text(self->true_peak_right_label,
-                                 fmt::format("{0:.0f} dB", util::linear_to_db(true_peak_R)).c_str());
-
-              gtk_level_bar_set_value(self->m_level, util::db_to_linear(momentary));
-              gtk_label_set_text(self->m_label, fmt::format("{0:.0f} LUFS", momentary).c_str());
-
-              gtk_level_bar_set_value(self->s_level, util::db_to_linear(shortterm));
-              gtk_label_set_text(self->s_label, fmt::format("{0:.0f} LUFS", shortterm).c_str());
-
-              gtk_level_bar_set_value(self->i_level, util::db_to_linear(integrated));
-              gtk_label_set_text(self->i_label, fmt::format("{0:.0f} LUFS", integrated).c_str());
-
-              gtk_level_bar_set_value(self->r_level, util::db_to_linear(relative));
-              gtk_label_set_text(self->r_label, fmt::format("{0:.0f} LUFS", relative).c_str());
-
-              gtk_level_bar_set_value(self->lra_level, util::db_to_linear(range));
-              gtk_label_set_text(self->lra_label, fmt::format("{0:.0f} LU", range).c_str());
-            },
-            [=]() { g_object_unref(self); });
-      }));
+  ui::bind_level_meters(GTK_WIDGET(self), level_meter, self->input_level_left, self->input_level_left_label,
+                        self->input_level_right, self->input_level_right_label);
+
+  ui::add_meter_tick_callback(GTK_WIDGET(self), level_meter, [=](const MeterBoard::Slot& slot) {
+    if (!GTK_IS_LEVEL_BAR(self->m_level) || !GTK_IS_LABEL(self->m_label) || !GTK_IS_LEVEL_BAR(self->s_level) ||
+        !GTK_IS_LABEL(self->s_label) || !GTK_IS_LEVEL_BAR(self->i_level) || !GTK_IS_LABEL(self->i_label) ||
+        !GTK_IS_LEVEL_BAR(self->r_level) || !GTK_IS_LABEL(self->r_label) || !GTK_IS_LEVEL_BAR(self->lra_level) ||
+        !GTK_IS_LABEL(self->lra_label) || !GTK_IS_LABEL(self->true_peak_left_label) ||
+        !GTK_IS_LABEL(self->true_peak_right_label)) {
+      return;
+    }
+
+    const auto momentary = slot.get_extra(LevelMeter::momentary_meter);
+    const auto shortterm = slot.get_extra(LevelMeter::shortterm_meter);
+    const auto integrated = slot.get_extra(LevelMeter::integrated_meter);
+    const auto relative = slot.get_extra(LevelMeter::relative_meter);
+    const auto range = slot.get_extra(LevelMeter::range_meter);
+    const auto true_peak_L = slot.get_extra(LevelMeter::true_peak_left_meter);
+    const auto true_peak_R = slot.get_extra(LevelMeter::true_peak_right_meter);
+
+    gtk_label_set_text(self->true_peak_left_label, fmt::format("{0:.0f} dB", util::linear_to_db(true_peak_L)).c_str());
+    gtk_label_set_text(self->true_peak_right_label,
+                       fmt::format("{0:.0f} dB", util::linear_to_db(true_peak_R)).c_str());
+
+    gtk_level_bar_set_value(self->m_level, util::db_to_linear(momentary));
+    gtk_label_set_text(self->m_label, fmt::format("{0:.0f} LUFS", momentary).c_str());
+
+    gtk_level_bar_set_value(self->s_level, util::db_to_linear(shortterm));
+    gtk_label_set_text(self->s_label, fmt::format("{0:.0f} LUFS", shortterm).c_str());
+
+    gtk_level_bar_set_value(self->i_level, util::db_to_linear(integrated));
+    gtk_label_set_text(self->i_label, fmt::format("{0:.0f} LUFS", integrated).c_str());
+
+    gtk_level_bar_set_value(self->r_level, util::db_to_linear(relative));
+    gtk_label_set_text(self->r_label, fmt::format("{0:.0f} LUFS", relative).c_str());
+
+    gtk_level_bar_set_value(self->lra_level, util::db_to_linear(range));
+    gtk_label_set_text(self->lra_label, fmt::format("{0:.0f} LU", range).c_str());
+  });
 
   gtk_label_set_text(self->plugin_credit, ui::get_plugin_credit_translated(self->data->level_meter->package).c_str());
 }
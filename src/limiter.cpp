@@ -180,10 +180,12 @@ void Limiter::process(std::span<float>& left_in,
       sidechain_l_port_value = lv2_wrapper->get_control_port_value("sclm_l");
       sidechain_r_port_value = lv2_wrapper->get_control_port_value("sclm_r");
 
-      gain_left.emit(gain_l_port_value);
-      gain_right.emit(gain_r_port_value);
-      sidechain_left.emit(sidechain_l_port_value);
-      sidechain_right.emit(sidechain_r_port_value);
+      if (meter_slot != nullptr) {
+        meter_slot->set_extra(gain_left_meter, gain_l_port_value);
+        meter_slot->set_extra(gain_right_meter, gain_r_port_value);
+        meter_slot->set_extra(sidechain_left_meter, sidechain_l_port_value);
+        meter_slot->set_extra(sidechain_right_meter, sidechain_r_port_value);
+      }
 
       notify();
     }
@@ -191,6 +193,10 @@ void Limiter::process(std::span<float>& left_in,
 }
 
 void Limiter::update_sidechain_links(const std::string& key) {
+  if (pm == nullptr) {
+    return;
+  }
+
   if (g_settings_get_boolean(settings, "external-sidechain") == 0) {
     pm->destroy_links(list_proxies);
 
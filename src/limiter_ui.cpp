@@ -35,6 +35,7 @@
 #include <string>
 #include <vector>
 #include "limiter.hpp"
+#include "meter_board.hpp"
 #include "node_info_holder.hpp"
 #include "pipe_manager.hpp"
 #include "pipe_objects.hpp"
@@ -155,107 +156,26 @@ void setup(LimiterBox* self, std::shared_ptr<Limiter> limiter, const std::string
     }
   }
 
-  self->data->connections.push_back(limiter->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
+  ui::bind_level_meters(GTK_WIDGET(self), limiter, self->input_level_left, self->input_level_left_label,
+                        self->input_level_right, self->input_level_right_label, self->output_level_left,
+                        self->output_level_left_label, self->output_level_right, self->output_level_right_label);
 
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(limiter->output_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                       self->output_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(limiter->gain_left.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->gain_left)) {
-            return;
-          }
-
-          gtk_label_set_text(self->gain_left, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(limiter->gain_right.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->gain_right)) {
-            return;
-          }
-
-          gtk_label_set_text(self->gain_right, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(limiter->sidechain_left.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
-
-          if (!GTK_IS_LABEL(self->sidechain_left)) {
-            return;
-          }
-
-          gtk_label_set_text(self->sidechain_left, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
-
-  self->data->connections.push_back(limiter->sidechain_right.connect([=](const float value) {
-    g_object_ref(self);
-
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
+  ui::add_meter_tick_callback(GTK_WIDGET(self), limiter, [=](const MeterBoard::Slot& slot) {
+    if (!GTK_IS_LABEL(self->gain_left) || !GTK_IS_LABEL(self->gain_right) || !GTK_IS_LABEL(self->sidechain_left) ||
+        !GTK_IS_LABEL(self->sidechain_right)) {
+      return;
+    }
 
-          if (!GTK_IS_LABEL(self->sidechain_right)) {
-            return;
-          }
+    const auto gain_left = slot.get_extra(Limiter::gain_left_meter);
+    const auto gain_right = slot.get_extra(Limiter::gain_right_meter);
+    const auto sidechain_left = slot.get_extra(Limiter::sidechain_left_meter);
+    const auto sidechain_right = slot.get_extra(Limiter::sidechain_right_meter);
 
-          gtk_label_set_text(self->sidechain_right, fmt::format("{0:.0f}", util::linear_to_db(value)).c_str());
-        },
-        [=]() { g_object_unref(self); });
-  }));
+    gtk_label_set_text(self->gain_left, fmt::format("{0:.0f}", util::linear_to_db(gain_left)).c_str());
+    gtk_label_set_text(self->gain_right, fmt::format("{0:.0f}", util::linear_to_db(gain_right)).c_str());
+    gtk_label_set_text(self->sidechain_left, fmt::format("{0:.0f}", util::linear_to_db(sidechain_left)).c_str());
+    gtk_label_set_text(self->sidechain_right, fmt::format("{0:.0f}", util::linear_to_db(sidechain_right)).c_str());
+  });
 
   self->data->connections.push_back(pm->source_added.connect([=](const NodeInfo info) {
     for (guint n = 0U; n < g_list_model_get_n_items(G_LIST_MODEL(self->input_devices_model)); n++) {
@@ -0,0 +1,249 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "loudness_analyzer.hpp"
+#include <ebur128.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <string>
+#include "channel_layout.hpp"
+
+namespace {
+
+auto to_ebur128_channel(const std::string& position) -> int {
+  if (position == "FL") {
+    return EBUR128_LEFT;
+  }
+
+  if (position == "FR") {
+    return EBUR128_RIGHT;
+  }
+
+  if (position == "FC") {
+    return EBUR128_CENTER;
+  }
+
+  if (position == "RL" || position == "SL") {
+    return EBUR128_LEFT_SURROUND;
+  }
+
+  if (position == "RR" || position == "SR") {
+    return EBUR128_RIGHT_SURROUND;
+  }
+
+  // LFE is not part of the BS.1770 measurement
+
+  return EBUR128_UNUSED;
+}
+
+}  // namespace
+
+LoudnessAnalyzer::~LoudnessAnalyzer() {
+  if (state != nullptr) {
+    ebur128_destroy(&state);
+  }
+}
+
+auto LoudnessAnalyzer::init(const uint& rate, const Options& options) -> bool {
+  if (state != nullptr) {
+    ebur128_destroy(&state);
+
+    state = nullptr;
+  }
+
+  metrics = Metrics();
+
+  if (rate == 0U) {
+    return false;
+  }
+
+  this->rate = rate;
+  this->options = options;
+
+  int mode = EBUR128_MODE_S | EBUR128_MODE_I | EBUR128_MODE_LRA;
+
+  if (options.true_peak) {
+    mode |= EBUR128_MODE_TRUE_PEAK;
+  }
+
+  if (options.sample_peak) {
+    mode |= EBUR128_MODE_SAMPLE_PEAK;
+  }
+
+  if (options.max_history_seconds == 0U) {
+    mode |= EBUR128_MODE_HISTOGRAM;
+  }
+
+  const auto positions =
+      options.positions.empty() ? channel_layout::get_positions(channel_layout::Layout::stereo) : options.positions;
+
+  n_channels = static_cast<uint>(positions.size());
+
+  state = ebur128_init(n_channels, rate, mode);
+
+  if (state == nullptr) {
+    return false;
+  }
+
+  sides.clear();
+
+  for (uint n = 0U; n < n_channels; n++) {
+    ebur128_set_channel(state, n, to_ebur128_channel(positions[n]));
+
+    sides.push_back(channel_layout::get_side(positions[n]));
+  }
+
+  set_max_history(options.max_history_seconds);
+
+  data.resize(static_cast<size_t>(n_channels) * chunk_frames);
+
+  // Query on the first quantum so that the owner has valid metrics right away.
+
+  frames_since_update = rate;
+
+  sample_peak_left = 0.0;
+  sample_peak_right = 0.0;
+
+  return true;
+}
+
+void LoudnessAnalyzer::set_max_history(const uint& seconds) {
+  options.max_history_seconds = seconds;
+
+  if (state == nullptr || seconds == 0U) {
+    return;
+  }
+
+  // The value given to ebur128_set_max_history must be in milliseconds
+
+  ebur128_set_max_history(state, static_cast<ulong>(seconds) * 1000UL);
+}
+
+template <typename Source>
+auto LoudnessAnalyzer::add_frames(const size_t& n_frames, Source&& source) -> bool {
+  if (state == nullptr) {
+    return false;
+  }
+
+  for (size_t offset = 0U; offset < n_frames; offset += chunk_frames) {
+    const auto count = std::min(chunk_frames, n_frames - offset);
+
+    for (size_t n = 0U; n < count; n++) {
+      for (uint c = 0U; c < n_channels; c++) {
+        data[n * n_channels + c] = source(c, offset + n);
+      }
+    }
+
+    ebur128_add_frames_float(state, data.data(), count);
+
+    if (options.sample_peak) {
+      for (uint c = 0U; c < n_channels; c++) {
+        double peak = 0.0;
+
+        if (EBUR128_SUCCESS != ebur128_prev_sample_peak(state, c, &peak)) {
+          continue;
+        }
+
+        if (sides[c] != channel_layout::Side::right) {
+          sample_peak_left = std::max(sample_peak_left, peak);
+        }
+
+        if (sides[c] != channel_layout::Side::left) {
+          sample_peak_right = std::max(sample_peak_right, peak);
+        }
+      }
+    }
+  }
+
+  frames_since_update += static_cast<uint>(n_frames);
+
+  if (frames_since_update < rate / std::max(update_rate.load(std::memory_order_relaxed), 1U)) {
+    return false;
+  }
+
+  frames_since_update = 0U;
+
+  update_metrics();
+
+  return true;
+}
+
+auto LoudnessAnalyzer::process(std::span<const float> left, std::span<const float> right) -> bool {
+  if (n_channels != 2U) {
+    return false;
+  }
+
+  return add_frames(std::min(left.size(), right.size()),
+                    [&](const uint& c, const size_t& n) { return (c == 0U) ? left[n] : right[n]; });
+}
+
+auto LoudnessAnalyzer::process(std::span<const std::span<float>> channels) -> bool {
+  if (channels.size() != n_channels) {
+    return false;
+  }
+
+  return add_frames(channels[0].size(), [&](const uint& c, const size_t& n) { return channels[c][n]; });
+}
+
+void LoudnessAnalyzer::update_metrics() {
+  metrics.valid = true;
+
+  // A failed query reads as zero and marks the whole update as invalid.
+
+  const auto query = [&](const int& status, double& value) {
+    if (status != EBUR128_SUCCESS) {
+      value = 0.0;
+
+      metrics.valid = false;
+    }
+  };
+
+  query(ebur128_loudness_momentary(state, &metrics.momentary), metrics.momentary);
+  query(ebur128_loudness_shortterm(state, &metrics.shortterm), metrics.shortterm);
+  query(ebur128_loudness_global(state, &metrics.global), metrics.global);
+  query(ebur128_relative_threshold(state, &metrics.relative), metrics.relative);
+  query(ebur128_loudness_range(state, &metrics.range), metrics.range);
+
+  if (options.true_peak) {
+    metrics.true_peak_left = 0.0;
+    metrics.true_peak_right = 0.0;
+
+    for (uint c = 0U; c < n_channels; c++) {
+      double peak = 0.0;
+
+      query(ebur128_true_peak(state, c, &peak), peak);
+
+      if (sides[c] != channel_layout::Side::right) {
+        metrics.true_peak_left = std::max(metrics.true_peak_left, peak);
+      }
+
+      if (sides[c] != channel_layout::Side::left) {
+        metrics.true_peak_right = std::max(metrics.true_peak_right, peak);
+      }
+    }
+  }
+
+  metrics.sample_peak_left = sample_peak_left;
+  metrics.sample_peak_right = sample_peak_right;
+
+  sample_peak_left = 0.0;
+  sample_peak_right = 0.0;
+}
@@ -0,0 +1,361 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "lv2_world.hpp"
+#include <gio/gio.h>
+#include <glib.h>
+#include <lilv/lilv.h>
+#include <lv2/atom/atom.h>
+#include <lv2/core/lv2.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <system_error>
+#include <vector>
+#include "tags_app.hpp"
+#include "tracer.hpp"
+#include "util.hpp"
+
+namespace lv2 {
+
+using namespace std::string_literals;
+
+namespace {
+
+constexpr auto disk_cache_version = 1;
+
+}  // namespace
+
+World::World() : world(lilv_world_new()) {
+  if (world == nullptr) {
+    util::warning("failed to initialized the world");
+
+    return;
+  }
+
+  auto* settings = g_settings_new(tags::app::id);
+
+  use_disk_cache = g_settings_get_boolean(settings, "lv2-port-cache") != 0;
+
+  g_object_unref(settings);
+
+  disk_cache_path = g_get_user_cache_dir() + "/easyeffects/lv2_ports.json"s;
+
+  util::debug("loading the installed lv2 bundles");
+
+  const tracer::Span span("lv2: world load");
+
+  lilv_world_load_all(world);
+}
+
+auto World::get() -> World& {
+  // Intentionally never destroyed. Plugin instances and native uis may still reference the world while static
+  // destructors run.
+
+  static auto* shared = new World();
+
+  return *shared;
+}
+
+auto World::get_lilv_world() const -> LilvWorld* {
+  return world;
+}
+
+auto World::lock() -> std::unique_lock<std::mutex> {
+  return std::unique_lock<std::mutex>(mutex);
+}
+
+auto World::find_plugin(const std::string& uri) -> const LilvPlugin* {
+  std::scoped_lock<std::mutex> lock(mutex);
+
+  if (world == nullptr) {
+    return nullptr;
+  }
+
+  if (const auto it = plugins.find(uri); it != plugins.end()) {
+    return it->second;
+  }
+
+  auto* const node = lilv_new_uri(world, uri.c_str());
+
+  if (node == nullptr) {
+    util::warning("Invalid plugin URI: " + uri);
+
+    return nullptr;
+  }
+
+  const auto* plugin = lilv_plugins_get_by_uri(lilv_world_get_all_plugins(world), node);
+
+  lilv_node_free(node);
+
+  plugins[uri] = plugin;
+
+  return plugin;
+}
+
+auto World::get_ports(const std::string& uri, const LilvPlugin* plugin) -> std::vector<Port> {
+  std::scoped_lock<std::mutex> lock(mutex);
+
+  if (const auto it = ports.find(uri); it != ports.end()) {
+    return it->second;
+  }
+
+  std::vector<Port> list;
+
+  if (use_disk_cache) {
+    auto* bundle_path = lilv_file_uri_parse(lilv_node_as_uri(lilv_plugin_get_bundle_uri(plugin)), nullptr);
+
+    const std::string bundle = (bundle_path != nullptr) ? bundle_path : "";
+
+    lilv_free(bundle_path);
+
+    const auto stamp = get_bundle_stamp(bundle);
+
+    if (!read_disk_cache(uri, bundle, stamp, list)) {
+      list = read_ports(plugin);
+
+      write_disk_cache(uri, bundle, stamp, list);
+    }
+  } else {
+    list = read_ports(plugin);
+  }
+
+  ports[uri] = list;
+
+  return list;
+}
+
+auto World::read_ports(const LilvPlugin* plugin) -> std::vector<Port> {
+  const auto n_ports = lilv_plugin_get_num_ports(plugin);
+
+  std::vector<Port> list(n_ports);
+
+  // Get min, max and default values for all ports
+
+  std::vector<float> values(n_ports);
+  std::vector<float> minimum(n_ports);
+  std::vector<float> maximum(n_ports);
+
+  lilv_plugin_get_port_ranges_float(plugin, minimum.data(), maximum.data(), values.data());
+
+  LilvNode* lv2_InputPort = lilv_new_uri(world, LV2_CORE__InputPort);
+  LilvNode* lv2_OutputPort = lilv_new_uri(world, LV2_CORE__OutputPort);
+  LilvNode* lv2_AudioPort = lilv_new_uri(world, LV2_CORE__AudioPort);
+  LilvNode* lv2_ControlPort = lilv_new_uri(world, LV2_CORE__ControlPort);
+  LilvNode* lv2_AtomPort = lilv_new_uri(world, LV2_ATOM__AtomPort);
+  LilvNode* lv2_connectionOptional = lilv_new_uri(world, LV2_CORE__connectionOptional);
+
+  for (uint n = 0U; n < n_ports; n++) {
+    auto* port = &list[n];
+
+    const auto* lilv_port = lilv_plugin_get_port_by_index(plugin, n);
+
+    auto* port_name = lilv_port_get_name(plugin, lilv_port);
+
+    port->index = n;
+    port->name = lilv_node_as_string(port_name);
+    port->symbol = lilv_node_as_string(lilv_port_get_symbol(plugin, lilv_port));
+    port->optional = lilv_port_has_property(plugin, lilv_port, lv2_connectionOptional);
+    port->is_input = false;
+
+    // Save port default value
+    if (!std::isnan(values[n])) {
+      port->value = values[n];
+    }
+    // Save minimum and maximum values
+    if (!std::isnan(minimum[n])) {
+      port->min = minimum[n];
+    }
+    if (!std::isnan(maximum[n])) {
+      port->max = maximum[n];
+    }
+
+    if (lilv_port_is_a(plugin, lilv_port, lv2_InputPort)) {
+      port->is_input = true;
+    } else if (!lilv_port_is_a(plugin, lilv_port, lv2_OutputPort) && !port->optional) {
+      util::warning("Port " + port->name + " is neither input nor output!");
+    }
+
+    if (lilv_port_is_a(plugin, lilv_port, lv2_ControlPort)) {
+      port->type = TYPE_CONTROL;
+    } else if (lilv_port_is_a(plugin, lilv_port, lv2_AtomPort)) {
+      port->type = TYPE_ATOM;
+    } else if (lilv_port_is_a(plugin, lilv_port, lv2_AudioPort)) {
+      port->type = TYPE_AUDIO;
+    } else if (!port->optional) {
+      util::warning("Port " + port->name + " has un unsupported type!");
+    }
+
+    lilv_node_free(port_name);
+  }
+
+  lilv_node_free(lv2_connectionOptional);
+  lilv_node_free(lv2_ControlPort);
+  lilv_node_free(lv2_AtomPort);
+  lilv_node_free(lv2_AudioPort);
+  lilv_node_free(lv2_OutputPort);
+  lilv_node_free(lv2_InputPort);
+
+  return list;
+}
+
+auto World::get_bundle_stamp(const std::filesystem::path& bundle) -> int64_t {
+  // The newest modification time among the bundle directory and its files. Editing a ttl in place does not touch the
+  // directory itself.
+
+  std::error_code ec;
+
+  auto stamp = static_cast<int64_t>(std::filesystem::last_write_time(bundle, ec).time_since_epoch().count());
+
+  if (ec) {
+    return -1;
+  }
+
+  for (const auto& entry : std::filesystem::directory_iterator(bundle, ec)) {
+    const auto t = entry.last_write_time(ec);
+
+    if (!ec) {
+      stamp = std::max(stamp, static_cast<int64_t>(t.time_since_epoch().count()));
+    }
+  }
+
+  return stamp;
+}
+
+auto World::read_disk_cache(const std::string& uri,
+                            const std::string& bundle,
+                            const int64_t& stamp,
+                            std::vector<Port>& out) -> bool {
+  if (!disk_cache_loaded) {
+    disk_cache_loaded = true;
+
+    if (std::ifstream is(disk_cache_path); is.is_open()) {
+      disk_cache = nlohmann::json::parse(is, nullptr, false);
+    }
+
+    if (disk_cache.is_discarded() || !disk_cache.is_object() ||
+        disk_cache.value("version", 0) != disk_cache_version) {
+      disk_cache = {{"version", disk_cache_version}, {"plugins", nlohmann::json::object()}};
+    }
+  }
+
+  if (stamp < 0 || !disk_cache["plugins"].contains(uri)) {
+    return false;
+  }
+
+  const auto& entry = disk_cache["plugins"][uri];
+
+  if (entry.value("bundle", ""s) != bundle || entry.value("stamp", int64_t{-1}) != stamp) {
+    util::debug(uri + " bundle changed. Its cached ports will be refreshed");
+
+    return false;
+  }
+
+  try {
+    for (const auto& p : entry.at("ports")) {
+      Port port;
+
+      port.type = static_cast<PortType>(p.at("type").get<int>());
+      port.index = p.at("index").get<uint>();
+      port.name = p.at("name").get<std::string>();
+      port.symbol = p.at("symbol").get<std::string>();
+      port.value = p.at("value").get<float>();
+      port.is_input = p.at("is-input").get<bool>();
+      port.optional = p.at("optional").get<bool>();
+
+      // json has no infinity. Unbounded limits are simply not stored.
+      if (p.contains("min")) {
+        port.min = p.at("min").get<float>();
+      }
+      if (p.contains("max")) {
+        port.max = p.at("max").get<float>();
+      }
+
+      out.push_back(port);
+    }
+  } catch (const nlohmann::json::exception& e) {
+    util::warning("invalid lv2 port cache entry for " + uri + ": " + e.what());
+
+    out.clear();
+
+    return false;
+  }
+
+  return true;
+}
+
+void World::write_disk_cache(const std::string& uri,
+                             const std::string& bundle,
+                             const int64_t& stamp,
+                             const std::vector<Port>& list) {
+  if (stamp < 0) {
+    return;
+  }
+
+  auto json_ports = nlohmann::json::array();
+
+  for (const auto& p : list) {
+    nlohmann::json jp = {{"type", static_cast<int>(p.type)}, {"index", p.index},       {"name", p.name},
+                         {"symbol", p.symbol},               {"value", p.value},       {"is-input", p.is_input},
+                         {"optional", p.optional}};
+
+    if (std::isfinite(p.min)) {
+      jp["min"] = p.min;
+    }
+    if (std::isfinite(p.max)) {
+      jp["max"] = p.max;
+    }
+
+    json_ports.push_back(jp);
+  }
+
+  disk_cache["plugins"][uri] = {{"bundle", bundle}, {"stamp", stamp}, {"ports", json_ports}};
+
+  std::error_code ec;
+
+  std::filesystem::create_directories(disk_cache_path.parent_path(), ec);
+
+  // Written to a temporary file first so that a crash never leaves a truncated cache behind.
+
+  auto tmp_path = disk_cache_path;
+
+  tmp_path += ".tmp";
+
+  if (std::ofstream os(tmp_path); os.is_open()) {
+    os << disk_cache.dump();
+  } else {
+    util::warning("could not write the lv2 port cache to " + tmp_path.string());
+
+    return;
+  }
+
+  std::filesystem::rename(tmp_path, disk_cache_path, ec);
+
+  if (ec) {
+    util::warning("could not write the lv2 port cache to " + disk_cache_path.string());
+  }
+}
+
+}  // namespace lv2
@@ -33,7 +33,6 @@
 #include <sys/types.h>
 #include <array>
 #include <chrono>
-#include <cmath>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
@@ -43,6 +42,8 @@
 #include <string>
 #include <thread>
 #include <vector>
+#include "lv2_world.hpp"
+#include "tracer.hpp"
 #include "util.hpp"
 
 namespace lv2 {
@@ -62,28 +63,13 @@ auto lv2_printf(LV2_Log_Handle handle, LV2_URID type, const char* format, ...) -
   return r;
 }
 
-Lv2Wrapper::Lv2Wrapper(const std::string& plugin_uri) : plugin_uri(plugin_uri), world(lilv_world_new()) {
+Lv2Wrapper::Lv2Wrapper(const std::string& plugin_uri)
+    : plugin_uri(plugin_uri), world(World::get().get_lilv_world()) {
   if (world == nullptr) {
-    util::warning("failed to initialized the world");
-
-    return;
-  }
-
-  auto* const uri = lilv_new_uri(world, plugin_uri.c_str());
-
-  if (uri == nullptr) {
-    util::warning("Invalid plugin URI: " + plugin_uri);
-
     return;
   }
 
-  lilv_world_load_all(world);
-
-  const LilvPlugins* plugins = lilv_world_get_all_plugins(world);
-
-  plugin = lilv_plugins_get_by_uri(plugins, uri);
-
-  lilv_node_free(uri);
+  plugin = World::get().find_plugin(plugin_uri);
 
   if (plugin == nullptr) {
     util::warning("Could not find the plugin: " + plugin_uri);
@@ -105,13 +91,11 @@ Lv2Wrapper::~Lv2Wrapper() {
 
     instance = nullptr;
   }
-
-  if (world != nullptr) {
-    lilv_world_free(world);
-  }
 }
 
 void Lv2Wrapper::check_required_features() {
+  const auto lock = World::get().lock();
+
   LilvNodes* required_features = lilv_plugin_get_required_features(plugin);
 
   if (required_features != nullptr) {
@@ -129,109 +113,51 @@ void Lv2Wrapper::check_required_features() {
 }
 
 void Lv2Wrapper::create_ports() {
-  n_ports = lilv_plugin_get_num_ports(plugin);
-
-  ports.resize(n_ports);
-
-  // Get min, max and default values for all ports
-
-  std::vector<float> values(n_ports);
-  std::vector<float> minimum(n_ports);
-  std::vector<float> maximum(n_ports);
-
-  lilv_plugin_get_port_ranges_float(plugin, minimum.data(), maximum.data(), values.data());
+  ports = World::get().get_ports(plugin_uri, plugin);
 
-  LilvNode* lv2_InputPort = lilv_new_uri(world, LV2_CORE__InputPort);
-  LilvNode* lv2_OutputPort = lilv_new_uri(world, LV2_CORE__OutputPort);
-  LilvNode* lv2_AudioPort = lilv_new_uri(world, LV2_CORE__AudioPort);
-  LilvNode* lv2_ControlPort = lilv_new_uri(world, LV2_CORE__ControlPort);
-  LilvNode* lv2_AtomPort = lilv_new_uri(world, LV2_ATOM__AtomPort);
-  LilvNode* lv2_connectionOptional = lilv_new_uri(world, LV2_CORE__connectionOptional);
+  n_ports = static_cast<uint>(ports.size());
 
   data_ports.in.left = data_ports.in.right = UINT_MAX;
   data_ports.probe.left = data_ports.probe.right = UINT_MAX;
   data_ports.out.left = data_ports.out.right = UINT_MAX;
 
-  for (uint n = 0U; n < n_ports; n++) {
-    auto* port = &ports[n];
-
-    const auto* lilv_port = lilv_plugin_get_port_by_index(plugin, n);
-
-    auto* port_name = lilv_port_get_name(plugin, lilv_port);
-
-    port->index = n;
-    port->name = lilv_node_as_string(port_name);
-    port->symbol = lilv_node_as_string(lilv_port_get_symbol(plugin, lilv_port));
-    port->optional = lilv_port_has_property(plugin, lilv_port, lv2_connectionOptional);
-
-    // Save port default value
-    if (!std::isnan(values[n])) {
-      port->value = values[n];
-    }
-    // Save minimum and maximum values
-    if (!std::isnan(minimum[n])) {
-      port->min = minimum[n];
-    }
-    if (!std::isnan(maximum[n])) {
-      port->max = maximum[n];
+  for (const auto& port : ports) {
+    if (port.type == TYPE_CONTROL) {
+      map_cp_symbol_to_idx[port.symbol] = port.index;
     }
 
-    // util::warning("port name: " + port->name);
-    // util::warning("port symbol: " + port->symbol);
-
-    if (lilv_port_is_a(plugin, lilv_port, lv2_InputPort)) {
-      port->is_input = true;
-    } else if (!lilv_port_is_a(plugin, lilv_port, lv2_OutputPort) && !port->optional) {
-      util::warning("Port " + port->name + " is neither input nor output!");
+    if (port.type != TYPE_AUDIO) {
+      continue;
     }
 
-    if (lilv_port_is_a(plugin, lilv_port, lv2_ControlPort)) {
-      port->type = TYPE_CONTROL;
-    } else if (lilv_port_is_a(plugin, lilv_port, lv2_AtomPort)) {
-      port->type = TYPE_ATOM;
-
-      // util::warning("port name: " + port->name);
-    } else if (lilv_port_is_a(plugin, lilv_port, lv2_AudioPort)) {
-      port->type = TYPE_AUDIO;
-
-      if (port->is_input) {
-        if (n_audio_in == 0)
-          data_ports.in.left = port->index;
-        else if (n_audio_in == 1)
-          data_ports.in.right = port->index;
-        else if (n_audio_in == 2)
-          data_ports.probe.left = port->index;
-        else if (n_audio_in == 3)
-          data_ports.probe.right = port->index;
-
-        n_audio_in++;
-      } else {
-        if (n_audio_out == 0)
-          data_ports.out.left = port->index;
-        else if (n_audio_out == 1)
-          data_ports.out.right = port->index;
-
-        n_audio_out++;
-      }
-    } else if (!port->optional) {
-      util::warning("Port " + port->name + " has un unsupported type!");
+    if (port.is_input) {
+      if (n_audio_in == 0)
+        data_ports.in.left = port.index;
+      else if (n_audio_in == 1)
+        data_ports.in.right = port.index;
+      else if (n_audio_in == 2)
+        data_ports.probe.left = port.index;
+      else if (n_audio_in == 3)
+        data_ports.probe.right = port.index;
+
+      n_audio_in++;
+    } else {
+      if (n_audio_out == 0)
+        data_ports.out.left = port.index;
+      else if (n_audio_out == 1)
+        data_ports.out.right = port.index;
+
+      n_audio_out++;
     }
-
-    lilv_node_free(port_name);
   }
 
   // util::warning("n audio_in ports: " + util::to_string(n_audio_in));
   // util::warning("n audio_out ports: " + util::to_string(n_audio_out));
-
-  lilv_node_free(lv2_connectionOptional);
-  lilv_node_free(lv2_ControlPort);
-  lilv_node_free(lv2_AtomPort);
-  lilv_node_free(lv2_AudioPort);
-  lilv_node_free(lv2_OutputPort);
-  lilv_node_free(lv2_InputPort);
 }
 
 auto Lv2Wrapper::create_instance(const uint& rate) -> bool {
+  const tracer::Span span([&] { return "lv2: instantiate " + plugin_uri; });
+
   this->rate = rate;
 
   if (instance != nullptr) {
@@ -279,7 +205,11 @@ auto Lv2Wrapper::create_instance(const uint& rate) -> bool {
   const auto features = std::to_array<const LV2_Feature*>(
       {&lv2_log_feature, &lv2_map_feature, &lv2_unmap_feature, &feature_options, static_features.data(), nullptr});
 
-  instance = lilv_plugin_instantiate(plugin, rate, features.data());
+  {
+    const auto lock = World::get().lock();
+
+    instance = lilv_plugin_instantiate(plugin, rate, features.data());
+  }
 
   if (instance == nullptr) {
     util::warning("failed to instantiate " + plugin_uri);
@@ -371,78 +301,72 @@ void Lv2Wrapper::deactivate() {
 }
 
 void Lv2Wrapper::set_control_port_value(const std::string& symbol, const float& value) {
-  auto found = false;
+  const auto iter = map_cp_symbol_to_idx.find(symbol);
 
-  for (auto& p : ports) {
-    if (p.type == PortType::TYPE_CONTROL && p.symbol == symbol) {
-      if (!p.is_input) {
-        util::warning(plugin_uri + " port " + symbol + " is not an input!");
+  if (iter == map_cp_symbol_to_idx.end()) {
+    util::warning(plugin_uri + " port symbol not found: " + symbol);
 
-        return;
-      }
+    return;
+  }
 
-      ui_port_event(p.index, value);
+  set_control_port_value(iter->second, value);
+}
 
-      // Check port bounds
-      if (value < p.min) {
-        // util::warning(plugin_uri + ": value " + util::to_string(value) + " is out of minimum limit for port " +
-        //               p.symbol + " (" + p.name + ")");
+void Lv2Wrapper::set_control_port_value(const uint& index, const float& value) {
+  auto& p = ports[index];
 
-        p.value = p.min;
-      } else if (value > p.max) {
-        // util::warning(plugin_uri + ": value " + util::to_string(value) + " is out of maximum limit for port " +
-        //               p.symbol + " (" + p.name + ")");
+  if (!p.is_input) {
+    util::warning(plugin_uri + " port " + p.symbol + " is not an input!");
 
-        p.value = p.max;
-      } else {
-        p.value = value;
-      }
+    return;
+  }
 
-      found = true;
+  ui_port_event(p.index, value);
 
-      break;
-    }
-  }
+  // Check port bounds
+  if (value < p.min) {
+    // util::warning(plugin_uri + ": value " + util::to_string(value) + " is out of minimum limit for port " +
+    //               p.symbol + " (" + p.name + ")");
 
-  if (!found) {
-    util::warning(plugin_uri + " port symbol not found: " + symbol);
+    p.value = p.min;
+  } else if (value > p.max) {
+    // util::warning(plugin_uri + ": value " + util::to_string(value) + " is out of maximum limit for port " +
+    //               p.symbol + " (" + p.name + ")");
+
+    p.value = p.max;
+  } else {
+    p.value = value;
   }
 }
-auto Lv2Wrapper::get_control_port_value(const std::string& symbol) -> float {
-  size_t hash = std::hash<std::string>{}(symbol);
 
-  for (const auto& slot : control_ports_cache) {
-    // We use hash == 0 to mean the cache slot and all following are empty.
-    // We might get collisions with hash == 0, which is fine.
-    if (slot.first == 0)
-      break;
+auto Lv2Wrapper::get_control_port_value(const std::string& symbol) -> float {
+  const auto iter = map_cp_symbol_to_idx.find(symbol);
 
-    if (slot.first != hash)
-      continue;
+  if (iter == map_cp_symbol_to_idx.end()) {
+    util::warning(plugin_uri + " port symbol not found: " + symbol);
 
-    // Ignore false positives.
-    const Port& p = ports[slot.second];
-    if (p.type == PortType::TYPE_CONTROL && p.symbol == symbol)
-      return p.value;
+    return 0.0F;
   }
 
-  for (const auto& p : ports) {
-    if (p.type == PortType::TYPE_CONTROL && p.symbol == symbol) {
-      // Add to cache.
-      for (size_t i = 0; i < control_ports_cache.size(); i++) {
-        if (control_ports_cache[i].first == 0) {
-          control_ports_cache[i] = std::pair<size_t, uint>(hash, p.index);
-          break;
-        }
-      }
+  return get_control_port_value(iter->second);
+}
 
-      return p.value;
+auto Lv2Wrapper::get_control_port_value(const uint& index) const -> float {
+  return ports[index].value;
+}
+
+auto Lv2Wrapper::bind_control_port(const std::string& symbol) -> ControlPortBinding* {
+  const auto iter = map_cp_symbol_to_idx.find(symbol);
+
+  if (iter == map_cp_symbol_to_idx.end()) {
+    if (found_plugin) {
+      util::warning(plugin_uri + " port symbol not found: " + symbol);
     }
-  }
 
-  util::warning(plugin_uri + " port symbol not found: " + symbol);
+    return nullptr;
+  }
 
-  return 0.0F;
+  return &control_port_bindings.emplace_back(ControlPortBinding{.self = this, .index = iter->second});
 }
 
 auto Lv2Wrapper::has_instance() -> bool {
@@ -474,6 +398,8 @@ void Lv2Wrapper::load_ui() {
         return;
       }
 
+      const auto world_lock = World::get().lock();
+
       LilvUIs* uis = lilv_plugin_get_uis(plugin);
 
       if (uis == nullptr) {
@@ -603,14 +529,14 @@ void Lv2Wrapper::load_ui() {
                   const void* buffer) {
                 auto self = static_cast<Lv2Wrapper*>(controller);
 
-                for (auto& p : self->ports) {
-                  if (p.index == port_index) {
-                    // util::warning("The user clicked on port: " + p.name + " -> " + p.symbol);
+                if (port_index >= self->ports.size()) {
+                  return;
+                }
+
+                // util::warning("The user clicked on port: " + self->ports[port_index].symbol);
 
-                    if (port_protocol == 0) {  // port is a ui:floatProtocol
-                      p.value = *static_cast<const float*>(buffer);
-                    }
-                  }
+                if (port_protocol == 0) {  // port is a ui:floatProtocol
+                  self->ports[port_index].value = *static_cast<const float*>(buffer);
                 }
               },
               this, &widget, features.data());
@@ -143,7 +143,9 @@ void Maximizer::process(std::span<float>& left_in,
 
       reduction_port_value = static_cast<double>(lv2_wrapper->get_control_port_value("gr"));
 
-      reduction.emit(reduction_port_value);
+      if (meter_slot != nullptr) {
+        meter_slot->set_extra(reduction_meter, static_cast<float>(reduction_port_value));
+      }
 
       notify();
     }
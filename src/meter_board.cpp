@@ -0,0 +1,67 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "meter_board.hpp"
+#include <cstddef>
+#include <mutex>
+#include "util.hpp"
+
+auto MeterBoard::get() -> MeterBoard& {
+  // Never destroyed. Plugins may release their slots while static objects are already being destroyed at exit.
+
+  static auto* board = new MeterBoard();
+
+  return *board;
+}
+
+auto MeterBoard::acquire() -> Slot* {
+  std::scoped_lock<std::mutex> lock(mutex);
+
+  for (size_t n = 0U; n < n_slots; n++) {
+    if (in_use[n]) {
+      continue;
+    }
+
+    in_use[n] = true;
+
+    auto& slot = slots[n];
+
+    slot.set_levels(util::minimum_db_level, util::minimum_db_level, util::minimum_db_level, util::minimum_db_level);
+
+    for (size_t m = 0U; m < n_extra; m++) {
+      slot.set_extra(m, 0.0F);
+    }
+
+    return &slot;
+  }
+
+  util::warning("the meter board is full. The level meters of new plugins will not be updated");
+
+  return nullptr;
+}
+
+void MeterBoard::release(Slot* slot) {
+  if (slot == nullptr) {
+    return;
+  }
+
+  std::scoped_lock<std::mutex> lock(mutex);
+
+  in_use[static_cast<size_t>(slot - slots.data())] = false;
+}
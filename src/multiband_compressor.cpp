@@ -166,10 +166,14 @@ void MultibandCompressor::process(std::span<float>& left_in,
                                              lv2_wrapper->get_control_port_value("rlm_" + nstr + "r"));
       }
 
-      frequency_range.emit(frequency_range_end_port_array);
-      envelope.emit(envelope_port_array);
-      curve.emit(curve_port_array);
-      reduction.emit(reduction_port_array);
+      if (meter_slot != nullptr) {
+        for (uint n = 0U; n < n_bands; n++) {
+          meter_slot->set_extra(frequency_range_meter + n, frequency_range_end_port_array.at(n));
+          meter_slot->set_extra(envelope_meter + n, envelope_port_array.at(n));
+          meter_slot->set_extra(curve_meter + n, curve_port_array.at(n));
+          meter_slot->set_extra(reduction_meter + n, reduction_port_array.at(n));
+        }
+      }
 
       notify();
     }
@@ -177,6 +181,10 @@ void MultibandCompressor::process(std::span<float>& left_in,
 }
 
 void MultibandCompressor::update_sidechain_links(const std::string& key) {
+  if (pm == nullptr) {
+    return;
+  }
+
   auto external_sidechain_enabled = false;
 
   for (uint n = 0U; !external_sidechain_enabled && n < n_bands; n++) {
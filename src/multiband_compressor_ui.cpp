@@ -34,6 +34,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include "meter_board.hpp"
 #include "multiband_compressor.hpp"
 #include "multiband_compressor_band_box.hpp"
 #include "node_info_holder.hpp"
@@ -207,104 +208,27 @@ void setup(MultibandCompressorBox* self,
     }
   }
 
-  self->data->connections.push_back(multiband_compressor->input_level.connect([=](const float left, const float right) {
-    g_object_ref(self);
+  ui::bind_level_meters(GTK_WIDGET(self), multiband_compressor, self->input_level_left, self->input_level_left_label,
+                        self->input_level_right, self->input_level_right_label, self->output_level_left,
+                        self->output_level_left_label, self->output_level_right, self->output_level_right_label);
 
-    util::idle_add(
-        [=]() {
-          if (get_ignore_filter_idle_add(serial)) {
-            return;
-          }
+  ui::add_meter_tick_callback(GTK_WIDGET(self), multiband_compressor, [=](const MeterBoard::Slot& slot) {
+    for (size_t n = 0U; n < tags::multiband_compressor::n_bands; n++) {
+      // The band ends are only zero until the plugin publishes its meters for the first time
 
-          update_level(self->input_level_left, self->input_level_left_label, self->input_level_right,
-                       self->input_level_right_label, left, right);
-        },
-        [=]() { g_object_unref(self); });
-  }));
+      if (const auto end = slot.get_extra(MultibandCompressor::frequency_range_meter + n); end > 0.0F) {
+        ui::multiband_compressor_band_box::set_end_label(self->bands[n], end);
+      }
 
-  self->data->connections.push_back(
-      multiband_compressor->output_level.connect([=](const float left, const float right) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              update_level(self->output_level_left, self->output_level_left_label, self->output_level_right,
-                           self->output_level_right_label, left, right);
-            },
-            [=]() { g_object_unref(self); });
-      }));
-
-  self->data->connections.push_back(multiband_compressor->frequency_range.connect(
-      [=](const std::array<float, tags::multiband_compressor::n_bands> values) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              for (size_t n = 0U; n < values.size(); n++) {
-                ui::multiband_compressor_band_box::set_end_label(self->bands[n], values[n]);
-              }
-            },
-            [=]() { g_object_unref(self); });
-      }));
-
-  self->data->connections.push_back(
-      multiband_compressor->envelope.connect([=](const std::array<float, tags::multiband_compressor::n_bands> values) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              for (size_t n = 0U; n < values.size(); n++) {
-                ui::multiband_compressor_band_box::set_envelope_label(self->bands[n], values[n]);
-              }
-            },
-            [=]() { g_object_unref(self); });
-      }));
-
-  self->data->connections.push_back(
-      multiband_compressor->curve.connect([=](const std::array<float, tags::multiband_compressor::n_bands> values) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              for (size_t n = 0U; n < values.size(); n++) {
-                ui::multiband_compressor_band_box::set_curve_label(self->bands[n], values[n]);
-              }
-            },
-            [=]() { g_object_unref(self); });
-      }));
-
-  self->data->connections.push_back(
-      multiband_compressor->reduction.connect([=](const std::array<float, tags::multiband_compressor::n_bands> values) {
-        g_object_ref(self);
-
-        util::idle_add(
-            [=]() {
-              if (get_ignore_filter_idle_add(serial)) {
-                return;
-              }
-
-              for (size_t n = 0U; n < values.size(); n++) {
-                ui::multiband_compressor_band_box::set_gain_label(self->bands[n], values[n]);
-              }
-            },
-            [=]() { g_object_unref(self); });
-      }));
+      const auto envelope = slot.get_extra(MultibandCompressor::envelope_meter + n);
+      const auto curve = slot.get_extra(MultibandCompressor::curve_meter + n);
+      const auto reduction = slot.get_extra(MultibandCompressor::reduction_meter + n);
+
+      ui::multiband_compressor_band_box::set_envelope_label(self->bands[n], envelope);
+      ui::multiband_compressor_band_box::set_curve_label(self->bands[n], curve);
+      ui::multiband_compressor_band_box::set_gain_label(self->bands[n], reduction);
+    }
+  });
 
   self->data->connections.push_back(pm->source_added.connect([=](const NodeInfo info) {
     for (guint n = 0U; n < g_list_model_get_n_items(G_LIST_MODEL(self->input_devices_model)); n++) {
@@ -0,0 +1,294 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "offline_renderer.hpp"
+#include <gio/gio.h>
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <sndfile.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <sndfile.hh>
+#include <span>
+#include <string>
+#include <vector>
+#include "config.h"
+#include "effects_base.hpp"
+#include "pipeline_type.hpp"
+#include "preset_type.hpp"
+#include "presets_manager.hpp"
+#include "tags_schema.hpp"
+#include "util.hpp"
+
+namespace {
+
+// The same limits we announce to the lv2 plugins
+
+constexpr auto min_quantum = 32;
+constexpr auto max_quantum = 8192;
+
+}  // namespace
+
+OfflineRenderer::OfflineRenderer(PipelineType pipe_type)
+    : EffectsBase("offline_renderer: ",
+                  (pipe_type == PipelineType::input) ? tags::schema::id_input : tags::schema::id_output,
+                  nullptr,
+                  pipe_type) {}
+
+OfflineRenderer::~OfflineRenderer() {
+  fused_chain->clear_chain();
+
+  util::debug(log_tag + "destroyed");
+}
+
+void OfflineRenderer::create_chain() {
+  create_filters_if_necessary();
+
+  const auto list = util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
+
+  fused_chain->set_chain(get_selected_plugins(list));
+}
+
+auto OfflineRenderer::dispatch_main_context() -> bool {
+  // Some plugins defer part of their setup to the main thread through util::idle_add. Here the main loop is not
+  // running so we have to dispatch these sources ourselves.
+
+  auto dispatched = false;
+
+  while (g_main_context_pending(nullptr) != 0) {
+    g_main_context_iteration(nullptr, 0);
+
+    dispatched = true;
+  }
+
+  return dispatched;
+}
+
+auto OfflineRenderer::render(const std::string& input_path, const std::string& output_path, const uint& quantum)
+    -> bool {
+  // SndfileHandle might have issues with std::string, so we provide cstring
+
+  auto input = SndfileHandle(input_path.c_str());
+
+  if (input.error() != 0 || input.channels() == 0) {
+    util::warning(log_tag + "could not open " + input_path + ": " + input.strError());
+
+    return false;
+  }
+
+  if (input.channels() > 2) {
+    util::warning(log_tag + input_path + " has " + util::to_string(input.channels()) +
+                  " channels. Only mono and stereo files are supported.");
+
+    return false;
+  }
+
+  const auto rate = static_cast<uint>(input.samplerate());
+  const auto n_channels = input.channels();
+  const auto n_frames = input.frames();
+
+  // Same container as the input but always with float samples so that nothing is clipped or dithered.
+
+  SF_INFO out_info{};
+
+  out_info.samplerate = input.samplerate();
+  out_info.channels = 2;
+  out_info.format = (input.format() & SF_FORMAT_TYPEMASK) | SF_FORMAT_FLOAT;
+
+  if (sf_format_check(&out_info) == 0) {
+    out_info.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+  }
+
+  auto output = SndfileHandle(output_path.c_str(), SFM_WRITE, out_info.format, 2, input.samplerate());
+
+  if (output.error() != 0) {
+    util::warning(log_tag + "could not create " + output_path + ": " + output.strError());
+
+    return false;
+  }
+
+  create_chain();
+
+  std::vector<float> interleaved(static_cast<size_t>(quantum) * 2U);
+  std::vector<float> buffer_left_in(quantum), buffer_right_in(quantum);
+  std::vector<float> buffer_left_out(quantum), buffer_right_out(quantum);
+
+  std::span<float> left_in(buffer_left_in);
+  std::span<float> right_in(buffer_right_in);
+  std::span<float> left_out(buffer_left_out);
+  std::span<float> right_out(buffer_right_out);
+
+  const auto run_cycle = [&]() {
+    fused_chain->prepare_process(rate, quantum);
+
+    fused_chain->process(left_in, right_in, left_out, right_out);
+
+    fused_chain->finish_process();
+  };
+
+  /*
+    The first cycle at a new rate calls each plugin's setup(). Silence is processed until the work they posted to the
+    main thread is done. Otherwise the beginning of the file would go through plugins that are still in passthrough.
+  */
+
+  std::ranges::fill(buffer_left_in, 0.0F);
+  std::ranges::fill(buffer_right_in, 0.0F);
+
+  for (uint n = 0U; n < max_warmup_cycles; n++) {
+    run_cycle();
+
+    if (!dispatch_main_context() && n > 0U) {
+      break;
+    }
+  }
+
+  fused_chain->update_latency();
+
+  // The output is shifted back by the chain latency so that it stays aligned with the input
+
+  const auto latency_frames =
+      static_cast<sf_count_t>(std::round(fused_chain->latency_value * static_cast<float>(rate)));
+
+  auto frames_to_skip = latency_frames;
+  auto frames_to_write = n_frames;
+
+  const auto time_start = std::chrono::steady_clock::now();
+
+  while (frames_to_write > 0) {
+    const auto n_read = input.readf(interleaved.data(), quantum);
+
+    for (sf_count_t n = 0; n < quantum; n++) {
+      if (n < n_read) {
+        buffer_left_in[n] = interleaved[n * n_channels];
+        buffer_right_in[n] = interleaved[(n * n_channels) + n_channels - 1];
+      } else {
+        buffer_left_in[n] = 0.0F;
+        buffer_right_in[n] = 0.0F;
+      }
+    }
+
+    run_cycle();
+
+    dispatch_main_context();
+
+    const auto offset = std::min(frames_to_skip, static_cast<sf_count_t>(quantum));
+
+    frames_to_skip -= offset;
+
+    const auto n_write = std::min(static_cast<sf_count_t>(quantum) - offset, frames_to_write);
+
+    for (sf_count_t n = 0; n < n_write; n++) {
+      interleaved[2 * n] = buffer_left_out[offset + n];
+      interleaved[(2 * n) + 1] = buffer_right_out[offset + n];
+    }
+
+    output.writef(interleaved.data(), n_write);
+
+    frames_to_write -= n_write;
+  }
+
+  const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
+
+  const auto duration = static_cast<double>(n_frames) / static_cast<double>(rate);
+
+  std::cout << output_path << ": " << util::to_string(duration, "") << " s rendered in " << util::to_string(elapsed, "")
+            << " s (" << util::to_string((elapsed > 0.0) ? duration / elapsed : 0.0, "") << "x realtime), quantum "
+            << quantum << ", rate " << rate << " Hz, latency compensation " << latency_frames << " frames" << '\n';
+
+  return true;
+}
+
+auto OfflineRenderer::run_from_command_line(int argc, char* argv[]) -> int {
+  // The preset is loaded into an in memory database. The running instance and the user settings are never touched.
+
+  g_setenv("GSETTINGS_BACKEND", "memory", 1);
+
+  gboolean render = 0;
+  gchar* preset = nullptr;
+  gchar* type = nullptr;
+  gint quantum = 1024;
+  gchar** files = nullptr;
+
+  auto entries = std::to_array<GOptionEntry>(
+      {{"render", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_NONE, &render,
+        _("Render a preset over an audio file without PipeWire"), nullptr},
+       {"load-preset", 'l', G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &preset, _("Name of the local preset to render"),
+        "NAME"},
+       {"preset-type", 't', G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &type,
+        _("Takes 'output' (default) or 'input' as a value"), "TYPE"},
+       {"quantum", 'q', G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &quantum, _("Frames processed per cycle. Default: 1024"),
+        "N"},
+       {G_OPTION_REMAINING, 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_FILENAME_ARRAY, &files, nullptr, nullptr},
+       {}});
+
+  auto* context = g_option_context_new(_("INPUT OUTPUT - Render a preset over an audio file"));
+
+  g_option_context_add_main_entries(context, entries.data(), GETTEXT_PACKAGE);
+
+  GError* error = nullptr;
+
+  const auto parsed = g_option_context_parse(context, &argc, &argv, &error) != 0;
+
+  g_option_context_free(context);
+
+  auto status = EXIT_FAILURE;
+
+  const auto n_files = (files != nullptr) ? g_strv_length(files) : 0U;
+
+  if (!parsed) {
+    std::cerr << error->message << '\n';
+
+    g_error_free(error);
+  } else if (preset == nullptr || n_files != 2U) {
+    std::cerr << "usage: easyeffects --render -l <preset> [-t output|input] [-q <quantum>] <input> <output>" << '\n';
+  } else if (type != nullptr && g_strcmp0(type, "input") != 0 && g_strcmp0(type, "output") != 0) {
+    std::cerr << "preset-type must have a value of input or output" << '\n';
+  } else if (quantum < min_quantum || quantum > max_quantum) {
+    std::cerr << "quantum must be between " << min_quantum << " and " << max_quantum << '\n';
+  } else {
+    const auto pipe_type = (g_strcmp0(type, "input") == 0) ? PipelineType::input : PipelineType::output;
+    const auto preset_type = (pipe_type == PipelineType::input) ? PresetType::input : PresetType::output;
+
+    // The preset is loaded first so that the plugins are created with their final settings
+
+    PresetsManager presets_manager;
+
+    if (!presets_manager.load_local_preset_file(preset_type, preset)) {
+      std::cerr << "could not load the preset " << preset << '\n';
+    } else {
+      OfflineRenderer renderer(pipe_type);
+
+      if (renderer.render(files[0], files[1], static_cast<uint>(quantum))) {
+        status = EXIT_SUCCESS;
+      }
+    }
+  }
+
+  g_free(preset);
+  g_free(type);
+  g_strfreev(files);
+
+  return status;
+}
@@ -19,6 +19,8 @@
 
 #include "output_level.hpp"
 #include <algorithm>
+#include <array>
+#include <cstddef>
 #include <span>
 #include <string>
 #include "pipe_manager.hpp"
@@ -31,7 +33,9 @@ OutputLevel::OutputLevel(const std::string& tag,
                          const std::string& schema_path,
                          PipeManager* pipe_manager,
                          PipelineType pipe_type)
-    : PluginBase(tag, "output_level", tags::plugin_package::ee, schema, schema_path, pipe_manager, pipe_type) {}
+    : PluginBase(tag, "output_level", tags::plugin_package::ee, schema, schema_path, pipe_manager, pipe_type) {
+  channel_policy = ChannelPolicy::linked;
+}
 
 OutputLevel::~OutputLevel() {
   if (connected_to_pw) {
@@ -50,11 +54,19 @@ void OutputLevel::process(std::span<float>& left_in,
                           std::span<float>& right_in,
                           std::span<float>& left_out,
                           std::span<float>& right_out) {
-  std::copy(left_in.begin(), left_in.end(), left_out.begin());
-  std::copy(right_in.begin(), right_in.end(), right_out.begin());
+  std::array<std::span<float>, 2U> inputs = {left_in, right_in};
+  std::array<std::span<float>, 2U> outputs = {left_out, right_out};
+
+  process(inputs, outputs);
+}
+
+void OutputLevel::process(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs) {
+  for (size_t c = 0U; c < inputs.size(); c++) {
+    std::ranges::copy(inputs[c], outputs[c].begin());
+  }
 
   if (post_messages) {
-    get_peaks(left_in, right_in, left_out, right_out);
+    get_peaks(inputs, outputs);
 
     if (send_notifications) {
       notify();
@@ -0,0 +1,274 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "partitioned_convolver.hpp"
+#include <sched.h>
+#include <sys/types.h>
+#include <zita-convolver.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include "convolution_pool.hpp"
+
+namespace {
+
+/*
+  Both engines have a single partition level whose size is the quantum. Zita runs that level in the caller thread,
+  so these values are not used to start any thread.
+*/
+
+constexpr auto CONVPROC_SCHEDULER_PRIORITY = 0;
+
+constexpr auto CONVPROC_SCHEDULER_CLASS = SCHED_FIFO;
+
+}  // namespace
+
+PartitionedConvolver::PartitionedConvolver(std::string name)
+    : client(std::make_unique<ConvolutionPool::Client>(std::move(name), [this] { run_deferred_block(); })) {}
+
+PartitionedConvolver::~PartitionedConvolver() {
+  stop_process();
+}
+
+void PartitionedConvolver::destroy(Convproc*& conv) {
+  if (conv == nullptr) {
+    return;
+  }
+
+  conv->stop_process();
+
+  conv->cleanup();
+
+  delete conv;
+
+  conv = nullptr;
+}
+
+auto PartitionedConvolver::configure(const uint& n_inputs,
+                                     const uint& n_outputs,
+                                     const uint& max_size,
+                                     const uint& quantum,
+                                     const uint& rate) -> int {
+  stop_process();
+
+  this->n_inputs = n_inputs;
+  this->n_outputs = n_outputs;
+  this->quantum = quantum;
+
+  deferred_quantum = std::max(quantum, std::min(deferred_factor * quantum, static_cast<uint>(Convproc::MAXPART)));
+
+  deferred_budget = std::chrono::nanoseconds(
+      rate != 0U ? static_cast<int64_t>(deferred_quantum) * 1000000000 / static_cast<int64_t>(rate) : 0);
+
+  const auto direct_size = std::min(max_size, 2U * deferred_quantum);
+
+  direct = new Convproc();
+
+  direct->set_options(0);
+
+  if (const int ret = direct->configure(n_inputs, n_outputs, direct_size, quantum, quantum, quantum, 0.0F /*density*/);
+      ret != 0) {
+    return ret;
+  }
+
+  if (max_size <= direct_size) {
+    return 0;
+  }
+
+  deferred = new Convproc();
+
+  deferred->set_options(0);
+
+  if (const int ret = deferred->configure(n_inputs, n_outputs, max_size - direct_size, deferred_quantum,
+                                          deferred_quantum, deferred_quantum, 0.0F /*density*/);
+      ret != 0) {
+    return ret;
+  }
+
+  deferred_input.assign(n_inputs, std::vector<float>(deferred_quantum, 0.0F));
+  deferred_staged.assign(n_inputs, std::vector<float>(deferred_quantum, 0.0F));
+  deferred_output.assign(n_outputs, std::vector<float>(deferred_quantum, 0.0F));
+
+  return 0;
+}
+
+auto PartitionedConvolver::impdata_create(const uint& input, const uint& output, std::span<const float> data) -> int {
+  const auto split = std::min(data.size(), static_cast<size_t>(2U * deferred_quantum));
+
+  auto* samples = const_cast<float*>(data.data());  // zita copies the data
+
+  if (const int ret = direct->impdata_create(input, output, 1, samples, 0, static_cast<int>(split)); ret != 0) {
+    return ret;
+  }
+
+  if (deferred == nullptr || split == data.size()) {
+    return 0;
+  }
+
+  return deferred->impdata_create(input, output, 1, samples + split, 0, static_cast<int>(data.size() - split));
+}
+
+auto PartitionedConvolver::start_process() -> int {
+  deferred_position = 0U;
+  deferred_submitted = false;
+  deferred_reset = false;
+  reset_before_block = false;
+
+  if (const int ret = direct->start_process(CONVPROC_SCHEDULER_PRIORITY, CONVPROC_SCHEDULER_CLASS); ret != 0) {
+    return ret;
+  }
+
+  if (deferred == nullptr) {
+    return 0;
+  }
+
+  if (const int ret = deferred->start_process(CONVPROC_SCHEDULER_PRIORITY, CONVPROC_SCHEDULER_CLASS); ret != 0) {
+    return ret;
+  }
+
+  // Only engines with a deferred part use the pool
+
+  ConvolutionPool::get().add(client.get());
+
+  registered = true;
+
+  return 0;
+}
+
+void PartitionedConvolver::stop_process() {
+  // The worker may still be using the deferred engine
+
+  if (registered) {
+    ConvolutionPool::get().remove(client.get());
+
+    registered = false;
+  } else {
+    ConvolutionPool::wait(*client);
+  }
+
+  destroy(direct);
+  destroy(deferred);
+
+  deferred_input.clear();
+  deferred_staged.clear();
+  deferred_output.clear();
+}
+
+auto PartitionedConvolver::process() -> int {
+  if (deferred != nullptr) {
+    for (uint n = 0U; n < n_inputs; n++) {
+      std::copy_n(direct->inpdata(n), quantum, deferred_input[n].begin() + deferred_position);
+    }
+  }
+
+  if (const int ret = direct->process(true); ret != 0 || deferred == nullptr) {
+    return ret;
+  }
+
+  for (uint n = 0U; n < n_outputs; n++) {
+    std::span out(direct->outdata(n), quantum);
+
+    const auto* tail = deferred_output[n].data() + deferred_position;
+
+    for (uint m = 0U; m < quantum; m++) {
+      out[m] += tail[m];
+    }
+  }
+
+  deferred_position += quantum;
+
+  if (deferred_position == deferred_quantum) {
+    deferred_position = 0U;
+
+    exchange_deferred_block();
+  }
+
+  return 0;
+}
+
+void PartitionedConvolver::exchange_deferred_block() {
+  /*
+    The block that has just been completed starts its convolution now and the result of the previous block is
+    collected. That result covers the taps from 2 * deferred_quantum on, so it belongs to the block that starts with
+    the next quantum.
+  */
+
+  if (client->is_busy()) {
+    /*
+      The worker did not finish in time. The tail is silent for the next block and the current input is lost. The
+      history of the deferred engine would be missing this block, and its output would be misaligned until the whole
+      kernel length has passed. It is cleared before the next block is convolved.
+    */
+
+    client->record_drop();
+
+    for (auto& v : deferred_output) {
+      std::ranges::fill(v, 0.0F);
+    }
+
+    deferred_submitted = false;
+    deferred_reset = true;
+
+    return;
+  }
+
+  for (uint n = 0U; n < n_outputs; n++) {
+    if (deferred_submitted) {
+      std::copy_n(deferred->outdata(n), deferred_quantum, deferred_output[n].begin());
+    } else {
+      std::ranges::fill(deferred_output[n], 0.0F);
+    }
+  }
+
+  // The worker copies the block to the engine. Clearing the engine history has to happen before that.
+
+  for (uint n = 0U; n < n_inputs; n++) {
+    std::ranges::copy(deferred_input[n], deferred_staged[n].begin());
+  }
+
+  reset_before_block = deferred_reset;
+
+  deferred_submitted = ConvolutionPool::get().submit(*client, deferred_budget);
+
+  if (deferred_submitted) {
+    deferred_reset = false;
+  }
+}
+
+void PartitionedConvolver::run_deferred_block() {
+  // Resetting costs about as much as convolving a block, so it is done here instead of in the realtime thread
+
+  if (reset_before_block) {
+    deferred->reset();
+  }
+
+  for (uint n = 0U; n < n_inputs; n++) {
+    std::ranges::copy(deferred_staged[n], deferred->inpdata(n));
+  }
+
+  deferred->process(true);
+}
+
+auto PartitionedConvolver::get_stats() const -> ConvolutionPool::Stats {
+  return client->get_stats();
+}
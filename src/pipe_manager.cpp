@@ -57,18 +57,24 @@
 #include <algorithm>
 #include <array>
 #include <cerrno>
-#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <ctime>
+#include <functional>
+#include <optional>
 #include <span>
 #include <stdexcept>
 #include <string>
-#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
+#include "channel_layout.hpp"
+#include "graph_transaction.hpp"
 #include "pipe_objects.hpp"
 #include "tags_app.hpp"
 #include "tags_pipewire.hpp"
+#include "tracer.hpp"
 #include "util.hpp"
 
 namespace {
@@ -165,6 +171,143 @@ auto link_info_from_props(const spa_dict* props) -> LinkInfo {
   return info;
 }
 
+auto port_direction_from_string(const std::string& direction) -> PortDirection {
+  if (direction == "in") {
+    return PortDirection::input;
+  }
+
+  if (direction == "out") {
+    return PortDirection::output;
+  }
+
+  return PortDirection::unknown;
+}
+
+auto audio_channel_from_string(const std::string& channel) -> AudioChannel {
+  constexpr auto names = std::to_array<std::pair<const char*, AudioChannel>>(
+      {{"MONO", AudioChannel::mono},
+       {"FL", AudioChannel::fl},
+       {"FR", AudioChannel::fr},
+       {"FC", AudioChannel::fc},
+       {"LFE", AudioChannel::lfe},
+       {"RL", AudioChannel::rl},
+       {"RR", AudioChannel::rr},
+       {"SL", AudioChannel::sl},
+       {"SR", AudioChannel::sr},
+       {"PROBE_FL", AudioChannel::probe_fl},
+       {"PROBE_FR", AudioChannel::probe_fr}});
+
+  for (const auto& [name, value] : names) {
+    if (channel == name) {
+      return value;
+    }
+  }
+
+  return AudioChannel::unknown;
+}
+
+// Channels of the speaker layouts supported by our filters. Mono and unknown ports are matched by port id.
+
+auto is_speaker_channel(const AudioChannel& channel) -> bool {
+  return channel >= AudioChannel::fl && channel <= AudioChannel::sr;
+}
+
+/*
+  Helpers for the vectors indexed by PipeManager. The index maps the key of an element to its position in the vector.
+  Removal keeps the order of the vector, which is the order shown in the PipeWire info page, and only updates the
+  positions of the elements that come after the removed one.
+*/
+
+template <typename T, typename Key>
+auto registry_find(std::vector<T>& list, const std::unordered_map<Key, size_t>& index, const Key& key) -> T* {
+  const auto it = index.find(key);
+
+  return (it != index.end()) ? &list[it->second] : nullptr;
+}
+
+template <typename T, typename Key>
+void registry_insert(std::vector<T>& list, std::unordered_map<Key, size_t>& index, const Key& key, const T& item) {
+  if (const auto it = index.find(key); it != index.end()) {
+    list[it->second] = item;
+
+    return;
+  }
+
+  index.emplace(key, list.size());
+
+  list.push_back(item);
+}
+
+template <typename T, typename Key, typename KeyOf>
+void registry_erase(std::vector<T>& list, std::unordered_map<Key, size_t>& index, const Key& key, KeyOf&& key_of) {
+  const auto it = index.find(key);
+
+  if (it == index.end()) {
+    return;
+  }
+
+  const auto position = it->second;
+
+  index.erase(it);
+
+  list.erase(list.begin() + static_cast<std::ptrdiff_t>(position));
+
+  for (auto n = position; n < list.size(); n++) {
+    index[key_of(list[n])] = n;
+  }
+}
+
+void add_port(PipeManager* pm, const PortInfo& info) {
+  if (pm->port_index_by_serial.contains(info.serial)) {
+    return;
+  }
+
+  registry_insert(pm->list_ports, pm->port_index_by_serial, info.serial, info);
+
+  pm->port_serials_by_node[info.node_id].push_back(info.serial);
+
+  if (info.channel != AudioChannel::unknown) {
+    pm->port_serial_by_key[{.node_id = info.node_id, .direction = info.direction, .channel = info.channel}] =
+        info.serial;
+  }
+}
+
+void remove_port(PipeManager* pm, const uint64_t& serial) {
+  const auto* port = registry_find(pm->list_ports, pm->port_index_by_serial, serial);
+
+  if (port == nullptr) {
+    return;
+  }
+
+  if (auto node_it = pm->port_serials_by_node.find(port->node_id); node_it != pm->port_serials_by_node.end()) {
+    std::erase(node_it->second, serial);
+
+    if (node_it->second.empty()) {
+      pm->port_serials_by_node.erase(node_it);
+    }
+  }
+
+  const PortKey key{.node_id = port->node_id, .direction = port->direction, .channel = port->channel};
+
+  if (auto key_it = pm->port_serial_by_key.find(key);
+      key_it != pm->port_serial_by_key.end() && key_it->second == serial) {
+    pm->port_serial_by_key.erase(key_it);
+  }
+
+  registry_erase(pm->list_ports, pm->port_index_by_serial, serial, [](const PortInfo& p) { return p.serial; });
+}
+
+// Removes the node from node_map and from the id index
+
+void erase_node(PipeManager* pm, std::map<uint64_t, NodeInfo>::iterator node_it) {
+  if (auto id_it = pm->node_serial_by_id.find(node_it->second.id);
+      id_it != pm->node_serial_by_id.end() && id_it->second == node_it->first) {
+    pm->node_serial_by_id.erase(id_it);
+  }
+
+  pm->node_map.erase(node_it);
+}
+
 auto port_info_from_props(const spa_dict* props) -> PortInfo {
   PortInfo info;
 
@@ -176,9 +319,13 @@ auto port_info_from_props(const spa_dict* props) -> PortInfo {
 
   spa_dict_get_num(props, PW_KEY_NODE_ID, info.node_id);
 
-  spa_dict_get_string(props, PW_KEY_PORT_DIRECTION, info.direction);
+  if (std::string direction; spa_dict_get_string(props, PW_KEY_PORT_DIRECTION, direction)) {
+    info.direction = port_direction_from_string(direction);
+  }
 
-  spa_dict_get_string(props, PW_KEY_AUDIO_CHANNEL, info.audio_channel);
+  if (spa_dict_get_string(props, PW_KEY_AUDIO_CHANNEL, info.audio_channel)) {
+    info.channel = audio_channel_from_string(info.audio_channel);
+  }
 
   spa_dict_get_string(props, PW_KEY_AUDIO_FORMAT, info.format_dsp);
 
@@ -216,7 +363,7 @@ void on_destroy_node_proxy(void* data) {
 
   spa_hook_remove(&nd->proxy_listener);
 
-  pm->node_map.erase(node_it);
+  erase_node(pm, node_it);
 
   if (!PipeManager::exiting) {
     if (nd->nd_info->media_class == tags::pipewire::media_class::source) {
@@ -371,7 +518,7 @@ void on_node_info(void* object, const struct pw_node_info* info) {
 
     spa_hook_remove(&nd->proxy_listener);
 
-    pm->node_map.erase(node_it);
+    erase_node(pm, node_it);
 
     if (nd->nd_info->media_class == tags::pipewire::media_class::source) {
       const auto nd_info_copy = *nd->nd_info;
@@ -798,26 +945,20 @@ void on_link_info(void* object, const struct pw_link_info* info) {
   auto* const ld = static_cast<proxy_data*>(object);
   auto* const pm = ld->pm;
 
-  LinkInfo link_copy;
-
-  for (auto& l : ld->pm->list_links) {
-    if (l.serial == ld->serial) {
-      l.state = info->state;
-
-      link_copy = l;
+  if (auto* l = registry_find(pm->list_links, pm->link_index_by_serial, ld->serial)) {
+    l->state = info->state;
 
-      util::idle_add([pm, link_copy] {
-        if (PipeManager::exiting) {
-          return;
-        }
+    const auto link_copy = *l;
 
-        pm->link_changed.emit(link_copy);
-      });
+    util::idle_add([pm, link_copy] {
+      if (PipeManager::exiting) {
+        return;
+      }
 
-      // util::warning(pw_link_state_as_string(l.state));
+      pm->link_changed.emit(link_copy);
+    });
 
-      break;
-    }
+    // util::warning(pw_link_state_as_string(l->state));
   }
 
   // const struct spa_dict_item* item = nullptr;
@@ -829,9 +970,8 @@ void on_destroy_link_proxy(void* data) {
 
   spa_hook_remove(&ld->proxy_listener);
 
-  ld->pm->list_links.erase(std::remove_if(ld->pm->list_links.begin(), ld->pm->list_links.end(),
-                                          [=](const auto& n) { return n.serial == ld->serial; }),
-                           ld->pm->list_links.end());
+  registry_erase(ld->pm->list_links, ld->pm->link_index_by_serial, ld->serial,
+                 [](const LinkInfo& l) { return l.serial; });
 }
 
 void on_destroy_port_proxy(void* data) {
@@ -839,24 +979,18 @@ void on_destroy_port_proxy(void* data) {
 
   spa_hook_remove(&pd->proxy_listener);
 
-  pd->pm->list_ports.erase(std::remove_if(pd->pm->list_ports.begin(), pd->pm->list_ports.end(),
-                                          [=](const auto& n) { return n.serial == pd->serial; }),
-                           pd->pm->list_ports.end());
+  remove_port(pd->pm, pd->serial);
 }
 
 void on_module_info(void* object, const struct pw_module_info* info) {
   auto* const md = static_cast<proxy_data*>(object);
 
-  for (auto& module : md->pm->list_modules) {
-    if (module.id == info->id) {
-      if (info->filename != nullptr) {
-        module.filename = info->filename;
-      }
-
-      spa_dict_get_string(info->props, PW_KEY_MODULE_DESCRIPTION, module.description);
-
-      break;
+  if (auto* module = registry_find(md->pm->list_modules, md->pm->module_index_by_id, info->id)) {
+    if (info->filename != nullptr) {
+      module->filename = info->filename;
     }
+
+    spa_dict_get_string(info->props, PW_KEY_MODULE_DESCRIPTION, module->description);
   }
 }
 
@@ -865,24 +999,18 @@ void on_destroy_module_proxy(void* data) {
 
   spa_hook_remove(&md->proxy_listener);
 
-  md->pm->list_modules.erase(std::remove_if(md->pm->list_modules.begin(), md->pm->list_modules.end(),
-                                            [=](const auto& n) { return n.id == md->id; }),
-                             md->pm->list_modules.end());
+  registry_erase(md->pm->list_modules, md->pm->module_index_by_id, md->id, [](const ModuleInfo& m) { return m.id; });
 }
 
 void on_client_info(void* object, const struct pw_client_info* info) {
   auto* const cd = static_cast<proxy_data*>(object);
 
-  for (auto& client : cd->pm->list_clients) {
-    if (client.id == info->id) {
-      spa_dict_get_string(info->props, PW_KEY_APP_NAME, client.name);
-
-      spa_dict_get_string(info->props, PW_KEY_ACCESS, client.access);
+  if (auto* client = registry_find(cd->pm->list_clients, cd->pm->client_index_by_id, info->id)) {
+    spa_dict_get_string(info->props, PW_KEY_APP_NAME, client->name);
 
-      spa_dict_get_string(info->props, PW_KEY_CLIENT_API, client.api);
+    spa_dict_get_string(info->props, PW_KEY_ACCESS, client->access);
 
-      break;
-    }
+    spa_dict_get_string(info->props, PW_KEY_CLIENT_API, client->api);
   }
 }
 
@@ -891,63 +1019,61 @@ void on_destroy_client_proxy(void* data) {
 
   spa_hook_remove(&cd->proxy_listener);
 
-  cd->pm->list_clients.erase(std::remove_if(cd->pm->list_clients.begin(), cd->pm->list_clients.end(),
-                                            [=](const auto& n) { return n.serial == cd->serial; }),
-                             cd->pm->list_clients.end());
+  registry_erase(cd->pm->list_clients, cd->pm->client_index_by_id, cd->id, [](const ClientInfo& c) { return c.id; });
 }
 
 void on_device_info(void* object, const struct pw_device_info* info) {
   auto* const dd = static_cast<proxy_data*>(object);
 
-  for (auto& device : dd->pm->list_devices) {
-    if (device.id != info->id) {
-      continue;
-    }
+  auto* device_ptr = registry_find(dd->pm->list_devices, dd->pm->device_index_by_id, info->id);
 
-    spa_dict_get_string(info->props, PW_KEY_DEVICE_NAME, device.name);
+  if (device_ptr == nullptr) {
+    return;
+  }
 
-    spa_dict_get_string(info->props, PW_KEY_DEVICE_NICK, device.nick);
+  auto& device = *device_ptr;
 
-    spa_dict_get_string(info->props, PW_KEY_DEVICE_DESCRIPTION, device.description);
+  spa_dict_get_string(info->props, PW_KEY_DEVICE_NAME, device.name);
 
-    spa_dict_get_string(info->props, PW_KEY_DEVICE_API, device.api);
+  spa_dict_get_string(info->props, PW_KEY_DEVICE_NICK, device.nick);
 
-    if (spa_dict_get_string(info->props, SPA_KEY_DEVICE_BUS_ID, device.bus_id)) {
-      std::ranges::replace(device.bus_id, ':', '_');
-      std::ranges::replace(device.bus_id, '+', '_');
-    }
+  spa_dict_get_string(info->props, PW_KEY_DEVICE_DESCRIPTION, device.description);
 
-    if (spa_dict_get_string(info->props, PW_KEY_DEVICE_BUS_PATH, device.bus_path)) {
-      std::ranges::replace(device.bus_path, ':', '_');
-      std::ranges::replace(device.bus_path, '+', '_');
-    }
+  spa_dict_get_string(info->props, PW_KEY_DEVICE_API, device.api);
 
-    /*
-        For some reason bluez5 devices do not define bus-path or bus-id. So as a workaround we set
-       SPA_KEY_API_BLUEZ5_ADDRESS as bus_path
-    */
+  if (spa_dict_get_string(info->props, SPA_KEY_DEVICE_BUS_ID, device.bus_id)) {
+    std::ranges::replace(device.bus_id, ':', '_');
+    std::ranges::replace(device.bus_id, '+', '_');
+  }
 
-    if (device.api == "bluez5") {
-      if (spa_dict_get_string(info->props, SPA_KEY_API_BLUEZ5_ADDRESS, device.bus_path)) {
-        std::replace(device.bus_path.begin(), device.bus_path.end(), ':', '_');
-      }
+  if (spa_dict_get_string(info->props, PW_KEY_DEVICE_BUS_PATH, device.bus_path)) {
+    std::ranges::replace(device.bus_path, ':', '_');
+    std::ranges::replace(device.bus_path, '+', '_');
+  }
+
+  /*
+      For some reason bluez5 devices do not define bus-path or bus-id. So as a workaround we set
+     SPA_KEY_API_BLUEZ5_ADDRESS as bus_path
+  */
+
+  if (device.api == "bluez5") {
+    if (spa_dict_get_string(info->props, SPA_KEY_API_BLUEZ5_ADDRESS, device.bus_path)) {
+      std::replace(device.bus_path.begin(), device.bus_path.end(), ':', '_');
     }
+  }
 
-    if ((info->change_mask & PW_DEVICE_CHANGE_MASK_PARAMS) != 0U) {
-      auto params = std::span(info->params, info->n_params);
+  if ((info->change_mask & PW_DEVICE_CHANGE_MASK_PARAMS) != 0U) {
+    auto params = std::span(info->params, info->n_params);
 
-      for (auto param : params) {
-        if ((param.flags & SPA_PARAM_INFO_READ) == 0U) {
-          continue;
-        }
+    for (auto param : params) {
+      if ((param.flags & SPA_PARAM_INFO_READ) == 0U) {
+        continue;
+      }
 
-        if (const auto id = param.id; id == SPA_PARAM_Route) {
-          pw_device_enum_params((struct pw_device*)dd->proxy, 0, id, 0, -1, nullptr);
-        }
+      if (const auto id = param.id; id == SPA_PARAM_Route) {
+        pw_device_enum_params((struct pw_device*)dd->proxy, 0, id, 0, -1, nullptr);
       }
     }
-
-    break;
   }
 }
 
@@ -978,42 +1104,42 @@ void on_device_event_param(void* object,
     return;
   }
 
-  for (auto& device : dd->pm->list_devices) {
-    if (device.id != dd->id) {
-      continue;
-    }
+  auto* device_ptr = registry_find(dd->pm->list_devices, dd->pm->device_index_by_id, dd->id);
 
-    auto* const pm = dd->pm;
+  if (device_ptr == nullptr) {
+    return;
+  }
 
-    if (direction == SPA_DIRECTION_INPUT) {
-      if (name != device.input_route_name || available != device.input_route_available) {
-        device.input_route_name = name;
-        device.input_route_available = available;
+  auto& device = *device_ptr;
 
-        util::idle_add([pm, device] {
-          if (PipeManager::exiting) {
-            return;
-          }
+  auto* const pm = dd->pm;
 
-          pm->device_input_route_changed.emit(device);
-        });
-      }
-    } else if (direction == SPA_DIRECTION_OUTPUT) {
-      if (name != device.output_route_name || available != device.output_route_available) {
-        device.output_route_name = name;
-        device.output_route_available = available;
-
-        util::idle_add([pm, device] {
-          if (PipeManager::exiting) {
-            return;
-          }
+  if (direction == SPA_DIRECTION_INPUT) {
+    if (name != device.input_route_name || available != device.input_route_available) {
+      device.input_route_name = name;
+      device.input_route_available = available;
 
-          pm->device_output_route_changed.emit(device);
-        });
-      }
+      util::idle_add([pm, device] {
+        if (PipeManager::exiting) {
+          return;
+        }
+
+        pm->device_input_route_changed.emit(device);
+      });
     }
+  } else if (direction == SPA_DIRECTION_OUTPUT) {
+    if (name != device.output_route_name || available != device.output_route_available) {
+      device.output_route_name = name;
+      device.output_route_available = available;
 
-    break;
+      util::idle_add([pm, device] {
+        if (PipeManager::exiting) {
+          return;
+        }
+
+        pm->device_output_route_changed.emit(device);
+      });
+    }
   }
 }
 
@@ -1022,9 +1148,7 @@ void on_destroy_device_proxy(void* data) {
 
   spa_hook_remove(&dd->proxy_listener);
 
-  dd->pm->list_devices.erase(std::remove_if(dd->pm->list_devices.begin(), dd->pm->list_devices.end(),
-                                            [=](const auto& n) { return n.id == dd->id; }),
-                             dd->pm->list_devices.end());
+  registry_erase(dd->pm->list_devices, dd->pm->device_index_by_id, dd->id, [](const DeviceInfo& d) { return d.id; });
 }
 
 auto on_metadata_property(void* data, uint32_t id, const char* key, const char* type, const char* value) -> int {
@@ -1253,9 +1377,15 @@ void on_registry_global(void* data,
       return;
     }
 
+    pm->node_serial_by_id[id] = serial;
+
     pw_proxy_add_object_listener(proxy, &nd->object_listener, &node_events, nd);
     pw_proxy_add_listener(proxy, &nd->proxy_listener, &node_proxy_events, nd);
 
+    // Wakes up whoever is blocked in PipeManager::wait_until() waiting for this node
+
+    pw_thread_loop_signal(pm->thread_loop, false);
+
     // sometimes PipeWire destroys the pointer before signal_idle is called,
     // therefore we make a copy of NodeInfo
 
@@ -1331,7 +1461,7 @@ void on_registry_global(void* data,
     link_info.id = id;
     link_info.serial = serial;
 
-    pm->list_links.push_back(link_info);
+    registry_insert(pm->list_links, pm->link_index_by_serial, serial, link_info);
 
     try {
       const auto input_node = pm->node_map_at_id(link_info.input_node_id);
@@ -1375,7 +1505,9 @@ void on_registry_global(void* data,
     // std::cout << port_info.name << "\t" << port_info.audio_channel << "\t" << port_info.direction << "\t"
     //           << port_info.format_dsp << "\t" << port_info.port_id << "\t" << port_info.node_id << std::endl;
 
-    pm->list_ports.push_back(port_info);
+    add_port(pm, port_info);
+
+    pw_thread_loop_signal(pm->thread_loop, false);
 
     return;
   }
@@ -1406,7 +1538,7 @@ void on_registry_global(void* data,
 
     spa_dict_get_string(props, PW_KEY_MODULE_NAME, m_info.name);
 
-    pm->list_modules.push_back(m_info);
+    registry_insert(pm->list_modules, pm->module_index_by_id, id, m_info);
 
     return;
   }
@@ -1435,7 +1567,7 @@ void on_registry_global(void* data,
 
     ClientInfo c_info{.id = id, .serial = serial};
 
-    pm->list_clients.push_back(c_info);
+    registry_insert(pm->list_clients, pm->client_index_by_id, id, c_info);
 
     return;
   }
@@ -1494,7 +1626,7 @@ void on_registry_global(void* data,
 
         DeviceInfo d_info{.id = id, .serial = serial, .media_class = media_class};
 
-        pm->list_devices.push_back(d_info);
+        registry_insert(pm->list_devices, pm->device_index_by_id, id, d_info);
       }
     }
 
@@ -1540,6 +1672,8 @@ void on_core_done(void* data, uint32_t id, int seq) {
   auto* const pm = static_cast<PipeManager*>(data);
 
   if (id == PW_ID_CORE) {
+    pm->sync_done_seq = seq;
+
     pw_thread_loop_signal(pm->thread_loop, false);
   }
 }
@@ -1555,7 +1689,12 @@ const struct pw_registry_events registry_events = {
 
 }  // namespace
 
-PipeManager::PipeManager() : header_version(pw_get_headers_version()), library_version(pw_get_library_version()) {
+PipeManager::PipeManager(std::vector<std::string> channel_positions)
+    : channel_positions(std::move(channel_positions)),
+      header_version(pw_get_headers_version()),
+      library_version(pw_get_library_version()) {
+  const tracer::Span span("PipeManager: connect");
+
   pw_init(nullptr, nullptr);
 
   spa_zero(core_listener);
@@ -1608,6 +1747,8 @@ PipeManager::PipeManager() : header_version(pw_get_headers_version()), library_v
 
   pw_core_add_listener(core, &core_listener, &core_events, this);
 
+  const auto audio_position = channel_layout::to_audio_position(this->channel_positions);
+
   // loading Easy Effects sink
 
   pw_properties* props_sink = pw_properties_new(nullptr, nullptr);
@@ -1619,7 +1760,7 @@ PipeManager::PipeManager() : header_version(pw_get_headers_version()), library_v
   pw_properties_set(props_sink, PW_KEY_NODE_PASSIVE, "out");
   pw_properties_set(props_sink, "factory.name", "support.null-audio-sink");
   pw_properties_set(props_sink, PW_KEY_MEDIA_CLASS, tags::pipewire::media_class::sink);
-  pw_properties_set(props_sink, "audio.position", "FL,FR");
+  pw_properties_set(props_sink, "audio.position", audio_position.c_str());
   pw_properties_set(props_sink, "monitor.channel-volumes", "false");
   pw_properties_set(props_sink, "monitor.passthrough", "true");
   pw_properties_set(props_sink, "priority.session", "0");
@@ -1639,7 +1780,7 @@ PipeManager::PipeManager() : header_version(pw_get_headers_version()), library_v
   pw_properties_set(props_source, PW_KEY_NODE_VIRTUAL, "true");
   pw_properties_set(props_source, "factory.name", "support.null-audio-sink");
   pw_properties_set(props_source, PW_KEY_MEDIA_CLASS, tags::pipewire::media_class::virtual_source);
-  pw_properties_set(props_source, "audio.position", "FL,FR");
+  pw_properties_set(props_source, "audio.position", audio_position.c_str());
   pw_properties_set(props_source, "monitor.channel-volumes", "false");
   pw_properties_set(props_source, "monitor.passthrough", "true");
   pw_properties_set(props_source, "priority.session", "0");
@@ -1649,27 +1790,41 @@ PipeManager::PipeManager() : header_version(pw_get_headers_version()), library_v
 
   pw_properties_free(props_source);
 
+  tracer::Span sync_span("PipeManager: registry sync");
+
   sync_wait_unlock();
 
   using namespace std::string_literals;
 
-  do {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  // The registry signals the loop when a node is added. No polling is needed to find our virtual devices.
 
-    for (const auto& [serial, node] : node_map) {
-      if (ee_sink_node.name.empty() && node.name == tags::pipewire::ee_sink_name) {
-        ee_sink_node = node;
+  const auto found = wait_until(
+      [&] {
+        for (const auto& [serial, node] : node_map) {
+          if (ee_sink_node.name.empty() && node.name == tags::pipewire::ee_sink_name) {
+            ee_sink_node = node;
+          } else if (ee_source_node.name.empty() && node.name == tags::pipewire::ee_source_name) {
+            ee_source_node = node;
+          }
+        }
 
-        util::debug(tags::pipewire::ee_sink_name + " node successfully retrieved with id "s + util::to_string(node.id) +
-                    " and serial " + util::to_string(node.serial));
-      } else if (ee_source_node.name.empty() && node.name == tags::pipewire::ee_source_name) {
-        ee_source_node = node;
+        return ee_sink_node.id != SPA_ID_INVALID && ee_source_node.id != SPA_ID_INVALID;
+      },
+      30);
 
-        util::debug(tags::pipewire::ee_source_name + " node successfully retrieved with id "s +
-                    util::to_string(node.id) + " and serial " + util::to_string(node.serial));
-      }
-    }
-  } while (ee_sink_node.id == SPA_ID_INVALID || ee_source_node.id == SPA_ID_INVALID);
+  sync_span.end();
+
+  if (!found) {
+    util::warning("Our virtual devices are taking too long to be available. Easy Effects may not work properly");
+
+    return;
+  }
+
+  util::debug(tags::pipewire::ee_sink_name + " node successfully retrieved with id "s +
+              util::to_string(ee_sink_node.id) + " and serial " + util::to_string(ee_sink_node.serial));
+
+  util::debug(tags::pipewire::ee_source_name + " node successfully retrieved with id "s +
+              util::to_string(ee_source_node.id) + " and serial " + util::to_string(ee_source_node.serial));
 }
 
 PipeManager::~PipeManager() {
@@ -1709,9 +1864,9 @@ PipeManager::~PipeManager() {
 auto PipeManager::node_map_at_id(const uint& id) -> NodeInfo& {
   // Helper method to access easily a node by id, same functionality as map.at()
 
-  for (auto& [serial, node] : node_map) {
-    if (node.id == id) {
-      return node;
+  if (const auto id_it = node_serial_by_id.find(id); id_it != node_serial_by_id.end()) {
+    if (auto node_it = node_map.find(id_it->second); node_it != node_map.end()) {
+      return node_it->second;
     }
   }
 
@@ -1809,48 +1964,55 @@ void PipeManager::set_node_mute(pw_proxy* proxy, const bool& state) const {
 }
 
 auto PipeManager::count_node_ports(const uint& node_id) -> uint {
-  uint count = 0U;
-
-  for (const auto& port : list_ports) {
-    if (port.node_id == node_id) {
-      count++;
-    }
-  }
+  const auto it = port_serials_by_node.find(node_id);
 
-  return count;
+  return (it != port_serials_by_node.end()) ? static_cast<uint>(it->second.size()) : 0U;
 }
 
-auto PipeManager::link_nodes(const uint& output_node_id,
-                             const uint& input_node_id,
-                             const bool& probe_link,
-                             const bool& link_passive) -> std::vector<pw_proxy*> {
-  std::vector<pw_proxy*> list;
+auto PipeManager::match_ports(const uint& output_node_id, const uint& input_node_id, const bool& probe_link)
+    -> std::vector<std::pair<PortInfo, PortInfo>> {
+  std::vector<std::pair<PortInfo, PortInfo>> list;
+
+  /*
+    The ports are copied because the registry callbacks can change the port list before the links are created.
+  */
+
   std::vector<PortInfo> list_output_ports;
   std::vector<PortInfo> list_input_ports;
   auto use_audio_channel = true;
 
-  for (const auto& port : list_ports) {
-    if (port.node_id == output_node_id && port.direction == "out") {
-      list_output_ports.push_back(port);
+  const auto find_port = [this](const uint64_t& serial) -> const PortInfo* {
+    return registry_find(list_ports, port_index_by_serial, serial);
+  };
 
-      if (!probe_link) {
-        if (port.audio_channel != "FL" && port.audio_channel != "FR") {
+  if (const auto it = port_serials_by_node.find(output_node_id); it != port_serials_by_node.end()) {
+    for (const auto& serial : it->second) {
+      if (const auto* port = find_port(serial); port != nullptr && port->direction == PortDirection::output) {
+        list_output_ports.push_back(*port);
+
+        if (!probe_link && !is_speaker_channel(port->channel)) {
           use_audio_channel = false;
         }
       }
     }
+  }
+
+  if (const auto it = port_serials_by_node.find(input_node_id); it != port_serials_by_node.end()) {
+    for (const auto& serial : it->second) {
+      const auto* port = find_port(serial);
+
+      if (port == nullptr || port->direction != PortDirection::input) {
+        continue;
+      }
 
-    if (port.node_id == input_node_id && port.direction == "in") {
       if (!probe_link) {
-        list_input_ports.push_back(port);
+        list_input_ports.push_back(*port);
 
-        if (port.audio_channel != "FL" && port.audio_channel != "FR") {
+        if (!is_speaker_channel(port->channel)) {
           use_audio_channel = false;
         }
-      } else {
-        if (port.audio_channel == "PROBE_FL" || port.audio_channel == "PROBE_FR") {
-          list_input_ports.push_back(port);
-        }
+      } else if (port->channel == AudioChannel::probe_fl || port->channel == AudioChannel::probe_fr) {
+        list_input_ports.push_back(*port);
       }
     }
   }
@@ -1867,62 +2029,57 @@ auto PipeManager::link_nodes(const uint& output_node_id,
     return list;
   }
 
-  for (const auto& outp : list_output_ports) {
-    for (const auto& inp : list_input_ports) {
-      bool ports_match = false;
+  // The input port that goes with an output port. When the channels are known it is found through the channel index.
 
-      if (!probe_link) {
-        if (use_audio_channel) {
-          ports_match = outp.audio_channel == inp.audio_channel;
-        } else {
-          ports_match = outp.port_id == inp.port_id;
-        }
-      } else {
-        if (outp.audio_channel == "FL" && inp.audio_channel == "PROBE_FL") {
-          ports_match = true;
-        }
+  const auto match_input = [&](const PortInfo& outp) -> std::optional<PortInfo> {
+    if (probe_link || use_audio_channel) {
+      auto channel = outp.channel;
 
-        if (outp.audio_channel == "FR" && inp.audio_channel == "PROBE_FR") {
-          ports_match = true;
+      if (probe_link) {
+        if (outp.channel != AudioChannel::fl && outp.channel != AudioChannel::fr) {
+          return std::nullopt;
         }
-      }
-
-      if (ports_match) {
-        pw_properties* props = pw_properties_new(nullptr, nullptr);
-
-        pw_properties_set(props, PW_KEY_LINK_PASSIVE, (link_passive) ? "true" : "false");
-        pw_properties_set(props, PW_KEY_OBJECT_LINGER, "false");
-        pw_properties_set(props, PW_KEY_LINK_OUTPUT_NODE, util::to_string(output_node_id).c_str());
-        pw_properties_set(props, PW_KEY_LINK_OUTPUT_PORT, util::to_string(outp.id).c_str());
-        pw_properties_set(props, PW_KEY_LINK_INPUT_NODE, util::to_string(input_node_id).c_str());
-        pw_properties_set(props, PW_KEY_LINK_INPUT_PORT, util::to_string(inp.id).c_str());
 
-        lock();
+        channel = (outp.channel == AudioChannel::fl) ? AudioChannel::probe_fl : AudioChannel::probe_fr;
+      }
 
-        auto* proxy = static_cast<pw_proxy*>(
-            pw_core_create_object(core, "link-factory", PW_TYPE_INTERFACE_Link, PW_VERSION_LINK, &props->dict, 0));
+      const auto it = port_serial_by_key.find(
+          {.node_id = input_node_id, .direction = PortDirection::input, .channel = channel});
 
-        pw_properties_free(props);
+      if (it == port_serial_by_key.end()) {
+        return std::nullopt;
+      }
 
-        if (proxy == nullptr) {
-          util::warning("failed to link the node " + util::to_string(output_node_id) + " to " +
-                        util::to_string(input_node_id));
+      const auto in_it = std::ranges::find(list_input_ports, it->second, &PortInfo::serial);
 
-          unlock();
+      return (in_it != list_input_ports.end()) ? std::optional(*in_it) : std::nullopt;
+    }
 
-          return list;
-        }
+    const auto in_it = std::ranges::find(list_input_ports, outp.port_id, &PortInfo::port_id);
 
-        sync_wait_unlock();
+    return (in_it != list_input_ports.end()) ? std::optional(*in_it) : std::nullopt;
+  };
 
-        list.push_back(proxy);
-      }
+  for (const auto& outp : list_output_ports) {
+    if (const auto inp = match_input(outp)) {
+      list.emplace_back(outp, *inp);
     }
   }
 
   return list;
 }
 
+auto PipeManager::link_nodes(const uint& output_node_id,
+                             const uint& input_node_id,
+                             const bool& probe_link,
+                             const bool& link_passive) -> std::vector<pw_proxy*> {
+  GraphTransaction transaction(this);
+
+  transaction.link_nodes(output_node_id, input_node_id, probe_link, link_passive);
+
+  return transaction.commit().proxies;
+}
+
 void PipeManager::lock() const {
   pw_thread_loop_lock(thread_loop);
 }
@@ -1932,13 +2089,53 @@ void PipeManager::unlock() const {
 }
 
 void PipeManager::sync_wait_unlock() const {
-  pw_core_sync(core, PW_ID_CORE, 0);
+  const auto seq = pw_core_sync(core, PW_ID_CORE, 0);
+
+  /*
+    The loop is also signalled by the registry and by the filters state changes. Only the done event carrying our
+    sequence number ends the round-trip. The requests are answered in order, so a later done event also means that
+    ours was answered. This matters when several threads are waiting at the same time.
+  */
+
+  if (seq >= 0) {
+    timespec abstime;
+
+    pw_thread_loop_get_time(thread_loop, &abstime, 30 * SPA_NSEC_PER_SEC);
 
-  pw_thread_loop_wait(thread_loop);
+    while (sync_done_seq < seq) {
+      if (pw_thread_loop_timed_wait_full(thread_loop, &abstime) != 0) {
+        util::warning("PipeWire did not answer our sync request in time");
+
+        break;
+      }
+    }
+  }
 
   pw_thread_loop_unlock(thread_loop);
 }
 
+auto PipeManager::wait_until(const std::function<bool()>& ready, const int& timeout_seconds) const -> bool {
+  timespec abstime;
+
+  lock();
+
+  pw_thread_loop_get_time(thread_loop, &abstime, timeout_seconds * SPA_NSEC_PER_SEC);
+
+  auto is_ready = ready();
+
+  while (!is_ready) {
+    if (pw_thread_loop_timed_wait_full(thread_loop, &abstime) != 0) {
+      break;
+    }
+
+    is_ready = ready();
+  }
+
+  unlock();
+
+  return is_ready;
+}
+
 auto PipeManager::wait_full() const -> int {
   timespec abstime;
 
@@ -1955,16 +2152,12 @@ void PipeManager::destroy_object(const int& id) const {
   sync_wait_unlock();
 }
 
-void PipeManager::destroy_links(const std::vector<pw_proxy*>& list) const {
-  for (auto* proxy : list) {
-    if (proxy != nullptr) {
-      lock();
+void PipeManager::destroy_links(const std::vector<pw_proxy*>& list) {
+  GraphTransaction transaction(this);
 
-      pw_proxy_destroy(proxy);
+  transaction.destroy_links(list);
 
-      sync_wait_unlock();
-    }
-  }
+  transaction.commit();
 }
 
 /*
@@ -28,6 +28,7 @@
 #include <mutex>
 #include <span>
 #include <string>
+#include "block_adapter.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 #include "tags_plugin_name.hpp"
@@ -45,6 +46,8 @@ Pitch::Pitch(const std::string& tag,
                  schema_path,
                  pipe_manager,
                  pipe_type) {
+  allocate_dry_delay();
+
   quick_seek = g_settings_get_boolean(settings, "quick-seek") != 0;
   anti_alias = g_settings_get_boolean(settings, "anti-alias") != 0;
 
@@ -213,8 +216,16 @@ void Pitch::setup() {
     data.resize(2U * static_cast<size_t>(n_samples));
   }
 
-  deque_out_L.resize(0U);
-  deque_out_R.resize(0U);
+  data_L.resize(n_samples);
+  data_R.resize(n_samples);
+
+  /*
+    SoundTouch does not work on fixed blocks. Only the output fifo is used. Its initial latency is found when the
+    first cycles run short. Tempo changes may produce more samples than we consume. The fifo has room for a few
+    quanta and drops the oldest frames after that.
+  */
+
+  block_adapter.setup(n_samples, n_samples, 0U, 4U * static_cast<size_t>(n_samples));
 
   util::idle_add([&, this] {
     if (soundtouch_ready) {
@@ -233,7 +244,15 @@ void Pitch::process(std::span<float>& left_in,
                     std::span<float>& right_in,
                     std::span<float>& left_out,
                     std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  const auto lock = lock_for_rt();
+
+  if (!lock.owns_lock()) {
+    write_delayed_dry(left_in, right_in, left_out, right_out);
+
+    return;
+  }
+
+  store_dry(left_in, right_in);
 
   if (bypass || !soundtouch_ready) {
     std::copy(left_in.begin(), left_in.end(), left_out.begin());
@@ -259,45 +278,20 @@ void Pitch::process(std::span<float>& left_in,
     n_received = snd_touch->receiveSamples(data.data(), n_samples);
 
     for (size_t n = 0U; n < n_received; n++) {
-      deque_out_L.push_back(data[n * 2U]);
-      deque_out_R.push_back(data[n * 2U + 1U]);
+      data_L[n] = data[n * 2U];
+      data_R[n] = data[n * 2U + 1U];
     }
 
+    block_adapter.push(std::span<const float>(data_L.data(), n_received),
+                       std::span<const float>(data_R.data(), n_received));
   } while (n_received != 0);
 
-  if (deque_out_L.size() >= left_out.size()) {
-    for (float& v : left_out) {
-      v = deque_out_L.front();
+  block_adapter.pop(left_out, right_out);
 
-      deque_out_L.pop_front();
-    }
+  if (block_adapter.get_latency() != latency_n_frames) {
+    latency_n_frames = block_adapter.get_latency();
 
-    for (float& v : right_out) {
-      v = deque_out_R.front();
-
-      deque_out_R.pop_front();
-    }
-  } else {
-    const uint offset = left_out.size() - deque_out_L.size();
-
-    if (offset != latency_n_frames) {
-      latency_n_frames = offset;
-
-      notify_latency = true;
-    }
-
-    for (uint n = 0U; !deque_out_L.empty() && n < left_out.size(); n++) {
-      if (n < offset) {
-        left_out[n] = 0.0F;
-        right_out[n] = 0.0F;
-      } else {
-        left_out[n] = deque_out_L.front();
-        right_out[n] = deque_out_R.front();
-
-        deque_out_R.pop_front();
-        deque_out_L.pop_front();
-      }
-    }
+    notify_latency = true;
   }
 
   if (output_gain != 1.0F) {
@@ -43,17 +43,102 @@
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <mutex>
 #include <span>
 #include <string>
-#include <thread>
 #include <utility>
+#include <vector>
+#include "channel_layout.hpp"
+#include "meter_board.hpp"
 #include "pipe_manager.hpp"
 #include "tags_app.hpp"
 #include "tags_plugin_name.hpp"
+#include "tracer.hpp"
 #include "util.hpp"
 
 namespace {
 
+// Used to size the delay lines when the server settings are not known
+
+constexpr auto default_rate = 48000U;
+
+constexpr auto default_max_quantum = 8192U;
+
+// Writes the inputs to the delay lines and, when there are outputs, reads them back delayed by the given frames
+
+void run_delay_lines(std::vector<std::vector<float>>& lines,
+                     size_t& write_index,
+                     std::span<const std::span<float>> inputs,
+                     std::span<std::span<float>> outputs,
+                     const size_t& delay_frames) {
+  if (lines.empty() || inputs.empty()) {
+    return;
+  }
+
+  const auto size = lines[0].size();
+
+  const auto delay = std::min(delay_frames, size - 1U);
+
+  const auto n_frames = inputs[0].size();
+
+  for (size_t c = 0U; c < inputs.size() && c < lines.size(); c++) {
+    auto& line = lines[c];
+
+    auto w = write_index;
+
+    for (size_t n = 0U; n < n_frames; n++) {
+      line[w] = inputs[c][n];
+
+      if (c < outputs.size()) {
+        outputs[c][n] = line[(w + size - delay) % size];
+      }
+
+      w = (w + 1U) % size;
+    }
+  }
+
+  write_index = (write_index + n_frames) % size;
+}
+
+void on_process_channels(PluginBase::data* d, const uint& n_samples) {
+  auto* pb = d->pb;
+
+  for (uint c = 0U; c < pb->n_channels; c++) {
+    auto* in = static_cast<float*>(pw_filter_get_dsp_buffer(d->in[c], n_samples));
+    auto* out = static_cast<float*>(pw_filter_get_dsp_buffer(d->out[c], n_samples));
+
+    auto& dummy = (c % 2U == 0U) ? pb->dummy_left : pb->dummy_right;
+
+    pb->channel_in[c] = (in != nullptr) ? std::span(in, n_samples) : std::span(dummy);
+    pb->channel_out[c] = (out != nullptr) ? std::span(out, n_samples) : std::span(dummy);
+  }
+
+  std::span<std::span<float>> inputs(pb->channel_in);
+  std::span<std::span<float>> outputs(pb->channel_out);
+
+  if (!pb->enable_probe) {
+    pb->process(inputs, outputs);
+
+    return;
+  }
+
+  auto* probe_left = static_cast<float*>(pw_filter_get_dsp_buffer(d->probe_left, n_samples));
+  auto* probe_right = static_cast<float*>(pw_filter_get_dsp_buffer(d->probe_right, n_samples));
+
+  if (probe_left == nullptr || probe_right == nullptr) {
+    std::span l(pb->dummy_left.data(), n_samples);
+    std::span r(pb->dummy_right.data(), n_samples);
+
+    pb->process_with_probe(inputs, outputs, l, r);
+  } else {
+    std::span l(probe_left, n_samples);
+    std::span r(probe_right, n_samples);
+
+    pb->process_with_probe(inputs, outputs, l, r);
+  }
+}
+
 void on_process(void* userdata, spa_io_position* position) {
   auto* d = static_cast<PluginBase::data*>(userdata);
 
@@ -64,34 +149,23 @@ void on_process(void* userdata, spa_io_position* position) {
     return;
   }
 
-  if (rate != d->pb->rate || n_samples != d->pb->n_samples) {
-    d->pb->rate = rate;
-    d->pb->n_samples = n_samples;
+  d->pb->prepare_process(rate, n_samples);
 
-    d->pb->dummy_left.resize(n_samples);
-    d->pb->dummy_right.resize(n_samples);
+  // util::warning("processing: " + util::to_string(n_samples));
 
-    std::ranges::fill(d->pb->dummy_left, 0.0F);
-    std::ranges::fill(d->pb->dummy_right, 0.0F);
+  if (d->pb->n_channels > 2U) {
+    on_process_channels(d, n_samples);
 
-    d->pb->clock_start = std::chrono::system_clock::now();
+    d->pb->finish_process();
 
-    d->pb->setup();
+    return;
   }
 
-  d->pb->delta_t = 0.001F * static_cast<float>(std::chrono::duration_cast<std::chrono::milliseconds>(
-                                                   std::chrono::system_clock::now() - d->pb->clock_start)
-                                                   .count());
-
-  d->pb->send_notifications = d->pb->delta_t >= d->pb->notification_time_window;
-
-  // util::warning("processing: " + util::to_string(n_samples));
-
-  auto* in_left = static_cast<float*>(pw_filter_get_dsp_buffer(d->in_left, n_samples));
-  auto* in_right = static_cast<float*>(pw_filter_get_dsp_buffer(d->in_right, n_samples));
+  auto* in_left = static_cast<float*>(pw_filter_get_dsp_buffer(d->in[0], n_samples));
+  auto* in_right = static_cast<float*>(pw_filter_get_dsp_buffer(d->in[1], n_samples));
 
-  auto* out_left = static_cast<float*>(pw_filter_get_dsp_buffer(d->out_left, n_samples));
-  auto* out_right = static_cast<float*>(pw_filter_get_dsp_buffer(d->out_right, n_samples));
+  auto* out_left = static_cast<float*>(pw_filter_get_dsp_buffer(d->out[0], n_samples));
+  auto* out_right = static_cast<float*>(pw_filter_get_dsp_buffer(d->out[1], n_samples));
 
   std::span<float> left_in;
   std::span<float> right_in;
@@ -141,11 +215,7 @@ void on_process(void* userdata, spa_io_position* position) {
     }
   }
 
-  if (d->pb->send_notifications) {
-    d->pb->clock_start = std::chrono::system_clock::now();
-
-    d->pb->send_notifications = false;
-  }
+  d->pb->finish_process();
 }
 
 auto update_filter(struct spa_loop* loop, bool async, uint32_t seq, const void* data, size_t size, void* user_data)
@@ -193,6 +263,12 @@ void on_filter_state_changed(void* userdata, pw_filter_state old, pw_filter_stat
     default:
       break;
   }
+
+  // Wakes up PipeManager::wait_until() in finish_connection()
+
+  if (d->pm != nullptr) {
+    pw_thread_loop_signal(d->pm->thread_loop, false);
+  }
 }
 
 const struct pw_filter_events filter_events = {.state_changed = on_filter_state_changed, .process = on_process};
@@ -215,9 +291,37 @@ PluginBase::PluginBase(std::string tag,
       settings(g_settings_new_with_path(schema.c_str(), schema_path.c_str())),
       global_settings(g_settings_new(tags::app::id)),
       pm(pipe_manager) {
+  channel_positions =
+      (pm != nullptr) ? pm->channel_positions : channel_layout::get_positions(channel_layout::Layout::stereo);
+
+  n_channels = static_cast<uint>(channel_positions.size());
+
+  n_ports = 2U * n_channels;
+
+  channel_in.resize(n_channels);
+  channel_out.resize(n_channels);
+
+  /*
+    The delay lines are allocated here so that the realtime thread only indexes into them. They hold one second of
+    plugin latency at the server rate plus the largest quantum. If the graph later runs at a higher rate the delay is
+    clamped to what fits.
+  */
+
+  uint server_rate = 0U;
+  uint max_quantum = 0U;
+
+  if (pm != nullptr) {
+    util::str_to_num(pm->default_clock_rate, server_rate);
+    util::str_to_num(pm->default_max_quantum, max_quantum);
+  }
+
+  delay_line_size = std::max(server_rate, default_rate) + std::max(max_quantum, default_max_quantum);
+
+  passthrough_delay.assign((n_channels > 2U) ? n_channels - 2U : 0U, std::vector<float>(delay_line_size, 0.0F));
+
   std::string description;
 
-  if (name != "output_level" && name != "spectrum") {
+  if (name != "output_level" && name != "spectrum" && name != "fused_chain") {
     description = tags::plugin_name::get_translated()[name];
 
     bypass = g_settings_get_boolean(settings, "bypass") != 0;
@@ -233,9 +337,33 @@ PluginBase::PluginBase(std::string tag,
     description = _("Output Level Meter");
   } else if (name == "spectrum") {
     description = _("Spectrum");
+  } else if (name == "fused_chain") {
+    description = _("Effects Chain");
   }
 
   pf_data.pb = this;
+  pf_data.pm = pm;
+
+  if (name != "spectrum" && name != "fused_chain") {
+    meter_slot = MeterBoard::get().acquire();
+  }
+
+  dsp_load_meter.set_threshold(0.01F * static_cast<float>(g_settings_get_int(global_settings, "dsp-load-threshold")));
+
+  gconnections_global.push_back(g_signal_connect(
+      global_settings, "changed::dsp-load-threshold",
+      G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+        auto* self = static_cast<PluginBase*>(user_data);
+
+        self->dsp_load_meter.set_threshold(0.01F * static_cast<float>(g_settings_get_int(settings, key)));
+      }),
+      this));
+
+  // Without a PipeManager the plugin is driven directly through process(). This is what the offline renderer does.
+
+  if (pm == nullptr) {
+    return;
+  }
 
   const auto filter_name = "ee_" + log_tag.substr(0U, log_tag.size() - 2U) + "_" + name;
 
@@ -254,49 +382,29 @@ PluginBase::PluginBase(std::string tag,
 
   filter = pw_filter_new(pm->core, filter_name.c_str(), props_filter);
 
-  // left channel input
-
-  auto* props_in_left = pw_properties_new(nullptr, nullptr);
-
-  pw_properties_set(props_in_left, PW_KEY_FORMAT_DSP, "32 bit float mono audio");
-  pw_properties_set(props_in_left, PW_KEY_PORT_NAME, "input_FL");
-  pw_properties_set(props_in_left, "audio.channel", "FL");
-
-  pf_data.in_left = static_cast<port*>(pw_filter_add_port(filter, PW_DIRECTION_INPUT, PW_FILTER_PORT_FLAG_MAP_BUFFERS,
-                                                          sizeof(port), props_in_left, nullptr, 0));
-
-  // right channel input
-
-  auto* props_in_right = pw_properties_new(nullptr, nullptr);
-
-  pw_properties_set(props_in_right, PW_KEY_FORMAT_DSP, "32 bit float mono audio");
-  pw_properties_set(props_in_right, PW_KEY_PORT_NAME, "input_FR");
-  pw_properties_set(props_in_right, "audio.channel", "FR");
-
-  pf_data.in_right = static_cast<port*>(pw_filter_add_port(filter, PW_DIRECTION_INPUT, PW_FILTER_PORT_FLAG_MAP_BUFFERS,
-                                                           sizeof(port), props_in_right, nullptr, 0));
+  for (const auto& position : channel_positions) {
+    auto* props_in = pw_properties_new(nullptr, nullptr);
 
-  // left channel output
+    pw_properties_set(props_in, PW_KEY_FORMAT_DSP, "32 bit float mono audio");
+    pw_properties_set(props_in, PW_KEY_PORT_NAME, ("input_" + position).c_str());
+    pw_properties_set(props_in, "audio.channel", position.c_str());
 
-  auto* props_out_left = pw_properties_new(nullptr, nullptr);
-
-  pw_properties_set(props_out_left, PW_KEY_FORMAT_DSP, "32 bit float mono audio");
-  pw_properties_set(props_out_left, PW_KEY_PORT_NAME, "output_FL");
-  pw_properties_set(props_out_left, "audio.channel", "FL");
-
-  pf_data.out_left = static_cast<port*>(pw_filter_add_port(filter, PW_DIRECTION_OUTPUT, PW_FILTER_PORT_FLAG_MAP_BUFFERS,
-                                                           sizeof(port), props_out_left, nullptr, 0));
-
-  // right channel output
+    pf_data.in.push_back(static_cast<port*>(pw_filter_add_port(filter, PW_DIRECTION_INPUT,
+                                                               PW_FILTER_PORT_FLAG_MAP_BUFFERS, sizeof(port), props_in,
+                                                               nullptr, 0)));
+  }
 
-  auto* props_out_right = pw_properties_new(nullptr, nullptr);
+  for (const auto& position : channel_positions) {
+    auto* props_out = pw_properties_new(nullptr, nullptr);
 
-  pw_properties_set(props_out_right, PW_KEY_FORMAT_DSP, "32 bit float mono audio");
-  pw_properties_set(props_out_right, PW_KEY_PORT_NAME, "output_FR");
-  pw_properties_set(props_out_right, "audio.channel", "FR");
+    pw_properties_set(props_out, PW_KEY_FORMAT_DSP, "32 bit float mono audio");
+    pw_properties_set(props_out, PW_KEY_PORT_NAME, ("output_" + position).c_str());
+    pw_properties_set(props_out, "audio.channel", position.c_str());
 
-  pf_data.out_right = static_cast<port*>(pw_filter_add_port(
-      filter, PW_DIRECTION_OUTPUT, PW_FILTER_PORT_FLAG_MAP_BUFFERS, sizeof(port), props_out_right, nullptr, 0));
+    pf_data.out.push_back(static_cast<port*>(pw_filter_add_port(filter, PW_DIRECTION_OUTPUT,
+                                                                PW_FILTER_PORT_FLAG_MAP_BUFFERS, sizeof(port),
+                                                                props_out, nullptr, 0)));
+  }
 
   if (enable_probe) {
     n_ports += 2;
@@ -330,15 +438,21 @@ PluginBase::PluginBase(std::string tag,
 PluginBase::~PluginBase() {
   post_messages = false;
 
-  pm->lock();
-
-  if (listener.link.next != nullptr || listener.link.prev != nullptr) {
-    spa_hook_remove(&listener);
+  if (rt_overflow_source != 0U) {
+    g_source_remove(rt_overflow_source);
   }
 
-  pw_filter_destroy(filter);
+  if (pm != nullptr) {
+    pm->lock();
 
-  pm->sync_wait_unlock();
+    if (listener.link.next != nullptr || listener.link.prev != nullptr) {
+      spa_hook_remove(&listener);
+    }
+
+    pw_filter_destroy(filter);
+
+    pm->sync_wait_unlock();
+  }
 
   for (auto& handler_id : gconnections) {
     g_signal_handler_disconnect(settings, handler_id);
@@ -346,7 +460,16 @@ PluginBase::~PluginBase() {
 
   gconnections.clear();
 
+  for (auto& handler_id : gconnections_global) {
+    g_signal_handler_disconnect(global_settings, handler_id);
+  }
+
+  gconnections_global.clear();
+
   g_object_unref(settings);
+  g_object_unref(global_settings);
+
+  MeterBoard::get().release(meter_slot);
 }
 
 void PluginBase::set_post_messages(const bool& state) {
@@ -358,10 +481,20 @@ void PluginBase::reset_settings() {
 }
 
 auto PluginBase::connect_to_pw() -> bool {
+  const tracer::Span span([&] { return log_tag + "connect_to_pw " + name; });
+
+  return request_connection() && finish_connection();
+}
+
+auto PluginBase::request_connection() -> bool {
   connected_to_pw = false;
   can_get_node_id = false;
   state = PW_FILTER_STATE_UNCONNECTED;
 
+  if (pm == nullptr) {
+    return false;
+  }
+
   pm->lock();
 
   if (pw_filter_connect(filter, PW_FILTER_FLAG_RT_PROCESS, nullptr, 0) != 0) {
@@ -374,33 +507,49 @@ auto PluginBase::connect_to_pw() -> bool {
 
   initialize_listener();
 
-  pm->sync_wait_unlock();
-
-  while (!can_get_node_id) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  pm->unlock();
 
-    if (state == PW_FILTER_STATE_ERROR) {
-      util::warning(log_tag + name + " is in an error");
+  return true;
+}
 
-      return false;
-    }
+auto PluginBase::connection_settled() const -> bool {
+  if (state == PW_FILTER_STATE_ERROR) {
+    return true;
   }
 
-  pm->lock();
-
-  node_id = pw_filter_get_node_id(filter);
-
-  pm->sync_wait_unlock();
-
   /*
     The filter we link in our pipeline have at least 4 ports. Some have six. Before we try to link filters we have to
     wait until the information about their ports is available in PipeManager's list_ports vector.
   */
 
-  while (pm->count_node_ports(node_id) != n_ports) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  return can_get_node_id && pm->count_node_ports(pw_filter_get_node_id(filter)) == n_ports;
+}
+
+auto PluginBase::finish_connection() -> bool {
+  if (pm == nullptr) {
+    return false;
+  }
+
+  // The filter state callback and the registry signal the loop. There is no need to poll.
+
+  if (!pm->wait_until([this] { return connection_settled(); })) {
+    util::warning(log_tag + name + " is taking too long to be connected to PipeWire");
+
+    return false;
+  }
+
+  if (state == PW_FILTER_STATE_ERROR) {
+    util::warning(log_tag + name + " is in an error");
+
+    return false;
   }
 
+  pm->lock();
+
+  node_id = pw_filter_get_node_id(filter);
+
+  pm->unlock();
+
   connected_to_pw = true;
 
   util::debug(log_tag + name + " successfully connected to PipeWire graph");
@@ -417,10 +566,18 @@ auto PluginBase::get_node_id() const -> uint {
 }
 
 void PluginBase::set_active(const bool& state) const {
+  if (filter == nullptr) {
+    return;
+  }
+
   pw_filter_set_active(filter, state);
 }
 
 void PluginBase::disconnect_from_pw() {
+  if (pm == nullptr) {
+    return;
+  }
+
   pm->lock();
 
   set_active(false);
@@ -437,10 +594,71 @@ void PluginBase::disconnect_from_pw() {
   pm->sync_wait_unlock();
 
   node_id = SPA_ID_INVALID;
+
+  if (const auto n = rt_contended_cycles.exchange(0U); n != 0U) {
+    util::debug(log_tag + name + " skipped " + util::to_string(n) + " realtime cycles because data_mutex was busy");
+  }
 }
 
 void PluginBase::setup() {}
 
+void PluginBase::prepare_process(const uint& rate, const uint& n_samples) {
+  if (rate != this->rate || n_samples != this->n_samples) {
+    this->rate = rate;
+    this->n_samples = n_samples;
+
+    dummy_left.resize(n_samples);
+    dummy_right.resize(n_samples);
+
+    std::ranges::fill(dummy_left, 0.0F);
+    std::ranges::fill(dummy_right, 0.0F);
+
+    for (auto& line : passthrough_delay) {
+      std::ranges::fill(line, 0.0F);
+    }
+
+    for (auto& line : dry_delay) {
+      std::ranges::fill(line, 0.0F);
+    }
+
+    passthrough_write_index = 0U;
+    dry_write_index = 0U;
+
+    clock_start = std::chrono::steady_clock::now();
+
+    setup();
+
+    dsp_load_meter.reset();
+  }
+
+  process_start = std::chrono::steady_clock::now();
+
+  delta_t = std::chrono::duration<float>(process_start - clock_start).count();
+
+  send_notifications = delta_t >= notification_time_window;
+}
+
+void PluginBase::finish_process() {
+  const auto now = std::chrono::steady_clock::now();
+
+  dsp_load_meter.record(std::chrono::duration<float>(now - process_start).count() * static_cast<float>(rate) /
+                        static_cast<float>(n_samples));
+
+  if (send_notifications) {
+    // The window is restarted even when nobody is reading the board so that the statistics never span a long time
+
+    const auto stats = dsp_load_meter.snapshot(true);
+
+    if (meter_slot != nullptr) {
+      meter_slot->set_dsp_load(stats);
+    }
+
+    clock_start = now;
+
+    send_notifications = false;
+  }
+}
+
 void PluginBase::process(std::span<float>& left_in,
                          std::span<float>& right_in,
                          std::span<float>& left_out,
@@ -453,6 +671,79 @@ void PluginBase::process(std::span<float>& left_in,
                          std::span<float>& probe_left,
                          std::span<float>& probe_right) {}
 
+void PluginBase::process(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs) {
+  process(inputs[0], inputs[1], outputs[0], outputs[1]);
+
+  pass_through_extra_channels(inputs, outputs);
+}
+
+void PluginBase::process_with_probe(std::span<std::span<float>> inputs,
+                                    std::span<std::span<float>> outputs,
+                                    std::span<float>& probe_left,
+                                    std::span<float>& probe_right) {
+  process(inputs[0], inputs[1], outputs[0], outputs[1], probe_left, probe_right);
+
+  pass_through_extra_channels(inputs, outputs);
+}
+
+void PluginBase::pass_through_extra_channels(std::span<std::span<float>> inputs, std::span<std::span<float>> outputs) {
+  if (passthrough_delay.empty() || inputs.size() <= 2U) {
+    return;
+  }
+
+  run_delay_lines(passthrough_delay, passthrough_write_index, inputs.subspan(2U), outputs.subspan(2U),
+                  static_cast<size_t>(latency_value * static_cast<float>(rate)));
+}
+
+void PluginBase::allocate_dry_delay() {
+  dry_delay.assign(n_channels, std::vector<float>(delay_line_size, 0.0F));
+}
+
+void PluginBase::store_dry(std::span<const std::span<float>> inputs) {
+  run_delay_lines(dry_delay, dry_write_index, inputs, {}, 0U);
+}
+
+void PluginBase::store_dry(const std::span<float>& left_in, const std::span<float>& right_in) {
+  const std::array<std::span<float>, 2U> inputs = {left_in, right_in};
+
+  store_dry(inputs);
+}
+
+void PluginBase::write_delayed_dry(std::span<const std::span<float>> inputs, std::span<std::span<float>> outputs) {
+  if (dry_delay.empty()) {
+    for (size_t c = 0U; c < inputs.size(); c++) {
+      std::ranges::copy(inputs[c], outputs[c].begin());
+    }
+
+    return;
+  }
+
+  // A bypassed plugin passes its input through without latency
+
+  const auto delay = bypass ? 0U : static_cast<size_t>(get_latency_seconds() * static_cast<float>(rate));
+
+  run_delay_lines(dry_delay, dry_write_index, inputs, outputs, delay);
+}
+
+void PluginBase::write_delayed_dry(const std::span<float>& left_in,
+                                   const std::span<float>& right_in,
+                                   std::span<float>& left_out,
+                                   std::span<float>& right_out) {
+  const std::array<std::span<float>, 2U> inputs = {left_in, right_in};
+  std::array<std::span<float>, 2U> outputs = {left_out, right_out};
+
+  write_delayed_dry(inputs, outputs);
+}
+
+auto PluginBase::get_channel_policy() const -> ChannelPolicy {
+  return channel_policy;
+}
+
+auto PluginBase::is_processed_channel(const size_t& n) const -> bool {
+  return !(lfe_passthrough && channel_policy == ChannelPolicy::per_channel &&
+           channel_layout::is_lfe(channel_positions[n]));
+}
+
 auto PluginBase::get_latency_seconds() -> float {
   return 0.0F;
 }
@@ -538,6 +829,39 @@ void PluginBase::apply_gain(std::span<float>& left, std::span<float>& right, con
   std::ranges::for_each(right, [&](auto& v) { v *= gain; });
 }
 
+void PluginBase::apply_gain(std::span<const std::span<float>> channels, const float& gain) {
+  for (const auto& c : channels) {
+    for (auto& v : c) {
+      v *= gain;
+    }
+  }
+}
+
+void PluginBase::get_peaks(std::span<const std::span<float>> inputs, std::span<const std::span<float>> outputs) {
+  if (!post_messages) {
+    return;
+  }
+
+  const auto update = [](const std::span<float>& channel, const channel_layout::Side& side, float& left, float& right) {
+    const float peak = std::ranges::max(channel);
+
+    if (side != channel_layout::Side::right) {
+      left = std::max(left, peak);
+    }
+
+    if (side != channel_layout::Side::left) {
+      right = std::max(right, peak);
+    }
+  };
+
+  for (size_t c = 0U; c < inputs.size(); c++) {
+    const auto side = channel_layout::get_side(channel_positions[c]);
+
+    update(inputs[c], side, input_peak_left, input_peak_right);
+    update(outputs[c], side, output_peak_left, output_peak_right);
+  }
+}
+
 void PluginBase::notify() {
   const auto input_peak_db_l = util::linear_to_db(input_peak_left);
   const auto input_peak_db_r = util::linear_to_db(input_peak_right);
@@ -545,8 +869,9 @@ void PluginBase::notify() {
   const auto output_peak_db_l = util::linear_to_db(output_peak_left);
   const auto output_peak_db_r = util::linear_to_db(output_peak_right);
 
-  input_level.emit(input_peak_db_l, input_peak_db_r);
-  output_level.emit(output_peak_db_l, output_peak_db_r);
+  if (meter_slot != nullptr) {
+    meter_slot->set_levels(input_peak_db_l, input_peak_db_r, output_peak_db_l, output_peak_db_r);
+  }
 
   input_peak_left = util::minimum_linear_level;
   input_peak_right = util::minimum_linear_level;
@@ -556,6 +881,103 @@ void PluginBase::notify() {
 
 void PluginBase::update_probe_links() {}
 
+auto PluginBase::lock_for_rt() -> std::unique_lock<std::mutex> {
+  std::unique_lock<std::mutex> lock(data_mutex, std::try_to_lock);
+
+  if (lock.owns_lock()) {
+    rt_commands.drain();
+  } else {
+    rt_contended_cycles++;
+  }
+
+  return lock;
+}
+
+auto PluginBase::is_idle() const -> bool {
+  return !connected_to_pw && fused_chain_users.load(std::memory_order_acquire) == 0U;
+}
+
+void PluginBase::post_to_rt(std::function<void()> cmd) {
+  /*
+    Nothing drains the queue while the filter is not being processed, as for a removed plugin or one of a snapshot
+    that is not active. The command is run right away after the ones still waiting.
+  */
+
+  if (is_idle()) {
+    run_posted_commands();
+
+    cmd();
+
+    return;
+  }
+
+  rt_commands.release_consumed();
+
+  if (rt_overflow.empty() && rt_commands.push(std::move(cmd))) {
+    return;
+  }
+
+  /*
+    The queue is full when the main thread posts faster than the realtime thread runs process(). The commands are
+    never run here because the realtime thread could be using the state they change. They wait in order until there
+    is room in the queue or until the filter stops being processed.
+  */
+
+  rt_overflow.push_back(std::move(cmd));
+
+  if (rt_overflow_source != 0U) {
+    return;
+  }
+
+  rt_overflow_source = g_timeout_add(50U, GSourceFunc(+[](PluginBase* self) {
+                                       if (self->is_idle()) {
+                                         self->rt_overflow_source = 0U;
+
+                                         self->run_posted_commands();
+
+                                         return G_SOURCE_REMOVE;
+                                       }
+
+                                       self->rt_commands.release_consumed();
+
+                                       while (!self->rt_overflow.empty() &&
+                                              self->rt_commands.push(std::move(self->rt_overflow.front()))) {
+                                         self->rt_overflow.pop_front();
+                                       }
+
+                                       if (!self->rt_overflow.empty()) {
+                                         return G_SOURCE_CONTINUE;
+                                       }
+
+                                       self->rt_overflow_source = 0U;
+
+                                       return G_SOURCE_REMOVE;
+                                     }),
+                                     this);
+}
+
+void PluginBase::run_posted_commands() {
+  rt_commands.drain();
+
+  rt_commands.release_consumed();
+
+  while (!rt_overflow.empty()) {
+    rt_overflow.front()();
+
+    rt_overflow.pop_front();
+  }
+
+  if (rt_overflow_source != 0U) {
+    g_source_remove(rt_overflow_source);
+
+    rt_overflow_source = 0U;
+  }
+}
+
 void PluginBase::update_filter_params() {
+  if (pm == nullptr) {
+    return;
+  }
+
   pw_loop_invoke(pw_thread_loop_get_loop(pm->thread_loop), update_filter, 1, nullptr, 0, false, this);
 }
@@ -0,0 +1,93 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "plugin_loader.hpp"
+#include <sys/types.h>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "util.hpp"
+
+PluginLoader::~PluginLoader() {
+  {
+    std::scoped_lock<std::mutex> lock(mutex);
+
+    quit = true;
+
+    jobs.clear();
+  }
+
+  cv.notify_all();
+
+  for (auto& t : workers) {
+    t.join();
+  }
+}
+
+auto PluginLoader::get() -> PluginLoader& {
+  static PluginLoader loader;
+
+  return loader;
+}
+
+void PluginLoader::submit(std::function<void()> job) {
+  {
+    std::scoped_lock<std::mutex> lock(mutex);
+
+    jobs.push_back(std::move(job));
+
+    const uint n_max = std::clamp(std::thread::hardware_concurrency(), 1U, max_workers);
+
+    if (n_idle < jobs.size() && workers.size() < n_max) {
+      workers.emplace_back([this] { worker_loop(); });
+
+      util::debug("plugin loader: started worker " + util::to_string(workers.size()));
+    }
+  }
+
+  cv.notify_one();
+}
+
+void PluginLoader::worker_loop() {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  while (true) {
+    n_idle++;
+
+    cv.wait(lock, [this] { return quit || !jobs.empty(); });
+
+    n_idle--;
+
+    if (quit) {
+      return;
+    }
+
+    auto job = std::move(jobs.front());
+
+    jobs.pop_front();
+
+    lock.unlock();
+
+    job();
+
+    lock.lock();
+  }
+}
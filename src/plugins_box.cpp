@@ -20,6 +20,8 @@
 #include "plugins_box.hpp"
 #include <STTypes.h>
 #include <adwaita.h>
+#include <fmt/core.h>
+#include <fmt/format.h>
 #include <gdk/gdk.h>
 #include <gio/gio.h>
 #include <glib-object.h>
@@ -58,6 +60,7 @@
 #include "deesser_ui.hpp"
 #include "delay.hpp"
 #include "delay_ui.hpp"
+#include "dsp_load_meter.hpp"
 #include "echo_canceller.hpp"
 #include "echo_canceller_ui.hpp"
 #include "effects_base.hpp"
@@ -79,6 +82,7 @@
 #include "loudness_ui.hpp"
 #include "maximizer.hpp"
 #include "maximizer_ui.hpp"
+#include "meter_board.hpp"
 #include "multiband_compressor.hpp"
 #include "multiband_compressor_ui.hpp"
 #include "multiband_gate.hpp"
@@ -158,387 +162,488 @@ struct _PluginsBox {
 // NOLINTNEXTLINE
 G_DEFINE_TYPE(PluginsBox, plugins_box, GTK_TYPE_BOX)
 
-template <PipelineType pipeline_type>
-void add_plugins_to_stack(PluginsBox* self) {
-  EffectsBase* effects_base = nullptr;
+// Shown in place of the plugin interface while the plugin is being built in the background
 
-  if constexpr (pipeline_type == PipelineType::input) {
-    effects_base = self->data->application->sie;
-  } else if constexpr (pipeline_type == PipelineType::output) {
-    effects_base = self->data->application->soe;
-  }
+auto create_loading_page() -> GtkWidget* {
+  auto* status_page = adw_status_page_new();
 
-  // saving the current visible page name for later usage
+  adw_status_page_set_title(ADW_STATUS_PAGE(status_page), _("Loading"));
 
-  const std::string visible_page_name =
-      (gtk_stack_get_visible_child_name(self->stack) != nullptr) ? gtk_stack_get_visible_child_name(self->stack) : "";
+  auto* spinner = gtk_spinner_new();
 
-  // removing all plugins
+  gtk_widget_set_size_request(spinner, 32, 32);
 
-  for (auto* child = gtk_widget_get_first_child(GTK_WIDGET(self->stack)); child != nullptr;) {
-    auto* next_child = gtk_widget_get_next_sibling(child);
+  gtk_spinner_start(GTK_SPINNER(spinner));
 
-    uint serial = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(child), "serial"));
+  adw_status_page_set_child(ADW_STATUS_PAGE(status_page), spinner);
 
-    set_ignore_filter_idle_add(serial, true);
+  gtk_widget_set_hexpand(status_page, 1);
+  gtk_widget_set_vexpand(status_page, 1);
 
-    gtk_stack_remove(self->stack, child);
+  /*
+    The status page is wrapped so that the stack page keeps its position in the plugins list when the plugin interface
+    takes its place. Removing and adding the page back would move it to the end of the list.
+  */
 
-    child = next_child;
-  }
+  auto* page = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
 
-  // Adding to the stack the plugins in the list that are not there yet
+  gtk_box_append(GTK_BOX(page), status_page);
 
-  auto plugins_list = util::gchar_array_to_vector(g_settings_get_strv(self->settings, "plugins"));
+  g_object_set_data(G_OBJECT(page), "loading", GUINT_TO_POINTER(1));
 
-  for (const auto& name : plugins_list) {
-    auto path = self->data->schema_path + tags::plugin_name::get_base_name(name) + "/" +
-                util::to_string(tags::plugin_name::get_id(name)) + "/";
+  return page;
+}
 
-    path.erase(std::remove(path.begin(), path.end(), '_'), path.end());
+auto create_plugin_page(PluginsBox* self, EffectsBase* effects_base, const std::string& name) -> GtkWidget* {
+  auto path = self->data->schema_path + tags::plugin_name::get_base_name(name) + "/" +
+              util::to_string(tags::plugin_name::get_id(name)) + "/";
 
-    if (name.starts_with(tags::plugin_name::autogain)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<AutoGain>(name);
+  path.erase(std::remove(path.begin(), path.end(), '_'), path.end());
 
-      auto* box = ui::autogain_box::create();
+  if (name.starts_with(tags::plugin_name::autogain)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<AutoGain>(name);
 
-      ui::autogain_box::setup(box, plugin_ptr, path);
+    auto* box = ui::autogain_box::create();
 
-      gtk_stack_add_named(self->stack, GTK_WIDGET(box), name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::bass_enhancer)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<BassEnhancer>(name);
+    ui::autogain_box::setup(box, plugin_ptr, path);
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::bass_enhancer_box::create();
+    return GTK_WIDGET(box);
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::bass_enhancer)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<BassEnhancer>(name);
 
-        ui::bass_enhancer_box::setup(plugin_box, plugin_ptr, path);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::bass_enhancer_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::bass_enhancer_box::setup(plugin_box, plugin_ptr, path);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::bass_loudness)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<BassLoudness>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::bass_loudness_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::bass_loudness)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<BassLoudness>(name);
 
-        ui::bass_loudness_box::setup(plugin_box, plugin_ptr, path);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::bass_loudness_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::bass_loudness_box::setup(plugin_box, plugin_ptr, path);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::compressor)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Compressor>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::compressor_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::compressor)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Compressor>(name);
 
-        ui::compressor_box::setup(plugin_box, plugin_ptr, path, self->data->application->pm);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::compressor_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::compressor_box::setup(plugin_box, plugin_ptr, path, self->data->application->pm);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (name.starts_with(tags::plugin_name::convolver)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Convolver>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      auto* box = ui::convolver_box::create();
+    return box;
+  } else if (name.starts_with(tags::plugin_name::convolver)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Convolver>(name);
 
-      ui::convolver_box::setup(box, plugin_ptr, path, self->data->application);
+    auto* box = ui::convolver_box::create();
 
-      gtk_stack_add_named(self->stack, GTK_WIDGET(box), name.c_str());
-    } else if (name.starts_with(tags::plugin_name::crossfeed)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Crossfeed>(name);
+    ui::convolver_box::setup(box, plugin_ptr, path, self->data->application);
 
-      auto* box = ui::crossfeed_box::create();
+    return GTK_WIDGET(box);
+  } else if (name.starts_with(tags::plugin_name::crossfeed)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Crossfeed>(name);
 
-      ui::crossfeed_box::setup(box, plugin_ptr, path);
+    auto* box = ui::crossfeed_box::create();
 
-      gtk_stack_add_named(self->stack, GTK_WIDGET(box), name.c_str());
-    } else if (name.starts_with(tags::plugin_name::crystalizer)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Crystalizer>(name);
+    ui::crossfeed_box::setup(box, plugin_ptr, path);
 
-      auto* box = ui::crystalizer_box::create();
+    return GTK_WIDGET(box);
+  } else if (name.starts_with(tags::plugin_name::crystalizer)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Crystalizer>(name);
 
-      ui::crystalizer_box::setup(box, plugin_ptr, path);
+    auto* box = ui::crystalizer_box::create();
 
-      gtk_stack_add_named(self->stack, GTK_WIDGET(box), name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::deepfilternet)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<DeepFilterNet>(name);
+    ui::crystalizer_box::setup(box, plugin_ptr, path);
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::deepfilternet_box::create();
+    return GTK_WIDGET(box);
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::deepfilternet)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<DeepFilterNet>(name);
 
-        ui::deepfilternet_box::setup(plugin_box, plugin_ptr, path);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::deepfilternet_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::deepfilternet_box::setup(plugin_box, plugin_ptr, path);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::deesser)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Deesser>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::deesser_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::deesser)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Deesser>(name);
 
-        ui::deesser_box::setup(plugin_box, plugin_ptr, path);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::deesser_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::deesser_box::setup(plugin_box, plugin_ptr, path);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::delay)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Delay>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::delay_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::delay)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Delay>(name);
 
-        ui::delay_box::setup(plugin_box, plugin_ptr, path);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::delay_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::delay_box::setup(plugin_box, plugin_ptr, path);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (name.starts_with(tags::plugin_name::echo_canceller)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<EchoCanceller>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      auto* box = ui::echo_canceller_box::create();
+    return box;
+  } else if (name.starts_with(tags::plugin_name::echo_canceller)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<EchoCanceller>(name);
 
-      ui::echo_canceller_box::setup(box, plugin_ptr, path);
+    auto* box = ui::echo_canceller_box::create();
 
-      gtk_stack_add_named(self->stack, GTK_WIDGET(box), name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::exciter)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Exciter>(name);
+    ui::echo_canceller_box::setup(box, plugin_ptr, path);
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::exciter_box::create();
+    return GTK_WIDGET(box);
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::exciter)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Exciter>(name);
 
-        ui::exciter_box::setup(plugin_box, plugin_ptr, path);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::exciter_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::exciter_box::setup(plugin_box, plugin_ptr, path);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::expander)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Expander>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::expander_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::expander)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Expander>(name);
 
-        ui::expander_box::setup(plugin_box, plugin_ptr, path, self->data->application->pm);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::expander_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::expander_box::setup(plugin_box, plugin_ptr, path, self->data->application->pm);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::equalizer)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Equalizer>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::equalizer_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::equalizer)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Equalizer>(name);
 
-        ui::equalizer_box::setup(plugin_box, plugin_ptr, path, self->data->application);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::equalizer_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::equalizer_box::setup(plugin_box, plugin_ptr, path, self->data->application);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::filter)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Filter>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::filter_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::filter)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Filter>(name);
 
-        ui::filter_box::setup(plugin_box, plugin_ptr, path);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::filter_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::filter_box::setup(plugin_box, plugin_ptr, path);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::gate)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Gate>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::gate_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::gate)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Gate>(name);
 
-        ui::gate_box::setup(plugin_box, plugin_ptr, path, self->data->application->pm);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::gate_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::gate_box::setup(plugin_box, plugin_ptr, path, self->data->application->pm);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::level_meter)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<LevelMeter>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::level_meter_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::level_meter)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<LevelMeter>(name);
 
-        ui::level_meter_box::setup(plugin_box, plugin_ptr, path);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::level_meter_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::level_meter_box::setup(plugin_box, plugin_ptr, path);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::limiter)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Limiter>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::limiter_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::limiter)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Limiter>(name);
 
-        ui::limiter_box::setup(plugin_box, plugin_ptr, path, self->data->application->pm);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::limiter_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::limiter_box::setup(plugin_box, plugin_ptr, path, self->data->application->pm);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::loudness)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Loudness>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::loudness_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::loudness)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Loudness>(name);
 
-        ui::loudness_box::setup(plugin_box, plugin_ptr, path);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::loudness_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::loudness_box::setup(plugin_box, plugin_ptr, path);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::maximizer)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Maximizer>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::maximizer_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::maximizer)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Maximizer>(name);
 
-        ui::maximizer_box::setup(plugin_box, plugin_ptr, path);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::maximizer_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::maximizer_box::setup(plugin_box, plugin_ptr, path);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::multiband_compressor)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<MultibandCompressor>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::multiband_compressor_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::multiband_compressor)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<MultibandCompressor>(name);
 
-        ui::multiband_compressor_box::setup(plugin_box, plugin_ptr, path, self->data->application->pm);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::multiband_compressor_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::multiband_compressor_box::setup(plugin_box, plugin_ptr, path, self->data->application->pm);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::multiband_gate)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<MultibandGate>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::multiband_gate_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::multiband_gate)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<MultibandGate>(name);
 
-        ui::multiband_gate_box::setup(plugin_box, plugin_ptr, path, self->data->application->pm);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::multiband_gate_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::multiband_gate_box::setup(plugin_box, plugin_ptr, path, self->data->application->pm);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (name.starts_with(tags::plugin_name::pitch)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Pitch>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      auto* box = ui::pitch_box::create();
+    return box;
+  } else if (name.starts_with(tags::plugin_name::pitch)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Pitch>(name);
 
-      ui::pitch_box::setup(box, plugin_ptr, path);
+    auto* box = ui::pitch_box::create();
 
-      gtk_stack_add_named(self->stack, GTK_WIDGET(box), name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::reverb)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Reverb>(name);
+    ui::pitch_box::setup(box, plugin_ptr, path);
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::reverb_box::create();
+    return GTK_WIDGET(box);
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::reverb)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Reverb>(name);
 
-        ui::reverb_box::setup(plugin_box, plugin_ptr, path);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::reverb_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::reverb_box::setup(plugin_box, plugin_ptr, path);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::rnnoise)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<RNNoise>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::rnnoise_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::rnnoise)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<RNNoise>(name);
 
-        ui::rnnoise_box::setup(plugin_box, plugin_ptr, path, self->data->application);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::rnnoise_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::rnnoise_box::setup(plugin_box, plugin_ptr, path, self->data->application);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::speex)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<Speex>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::speex_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::speex)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<Speex>(name);
 
-        ui::speex_box::setup(plugin_box, plugin_ptr, path, self->data->application);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::speex_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::speex_box::setup(plugin_box, plugin_ptr, path, self->data->application);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
-    } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::stereo_tools)) {
-      auto plugin_ptr = effects_base->get_plugin_instance<StereoTools>(name);
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
 
-      if (plugin_ptr->package_installed) {
-        auto* plugin_box = ui::stereo_tools_box::create();
+    return box;
+  } else if (GtkWidget* box = nullptr; name.starts_with(tags::plugin_name::stereo_tools)) {
+    auto plugin_ptr = effects_base->get_plugin_instance<StereoTools>(name);
 
-        ui::stereo_tools_box::setup(plugin_box, plugin_ptr, path);
+    if (plugin_ptr->package_installed) {
+      auto* plugin_box = ui::stereo_tools_box::create();
 
-        box = GTK_WIDGET(plugin_box);
-      } else {
-        box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
-      }
+      ui::stereo_tools_box::setup(plugin_box, plugin_ptr, path);
 
-      gtk_stack_add_named(self->stack, box, name.c_str());
+      box = GTK_WIDGET(plugin_box);
+    } else {
+      box = ui::missing_plugin_box(plugin_ptr->name, plugin_ptr->package);
+    }
+
+    return box;
+  }
+
+  return nullptr;
+}
+
+template <PipelineType pipeline_type>
+void replace_loading_page(PluginsBox* self, const std::string& name) {
+  EffectsBase* effects_base = nullptr;
+
+  if constexpr (pipeline_type == PipelineType::input) {
+    effects_base = self->data->application->sie;
+  } else if constexpr (pipeline_type == PipelineType::output) {
+    effects_base = self->data->application->soe;
+  }
+
+  auto* page = gtk_stack_get_child_by_name(self->stack, name.c_str());
+
+  if (page == nullptr || g_object_get_data(G_OBJECT(page), "loading") == nullptr) {
+    return;
+  }
+
+  auto* plugin_page = create_plugin_page(self, effects_base, name);
+
+  if (plugin_page == nullptr) {
+    return;
+  }
+
+  gtk_box_remove(GTK_BOX(page), gtk_widget_get_first_child(page));
+
+  gtk_widget_set_hexpand(plugin_page, 1);
+  gtk_widget_set_vexpand(plugin_page, 1);
+
+  gtk_box_append(GTK_BOX(page), plugin_page);
+
+  // The stack removal loop reads the serial from the page and not from the plugin interface inside it
+
+  g_object_set_data(G_OBJECT(page), "serial", g_object_get_data(G_OBJECT(plugin_page), "serial"));
+  g_object_set_data(G_OBJECT(page), "loading", nullptr);
+
+  // Rebinding the row so that it stops showing the loading state and starts showing the dsp load
+
+  auto* pages = gtk_stack_get_pages(self->stack);
+
+  for (guint n = 0U, n_items = g_list_model_get_n_items(G_LIST_MODEL(pages)); n < n_items; n++) {
+    auto* stack_page = static_cast<GtkStackPage*>(g_list_model_get_item(G_LIST_MODEL(pages), n));
+
+    const bool found = gtk_stack_page_get_child(stack_page) == page;
+
+    g_object_unref(stack_page);
+
+    if (found) {
+      g_list_model_items_changed(G_LIST_MODEL(pages), n, 1, 1);
+
+      break;
+    }
+  }
+
+  g_object_unref(pages);
+}
+
+template <PipelineType pipeline_type>
+void add_plugins_to_stack(PluginsBox* self) {
+  EffectsBase* effects_base = nullptr;
+
+  if constexpr (pipeline_type == PipelineType::input) {
+    effects_base = self->data->application->sie;
+  } else if constexpr (pipeline_type == PipelineType::output) {
+    effects_base = self->data->application->soe;
+  }
+
+  // saving the current visible page name for later usage
+
+  const std::string visible_page_name =
+      (gtk_stack_get_visible_child_name(self->stack) != nullptr) ? gtk_stack_get_visible_child_name(self->stack) : "";
+
+  // removing all plugins
+
+  for (auto* child = gtk_widget_get_first_child(GTK_WIDGET(self->stack)); child != nullptr;) {
+    auto* next_child = gtk_widget_get_next_sibling(child);
+
+    uint serial = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(child), "serial"));
+
+    set_ignore_filter_idle_add(serial, true);
+
+    gtk_stack_remove(self->stack, child);
+
+    child = next_child;
+  }
+
+  // Adding to the stack the plugins in the list that are not there yet
+
+  auto plugins_list = util::gchar_array_to_vector(g_settings_get_strv(self->settings, "plugins"));
+
+  for (const auto& name : plugins_list) {
+    if (!effects_base->is_plugin_ready(name)) {
+      gtk_stack_add_named(self->stack, create_loading_page(), name.c_str());
+
+      continue;
+    }
+
+    if (auto* page = create_plugin_page(self, effects_base, name); page != nullptr) {
+      gtk_stack_add_named(self->stack, page, name.c_str());
     }
   }
 
@@ -614,6 +719,7 @@ void setup_listview(PluginsBox* self) {
         g_object_set_data(G_OBJECT(item), "plugin_enabled_icon", plugin_enabled_icon);
         g_object_set_data(G_OBJECT(item), "plugin_bypassed_icon", plugin_bypassed_icon);
         g_object_set_data(G_OBJECT(item), "name", gtk_builder_get_object(builder, "name"));
+        g_object_set_data(G_OBJECT(item), "dsp_load", gtk_builder_get_object(builder, "dsp_load"));
         g_object_set_data(G_OBJECT(item), "remove", remove);
         g_object_set_data(G_OBJECT(item), "enable", enable);
         g_object_set_data(G_OBJECT(item), "drag_handle", drag_handle);
@@ -774,9 +880,73 @@ void setup_listview(PluginsBox* self) {
         gsettings_bind_widget(settings, "bypass", enable, G_SETTINGS_BIND_INVERT_BOOLEAN);
 
         g_object_unref(settings);
+
+        // showing the worst processing time of the last notification window
+
+        auto* dsp_load = static_cast<GtkLabel*>(g_object_get_data(G_OBJECT(item), "dsp_load"));
+
+        gtk_label_set_text(dsp_load, "");
+        gtk_widget_set_tooltip_text(GTK_WIDGET(dsp_load), nullptr);
+        gtk_widget_remove_css_class(GTK_WIDGET(dsp_load), "warning");
+
+        EffectsBase* effects_base = nullptr;
+
+        if (self->data->pipeline_type == PipelineType::input) {
+          effects_base = self->data->application->sie;
+        } else if (self->data->pipeline_type == PipelineType::output) {
+          effects_base = self->data->application->soe;
+        }
+
+        auto plugins = effects_base->get_plugins_map();
+
+        if (!plugins.contains(page_name)) {
+          gtk_label_set_text(dsp_load, _("Loading"));
+
+          return;
+        }
+
+        const auto tick_id =
+            ui::add_meter_tick_callback(GTK_WIDGET(dsp_load), plugins[page_name], [=](const MeterBoard::Slot& slot) {
+              const auto stats = slot.get_dsp_load();
+
+              if (stats.cycles == 0U) {
+                return;
+              }
+
+              gtk_label_set_text(dsp_load, fmt::format("{0:.0f}%", 100.0F * stats.max).c_str());
+
+              gtk_widget_set_tooltip_text(
+                  GTK_WIDGET(dsp_load),
+                  fmt::format(ui::get_user_locale(),
+                              _("Processing Time: median {0:.1Lf}%, 99th percentile {1:.1Lf}%, maximum {2:.1Lf}%\n"
+                                "Cycles Above the Warning Limit: {3}"),
+                              100.0F * stats.p50, 100.0F * stats.p99, 100.0F * stats.max, stats.overruns)
+                      .c_str());
+
+              if (stats.max > stats.threshold) {
+                gtk_widget_add_css_class(GTK_WIDGET(dsp_load), "warning");
+              } else {
+                gtk_widget_remove_css_class(GTK_WIDGET(dsp_load), "warning");
+              }
+            });
+
+        g_object_set_data(G_OBJECT(item), "dsp-load-tick", GUINT_TO_POINTER(tick_id));
       }),
       self);
 
+  g_signal_connect(factory, "unbind",
+                   G_CALLBACK(+[](GtkSignalListItemFactory* factory, GtkListItem* item, PluginsBox* self) {
+                     auto* dsp_load = static_cast<GtkWidget*>(g_object_get_data(G_OBJECT(item), "dsp_load"));
+
+                     if (const auto id = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(item), "dsp-load-tick"));
+                         id != 0U) {
+                       gtk_widget_remove_tick_callback(dsp_load, id);
+                     }
+
+                     g_object_set_data(G_OBJECT(item), "dsp-load-tick", nullptr);
+                   }),
+                   self);
+
   gtk_list_view_set_factory(self->listview, factory);
 
   g_object_unref(factory);
@@ -800,6 +970,11 @@ void setup(PluginsBox* self, app::Application* application, PipelineType pipelin
           }),
           self));
 
+      // The loading page is replaced by the plugin interface
+
+      self->data->connections.push_back(application->sie->plugin_loaded.connect(
+          [self](const std::string& name) { replace_loading_page<PipelineType::input>(self, name); }));
+
       gtk_image_set_from_icon_name(self->startpoint_icon, "audio-input-microphone-symbolic");
       gtk_image_set_from_icon_name(self->endpoint_icon, "ee-applications-multimedia-symbolic");
 
@@ -821,6 +996,11 @@ void setup(PluginsBox* self, app::Application* application, PipelineType pipelin
           }),
           self));
 
+      // The loading page is replaced by the plugin interface
+
+      self->data->connections.push_back(application->soe->plugin_loaded.connect(
+          [self](const std::string& name) { replace_loading_page<PipelineType::output>(self, name); }));
+
       gtk_image_set_from_icon_name(self->startpoint_icon, "ee-applications-multimedia-symbolic");
       gtk_image_set_from_icon_name(self->endpoint_icon, "audio-speakers-symbolic");
 
@@ -0,0 +1,232 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "polyphase_resampler.hpp"
+#include <sys/types.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Taps of each phase when upsampling. Downsampling scales it by the ratio to keep the same transition band.
+
+constexpr uint base_n_taps = 32U;
+
+// The dot products accumulate in this many independent lanes
+
+constexpr uint n_lanes = 8U;
+
+constexpr double kaiser_beta = 8.0;
+
+// Cutoff relative to the Nyquist frequency of the lower of the two rates
+
+constexpr double rolloff = 0.92;
+
+// Zeroth order modified Bessel function of the first kind. std::cyl_bessel_i is not available in libc++.
+
+auto bessel_i0(const double& x) -> double {
+  double sum = 1.0;
+  double term = 1.0;
+
+  for (int k = 1; k < 64; k++) {
+    term *= (0.5 * x / k) * (0.5 * x / k);
+
+    sum += term;
+
+    if (term < 1e-12 * sum) {
+      break;
+    }
+  }
+
+  return sum;
+}
+
+template <typename T>
+inline void dot_stereo(const T* coefficients,
+                       const T* left,
+                       const T* right,
+                       const uint& n_taps,
+                       T& out_left,
+                       T& out_right) {
+  std::array<T, n_lanes> sum_left{};
+  std::array<T, n_lanes> sum_right{};
+
+  for (uint n = 0U; n < n_taps; n += n_lanes) {
+    for (uint k = 0U; k < n_lanes; k++) {
+      sum_left[k] += coefficients[n + k] * left[n + k];
+      sum_right[k] += coefficients[n + k] * right[n + k];
+    }
+  }
+
+  out_left = std::accumulate(sum_left.begin(), sum_left.end(), static_cast<T>(0));
+  out_right = std::accumulate(sum_right.begin(), sum_right.end(), static_cast<T>(0));
+}
+
+}  // namespace
+
+auto PolyphaseResampler::make_bank(const uint& up, const uint& down) -> std::shared_ptr<const Bank> {
+  auto bank = std::make_shared<Bank>();
+
+  const auto decimation = std::max(1.0, static_cast<double>(down) / static_cast<double>(up));
+
+  bank->n_phases = up;
+
+  bank->n_taps = static_cast<uint>(std::ceil(base_n_taps * decimation / n_lanes)) * n_lanes;
+
+  const auto length = static_cast<size_t>(bank->n_taps) * up;
+
+  const auto center = 0.5 * static_cast<double>(length - 1U);
+
+  // cycles per sample at the upsampled rate
+
+  const auto cutoff = 0.5 * rolloff / static_cast<double>(std::max(up, down));
+
+  std::vector<double> prototype(length);
+
+  for (size_t n = 0U; n < length; n++) {
+    const auto x = static_cast<double>(n) - center;
+
+    const auto sinc = (x == 0.0) ? 1.0 : std::sin(2.0 * std::numbers::pi * cutoff * x) / (std::numbers::pi * x);
+
+    const auto r = x / (center + 1.0);
+
+    const auto window = bessel_i0(kaiser_beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / bessel_i0(kaiser_beta);
+
+    prototype[n] = (x == 0.0) ? 2.0 * cutoff * window : sinc * window;
+  }
+
+  bank->coefficients.resize(length);
+
+  for (uint p = 0U; p < up; p++) {
+    // Normalizing every phase gives exactly unity gain at DC for all of them
+
+    double sum = 0.0;
+
+    for (uint k = 0U; k < bank->n_taps; k++) {
+      sum += prototype[p + (static_cast<size_t>(k) * up)];
+    }
+
+    const auto gain = (sum != 0.0) ? 1.0 / sum : 0.0;
+
+    for (uint i = 0U; i < bank->n_taps; i++) {
+      const auto k = bank->n_taps - 1U - i;
+
+      bank->coefficients[(static_cast<size_t>(p) * bank->n_taps) + i] =
+          static_cast<float>(gain * prototype[p + (static_cast<size_t>(k) * up)]);
+    }
+  }
+
+  return bank;
+}
+
+auto PolyphaseResampler::get_bank(const uint& up, const uint& down) -> std::shared_ptr<const Bank> {
+  // Plugins usually create several resamplers for the same pair of rates. They share the bank.
+
+  static std::mutex mutex;
+  static std::map<std::pair<uint, uint>, std::shared_ptr<const Bank>> banks;
+
+  std::scoped_lock<std::mutex> lock(mutex);
+
+  auto& bank = banks[{up, down}];
+
+  if (bank == nullptr) {
+    bank = make_bank(up, down);
+  }
+
+  return bank;
+}
+
+void PolyphaseResampler::setup(const uint& input_rate, const uint& output_rate, const size_t& max_input_frames) {
+  const auto divisor = std::gcd(input_rate, output_rate);
+
+  up = (divisor != 0U) ? output_rate / divisor : 1U;
+  down = (divisor != 0U) ? input_rate / divisor : 1U;
+
+  bank = get_bank(up, down);
+
+  const auto length = static_cast<size_t>(bank->n_taps) * up;
+
+  latency = static_cast<uint>(std::lround(0.5 * static_cast<double>(length - 1U) / static_cast<double>(down)));
+
+  history_L.assign(bank->n_taps - 1U + max_input_frames, 0.0F);
+  history_R.assign(history_L.size(), 0.0F);
+
+  const auto max_output_frames = ((max_input_frames * up) / down) + 2U;
+
+  output_L.assign(max_output_frames, 0.0F);
+  output_R.assign(max_output_frames, 0.0F);
+
+  reset();
+}
+
+void PolyphaseResampler::reset() {
+  std::ranges::fill(history_L, 0.0F);
+  std::ranges::fill(history_R, 0.0F);
+
+  phase = 0U;
+  position = 0U;
+}
+
+auto PolyphaseResampler::process(const std::span<const float>& left, const std::span<const float>& right)
+    -> std::pair<std::span<const float>, std::span<const float>> {
+  if (bank == nullptr) {
+    return {};
+  }
+
+  const auto n_taps = bank->n_taps;
+  const auto n_history = n_taps - 1U;
+  const auto n_input = std::min(left.size(), history_L.size() - n_history);
+
+  std::copy_n(left.begin(), n_input, history_L.begin() + n_history);
+  std::copy_n(right.begin(), n_input, history_R.begin() + n_history);
+
+  const auto* coefficients = bank->coefficients.data();
+
+  size_t n_output = 0U;
+
+  while (position < n_input && n_output < output_L.size()) {
+    dot_stereo(coefficients + (static_cast<size_t>(phase) * n_taps), history_L.data() + position,
+               history_R.data() + position, n_taps, output_L[n_output], output_R[n_output]);
+
+    n_output++;
+
+    phase += down;
+    position += phase / up;
+    phase %= up;
+  }
+
+  position -= std::min(position, n_input);
+
+  // keeping the last n_taps - 1 input frames for the next call
+
+  std::copy_n(history_L.begin() + n_input, n_history, history_L.begin());
+  std::copy_n(history_R.begin() + n_input, n_history, history_R.begin());
+
+  return {std::span<const float>(output_L.data(), n_output), std::span<const float>(output_R.data(), n_output)};
+}
@@ -42,7 +42,8 @@ struct _PreferencesGeneral {
       *use_cubic_volumes, *inactivity_timer_enable, *autohide_popovers, *exclude_monitor_streams,
       *show_native_plugin_ui;
 
-  GtkSpinButton *inactivity_timeout, *meters_update_interval, *lv2ui_update_frequency;
+  GtkSpinButton *inactivity_timeout, *meters_update_interval, *lv2ui_update_frequency, *dsp_load_threshold,
+      *loudness_update_rate;
 
   GSettings* settings;
 };
@@ -126,6 +127,8 @@ void preferences_general_class_init(PreferencesGeneralClass* klass) {
   gtk_widget_class_bind_template_child(widget_class, PreferencesGeneral, inactivity_timeout);
   gtk_widget_class_bind_template_child(widget_class, PreferencesGeneral, meters_update_interval);
   gtk_widget_class_bind_template_child(widget_class, PreferencesGeneral, lv2ui_update_frequency);
+  gtk_widget_class_bind_template_child(widget_class, PreferencesGeneral, dsp_load_threshold);
+  gtk_widget_class_bind_template_child(widget_class, PreferencesGeneral, loudness_update_rate);
   gtk_widget_class_bind_template_child(widget_class, PreferencesGeneral, show_native_plugin_ui);
 }
 
@@ -136,18 +139,19 @@ void preferences_general_init(PreferencesGeneral* self) {
 
   prepare_spinbuttons<"s">(self->inactivity_timeout);
   prepare_spinbuttons<"ms">(self->meters_update_interval);
-  prepare_spinbuttons<"Hz">(self->lv2ui_update_frequency);
+  prepare_spinbuttons<"Hz">(self->lv2ui_update_frequency, self->loudness_update_rate);
+  prepare_spinbuttons<"%">(self->dsp_load_threshold);
 
   // initializing some widgets
 
   gsettings_bind_widgets<"process-all-inputs", "process-all-outputs", "use-dark-theme", "shutdown-on-window-close",
                          "use-cubic-volumes", "autohide-popovers", "exclude-monitor-streams", "inactivity-timer-enable",
-                         "inactivity-timeout", "meters-update-interval", "lv2ui-update-frequency",
-                         "show-native-plugin-ui">(
+                         "inactivity-timeout", "meters-update-interval", "lv2ui-update-frequency", "dsp-load-threshold",
+                         "loudness-update-rate", "show-native-plugin-ui">(
       self->settings, self->process_all_inputs, self->process_all_outputs, self->theme_switch,
       self->shutdown_on_window_close, self->use_cubic_volumes, self->autohide_popovers, self->exclude_monitor_streams,
       self->inactivity_timer_enable, self->inactivity_timeout, self->meters_update_interval,
-      self->lv2ui_update_frequency, self->show_native_plugin_ui);
+      self->lv2ui_update_frequency, self->dsp_load_threshold, self->loudness_update_rate, self->show_native_plugin_ui);
 
 #ifdef ENABLE_LIBPORTAL
   libportal::init(self->enable_autostart, self->shutdown_on_window_close);
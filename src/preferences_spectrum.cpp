@@ -47,9 +47,10 @@ struct _PreferencesSpectrum {
 
   GtkColorDialogButton *color_button, *axis_color_button;
 
-  GtkDropDown* type;
+  GtkDropDown *type, *fft_size, *window, *averaging;
 
-  GtkSpinButton *n_points, *height, *line_width, *minimum_frequency, *maximum_frequency, *avsync_delay;
+  GtkSpinButton *n_points, *height, *line_width, *minimum_frequency, *maximum_frequency, *avsync_delay, *overlap,
+      *averaging_time;
 
   GSettings* settings;
 
@@ -120,6 +121,11 @@ void preferences_spectrum_class_init(PreferencesSpectrumClass* klass) {
   gtk_widget_class_bind_template_child(widget_class, PreferencesSpectrum, minimum_frequency);
   gtk_widget_class_bind_template_child(widget_class, PreferencesSpectrum, maximum_frequency);
   gtk_widget_class_bind_template_child(widget_class, PreferencesSpectrum, avsync_delay);
+  gtk_widget_class_bind_template_child(widget_class, PreferencesSpectrum, fft_size);
+  gtk_widget_class_bind_template_child(widget_class, PreferencesSpectrum, window);
+  gtk_widget_class_bind_template_child(widget_class, PreferencesSpectrum, overlap);
+  gtk_widget_class_bind_template_child(widget_class, PreferencesSpectrum, averaging);
+  gtk_widget_class_bind_template_child(widget_class, PreferencesSpectrum, averaging_time);
 
   gtk_widget_class_bind_template_callback(widget_class, on_spectrum_color_set);
   gtk_widget_class_bind_template_callback(widget_class, on_spectrum_axis_color_set);
@@ -146,6 +152,10 @@ void preferences_spectrum_init(PreferencesSpectrum* self) {
 
   prepare_spinbuttons<"px">(self->height, self->line_width);
 
+  prepare_spinbuttons<"%">(self->overlap);
+
+  prepare_spinbuttons<"ms">(self->averaging_time);
+
   g_signal_connect(self->minimum_frequency, "output", G_CALLBACK(+[](GtkSpinButton* button, gpointer user_data) {
                      return parse_spinbutton_output(button, "Hz");
                    }),
@@ -193,12 +203,16 @@ void preferences_spectrum_init(PreferencesSpectrum* self) {
   // spectrum section gsettings bindings
 
   gsettings_bind_widgets<"show", "fill", "rounded-corners", "show-bar-border", "dynamic-y-scale", "n-points", "height",
-                         "line-width", "minimum-frequency", "maximum-frequency", "avsync-delay">(
-      self->settings, self->show, self->fill, self->rounded_corners, self->show_bar_border, self->dynamic_y_scale,
-      self->n_points, self->height, self->line_width, self->minimum_frequency, self->maximum_frequency,
-      self->avsync_delay);
+                         "line-width", "minimum-frequency", "maximum-frequency", "avsync-delay", "overlap",
+                         "averaging-time">(self->settings, self->show, self->fill, self->rounded_corners,
+                                           self->show_bar_border, self->dynamic_y_scale, self->n_points, self->height,
+                                           self->line_width, self->minimum_frequency, self->maximum_frequency,
+                                           self->avsync_delay, self->overlap, self->averaging_time);
 
   ui::gsettings_bind_enum_to_combo_widget(self->settings, "type", self->type);
+  ui::gsettings_bind_enum_to_combo_widget(self->settings, "fft-size", self->fft_size);
+  ui::gsettings_bind_enum_to_combo_widget(self->settings, "window", self->window);
+  ui::gsettings_bind_enum_to_combo_widget(self->settings, "averaging", self->averaging);
 
   // Spectrum gsettings signals connections
 
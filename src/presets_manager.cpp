@@ -27,6 +27,7 @@
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
+#include <map>
 #include <memory>
 #include <nlohmann/json_fwd.hpp>
 #include <optional>
@@ -70,6 +71,7 @@
 #include "tags_plugin_name.hpp"
 #include "tags_resources.hpp"
 #include "tags_schema.hpp"
+#include "tracer.hpp"
 #include "util.hpp"
 
 PresetsManager::PresetsManager()
@@ -661,6 +663,8 @@ auto PresetsManager::load_community_preset_file(const PresetType& preset_type,
 }
 
 auto PresetsManager::load_preset_file(const PresetType& preset_type, const std::filesystem::path& input_file) -> bool {
+  const tracer::Span span([&] { return "load_preset_file " + input_file.stem().string(); });
+
   nlohmann::json json;
 
   std::vector<std::string> plugins;
@@ -685,10 +689,23 @@ auto PresetsManager::read_effects_pipeline_from_preset(const PresetType& preset_
                                                        const std::filesystem::path& input_file,
                                                        nlohmann::json& json,
                                                        std::vector<std::string>& plugins) -> bool {
-  const auto* preset_type_str = (preset_type == PresetType::input) ? "input" : "output";
+  if (!read_plugins_order(preset_type, input_file, json, plugins)) {
+    return false;
+  }
 
   GSettings* settings = (preset_type == PresetType::input) ? sie_settings : soe_settings;
 
+  g_settings_set_strv(settings, "plugins", util::make_gchar_pointer_vector(plugins).data());
+
+  return true;
+}
+
+auto PresetsManager::read_plugins_order(const PresetType& preset_type,
+                                        const std::filesystem::path& input_file,
+                                        nlohmann::json& json,
+                                        std::vector<std::string>& plugins) -> bool {
+  const auto* preset_type_str = (preset_type == PresetType::input) ? "input" : "output";
+
   try {
     std::ifstream is(input_file);
 
@@ -724,8 +741,6 @@ auto PresetsManager::read_effects_pipeline_from_preset(const PresetType& preset_
     return false;
   }
 
-  g_settings_set_strv(settings, "plugins", util::make_gchar_pointer_vector(plugins).data());
-
   return true;
 }
 
@@ -755,6 +770,71 @@ auto PresetsManager::read_plugins_preset(const PresetType& preset_type,
   return true;
 }
 
+auto PresetsManager::write_snapshot(const PresetType& preset_type,
+                                    const std::string& name,
+                                    const uint& first_instance_id,
+                                    std::vector<std::string>& plugins,
+                                    std::vector<std::string>& blocklist) -> bool {
+  const auto conf_dir = (preset_type == PresetType::output) ? user_output_dir : user_input_dir;
+
+  const auto input_file = conf_dir / std::filesystem::path{name + json_ext};
+
+  if (!std::filesystem::exists(input_file)) {
+    util::warning("can't find the local preset \"" + name + "\" on the filesystem");
+
+    return false;
+  }
+
+  const tracer::Span span([&] { return "write_snapshot " + name; });
+
+  const auto* section = (preset_type == PresetType::input) ? "input" : "output";
+
+  nlohmann::json json;
+
+  std::vector<std::string> preset_plugins;
+
+  if (!read_plugins_order(preset_type, input_file, json, preset_plugins)) {
+    return false;
+  }
+
+  try {
+    blocklist = json.at(section).at("blocklist").get<std::vector<std::string>>();
+  } catch (const nlohmann::json::exception& e) {
+    notify_error(PresetError::blocklist_format);
+
+    util::warning(e.what());
+
+    return false;
+  }
+
+  /*
+    The parameters are moved to the new instance names before they are written. Old format presets store them under
+    the base name of the plugin.
+  */
+
+  nlohmann::json snapshot_json;
+
+  std::map<std::string, uint> n_instances;
+
+  plugins.clear();
+
+  for (const auto& p : preset_plugins) {
+    const auto base_name = tags::plugin_name::get_base_name(p);
+
+    const auto instance_name = base_name + "#" + util::to_string(first_instance_id + n_instances[base_name]++);
+
+    if (json.at(section).contains(p)) {
+      snapshot_json[section][instance_name] = json.at(section).at(p);
+    } else if (json.at(section).contains(base_name)) {
+      snapshot_json[section][instance_name] = json.at(section).at(base_name);
+    }
+
+    plugins.push_back(instance_name);
+  }
+
+  return read_plugins_preset(preset_type, plugins, snapshot_json);
+}
+
 void PresetsManager::import_from_filesystem(const PresetType& preset_type, const std::string& file_path) {
   // When importing presets from the filesystem, we overwrite the file if it already exists.
 
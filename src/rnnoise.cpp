@@ -27,14 +27,16 @@
 #include <sys/types.h>
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdio>
 #include <memory>
 #include <mutex>
 #include <span>
 #include <string>
+#include "block_adapter.hpp"
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
-#include "resampler.hpp"
+#include "polyphase_resampler.hpp"
 #include "tags_plugin_name.hpp"
 #include "tags_resources.hpp"
 #include "util.hpp"
@@ -53,11 +55,8 @@ RNNoise::RNNoise(const std::string& tag,
                  pipe_type),
       enable_vad(g_settings_get_boolean(settings, "enable-vad")),
       vad_thres(g_settings_get_double(settings, "vad-thres") / 100.0F),
-      data_L(0),
-      data_R(0) {
-  data_L.reserve(blocksize);
-  data_R.reserve(blocksize);
-  data_tmp.reserve(blocksize);
+      data_tmp(blocksize) {
+  allocate_dry_delay();
 
   // Initialize directories for local and community models
   local_dir_rnnoise = std::string{g_get_user_config_dir()} + "/easyeffects/rnnoise";
@@ -178,25 +177,37 @@ RNNoise::~RNNoise() {
 }
 
 void RNNoise::setup() {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  setup_pending = true;
+}
 
+void RNNoise::apply_setup() {
   resampler_ready = false;
 
   latency_n_frames = 0U;
 
   resample = rate != rnnoise_rate;
 
-  data_L.resize(0U);
-  data_R.resize(0U);
+  if (resample) {
+    // frames produced by the output resamplers for each rnnoise block
+
+    const auto block_out = static_cast<size_t>(
+        std::ceil(static_cast<double>(blocksize) * static_cast<double>(rate) / static_cast<double>(rnnoise_rate)));
+
+    block_adapter.setup(blocksize, n_samples, block_out, n_samples + 3U * block_out);
+  } else {
+    block_adapter.setup(blocksize, n_samples, BlockAdapter<float>::get_priming(blocksize, n_samples));
+  }
 
-  deque_out_L.resize(0U);
-  deque_out_R.resize(0U);
+  if (resample) {
+    resampler_in.setup(rate, rnnoise_rate, n_samples);
+    resampler_out.setup(rnnoise_rate, rate, blocksize);
 
-  resampler_inL = std::make_unique<Resampler>(rate, rnnoise_rate);
-  resampler_inR = std::make_unique<Resampler>(rate, rnnoise_rate);
+    // The delay of the input resampler is given in frames at the rnnoise rate
 
-  resampler_outL = std::make_unique<Resampler>(rnnoise_rate, rate);
-  resampler_outR = std::make_unique<Resampler>(rnnoise_rate, rate);
+    resampler_latency = resampler_out.get_latency() + (resampler_in.get_latency() * rate / rnnoise_rate);
+  } else {
+    resampler_latency = 0U;
+  }
 
   resampler_ready = true;
 }
@@ -205,7 +216,21 @@ void RNNoise::process(std::span<float>& left_in,
                       std::span<float>& right_in,
                       std::span<float>& left_out,
                       std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  const auto lock = lock_for_rt();
+
+  if (!lock.owns_lock()) {
+    write_delayed_dry(left_in, right_in, left_out, right_out);
+
+    return;
+  }
+
+  if (setup_pending) {
+    apply_setup();
+
+    setup_pending = false;
+  }
+
+  store_dry(left_in, right_in);
 
   if (bypass || !rnnoise_ready) {
     std::copy(left_in.begin(), left_in.end(), left_out.begin());
@@ -220,74 +245,34 @@ void RNNoise::process(std::span<float>& left_in,
 
   if (resample) {
     if (resampler_ready) {
-      const auto resampled_inL = resampler_inL->process(left_in, false);
-      const auto resampled_inR = resampler_inR->process(right_in, false);
-
-      resampled_data_L.resize(0U);
-      resampled_data_R.resize(0U);
+      const auto [resampled_inL, resampled_inR] = resampler_in.process(left_in, right_in);
 
+      block_adapter.write(resampled_inL, resampled_inR, [this](std::span<float>& l, std::span<float>& r) {
 #ifdef ENABLE_RNNOISE
-      remove_noise(resampled_inL, resampled_inR, resampled_data_L, resampled_data_R);
+        remove_noise(l, r);
 #endif
 
-      auto resampled_outL = resampler_outL->process(resampled_data_L, false);
-      auto resampled_outR = resampler_outR->process(resampled_data_R, false);
+        const auto [resampled_outL, resampled_outR] = resampler_out.process(l, r);
 
-      for (const auto& v : resampled_outL) {
-        deque_out_L.push_back(v);
-      }
-
-      for (const auto& v : resampled_outR) {
-        deque_out_R.push_back(v);
-      }
+        block_adapter.push(resampled_outL, resampled_outR);
+      });
     } else {
-      for (const auto& v : left_in) {
-        deque_out_L.push_back(v);
-      }
-
-      for (const auto& v : right_in) {
-        deque_out_R.push_back(v);
-      }
+      block_adapter.push(left_in, right_in);
     }
+
+    block_adapter.pop(left_out, right_out);
   } else {
+    block_adapter.process(left_in, right_in, left_out, right_out, [this](std::span<float>& l, std::span<float>& r) {
 #ifdef ENABLE_RNNOISE
-    remove_noise(left_in, right_in, deque_out_L, deque_out_R);
+      remove_noise(l, r);
 #endif
+    });
   }
 
-  if (deque_out_L.size() >= left_out.size()) {
-    for (float& v : left_out) {
-      v = deque_out_L.front();
-
-      deque_out_L.pop_front();
-    }
-
-    for (float& v : right_out) {
-      v = deque_out_R.front();
-
-      deque_out_R.pop_front();
-    }
-  } else {
-    const uint offset = 2U * (left_out.size() - deque_out_L.size());
-
-    if (offset != latency_n_frames) {
-      latency_n_frames = offset;
+  if (const auto delay = block_adapter.get_latency() + resampler_latency; delay != latency_n_frames) {
+    latency_n_frames = delay;
 
-      notify_latency = true;
-    }
-
-    for (uint n = 0U; !deque_out_L.empty() && n < left_out.size(); n++) {
-      if (n < offset) {
-        left_out[n] = 0.0F;
-        right_out[n] = 0.0F;
-      } else {
-        left_out[n] = deque_out_L.front();
-        right_out[n] = deque_out_R.front();
-
-        deque_out_R.pop_front();
-        deque_out_L.pop_front();
-      }
-    }
+    notify_latency = true;
   }
 
   if (output_gain != 1.0F) {
@@ -24,19 +24,75 @@
 #include <glib.h>
 #include <sys/types.h>
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstddef>
-#include <cstring>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <numbers>
 #include <span>
 #include <string>
+#include <thread>
+#include <vector>
 #include "pipe_manager.hpp"
 #include "plugin_base.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
 
+Spectrum::Analyzer::Analyzer(const uint& fft_size, const Window& window_type)
+    : fft_size(fft_size),
+      n_bins(fft_size / 2U + 1U),
+      window(fft_size),
+      power(n_bins),
+      accumulated(n_bins),
+      result(n_bins) {
+  // Precompute the window, which is an expensive operation.
+  // https://en.wikipedia.org/wiki/Window_function
+
+  for (size_t n = 0; n < fft_size; n++) {
+    const auto x = 2.0 * std::numbers::pi * static_cast<double>(n) / static_cast<double>(fft_size - 1U);
+
+    switch (window_type) {
+      case Window::hann:
+        window[n] = static_cast<float>(0.5 * (1.0 - std::cos(x)));
+        break;
+      case Window::hamming:
+        window[n] = static_cast<float>(0.54 - 0.46 * std::cos(x));
+        break;
+      case Window::blackman_harris:
+        window[n] = static_cast<float>(0.35875 - 0.48829 * std::cos(x) + 0.14128 * std::cos(2.0 * x) -
+                                       0.01168 * std::cos(3.0 * x));
+        break;
+      case Window::flat_top:
+        window[n] = static_cast<float>(0.21557895 - 0.41663158 * std::cos(x) + 0.277263158 * std::cos(2.0 * x) -
+                                       0.083578947 * std::cos(3.0 * x) + 0.006947368 * std::cos(4.0 * x));
+        break;
+    }
+  }
+
+  double window_sum = 0.0;
+
+  for (const auto& w : window) {
+    window_sum += static_cast<double>(w);
+  }
+
+  scale = static_cast<float>(1.0 / (window_sum * window_sum));
+
+  real_input = fftwf_alloc_real(fft_size);
+  complex_output = fftwf_alloc_complex(n_bins);
+
+  plan = fftwf_plan_dft_r2c_1d(static_cast<int>(fft_size), real_input, complex_output, FFTW_ESTIMATE);
+}
+
+Spectrum::Analyzer::~Analyzer() {
+  fftwf_destroy_plan(plan);
+
+  fftwf_free(real_input);
+  fftwf_free(complex_output);
+}
+
 Spectrum::Spectrum(const std::string& tag,
                    const std::string& schema,
                    const std::string& schema_path,
@@ -44,17 +100,7 @@ Spectrum::Spectrum(const std::string& tag,
                    PipelineType pipe_type)
     : PluginBase(tag, "spectrum", tags::plugin_package::ee, schema, schema_path, pipe_manager, pipe_type),
       fftw_ready(true) {
-  // Precompute the Hann window, which is an expensive operation.
-  // https://en.wikipedia.org/wiki/Hann_function
-  for (size_t n = 0; n < n_bands; n++) {
-    hann_window[n] =
-        0.5F *
-        (1.0F - std::cos(2.0F * std::numbers::pi_v<float> * static_cast<float>(n) / static_cast<float>(n_bands - 1)));
-  }
-
-  complex_output = fftwf_alloc_complex(n_bands);
-
-  plan = fftwf_plan_dft_r2c_1d(static_cast<int>(n_bands), real_input.data(), complex_output, FFTW_ESTIMATE);
+  std::ranges::fill(ring, 0.0F);
 
   lv2_wrapper = std::make_unique<lv2::Lv2Wrapper>("http://lsp-plug.in/plugins/lv2/comp_delay_x2_stereo");
 
@@ -84,6 +130,27 @@ Spectrum::Spectrum(const std::string& tag,
                      self->bypass = g_settings_get_boolean(settings, key) == 0;
                    }),
                    this);
+
+  for (const auto* key : {"changed::n-points", "changed::minimum-frequency", "changed::maximum-frequency"}) {
+    g_signal_connect(settings, key, G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                       static_cast<Spectrum*>(user_data)->read_display_settings();
+                     }),
+                     this);
+  }
+
+  for (const auto* key :
+       {"changed::fft-size", "changed::window", "changed::overlap", "changed::averaging", "changed::averaging-time"}) {
+    g_signal_connect(settings, key, G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                       static_cast<Spectrum*>(user_data)->create_analyzer();
+                     }),
+                     this);
+  }
+
+  read_display_settings();
+
+  create_analyzer();
+
+  analysis_thread = std::thread([this]() { analysis_loop(); });
 }
 
 Spectrum::~Spectrum() {
@@ -93,25 +160,36 @@ Spectrum::~Spectrum() {
 
   fftw_ready = false;
 
-  if (complex_output != nullptr) {
-    fftwf_free(complex_output);
+  {
+    std::scoped_lock<std::mutex> lock(analysis_mutex);
+
+    analysis_quit = true;
   }
 
-  fftwf_destroy_plan(plan);
+  analysis_cv.notify_one();
+
+  if (analysis_thread.joinable()) {
+    analysis_thread.join();
+  }
+
+  // The analyzer and its fftw plan are released here on the main thread.
+
+  analyzer.reset();
 
   util::debug(log_tag + name + " destroyed");
 }
 
 void Spectrum::setup() {
-  std::ranges::fill(real_input, 0.0F);
-  std::ranges::fill(latest_samples_mono, 0.0F);
-
   left_delayed_vector.resize(n_samples, 0.0F);
   right_delayed_vector.resize(n_samples, 0.0F);
 
   left_delayed = std::span<float>(left_delayed_vector);
   right_delayed = std::span<float>(right_delayed_vector);
 
+  if (analysis_rate.exchange(rate) != rate) {
+    layout_dirty = true;
+  }
+
   lv2_wrapper->set_n_samples(n_samples);
 
   if (!lv2_wrapper->found_plugin) {
@@ -135,6 +213,9 @@ void Spectrum::process(std::span<float>& left_in,
     return;
   }
 
+  std::span<float> left = left_in;
+  std::span<float> right = right_in;
+
   // delay the visualization of the spectrum by the reported latency
   // of the output device, so that the spectrum is visually in sync
   // with the audio as experienced by the user. (A/V sync)
@@ -142,129 +223,314 @@ void Spectrum::process(std::span<float>& left_in,
     lv2_wrapper->connect_data_ports(left_in, right_in, left_delayed, right_delayed);
     lv2_wrapper->run();
 
-    // Downmix the latest n_bands samples from the delayed signal.
-    if (n_samples < n_bands) {
-      // Drop the oldest quantum.
-      std::memmove(&latest_samples_mono[0], &latest_samples_mono[n_samples], (n_bands - n_samples) * sizeof(float));
+    left = left_delayed;
+    right = right_delayed;
+  }
+
+  /*
+    Append the downmixed quantum to the ring and only then publish the new sample count. The release store pairs
+    with the acquire load in the analysis thread, so every sample below the published count is visible to it.
+  */
+
+  const auto write_count = ring_write_count.load(std::memory_order_relaxed);
+
+  for (size_t n = 0; n < n_samples; n++) {
+    ring[(write_count + n) & ring_mask] = 0.5F * (left[n] + right[n]);
+  }
+
+  ring_write_count.store(write_count + n_samples, std::memory_order_release);
+}
+
+void Spectrum::read_display_settings() {
+  display_min_freq = static_cast<float>(g_settings_get_int(settings, "minimum-frequency"));
+  display_max_freq = static_cast<float>(g_settings_get_int(settings, "maximum-frequency"));
+  display_n_points = static_cast<uint>(g_settings_get_int(settings, "n-points"));
+
+  layout_dirty = true;
+}
+
+void Spectrum::create_analyzer() {
+  const auto fft_size = 1024U << static_cast<uint>(g_settings_get_enum(settings, "fft-size"));
+
+  auto new_analyzer =
+      std::make_unique<Analyzer>(fft_size, static_cast<Window>(g_settings_get_enum(settings, "window")));
+
+  const auto overlap = 0.01 * static_cast<double>(g_settings_get_int(settings, "overlap"));
+
+  new_analyzer->hop = std::max(1U, static_cast<uint>(std::lround(static_cast<double>(fft_size) * (1.0 - overlap))));
+
+  new_analyzer->averaging = static_cast<Averaging>(g_settings_get_enum(settings, "averaging"));
+
+  new_analyzer->averaging_time = 0.001F * static_cast<float>(g_settings_get_int(settings, "averaging-time"));
+
+  util::debug(log_tag + name + " analyzer: fft size " + util::to_string(fft_size) + ", hop " +
+              util::to_string(new_analyzer->hop));
+
+  {
+    std::scoped_lock<std::mutex> lock(analysis_mutex);
+
+    analyzer.swap(new_analyzer);
+
+    analyzer_changed = true;
+  }
+
+  // new_analyzer now holds the previous one, which is destroyed here on the main thread together with its plan.
+}
+
+void Spectrum::analysis_loop() {
+  /*
+    The realtime thread only appends samples to the ring. Windowing, the fft, the averaging and the reduction to the
+    display points happen here so that neither the realtime thread nor the GTK frame clock pay for them. We poll at
+    about the display refresh rate instead of being woken up because realtime must not signal us.
+  */
+
+  std::unique_lock<std::mutex> lock(analysis_mutex);
+
+  while (!analysis_cv.wait_for(lock, analysis_period, [this]() { return analysis_quit; })) {
+    if (bypass || !fftw_ready || analyzer == nullptr) {
+      continue;
+    }
+
+    const auto written = ring_write_count.load(std::memory_order_acquire);
+
+    if (const auto dirty = layout_dirty.exchange(false); dirty || analyzer_changed) {
+      analyzer_changed = false;
+
+      build_display_layout();
+
+      reset_averaging();
+
+      next_frame_end = written;
+    }
+
+    const uint64_t fft_size = analyzer->fft_size;
+
+    if (display_bands.empty() || written < fft_size) {
+      continue;
+    }
+
+    // Without averaging only the newest frame matters. Otherwise restart from it if we fell too far behind.
+
+    if (written >= next_frame_end &&
+        (analyzer->averaging == Averaging::none || written - next_frame_end > ring_size - ring_guard - fft_size)) {
+      next_frame_end = written;
+    }
+
+    next_frame_end = std::max(next_frame_end, fft_size);
+
+    bool updated = false;
+
+    while (next_frame_end <= written) {
+      updated = analyze_frame(next_frame_end) || updated;
 
-      // Copy the new quantum.
-      for (size_t n = 0; n < n_samples; n++) {
-        latest_samples_mono[n_bands - n_samples + n] = 0.5F * (left_delayed[n] + right_delayed[n]);
+      next_frame_end += analyzer->hop;
+    }
+
+    if (!updated) {
+      continue;
+    }
+
+    reduce_to_display();
+
+    std::scoped_lock<std::mutex> display_lock(display_mutex);
+
+    published_db = display_db;
+
+    new_frame = true;
+  }
+}
+
+auto Spectrum::analyze_frame(const uint64_t& frame_end) -> bool {
+  auto& a = *analyzer;
+
+  const auto frame_start = frame_end - a.fft_size;
+
+  for (size_t n = 0; n < a.fft_size; n++) {
+    a.real_input[n] = ring[(frame_start + n) & ring_mask] * a.window[n];
+  }
+
+  // Seqlock style check: if realtime may have started overwriting the frame while we copied it we drop it.
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  if (ring_write_count.load(std::memory_order_relaxed) - frame_start > ring_size - ring_guard) {
+    return false;
+  }
+
+  fftwf_execute(a.plan);
+
+  for (uint i = 0U; i < a.n_bins; i++) {
+    a.power[i] =
+        a.scale * (a.complex_output[i][0] * a.complex_output[i][0] + a.complex_output[i][1] * a.complex_output[i][1]);
+  }
+
+  switch (a.averaging) {
+    case Averaging::none: {
+      std::ranges::copy(a.power, a.result.begin());
+
+      return true;
+    }
+    case Averaging::exponential: {
+      if (a.n_averaged == 0U) {
+        std::ranges::copy(a.power, a.result.begin());
+
+        a.n_averaged = 1U;
+      } else {
+        for (uint i = 0U; i < a.n_bins; i++) {
+          a.result[i] = a.decay * a.result[i] + (1.0F - a.decay) * a.power[i];
+        }
       }
-    } else {
-      // Copy the latest n_bands samples.
-      for (size_t n = 0; n < n_bands; n++)
-        latest_samples_mono[n] =
-            0.5F * (left_delayed[n_samples - n_bands + n] + right_delayed[n_samples - n_bands + n]);
+
+      return true;
     }
-  } else {
-    // Downmix the latest n_bands samples from the non-delayed signal.
-    if (n_samples < n_bands) {
-      // Drop the oldest quantum.
-      std::memmove(&latest_samples_mono[0], &latest_samples_mono[n_samples], (n_bands - n_samples) * sizeof(float));
-
-      // Copy the new quantum.
-      for (size_t n = 0; n < n_samples; n++) {
-        latest_samples_mono[n_bands - n_samples + n] = 0.5F * (left_in[n] + right_in[n]);
+    case Averaging::peak_hold: {
+      for (uint i = 0U; i < a.n_bins; i++) {
+        a.result[i] = std::max(a.power[i], a.decay * a.result[i]);
       }
-    } else {
-      // Copy the latest n_bands samples.
-      for (size_t n = 0; n < n_bands; n++)
-        latest_samples_mono[n] = 0.5F * (left_in[n_samples - n_bands + n] + right_in[n_samples - n_bands + n]);
+
+      return true;
+    }
+    case Averaging::welch: {
+      // Mean of the periodograms of welch_frames overlapping segments. The display updates once per average.
+
+      for (uint i = 0U; i < a.n_bins; i++) {
+        a.accumulated[i] = (a.n_averaged == 0U) ? a.power[i] : a.accumulated[i] + a.power[i];
+      }
+
+      if (++a.n_averaged < a.welch_frames) {
+        return false;
+      }
+
+      for (uint i = 0U; i < a.n_bins; i++) {
+        a.result[i] = a.accumulated[i] / static_cast<float>(a.n_averaged);
+      }
+
+      a.n_averaged = 0U;
+
+      return true;
     }
   }
 
-  /*
-   * OK, we have the latest_samples_mono array that contains n_bands samples. We
-   * want to export it to the GUI thread. We don't wakeup the GUI thread from
-   * realtime, we only want to update the buffer and let the GUI thread follow
-   * its scheduling and have access to our new buffer. We accept losing old data.
-   *
-   * For that, we want to synchronise both threads. Realtime shouldn't have to
-   * wait (ie loop or syscall). It is fine if GUI waits a little.
-   *
-   * The overall concept is to use two buffers. When realtime comes in, it
-   * writes into one. When GUI arrives, it waits for realtime to be done
-   * writing (if it is busy) and it switches the active buffer to become the
-   * other one. As GUI is the one doing the toggle, it knows it can read at its
-   * pace the inactive buffer. Realtime will always have a buffer to write
-   * into, and it is fine if it overwrites data.
-   *
-   * We use an atomic integer (db_control) that contains three bits:
-   *  - DB_BIT_IDX: the current buffer index.
-   *  - DB_BIT_NEWDATA: indicates if realtime wrote new data.
-   *  - DB_BIT_BUSY: indicates if realtime is currently busy writing data.
-   *
-   * Realtime does this:
-   *  - Grab db_control and enable its BUSY bit.
-   *  - Write data into the correct buffer based on the IDX bit.
-   *  - Write db_control with same index as before, BUSY bit disabled and
-   *    NEWDATA bit enabled.
-   *
-   * GUI does this:
-   *  - Early return if NEWDATA is not enabled. It means realtime hasn't ran
-   *    since the last time GUI ran.
-   *  - Then it tries toggling the IDX bit. "Tries" because the operation fails
-   *    as long as the BUSY bit is active.
-   *  - From now on it can read the previous buffer knowing realtime cannot be
-   *    writing into it.
-   *
-   * This is single-producer single-consumer double-buffering. The
-   * implementation is inspired from the "Real-time 101" ADC19 talk
-   * (David Rowland & Fabian Renn-Giles).
-   *
-   * Talk part 1 & 2, slides (page 74 onwards) and illustrating library:
-   * https://www.youtube.com/watch?v=Q0vrQFyAdWI
-   * https://www.youtube.com/watch?v=PoZAo2Vikbo
-   * https://github.com/drowaudio/presentations/blob/master/ADC%202019%20-%20Real-time%20101/Real-time%20101.pdf
-   * https://github.com/hogliux/farbot
-   */
-
-  // Grab the current index AND mark as busy at the same time.
-  int index = db_control.fetch_or(DB_BIT_BUSY) & DB_BIT_IDX;
-
-  // Fill the buffer.
-  db_buffers[index] = latest_samples_mono;
-
-  // Mark new data available AND mark as not busy anymore.
-  db_control.store(index | DB_BIT_NEWDATA);
+  return false;
+}
+
+void Spectrum::reset_averaging() {
+  auto& a = *analyzer;
+
+  const auto sampling_rate = static_cast<float>(analysis_rate.load());
+
+  const auto hop_time = (sampling_rate > 0.0F) ? static_cast<float>(a.hop) / sampling_rate : 0.0F;
+
+  a.decay = (a.averaging_time > 0.0F) ? std::exp(-hop_time / a.averaging_time) : 0.0F;
+
+  a.welch_frames = (hop_time > 0.0F) ? std::max(1U, static_cast<uint>(std::lround(a.averaging_time / hop_time))) : 1U;
+
+  a.n_averaged = 0U;
+
+  std::ranges::fill(a.result, 0.0F);
 }
 
-std::tuple<uint, uint, double*> Spectrum::compute_magnitudes() {
-  // Early return if no new data is available, ie if process() has not been
-  // called since our last compute_magnitudes() call.
-  int curr_control = db_control.load();
-  if (!(curr_control & DB_BIT_NEWDATA)) {
-    return std::tuple<uint, uint, double*>(0, 0, nullptr);
+void Spectrum::build_display_layout() {
+  display_bands.clear();
+  display_freqs.clear();
+
+  const auto sampling_rate = static_cast<float>(analysis_rate.load());
+  const auto min_freq = display_min_freq.load();
+  const auto max_freq = std::min(display_max_freq.load(), 0.5F * sampling_rate);
+
+  if (sampling_rate == 0.0F || min_freq <= 0.0F || min_freq > (max_freq - 100.0F)) {
+    return;
+  }
+
+  const auto log_axis = util::logspace(min_freq, max_freq, display_n_points.load());
+
+  if (log_axis.empty()) {
+    return;
   }
 
-  // CAS loop to toggle the buffer used and remove NEWDATA flag, waiting for !BUSY.
-  int next_control;
-  do {
-    curr_control &= ~DB_BIT_BUSY;
-    next_control = (curr_control ^ DB_BIT_IDX) & DB_BIT_IDX;
-  } while (!db_control.compare_exchange_weak(curr_control, next_control));
+  const auto n_bins = analyzer->n_bins;
+  const auto bin_width = sampling_rate / static_cast<float>(analyzer->fft_size);
+  const auto last_bin = static_cast<float>(n_bins - 1U);
+
+  display_bands.resize(log_axis.size());
+  display_freqs.resize(log_axis.size());
+  display_db.resize(log_axis.size());
+
+  for (size_t n = 0U; n < log_axis.size(); n++) {
+    display_freqs[n] = static_cast<double>(log_axis[n]);
 
-  // Buffer with data is at the index which was found inside db_control.
-  int index = curr_control & DB_BIT_IDX;
-  float* buf = db_buffers[index].data();
+    // Each point covers the frequencies up to the geometric mean with its neighbours.
+
+    const auto f_prev = (n > 0U) ? log_axis[n - 1U] : log_axis[n] * log_axis[n] / log_axis[n + 1U];
+    const auto f_next = (n + 1U < log_axis.size()) ? log_axis[n + 1U] : log_axis[n] * log_axis[n] / log_axis[n - 1U];
+
+    const auto first = std::ceil(std::sqrt(f_prev * log_axis[n]) / bin_width);
+    const auto last = std::min(std::floor(std::sqrt(log_axis[n] * f_next) / bin_width), last_bin);
+
+    auto& band = display_bands[n];
+
+    if (last > first) {
+      band.interpolate = false;
+      band.first_bin = static_cast<uint>(first);
+      band.last_bin = static_cast<uint>(last);
+    } else {
+      const auto position = std::min(log_axis[n] / bin_width, last_bin);
 
-  // https://en.wikipedia.org/wiki/Hann_function
-  for (size_t n = 0; n < n_bands; n++) {
-    real_input[n] = buf[n] * hann_window[n];
+      band.interpolate = true;
+      band.first_bin = std::min(static_cast<uint>(position), n_bins - 2U);
+      band.last_bin = band.first_bin + 1U;
+      band.weight = position - static_cast<float>(band.first_bin);
+    }
   }
 
-  fftwf_execute(plan);
+  std::scoped_lock<std::mutex> lock(display_mutex);
+
+  published_freqs = display_freqs;
+
+  published_layout_serial++;
+
+  new_frame = false;
+}
+
+void Spectrum::reduce_to_display() {
+  const auto& result = analyzer->result;
+
+  for (size_t n = 0U; n < display_bands.size(); n++) {
+    const auto& band = display_bands[n];
+
+    float v = 0.0F;
 
-  for (uint i = 0U; i < output.size(); i++) {
-    float sqr = complex_output[i][0] * complex_output[i][0] + complex_output[i][1] * complex_output[i][1];
+    if (band.interpolate) {
+      v = (1.0F - band.weight) * result[band.first_bin] + band.weight * result[band.last_bin];
+    } else {
+      v = *std::max_element(result.begin() + band.first_bin, result.begin() + band.last_bin + 1U);
+    }
 
-    sqr /= static_cast<float>(output.size() * output.size());
+    v = 10.0F * std::log10(v);
 
-    output[i] = static_cast<double>(sqr);
+    display_db[n] = (!std::isinf(v) && v > util::minimum_db_level) ? v : util::minimum_db_level;
   }
+}
+
+auto Spectrum::get_display_data(uint& layout_serial, std::vector<double>& frequencies, std::vector<double>& magnitudes)
+    -> bool {
+  std::scoped_lock<std::mutex> lock(display_mutex);
+
+  if (!new_frame) {
+    return false;
+  }
+
+  new_frame = false;
+
+  if (layout_serial != published_layout_serial) {
+    layout_serial = published_layout_serial;
+
+    frequencies = published_freqs;
+  }
+
+  magnitudes = published_db;
 
-  return std::tuple<uint, uint, double*>(rate, output.size(), output.data());
+  return true;
 }
 
 auto Spectrum::get_latency_seconds() -> float {
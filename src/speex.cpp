@@ -54,113 +54,115 @@ Speex::Speex(const std::string& tag,
       enable_dereverb(g_settings_get_boolean(settings, "enable-dereverb")) {
   gconnections.push_back(g_signal_connect(
       settings, "changed::enable-denoise", G_CALLBACK(+[](GSettings* settings, char* key, Speex* self) {
-        std::scoped_lock<std::mutex> lock(self->data_mutex);
+        self->post_to_rt([self, value = g_settings_get_boolean(settings, key)]() {
+          self->enable_denoise = value;
 
-        self->enable_denoise = g_settings_get_boolean(settings, key);
+          if (self->state_left) {
+            speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_DENOISE, &self->enable_denoise);
+          }
 
-        if (self->state_left) {
-          speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_DENOISE, &self->enable_denoise);
-        }
-
-        if (self->state_right) {
-          speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_DENOISE, &self->enable_denoise);
-        }
+          if (self->state_right) {
+            speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_DENOISE, &self->enable_denoise);
+          }
+        });
       }),
       this));
 
   gconnections.push_back(g_signal_connect(
       settings, "changed::noise-suppression", G_CALLBACK(+[](GSettings* settings, char* key, Speex* self) {
-        std::scoped_lock<std::mutex> lock(self->data_mutex);
-
-        self->noise_suppression = g_settings_get_int(settings, key);
+        self->post_to_rt([self, value = g_settings_get_int(settings, key)]() {
+          self->noise_suppression = value;
 
-        if (self->state_left) {
-          speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_NOISE_SUPPRESS, &self->noise_suppression);
-        }
+          if (self->state_left) {
+            speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_NOISE_SUPPRESS, &self->noise_suppression);
+          }
 
-        if (self->state_right) {
-          speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_NOISE_SUPPRESS, &self->noise_suppression);
-        }
+          if (self->state_right) {
+            speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_NOISE_SUPPRESS, &self->noise_suppression);
+          }
+        });
       }),
       this));
 
   gconnections.push_back(
       g_signal_connect(settings, "changed::enable-agc", G_CALLBACK(+[](GSettings* settings, char* key, Speex* self) {
-                         std::scoped_lock<std::mutex> lock(self->data_mutex);
-
-                         self->enable_agc = g_settings_get_boolean(settings, key);
+                         self->post_to_rt([self, value = g_settings_get_boolean(settings, key)]() {
+                           self->enable_agc = value;
 
-                         if (self->state_left) {
-                           speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_AGC, &self->enable_agc);
-                         }
+                           if (self->state_left) {
+                             speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_AGC, &self->enable_agc);
+                           }
 
-                         if (self->state_right) {
-                           speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_AGC, &self->enable_agc);
-                         }
+                           if (self->state_right) {
+                             speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_AGC, &self->enable_agc);
+                           }
+                         });
                        }),
                        this));
 
   gconnections.push_back(
       g_signal_connect(settings, "changed::enable-vad", G_CALLBACK(+[](GSettings* settings, char* key, Speex* self) {
-                         std::scoped_lock<std::mutex> lock(self->data_mutex);
+                         self->post_to_rt([self, value = g_settings_get_boolean(settings, key)]() {
+                           self->enable_vad = value;
 
-                         self->enable_vad = g_settings_get_boolean(settings, key);
+                           if (self->state_left) {
+                             speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_VAD, &self->enable_vad);
+                           }
 
-                         if (self->state_left) {
-                           speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_VAD, &self->enable_vad);
-                         }
-
-                         if (self->state_right) {
-                           speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_VAD, &self->enable_vad);
-                         }
+                           if (self->state_right) {
+                             speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_VAD, &self->enable_vad);
+                           }
+                         });
                        }),
                        this));
 
   gconnections.push_back(g_signal_connect(
       settings, "changed::vad-probability-start", G_CALLBACK(+[](GSettings* settings, char* key, Speex* self) {
-        std::scoped_lock<std::mutex> lock(self->data_mutex);
-
-        self->vad_probability_start = g_settings_get_int(settings, key);
+        self->post_to_rt([self, value = g_settings_get_int(settings, key)]() {
+          self->vad_probability_start = value;
 
-        if (self->state_left) {
-          speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_PROB_START, &self->vad_probability_start);
-        }
+          if (self->state_left) {
+            speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_PROB_START, &self->vad_probability_start);
+          }
 
-        if (self->state_right) {
-          speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_PROB_START, &self->vad_probability_start);
-        }
+          if (self->state_right) {
+            speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_PROB_START, &self->vad_probability_start);
+          }
+        });
       }),
       this));
 
   gconnections.push_back(g_signal_connect(
       settings, "changed::vad-probability-continue", G_CALLBACK(+[](GSettings* settings, char* key, Speex* self) {
-        std::scoped_lock<std::mutex> lock(self->data_mutex);
-
-        self->vad_probability_continue = g_settings_get_int(settings, key);
-
-        if (self->state_left) {
-          speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_PROB_CONTINUE, &self->vad_probability_continue);
-        }
-
-        if (self->state_right) {
-          speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_PROB_CONTINUE, &self->vad_probability_continue);
-        }
+        self->post_to_rt([self, value = g_settings_get_int(settings, key)]() {
+          self->vad_probability_continue = value;
+
+          if (self->state_left) {
+            speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_PROB_CONTINUE,
+                                 &self->vad_probability_continue);
+          }
+
+          if (self->state_right) {
+            speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_PROB_CONTINUE,
+                                 &self->vad_probability_continue);
+          }
+        });
       }),
       this));
 
   gconnections.push_back(g_signal_connect(
       settings, "changed::enable-dereverb", G_CALLBACK(+[](GSettings* settings, char* key, Speex* self) {
-        std::scoped_lock<std::mutex> lock(self->data_mutex);
+        self->post_to_rt([self, value = g_settings_get_boolean(settings, key)]() {
+          self->enable_dereverb = value;
 
-        self->enable_dereverb = g_settings_get_boolean(settings, key);
+          if (self->state_left) {
+            speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_DEREVERB, &self->enable_dereverb);
+          }
 
-        if (self->state_left) {
-          speex_preprocess_ctl(self->state_left, SPEEX_PREPROCESS_SET_DEREVERB, &self->enable_dereverb);
-        }
-
-        if (self->state_right) {
-          speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_DEREVERB, &self->enable_dereverb);
-        }
+          if (self->state_right) {
+            speex_preprocess_ctl(self->state_right, SPEEX_PREPROCESS_SET_DEREVERB, &self->enable_dereverb);
+          }
+        });
       }),
       this));
 
@@ -180,8 +182,10 @@ Speex::~Speex() {
 }
 
 void Speex::setup() {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  setup_pending = true;
+}
 
+void Speex::apply_setup() {
   latency_n_frames = 0U;
 
   speex_ready = false;
@@ -233,7 +237,19 @@ void Speex::process(std::span<float>& left_in,
                     std::span<float>& right_in,
                     std::span<float>& left_out,
                     std::span<float>& right_out) {
-  std::scoped_lock<std::mutex> lock(data_mutex);
+  const auto lock = lock_for_rt();
+
+  if (!lock.owns_lock()) {
+    write_delayed_dry(left_in, right_in, left_out, right_out);
+
+    return;
+  }
+
+  if (setup_pending) {
+    apply_setup();
+
+    setup_pending = false;
+  }
 
   if (bypass || !speex_ready) {
     std::copy(left_in.begin(), left_in.end(), left_out.begin());
@@ -26,14 +26,14 @@
 #include <sigc++/functors/mem_fun.h>
 #include <spa/utils/defs.h>
 #include <algorithm>
-#include <chrono>
 #include <cstdlib>
 #include <ranges>
 #include <set>
 #include <string>
-#include <thread>
+#include <utility>
 #include <vector>
 #include "effects_base.hpp"
+#include "graph_transaction.hpp"
 #include "pipe_manager.hpp"
 #include "pipe_objects.hpp"
 #include "tags_pipewire.hpp"
@@ -83,6 +83,14 @@ StreamInputEffects::StreamInputEffects(PipeManager* pipe_manager)
   connections.push_back(pm->stream_input_added.connect(sigc::mem_fun(*this, &StreamInputEffects::on_app_added)));
   connections.push_back(pm->link_changed.connect(sigc::mem_fun(*this, &StreamInputEffects::on_link_changed)));
 
+  // Plugins that finish loading are inserted in the running chain. Only the links around them are touched.
+
+  connections.push_back(plugin_loaded.connect([this](const std::string& name) {
+    if (!bypass && !chain_links.empty()) {
+      connect_filters();
+    }
+  }));
+
   connect_filters();
 
   gconnections.push_back(g_signal_connect(settings, "changed::input-device",
@@ -126,6 +134,18 @@ StreamInputEffects::StreamInputEffects(PipeManager* pipe_manager)
                                             self->set_bypass(false);
                                           }),
                                           this));
+
+  gconnections.push_back(g_signal_connect(settings, "changed::fused-pipeline",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<StreamInputEffects*>(user_data);
+
+                                            if (g_settings_get_boolean(self->global_settings, "bypass") != 0) {
+                                              return;  // applied when the global bypass is disabled
+                                            }
+
+                                            self->set_bypass(false);
+                                          }),
+                                          this));
 }
 
 StreamInputEffects::~StreamInputEffects() {
@@ -174,7 +194,7 @@ void StreamInputEffects::on_link_changed(const LinkInfo link_info) {
   }
 
   if (apps_want_to_play()) {
-    if (list_proxies.empty()) {
+    if (chain_links.empty()) {
       util::debug("At least one app linked to our device wants to play. Linking our filters.");
 
       connect_filters();
@@ -185,7 +205,7 @@ void StreamInputEffects::on_link_changed(const LinkInfo link_info) {
       // if the timer is enabled, wait for the timeout, then unlink plugin pipeline
       int inactivity_timeout = g_settings_get_int(global_settings, "inactivity-timeout");
       g_timeout_add_seconds(inactivity_timeout, GSourceFunc(+[](StreamInputEffects* self) {
-                              if (!self->apps_want_to_play() && !self->list_proxies.empty()) {
+                              if (!self->apps_want_to_play() && !self->chain_links.empty()) {
                                 util::debug("No app linked to our device wants to play. Unlinking our filters.");
 
                                 self->disconnect_filters();
@@ -197,7 +217,7 @@ void StreamInputEffects::on_link_changed(const LinkInfo link_info) {
 
     } else {
       // otherwise, do nothing
-      if (!list_proxies.empty()) {
+      if (!chain_links.empty()) {
         util::debug(
             "No app linked to our device wants to play, but the inactivity timer is disabled. Leaving filters linked.");
       };
@@ -237,97 +257,71 @@ void StreamInputEffects::connect_filters(const bool& bypass) {
   const auto list =
       (bypass) ? std::vector<std::string>() : util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
 
-  auto mic_linked = false;
-
   // waiting for the input device ports information to be available.
 
-  int timeout = 0;
-
-  while (pm->count_node_ports(pm->input_device.id) < 1) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
-    timeout++;
+  const auto device_id = pm->input_device.id;
 
-    if (timeout > 10000) {
-      util::warning("Information about the ports of the input device " + pm->input_device.name + " with id " +
-                    util::to_string(pm->input_device.id) + " are taking to long to be available. Aborting the link");
+  if (!pm->wait_until([&] { return pm->count_node_ports(device_id) >= 1U; })) {
+    util::warning("Information about the ports of the input device " + pm->input_device.name + " with id " +
+                  util::to_string(pm->input_device.id) + " are taking to long to be available. Aborting the link");
 
-      return;
-    }
+    return;
   }
 
-  uint prev_node_id = pm->input_device.id;
-  uint next_node_id = 0U;
+  /*
+    Only the node order is decided here. link_chain compares it with what is already linked and rewires just the edges
+    that changed, so reordering or toggling plugins does not interrupt the audio.
+  */
 
-  // link plugins
+  std::vector<uint> nodes = {pm->input_device.id};
 
-  if (!list.empty()) {
-    for (const auto& name : list) {
-      if (!plugins.contains(name)) {
-        continue;
-      }
+  std::vector<std::pair<uint, uint>> probe_edges;
 
-      if (!plugins[name]->connected_to_pw ? plugins[name]->connect_to_pw() : true) {
-        next_node_id = plugins[name]->get_node_id();
+  auto fused = false;
 
-        const auto links = pm->link_nodes(prev_node_id, next_node_id);
+  if (!list.empty()) {
+    if (use_fused_chain(list)) {
+      if (connect_fused_chain(list)) {
+        nodes.push_back(fused_chain->get_node_id());
 
-        for (auto* link : links) {
-          list_proxies.push_back(link);
-        }
+        fused = true;
+      }
+    } else {
+      connect_concurrently(get_selected_plugins(list));
 
-        if (mic_linked && (links.size() == 2U)) {
-          prev_node_id = next_node_id;
-        } else if (!mic_linked && (!links.empty())) {
-          prev_node_id = next_node_id;
-          mic_linked = true;
-        } else {
-          util::warning(" link from node " + util::to_string(prev_node_id) + " to node " +
-                        util::to_string(next_node_id) + " failed");
+      for (const auto& name : list) {
+        if (plugins.contains(name) && plugins[name]->connected_to_pw) {
+          nodes.push_back(plugins[name]->get_node_id());
         }
       }
-    }
 
-    // checking if we have to link the echo_canceller probe to the output device
+      // checking if we have to link the echo_canceller probe to the output device
 
-    for (const auto& name : list) {
-      if (!plugins.contains(name)) {
-        continue;
-      }
+      for (const auto& name : list) {
+        if (!plugins.contains(name)) {
+          continue;
+        }
 
-      if (name.starts_with(tags::plugin_name::echo_canceller)) {
-        if (plugins[name]->connected_to_pw) {
-          for (const auto& link : pm->link_nodes(pm->output_device.id, plugins[name]->get_node_id(), true)) {
-            list_proxies.push_back(link);
+        if (name.starts_with(tags::plugin_name::echo_canceller)) {
+          if (plugins[name]->connected_to_pw) {
+            probe_edges.emplace_back(pm->output_device.id, plugins[name]->get_node_id());
           }
         }
-      }
 
-      plugins[name]->update_probe_links();
+        plugins[name]->update_probe_links();
+      }
     }
   }
 
-  // link spectrum, output level meter and source node
-
-  for (const auto node_id : {spectrum->get_node_id(), output_level->get_node_id(), pm->ee_source_node.id}) {
-    next_node_id = node_id;
+  // spectrum, output level meter and source node
 
-    const auto links = pm->link_nodes(prev_node_id, next_node_id);
+  nodes.push_back(spectrum->get_node_id());
+  nodes.push_back(output_level->get_node_id());
+  nodes.push_back(pm->ee_source_node.id);
 
-    for (auto* link : links) {
-      list_proxies.push_back(link);
-    }
+  link_chain(nodes, probe_edges, pm->input_device.id);
 
-    if (mic_linked && (links.size() == 2U)) {
-      prev_node_id = next_node_id;
-    } else if (!mic_linked && (!links.empty())) {
-      prev_node_id = next_node_id;
-      mic_linked = true;
-    } else {
-      util::warning(" link from node " + util::to_string(prev_node_id) + " to node " + util::to_string(next_node_id) +
-                    " failed");
-    }
-  }
+  disconnect_unused_filters(list, fused);
 }
 
 void StreamInputEffects::disconnect_filters() {
@@ -342,12 +336,12 @@ void StreamInputEffects::disconnect_filters() {
         link_id_list.insert(link.id);
       }
     }
+  }
 
-    if (plugin->connected_to_pw) {
-      if (std::ranges::find(selected_plugins_list, plugin->name) == selected_plugins_list.end()) {
-        util::debug("disconnecting the " + plugin->name + " filter from PipeWire");
-
-        plugin->disconnect_from_pw();
+  if (fused_chain->connected_to_pw) {
+    for (const auto& link : pm->list_links) {
+      if (link.input_node_id == fused_chain->get_node_id() || link.output_node_id == fused_chain->get_node_id()) {
+        link_id_list.insert(link.id);
       }
     }
   }
@@ -359,13 +353,19 @@ void StreamInputEffects::disconnect_filters() {
     }
   }
 
+  // Everything is removed with a single PipeWire round-trip
+
+  GraphTransaction transaction(pm);
+
   for (const auto& id : link_id_list) {
-    pm->destroy_object(static_cast<int>(id));
+    transaction.destroy_object(id);
   }
 
-  pm->destroy_links(list_proxies);
+  unlink_chain(transaction);
 
-  list_proxies.clear();
+  transaction.commit();
+
+  disconnect_unused_filters(selected_plugins_list, false);
 
   // remove_unused_filters();
 }
@@ -373,7 +373,7 @@ void StreamInputEffects::disconnect_filters() {
 void StreamInputEffects::set_bypass(const bool& state) {
   bypass = state;
 
-  disconnect_filters();
+  // The chain is rewired incrementally. Only the links that differ from the current ones are touched.
 
   connect_filters(state);
 }
@@ -27,14 +27,14 @@
 #include <sigc++/functors/mem_fun.h>
 #include <spa/utils/defs.h>
 #include <algorithm>
-#include <chrono>
 #include <cstdlib>
 #include <ranges>
 #include <set>
 #include <string>
-#include <thread>
+#include <utility>
 #include <vector>
 #include "effects_base.hpp"
+#include "graph_transaction.hpp"
 #include "pipe_manager.hpp"
 #include "pipe_objects.hpp"
 #include "tags_pipewire.hpp"
@@ -83,6 +83,14 @@ StreamOutputEffects::StreamOutputEffects(PipeManager* pipe_manager)
 
   connections.push_back(pm->stream_output_added.connect(sigc::mem_fun(*this, &StreamOutputEffects::on_app_added)));
 
+  // Plugins that finish loading are inserted in the running chain. Only the links around them are touched.
+
+  connections.push_back(plugin_loaded.connect([this](const std::string& name) {
+    if (!bypass) {
+      connect_filters();
+    }
+  }));
+
   connect_filters();
 
   gconnections.push_back(g_signal_connect(settings, "changed::output-device",
@@ -126,6 +134,18 @@ StreamOutputEffects::StreamOutputEffects(PipeManager* pipe_manager)
                                             self->set_bypass(false);
                                           }),
                                           this));
+
+  gconnections.push_back(g_signal_connect(settings, "changed::fused-pipeline",
+                                          G_CALLBACK(+[](GSettings* settings, char* key, gpointer user_data) {
+                                            auto* self = static_cast<StreamOutputEffects*>(user_data);
+
+                                            if (g_settings_get_boolean(self->global_settings, "bypass") != 0) {
+                                              return;  // applied when the global bypass is disabled
+                                            }
+
+                                            self->set_bypass(false);
+                                          }),
+                                          this));
 }
 
 StreamOutputEffects::~StreamOutputEffects() {
@@ -184,104 +204,78 @@ void StreamOutputEffects::connect_filters(const bool& bypass) {
   const auto list =
       (bypass) ? std::vector<std::string>() : util::gchar_array_to_vector(g_settings_get_strv(settings, "plugins"));
 
-  uint prev_node_id = pm->ee_sink_node.id;
-  uint next_node_id = 0U;
+  /*
+    Only the node order is decided here. link_chain compares it with what is already linked and rewires just the edges
+    that changed, so reordering or toggling plugins does not interrupt the audio.
+  */
 
-  // link plugins
+  std::vector<uint> nodes = {pm->ee_sink_node.id};
 
-  if (!list.empty()) {
-    for (const auto& name : list) {
-      if (!plugins.contains(name)) {
-        continue;
-      }
+  std::vector<std::pair<uint, uint>> probe_edges;
 
-      if (!plugins[name]->connected_to_pw ? plugins[name]->connect_to_pw() : true) {
-        next_node_id = plugins[name]->get_node_id();
+  auto fused = false;
 
-        const auto links = pm->link_nodes(prev_node_id, next_node_id);
+  if (!list.empty()) {
+    if (use_fused_chain(list)) {
+      if (connect_fused_chain(list)) {
+        nodes.push_back(fused_chain->get_node_id());
 
-        for (auto* link : links) {
-          list_proxies.push_back(link);
-        }
+        fused = true;
+      }
+    } else {
+      connect_concurrently(get_selected_plugins(list));
 
-        if (links.size() == 2U) {
-          prev_node_id = next_node_id;
-        } else {
-          util::warning(" link from node " + util::to_string(prev_node_id) + " to node " +
-                        util::to_string(next_node_id) + " failed");
+      for (const auto& name : list) {
+        if (plugins.contains(name) && plugins[name]->connected_to_pw) {
+          nodes.push_back(plugins[name]->get_node_id());
         }
       }
-    }
 
-    // checking if we have to link the echo_canceller probe to the output device
+      // checking if we have to link the echo_canceller probe to the output device
 
-    for (const auto& name : list) {
-      if (!plugins.contains(name)) {
-        continue;
-      }
+      for (const auto& name : list) {
+        if (!plugins.contains(name)) {
+          continue;
+        }
 
-      if (name.starts_with(tags::plugin_name::echo_canceller)) {
-        if (plugins[name]->connected_to_pw) {
-          for (const auto& link : pm->link_nodes(pm->output_device.id, plugins[name]->get_node_id(), true)) {
-            list_proxies.push_back(link);
+        if (name.starts_with(tags::plugin_name::echo_canceller)) {
+          if (plugins[name]->connected_to_pw) {
+            probe_edges.emplace_back(pm->output_device.id, plugins[name]->get_node_id());
           }
         }
-      }
 
-      plugins[name]->update_probe_links();
+        plugins[name]->update_probe_links();
+      }
     }
   }
 
-  // link spectrum and output level meter
-
-  for (const auto& node_id : {spectrum->get_node_id(), output_level->get_node_id()}) {
-    next_node_id = node_id;
+  // spectrum and output level meter
 
-    const auto links = pm->link_nodes(prev_node_id, next_node_id);
-
-    for (auto* link : links) {
-      list_proxies.push_back(link);
-    }
-
-    if (links.size() == 2U) {
-      prev_node_id = next_node_id;
-    } else {
-      util::warning(" link from node " + util::to_string(prev_node_id) + " to node " + util::to_string(next_node_id) +
-                    " failed");
-    }
-  }
+  nodes.push_back(spectrum->get_node_id());
+  nodes.push_back(output_level->get_node_id());
 
   // waiting for the output device ports information to be available.
 
-  int timeout = 0;
+  const auto device_id = pm->output_device.id;
 
-  while (pm->count_node_ports(pm->output_device.id) < 2) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  if (!pm->wait_until([&] { return pm->count_node_ports(device_id) >= 2U; })) {
+    util::warning("Information about the ports of the output device " + pm->output_device.name + " with id " +
+                  util::to_string(pm->output_device.id) + " are taking to long to be available. Aborting the link");
 
-    timeout++;
+    link_chain(nodes, probe_edges, pm->output_device.id);
 
-    if (timeout > 10000) {  // 10 seconds
-      util::warning("Information about the ports of the output device " + pm->output_device.name + " with id " +
-                    util::to_string(pm->output_device.id) + " are taking to long to be available. Aborting the link");
+    disconnect_unused_filters(list, fused);
 
-      return;
-    }
+    return;
   }
 
-  // link output device
+  // output device
 
-  next_node_id = pm->output_device.id;
+  nodes.push_back(pm->output_device.id);
 
-  const auto links = pm->link_nodes(prev_node_id, next_node_id);
+  link_chain(nodes, probe_edges, pm->output_device.id);
 
-  for (auto* link : links) {
-    list_proxies.push_back(link);
-  }
-
-  if (links.size() < 2U) {
-    util::warning(" link from node " + util::to_string(prev_node_id) + " to output device " +
-                  util::to_string(next_node_id) + " failed");
-  }
+  disconnect_unused_filters(list, fused);
 }
 
 void StreamOutputEffects::disconnect_filters() {
@@ -296,12 +290,12 @@ void StreamOutputEffects::disconnect_filters() {
         link_id_list.insert(link.id);
       }
     }
+  }
 
-    if (plugin->connected_to_pw) {
-      if (std::ranges::find(selected_plugins_list, plugin->name) == selected_plugins_list.end()) {
-        util::debug("disconnecting the " + plugin->name + " filter from PipeWire");
-
-        plugin->disconnect_from_pw();
+  if (fused_chain->connected_to_pw) {
+    for (const auto& link : pm->list_links) {
+      if (link.input_node_id == fused_chain->get_node_id() || link.output_node_id == fused_chain->get_node_id()) {
+        link_id_list.insert(link.id);
       }
     }
   }
@@ -313,13 +307,19 @@ void StreamOutputEffects::disconnect_filters() {
     }
   }
 
+  // Everything is removed with a single PipeWire round-trip
+
+  GraphTransaction transaction(pm);
+
   for (const auto& id : link_id_list) {
-    pm->destroy_object(static_cast<int>(id));
+    transaction.destroy_object(id);
   }
 
-  pm->destroy_links(list_proxies);
+  unlink_chain(transaction);
 
-  list_proxies.clear();
+  transaction.commit();
+
+  disconnect_unused_filters(selected_plugins_list, false);
 
   // remove_unused_filters();
 }
@@ -327,7 +327,7 @@ void StreamOutputEffects::disconnect_filters() {
 void StreamOutputEffects::set_bypass(const bool& state) {
   bypass = state;
 
-  disconnect_filters();
+  // The chain is rewired incrementally. Only the links that differ from the current ones are touched.
 
   connect_filters(state);
 }
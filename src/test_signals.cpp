@@ -22,14 +22,13 @@
 #include <pipewire/keys.h>
 #include <pipewire/port.h>
 #include <pipewire/properties.h>
+#include <pipewire/thread-loop.h>
 #include <spa/node/io.h>
 #include <spa/utils/hook.h>
 #include <sys/types.h>
-#include <chrono>
 #include <cmath>
 #include <numbers>
 #include <span>
-#include <thread>
 #include "pipe_manager.hpp"
 #include "tags_app.hpp"
 #include "util.hpp"
@@ -130,6 +129,8 @@ void on_filter_state_changed(void* userdata, pw_filter_state old, pw_filter_stat
     default:
       break;
   }
+
+  pw_thread_loop_signal(d->pm->thread_loop, false);
 }
 
 const struct pw_filter_events filter_events = {.state_changed = on_filter_state_changed, .process = on_process};
@@ -138,6 +139,7 @@ const struct pw_filter_events filter_events = {.state_changed = on_filter_state_
 
 TestSignals::TestSignals(PipeManager* pipe_manager) : pm(pipe_manager), random_generator(rd()) {
   pf_data.ts = this;
+  pf_data.pm = pm;
 
   const auto* filter_name = "ee_test_signals";
 
@@ -192,16 +194,14 @@ TestSignals::TestSignals(PipeManager* pipe_manager) : pm(pipe_manager), random_g
 
   pm->sync_wait_unlock();
 
-  while (!can_get_node_id) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  pm->wait_until([this] { return can_get_node_id || state == PW_FILTER_STATE_ERROR; });
 
-    if (state == PW_FILTER_STATE_ERROR) {
-      using namespace std::string_literals;
+  if (!can_get_node_id) {
+    using namespace std::string_literals;
 
-      util::warning(filter_name + " is in an error"s);
+    util::warning(filter_name + " is in an error"s);
 
-      return;
-    }
+    return;
   }
 
   pm->lock();
@@ -0,0 +1,206 @@
+/*
+ *  Copyright © 2017-2025 Wellington Wallace
+ *
+ *  This file is part of Easy Effects.
+ *
+ *  Easy Effects is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Easy Effects is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Easy Effects. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tracer.hpp"
+#include <sys/types.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+#include "util.hpp"
+
+namespace {
+
+struct Event {
+  std::string name;
+
+  int64_t ts = 0;  // us since origin, which is taken at static initialization
+
+  int64_t dur = 0;  // us
+
+  uint tid = 0U;
+};
+
+std::atomic<bool> enabled = false;
+
+std::mutex mutex;
+
+// Spans kept in memory before they are appended to the output file
+
+constexpr auto max_pending_events = 4096U;
+
+std::vector<Event> events;
+
+std::string output_path;
+
+bool file_started = false;
+
+bool file_closed = false;
+
+const auto origin = std::chrono::steady_clock::now();
+
+// Small and stable thread ids read better in the trace viewers than the native ones
+
+auto thread_index() -> uint {
+  static std::atomic<uint> next = 1U;
+
+  thread_local const uint index = next.fetch_add(1U);
+
+  return index;
+}
+
+auto to_us(const std::chrono::steady_clock::duration& d) -> int64_t {
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+/*
+  The file uses the JSON array variant of the trace event format. Its closing bracket is optional, so the spans can be
+  appended as they are flushed and the file stays readable even if the application never reaches the shutdown.
+*/
+
+void flush_locked() {
+  if (file_closed) {
+    events.clear();
+  }
+
+  if (events.empty()) {
+    return;
+  }
+
+  std::ofstream file(output_path, file_started ? std::ios::app : std::ios::trunc);
+
+  if (!file.is_open()) {
+    util::warning("could not open the trace file " + output_path);
+
+    events.clear();
+
+    return;
+  }
+
+  const auto pid = static_cast<int64_t>(getpid());
+
+  for (const auto& e : events) {
+    file << (file_started ? ",\n" : "[\n");
+
+    file << nlohmann::json{{"name", e.name},
+                           {"cat", "easyeffects"},
+                           {"ph", "X"},
+                           {"ts", e.ts},
+                           {"dur", e.dur},
+                           {"pid", pid},
+                           {"tid", e.tid}}
+                .dump();
+
+    file_started = true;
+  }
+
+  util::debug("trace: " + util::to_string(events.size()) + " spans appended to " + output_path);
+
+  events.clear();
+}
+
+}  // namespace
+
+namespace tracer {
+
+void enable(const std::string& output_file) {
+  {
+    std::scoped_lock<std::mutex> lock(mutex);
+
+    output_path = output_file;
+  }
+
+  enabled.store(true, std::memory_order_release);
+
+  util::debug("tracing enabled. The trace will be written to " + output_file);
+}
+
+auto is_enabled() -> bool {
+  return enabled.load(std::memory_order_acquire);
+}
+
+void flush() {
+  if (!is_enabled()) {
+    return;
+  }
+
+  std::scoped_lock<std::mutex> lock(mutex);
+
+  flush_locked();
+}
+
+void write() {
+  if (!is_enabled()) {
+    return;
+  }
+
+  std::scoped_lock<std::mutex> lock(mutex);
+
+  flush_locked();
+
+  if (file_started && !file_closed) {
+    std::ofstream file(output_path, std::ios::app);
+
+    file << "\n]\n";
+  }
+
+  file_closed = true;
+
+  util::debug("trace written to " + output_path);
+}
+
+Span::Span(const char* name) : active(is_enabled()) {
+  if (active) {
+    this->name = name;
+
+    start = std::chrono::steady_clock::now();
+  }
+}
+
+Span::~Span() {
+  end();
+}
+
+void Span::end() {
+  if (!active) {
+    return;
+  }
+
+  active = false;
+
+  const auto now = std::chrono::steady_clock::now();
+
+  std::scoped_lock<std::mutex> lock(mutex);
+
+  events.push_back(
+      {.name = std::move(name), .ts = to_us(start - origin), .dur = to_us(now - start), .tid = thread_index()});
+
+  if (events.size() >= max_pending_events) {
+    flush_locked();
+  }
+}
+
+}  // namespace tracer
@@ -30,11 +30,16 @@
 #include <gtk/gtkshortcut.h>
 #include <sys/types.h>
 #include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <locale>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include "meter_board.hpp"
+#include "plugin_base.hpp"
 #include "tags_app.hpp"
 #include "tags_plugin_name.hpp"
 #include "util.hpp"
@@ -248,6 +253,66 @@ void update_level(GtkLevelBar* w_left,
   }
 }
 
+auto add_meter_tick_callback(GtkWidget* widget,
+                             std::shared_ptr<PluginBase> plugin,
+                             std::function<void(const MeterBoard::Slot&)> update) -> guint {
+  if (plugin->meter_slot == nullptr) {
+    return 0U;
+  }
+
+  struct Data {
+    std::shared_ptr<PluginBase> plugin;
+
+    std::function<void(const MeterBoard::Slot&)> update;
+
+    uint64_t sequence = 0U;
+  };
+
+  auto* d = new Data{.plugin = std::move(plugin), .update = std::move(update)};
+
+  return gtk_widget_add_tick_callback(
+      widget,
+      +[](GtkWidget* widget, GdkFrameClock* frame_clock, gpointer user_data) {
+        auto* d = static_cast<Data*>(user_data);
+
+        if (gtk_widget_get_mapped(widget) == 0) {
+          return G_SOURCE_CONTINUE;
+        }
+
+        const auto& slot = *d->plugin->meter_slot;
+
+        if (const auto sequence = slot.get_sequence(); sequence != d->sequence) {
+          d->sequence = sequence;
+
+          d->update(slot);
+        }
+
+        return G_SOURCE_CONTINUE;
+      },
+      d, +[](gpointer user_data) { delete static_cast<Data*>(user_data); });
+}
+
+void bind_level_meters(GtkWidget* widget,
+                       std::shared_ptr<PluginBase> plugin,
+                       GtkLevelBar* input_left,
+                       GtkLabel* input_left_label,
+                       GtkLevelBar* input_right,
+                       GtkLabel* input_right_label,
+                       GtkLevelBar* output_left,
+                       GtkLabel* output_left_label,
+                       GtkLevelBar* output_right,
+                       GtkLabel* output_right_label) {
+  add_meter_tick_callback(widget, std::move(plugin), [=](const MeterBoard::Slot& slot) {
+    update_level(input_left, input_left_label, input_right, input_right_label,
+                 slot.input_left.load(std::memory_order_relaxed), slot.input_right.load(std::memory_order_relaxed));
+
+    if (output_left != nullptr) {
+      update_level(output_left, output_left_label, output_right, output_right_label,
+                   slot.output_left.load(std::memory_order_relaxed), slot.output_right.load(std::memory_order_relaxed));
+    }
+  });
+}
+
 auto get_plugin_credit_translated(const std::string& plugin_package) -> std::string {
   try {
     // For translators: {} is replaced by the library used by the plugin. I.e. "Using Calf Studio".